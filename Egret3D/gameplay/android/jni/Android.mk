@@ -49,12 +49,16 @@ LOCAL_SRC_FILES := \
     Font.cpp \
     Form.cpp \
     FrameBuffer.cpp \
+    FramePacket.cpp \
+    FrameScheduler.cpp \
     Frustum.cpp \
     Game.cpp \
     Gamepad.cpp \
+    GlyphCache.cpp \
     HeightField.cpp \
     Image.cpp \
     ImageControl.cpp \
+    ImageLoader.cpp \
     Joint.cpp \
     JoystickControl.cpp \
     Label.cpp \
@@ -73,6 +77,7 @@ LOCAL_SRC_FILES := \
     Node.cpp \
     ParticleEmitter.cpp \
     Pass.cpp \
+    PerformanceCounters.cpp \
     PhysicsCharacter.cpp \
     PhysicsCollisionObject.cpp \
     PhysicsCollisionShape.cpp \
@@ -90,6 +95,7 @@ LOCAL_SRC_FILES := \
     Plane.cpp \
     Platform.cpp \
     PlatformAndroid.cpp \
+    Profiler.cpp \
     Properties.cpp \
     Quaternion.cpp \
     RadioButton.cpp \
@@ -104,15 +110,19 @@ LOCAL_SRC_FILES := \
     Script.cpp \
     ScriptController.cpp \
     ScriptTarget.cpp \
+    ShaderPreprocessor.cpp \
     Slider.cpp \
     Sprite.cpp \
     SpriteBatch.cpp \
     Technique.cpp \
     Terrain.cpp \
+    TerrainPager.cpp \
     TerrainPatch.cpp \
     Text.cpp \
     TextBox.cpp \
     Texture.cpp \
+    TextureAtlas.cpp \
+    TextureDecompressor.cpp \
     Theme.cpp \
     ThemeStyle.cpp \
     TileSet.cpp \
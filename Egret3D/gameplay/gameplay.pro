@@ -47,14 +47,20 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Font.cpp \
     src/Form.cpp \
     src/FrameBuffer.cpp \
+    src/FramePacket.cpp \
+    src/FramePacket.inl \
+    src/FrameScheduler.cpp \
+    src/FrameScheduler.inl \
     src/Frustum.cpp \
     src/Game.cpp \
     src/Game.inl \
     src/Gamepad.cpp \
+    src/GlyphCache.cpp \
     src/HeightField.cpp \
     src/Image.cpp \
     src/Image.inl \
     src/ImageControl.cpp \
+    src/ImageLoader.cpp \
     src/Joint.cpp \
     src/JoystickControl.cpp \
     src/Label.cpp \
@@ -77,6 +83,8 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Node.cpp \
     src/ParticleEmitter.cpp \
     src/Pass.cpp \
+    src/PerformanceCounters.cpp \
+    src/PerformanceCounters.inl \
     src/PhysicsCharacter.cpp \
     src/PhysicsCollisionObject.cpp \
     src/PhysicsCollisionShape.cpp \
@@ -99,6 +107,7 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/Plane.cpp \
     src/Plane.inl \
     src/Platform.cpp \
+    src/Profiler.cpp \
     src/Properties.cpp \
     src/Quaternion.cpp \
     src/Quaternion.inl \
@@ -116,15 +125,19 @@ SOURCES += src/AbsoluteLayout.cpp \
     src/ScriptController.cpp \
     src/ScriptController.inl \
     src/ScriptTarget.cpp \
+    src/ShaderPreprocessor.cpp \
     src/Slider.cpp \
     src/Sprite.cpp \
     src/SpriteBatch.cpp \
     src/Technique.cpp \
     src/Terrain.cpp \
+    src/TerrainPager.cpp \
     src/TerrainPatch.cpp \
     src/Text.cpp \
     src/TextBox.cpp \
     src/Texture.cpp \
+    src/TextureAtlas.cpp \
+    src/TextureDecompressor.cpp \
     src/Theme.cpp \
     src/ThemeStyle.cpp \
     src/TileSet.cpp \
@@ -307,20 +320,25 @@ HEADERS += src/AbsoluteLayout.h \
     src/Font.h \
     src/Form.h \
     src/FrameBuffer.h \
+    src/FramePacket.h \
+    src/FrameScheduler.h \
     src/Frustum.h \
     src/Game.h \
     src/Gamepad.h \
     src/gameplay.h \
     src/Gesture.h \
+    src/GlyphCache.h \
     src/HeightField.h \
     src/Image.h \
     src/ImageControl.h \
+    src/ImageLoader.h \
     src/Joint.h \
     src/JoystickControl.h \
     src/Keyboard.h \
     src/Label.h \
     src/Layout.h \
     src/Light.h \
+    src/LockFreeQueue.h \
     src/Logger.h \
     src/Material.h \
     src/MaterialParameter.h \
@@ -335,6 +353,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/Node.h \
     src/ParticleEmitter.h \
     src/Pass.h \
+    src/PerformanceCounters.h \
     src/PhysicsCharacter.h \
     src/PhysicsCollisionObject.h \
     src/PhysicsCollisionShape.h \
@@ -351,6 +370,7 @@ HEADERS += src/AbsoluteLayout.h \
     src/PhysicsVehicleWheel.h \
     src/Plane.h \
     src/Platform.h \
+    src/Profiler.h \
     src/Properties.h \
     src/Quaternion.h \
     src/RadioButton.h \
@@ -365,16 +385,20 @@ HEADERS += src/AbsoluteLayout.h \
     src/Script.h \
     src/ScriptController.h \
     src/ScriptTarget.h \
+    src/ShaderPreprocessor.h \
     src/Slider.h \
     src/Sprite.h \
     src/SpriteBatch.h \
     src/Stream.h \
     src/Technique.h \
     src/Terrain.h \
+    src/TerrainPager.h \
     src/TerrainPatch.h \
     src/Text.h \
     src/TextBox.h \
     src/Texture.h \
+    src/TextureAtlas.h \
+    src/TextureDecompressor.h \
     src/Theme.h \
     src/ThemeStyle.h \
     src/TileSet.h \
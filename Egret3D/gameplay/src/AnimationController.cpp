@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "AnimationController.h"
+#include "PerformanceCounters.h"
 #include "Game.h"
 #include "Curve.h"
 
@@ -97,6 +98,8 @@ void AnimationController::update(float elapsedTime)
 {
     if (_state != RUNNING)
         return;
+
+    PerformanceCounters::add(PerformanceCounters::ANIMATION_CLIPS_RUNNING, (unsigned int)_runningClips.size());
     
     Transform::suspendTransformChanged();
 
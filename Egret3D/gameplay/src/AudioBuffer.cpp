@@ -39,9 +39,25 @@ static long tellStream(void* datasource)
 }
 
 AudioBuffer::AudioBuffer(const char* path, ALuint* buffer, bool streamed)
-: _filePath(path), _streamed(streamed), _buffersNeededCount(0)
+: _filePath(path), _streamed(streamed), _duration(0.0f), _buffersNeededCount(0), _buffersPrefilledCount(1), _streamLooped(false), _streamEnded(false),
+  _streamGeneration(0), _decodedGeneration(0)
 {
     memcpy(_alBufferQueue, buffer, sizeof(_alBufferQueue));
+    if (streamed)
+    {
+        _streamChunks.reset(new LockFreeQueue<StreamChunk, STREAMING_DECODE_AHEAD>());
+    }
+    else
+    {
+        // Virtual voices advance their playback position using the buffer duration.
+        ALint size = 0, frequency = 0, channels = 0, bits = 0;
+        AL_CHECK( alGetBufferi(_alBufferQueue[0], AL_SIZE, &size) );
+        AL_CHECK( alGetBufferi(_alBufferQueue[0], AL_FREQUENCY, &frequency) );
+        AL_CHECK( alGetBufferi(_alBufferQueue[0], AL_CHANNELS, &channels) );
+        AL_CHECK( alGetBufferi(_alBufferQueue[0], AL_BITS, &bits) );
+        if (frequency > 0 && channels > 0 && bits > 0)
+            _duration = (float)size / (float)(frequency * channels * (bits / 8));
+    }
 }
 
 AudioBuffer::~AudioBuffer()
@@ -168,6 +184,10 @@ AudioBuffer* AudioBuffer::create(const char* path, bool streamed)
     else if (buffer->_streamStateOgg.get())
         buffer->_buffersNeededCount = (buffer->_streamStateOgg->dataSize + STREAMING_BUFFER_SIZE - 1) / STREAMING_BUFFER_SIZE;
 
+    // Start playback with the whole queue, not just the buffer filled by the loader.
+    if (streamed)
+        buffer->_buffersPrefilledCount = buffer->prefill();
+
     if (!streamed)
         __buffers.push_back(buffer);
 
@@ -466,22 +486,17 @@ bool AudioBuffer::loadOgg(Stream* stream, ALuint buffer, bool streamed, AudioStr
     return true;
 }
 
-bool AudioBuffer::streamData(ALuint buffer, bool looped)
+unsigned int AudioBuffer::decodeData(char* data, bool looped)
 {
-    static char buffers[STREAMING_BUFFER_SIZE];
-    
     if (_streamStateWav.get())
     {
-        ALsizei bytesRead = _fileStream->read(buffers, sizeof(char), STREAMING_BUFFER_SIZE);
+        ALsizei bytesRead = _fileStream->read(data, sizeof(char), STREAMING_BUFFER_SIZE);
         if (bytesRead != STREAMING_BUFFER_SIZE)
         {
             if (looped)
                 _fileStream->seek(_streamStateWav->dataStart, SEEK_SET);
         }
-        if (bytesRead > 0)
-            AL_CHECK(alBufferData(buffer, _streamStateWav->format, buffers, bytesRead, _streamStateWav->frequency));
-        
-        return bytesRead > 0 || looped;
+        return bytesRead > 0 ? bytesRead : 0;
     }
     else if (_streamStateOgg.get())
     {
@@ -491,7 +506,7 @@ bool AudioBuffer::streamData(ALuint buffer, bool looped)
 
         while (bytesRead < STREAMING_BUFFER_SIZE)
         {
-            result = ov_read(&_streamStateOgg->oggFile, buffers + bytesRead, STREAMING_BUFFER_SIZE - bytesRead, 0, 2, 1, &section);
+            result = ov_read(&_streamStateOgg->oggFile, data + bytesRead, STREAMING_BUFFER_SIZE - bytesRead, 0, 2, 1, &section);
             if (result > 0)
             {
                 bytesRead += result;
@@ -503,14 +518,126 @@ bool AudioBuffer::streamData(ALuint buffer, bool looped)
                 break;
             }
         }
+        return bytesRead;
+    }
 
-        if (bytesRead > 0)
-            AL_CHECK(alBufferData(buffer, _streamStateOgg->format, buffers, bytesRead, _streamStateOgg->frequency));
-        
-        return (bytesRead > 0) || looped;
+    return 0;
+}
+
+void AudioBuffer::rewindData()
+{
+    if (_streamStateWav.get())
+        _fileStream->seek(_streamStateWav->dataStart, SEEK_SET);
+    else if (_streamStateOgg.get())
+        ov_pcm_seek(&_streamStateOgg->oggFile, _streamStateOgg->dataStart);
+}
+
+int AudioBuffer::prefill()
+{
+    int count = std::min<int>(_buffersNeededCount, STREAMING_BUFFER_QUEUE_SIZE);
+    if (count <= 1)
+        return 1;
+
+    ALuint format = _streamStateWav.get() ? _streamStateWav->format : _streamStateOgg->format;
+    ALuint frequency = _streamStateWav.get() ? _streamStateWav->frequency : _streamStateOgg->frequency;
+    char* data = new char[STREAMING_BUFFER_SIZE];
+    int filled = 1;
+    for (; filled < count; ++filled)
+    {
+        unsigned int size = decodeData(data, false);
+        if (size == 0)
+            break;
+        AL_CHECK( alBufferData(_alBufferQueue[filled], format, data, size, frequency) );
     }
-    
-    return false;
+    SAFE_DELETE_ARRAY(data);
+
+    return filled;
+}
+
+void AudioBuffer::rewindStream()
+{
+    GP_ASSERT(_streamChunks.get());
+
+    // The streaming thread seeks back once it sees the new generation, so that it keeps
+    // sole ownership of the file stream. Chunks it already decoded are dropped here.
+    ++_streamGeneration;
+    while (_streamChunks->front())
+        _streamChunks->popFront();
+}
+
+bool AudioBuffer::decodeAhead()
+{
+    GP_ASSERT(_streamChunks.get());
+
+    bool decoded = false;
+    StreamChunk* chunk;
+    for (;;)
+    {
+        // Start over when the main thread rewound the stream
+        unsigned int generation = _streamGeneration;
+        if (generation != _decodedGeneration)
+        {
+            rewindData();
+            _streamEnded = false;
+            _decodedGeneration = generation;
+        }
+        if (_streamEnded || (chunk = _streamChunks->beginWrite()) == NULL)
+            break;
+
+        bool looped = _streamLooped;
+        chunk->generation = generation;
+        chunk->size = decodeData(chunk->data, looped);
+        if (chunk->size == 0 && looped)
+        {
+            // The stream wrapped exactly at the end of the data, so decode again from the start
+            chunk->size = decodeData(chunk->data, looped);
+        }
+        if (chunk->size == 0)
+        {
+            _streamEnded = true;
+            break;
+        }
+        _streamChunks->endWrite();
+        decoded = true;
+    }
+    return decoded;
+}
+
+bool AudioBuffer::streamData(ALuint buffer)
+{
+    GP_ASSERT(_streamChunks.get());
+
+    StreamChunk* chunk = frontChunk();
+    if (!chunk)
+        return false;
+
+    ALuint format = _streamStateWav.get() ? _streamStateWav->format : _streamStateOgg->format;
+    ALuint frequency = _streamStateWav.get() ? _streamStateWav->frequency : _streamStateOgg->frequency;
+    AL_CHECK(alBufferData(buffer, format, chunk->data, chunk->size, frequency));
+    _streamChunks->popFront();
+
+    return true;
+}
+
+bool AudioBuffer::hasStreamData()
+{
+    return frontChunk() != NULL;
+}
+
+bool AudioBuffer::isStreamFinished()
+{
+    // A rewound stream is not finished until the streaming thread has started over
+    return _decodedGeneration == _streamGeneration && _streamEnded && frontChunk() == NULL;
+}
+
+AudioBuffer::StreamChunk* AudioBuffer::frontChunk()
+{
+    GP_ASSERT(_streamChunks.get());
+
+    StreamChunk* chunk;
+    while ((chunk = _streamChunks->front()) != NULL && chunk->generation != _streamGeneration)
+        _streamChunks->popFront();
+    return chunk;
 }
 
 }
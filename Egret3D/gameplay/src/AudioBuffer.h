@@ -3,6 +3,7 @@
 
 #include "Ref.h"
 #include "Stream.h"
+#include "LockFreeQueue.h"
 
 namespace egret
 {
@@ -17,6 +18,7 @@ class AudioSource;
 class AudioBuffer : public Ref
 {
     friend class AudioSource;
+    friend class AudioController;
 
 private:
     
@@ -63,20 +65,112 @@ private:
 
     enum { STREAMING_BUFFER_QUEUE_SIZE = 3 };
     enum { STREAMING_BUFFER_SIZE = 48000 };
+    enum { STREAMING_DECODE_AHEAD = 4 };
+
+    /**
+     * A chunk of decoded audio data waiting to be queued on an OpenAL buffer.
+     */
+    struct StreamChunk
+    {
+        char data[STREAMING_BUFFER_SIZE];
+        unsigned int size;
+        unsigned int generation;
+    };
 
     static bool loadWav(Stream* stream, ALuint buffer, bool streamed, AudioStreamStateWav* streamState);
     
     static bool loadOgg(Stream* stream, ALuint buffer, bool streamed, AudioStreamStateOgg* streamState);
 
-    bool streamData(ALuint buffer, bool looped);
+    /**
+     * Decodes the next chunk of streamed audio data.
+     *
+     * @param data The destination for the decoded data (STREAMING_BUFFER_SIZE bytes).
+     * @param looped Whether to seek back to the start of the data when the end is reached.
+     *
+     * @return The number of bytes decoded; zero once the end of a non-looped stream is reached.
+     */
+    unsigned int decodeData(char* data, bool looped);
+
+    /**
+     * Seeks back to the start of the streamed audio data.
+     */
+    void rewindData();
+
+    /**
+     * Fills the OpenAL buffers of the streaming queue with the start of the stream.
+     *
+     * Called from the main thread only, before the stream is decoded ahead.
+     *
+     * @return The number of buffers filled.
+     */
+    int prefill();
+
+    /**
+     * Restarts the stream from the beginning.
+     *
+     * Called from the main thread only. Decoded data is discarded and the streaming
+     * thread decodes again from the start of the stream.
+     */
+    void rewindStream();
+
+    /**
+     * Decodes chunks ahead of playback until the decode-ahead queue is full.
+     *
+     * Called from the audio streaming thread only.
+     *
+     * @return True if any data was decoded.
+     */
+    bool decodeAhead();
+
+    /**
+     * Fills the given OpenAL buffer with the next decoded chunk.
+     *
+     * Called from the main thread only; never decodes.
+     *
+     * @param buffer The OpenAL buffer to fill.
+     *
+     * @return True if the buffer was filled, false if no decoded data was available.
+     */
+    bool streamData(ALuint buffer);
+
+    /**
+     * Determines whether decoded data is available to stream.
+     *
+     * Called from the main thread only.
+     *
+     * @return True if streamData can fill a buffer.
+     */
+    bool hasStreamData();
+
+    /**
+     * Determines whether the end of a non-looped stream has been decoded and all
+     * decoded data has been consumed.
+     *
+     * Called from the main thread only.
+     *
+     * @return True if there is no more data to stream.
+     */
+    bool isStreamFinished();
+
+    /**
+     * Gets the next decoded chunk, discarding chunks decoded before the stream was rewound.
+     */
+    StreamChunk* frontChunk();
 
     ALuint _alBufferQueue[STREAMING_BUFFER_QUEUE_SIZE];
     std::string _filePath;
     bool _streamed;
+    float _duration;
     std::unique_ptr<Stream> _fileStream;
     std::unique_ptr<AudioStreamStateWav> _streamStateWav;
     std::unique_ptr<AudioStreamStateOgg> _streamStateOgg;
     int _buffersNeededCount;
+    int _buffersPrefilledCount;
+    std::unique_ptr<LockFreeQueue<StreamChunk, STREAMING_DECODE_AHEAD> > _streamChunks;
+    std::atomic<bool> _streamLooped;
+    std::atomic<bool> _streamEnded;
+    std::atomic<unsigned int> _streamGeneration;
+    std::atomic<unsigned int> _decodedGeneration;
 };
 
 }
@@ -3,12 +3,32 @@
 #include "AudioListener.h"
 #include "AudioBuffer.h"
 #include "AudioSource.h"
+#include "Game.h"
+
+// Device name that selects the OpenAL Soft loopback device, which mixes without any audio output.
+#define AUDIO_LOOPBACK_DEVICE "loopback"
+
+// Loopback device mixing format.
+#define AUDIO_LOOPBACK_FREQUENCY 44100
+
+// Default number of voices shared by non-streamed sources.
+#define AUDIO_DEFAULT_VOICES 32
+
+// Maximum time the streaming thread sleeps before re-checking its streams.
+#define STREAMING_THREAD_TIMEOUT 100
 
 namespace egret
 {
 
+#ifdef ALC_SOFT_loopback
+static LPALCLOOPBACKOPENDEVICESOFT __alcLoopbackOpenDeviceSOFT = NULL;
+static LPALCRENDERSAMPLESSOFT __alcRenderSamplesSOFT = NULL;
+#endif
+
 AudioController::AudioController() 
-: _alcDevice(NULL), _alcContext(NULL), _pausingSource(NULL), _streamingThreadActive(true)
+: _alcDevice(NULL), _alcContext(NULL), _loopbackDevice(false), _pausingSource(NULL), _voiceCount(0), _virtualSourceCount(0),
+  _streamingThreadActive(true),
+  _streamingWake(false), _streamingUnderruns(0)
 {
 }
 
@@ -18,14 +38,48 @@ AudioController::~AudioController()
 
 void AudioController::initialize()
 {
-    _alcDevice = alcOpenDevice(NULL);
+    // The device can be selected with the 'device' property of the 'audio' config namespace.
+    Properties* config = Game::getInstance()->getConfig()->getNamespace("audio", true);
+    const char* deviceName = config ? config->getString("device") : NULL;
+    ALCint* attributes = NULL;
+
+    if (deviceName && strcmp(deviceName, AUDIO_LOOPBACK_DEVICE) == 0)
+    {
+#ifdef ALC_SOFT_loopback
+        // Loopback devices render on demand (see update), so playback is driven by game time only.
+        static ALCint loopbackAttributes[] =
+        {
+            ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+            ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+            ALC_FREQUENCY, AUDIO_LOOPBACK_FREQUENCY,
+            0
+        };
+        if (alcIsExtensionPresent(NULL, "ALC_SOFT_loopback"))
+        {
+            __alcLoopbackOpenDeviceSOFT = (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+            __alcRenderSamplesSOFT = (LPALCRENDERSAMPLESSOFT)alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+        }
+        if (__alcLoopbackOpenDeviceSOFT && __alcRenderSamplesSOFT)
+        {
+            _alcDevice = __alcLoopbackOpenDeviceSOFT(NULL);
+            _loopbackDevice = _alcDevice != NULL;
+            attributes = loopbackAttributes;
+        }
+#endif
+        if (!_loopbackDevice)
+            GP_WARN("OpenAL loopback device is not supported; using the default device.");
+        deviceName = NULL;
+    }
+
+    if (!_alcDevice)
+        _alcDevice = alcOpenDevice(deviceName);
     if (!_alcDevice)
     {
         GP_ERROR("Unable to open OpenAL device.\n");
         return;
     }
     
-    _alcContext = alcCreateContext(_alcDevice, NULL);
+    _alcContext = alcCreateContext(_alcDevice, attributes);
     ALCenum alcErr = alcGetError(_alcDevice);
     if (!_alcContext || alcErr != ALC_NO_ERROR)
     {
@@ -40,7 +94,26 @@ void AudioController::initialize()
     {
         GP_ERROR("Unable to make OpenAL context current. Error: %d\n", alcErr);
     }
+
+    // Create the voices shared by non-streamed sources.
+    unsigned int voiceCount = AUDIO_DEFAULT_VOICES;
+    if (config && config->exists("voices"))
+        voiceCount = (unsigned int)std::max(config->getInt("voices"), 1);
+    _freeVoices.reserve(voiceCount);
+    for (unsigned int i = 0; i < voiceCount; ++i)
+    {
+        ALuint voice = 0;
+        AL_CHECK( alGenSources(1, &voice) );
+        if (AL_LAST_ERROR())
+        {
+            GP_WARN("Only %u of %u audio voices could be created.", i, voiceCount);
+            break;
+        }
+        _freeVoices.push_back(voice);
+    }
+    _voiceCount = (unsigned int)_freeVoices.size();
     _streamingMutex.reset(new std::mutex());
+    _streamingCondition.reset(new std::condition_variable());
 }
 
 void AudioController::finalize()
@@ -48,10 +121,41 @@ void AudioController::finalize()
     GP_ASSERT(_streamingSources.empty());
     if (_streamingThread.get())
     {
+        // Make room for the streams retired while the thread drains its commands.
+        releaseRetiredStreams();
+
         _streamingThreadActive = false;
+        wakeStreamingThread();
         _streamingThread->join();
         _streamingThread.reset(NULL);
     }
+    releaseRetiredStreams();
+
+    // The streaming thread has exited, so release the streams it still owned.
+    StreamCommand command;
+    while (_streamingCommands.pop(&command))
+    {
+        if (command.add)
+        {
+            _streams.push_back(command.buffer);
+        }
+        else
+        {
+            _streams.erase(std::find(_streams.begin(), _streams.end(), command.buffer));
+            SAFE_RELEASE(command.buffer);
+        }
+    }
+    for (size_t i = 0, count = _streams.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_streams[i]);
+    }
+    _streams.clear();
+
+    GP_ASSERT(_freeVoices.size() == _voiceCount);
+    if (!_freeVoices.empty())
+        AL_CHECK( alDeleteSources((ALsizei)_freeVoices.size(), &_freeVoices[0]) );
+    _freeVoices.clear();
+    _voiceCount = 0;
 
     alcMakeContextCurrent(NULL);
     if (_alcContext)
@@ -110,6 +214,35 @@ void AudioController::update(float elapsedTime)
         AL_CHECK( alListenerfv(AL_VELOCITY, (ALfloat*)&listener->getVelocity()) );
         AL_CHECK( alListenerfv(AL_POSITION, (ALfloat*)&listener->getPosition()) );
     }
+
+    updateVoices(elapsedTime);
+    updateStreaming();
+
+#ifdef ALC_SOFT_loopback
+    if (_loopbackDevice && elapsedTime > 0)
+    {
+        // Mix the elapsed time worth of samples so that sources advance without an output device.
+        ALCsizei frames = (ALCsizei)(elapsedTime * 0.001f * AUDIO_LOOPBACK_FREQUENCY);
+        _loopbackSamples.resize(frames * 2);
+        if (frames > 0)
+            __alcRenderSamplesSOFT(_alcDevice, &_loopbackSamples[0], frames);
+    }
+#endif
+}
+
+unsigned int AudioController::getStreamingUnderrunCount() const
+{
+    return _streamingUnderruns;
+}
+
+unsigned int AudioController::getVoiceCount() const
+{
+    return _voiceCount;
+}
+
+unsigned int AudioController::getVirtualSourceCount() const
+{
+    return _virtualSourceCount;
 }
 
 void AudioController::addPlayingSource(AudioSource* source)
@@ -118,16 +251,19 @@ void AudioController::addPlayingSource(AudioSource* source)
     {
         _playingSources.insert(source);
 
+        // Start on a free voice right away; otherwise play virtually until the next update.
+        if (!source->isStreamed() && !source->_alSource)
+            acquireVoice(source);
+
         if (source->isStreamed())
         {
             GP_ASSERT(_streamingSources.find(source) == _streamingSources.end());
-            bool startThread = _streamingSources.empty() && _streamingThread.get() == NULL;
-            _streamingMutex->lock();
             _streamingSources.insert(source);
-            _streamingMutex->unlock();
 
-            if (startThread)
+            if (_streamingThread.get() == NULL)
                 _streamingThread.reset(new std::thread(&streamingThreadProc, this));
+
+            postStreamCommand(source->_buffer, true);
         }
     }
 }
@@ -141,31 +277,223 @@ void AudioController::removePlayingSource(AudioSource* source)
         {
             _playingSources.erase(iter);
  
-            if (source->isStreamed())
+            if (!source->isStreamed())
+            {
+                releaseVoice(source);
+            }
+            else
             {
                 GP_ASSERT(_streamingSources.find(source) != _streamingSources.end());
-                _streamingMutex->lock();
                 _streamingSources.erase(source);
-                _streamingMutex->unlock();
+
+                postStreamCommand(source->_buffer, false);
             }
         }
     } 
 }
 
+bool AudioController::compareVoiceCandidates(const AudioSource* a, const AudioSource* b)
+{
+    if (a->_priority != b->_priority)
+        return a->_priority > b->_priority;
+    return a->_audibility > b->_audibility;
+}
+
+void AudioController::updateVoices(float elapsedTime)
+{
+    AudioListener* listener = AudioListener::getInstance();
+    float elapsedSeconds = elapsedTime * 0.001f;
+
+    _voiceCandidates.clear();
+    std::set<AudioSource*>::iterator itr = _playingSources.begin();
+    while (itr != _playingSources.end())
+    {
+        AudioSource* source = *itr;
+        GP_ASSERT(source);
+        if (source->isStreamed() || source->_state != AudioSource::PLAYING)
+        {
+            ++itr;
+            continue;
+        }
+
+        // Retire sources that played to their end, whether they were mixed or virtual.
+        bool playing;
+        if (source->_alSource)
+        {
+            ALint state;
+            AL_CHECK( alGetSourcei(source->_alSource, AL_SOURCE_STATE, &state) );
+            playing = (state == AL_PLAYING || state == AL_PAUSED);
+        }
+        else
+        {
+            playing = source->advanceVirtual(elapsedSeconds);
+        }
+        if (!playing)
+        {
+            source->_state = AudioSource::STOPPED;
+            source->_playPosition = 0.0f;
+            releaseVoice(source);
+            itr = _playingSources.erase(itr);
+            continue;
+        }
+
+        // Estimate the audibility with OpenAL's default inverse distance clamped model.
+        float audibility = source->_gain;
+        if (listener)
+        {
+            kmVec3 offset;
+            kmVec3Subtract(&offset, &source->_position, &listener->getPosition());
+            audibility /= 1.0f + std::max(kmVec3Length(&offset) - 1.0f, 0.0f);
+        }
+        source->_audibility = audibility;
+        _voiceCandidates.push_back(source);
+        ++itr;
+    }
+
+    // Only the ordering around the voice count matters, not a full sort.
+    size_t voiced = std::min<size_t>(_voiceCount, _voiceCandidates.size());
+    if (voiced < _voiceCandidates.size())
+    {
+        std::nth_element(_voiceCandidates.begin(), _voiceCandidates.begin() + voiced, _voiceCandidates.end(), compareVoiceCandidates);
+
+        // Take the voices from the sources that lost them before handing any out.
+        for (size_t i = voiced, count = _voiceCandidates.size(); i < count; ++i)
+        {
+            releaseVoice(_voiceCandidates[i]);
+        }
+    }
+
+    _virtualSourceCount = (unsigned int)(_voiceCandidates.size() - voiced);
+    for (size_t i = 0; i < voiced; ++i)
+    {
+        AudioSource* source = _voiceCandidates[i];
+        if (!source->_alSource && !acquireVoice(source))
+        {
+            // Voices held by sources paused with the controller are not reclaimed.
+            ++_virtualSourceCount;
+        }
+    }
+}
+
+bool AudioController::acquireVoice(AudioSource* source)
+{
+    GP_ASSERT(source && !source->_alSource);
+    if (_freeVoices.empty())
+        return false;
+
+    source->bindVoice(_freeVoices.back());
+    _freeVoices.pop_back();
+    return true;
+}
+
+void AudioController::releaseVoice(AudioSource* source)
+{
+    GP_ASSERT(source);
+    if (source->_alSource)
+        _freeVoices.push_back(source->unbindVoice());
+}
+
+void AudioController::updateStreaming()
+{
+    bool consumed = false;
+    for (std::set<AudioSource*>::iterator itr = _streamingSources.begin(); itr != _streamingSources.end(); ++itr)
+    {
+        if ((*itr)->streamDataIfNeeded())
+            consumed = true;
+    }
+
+    // Decode-ahead slots were freed, so let the streaming thread refill them.
+    if (consumed)
+        wakeStreamingThread();
+
+    releaseRetiredStreams();
+}
+
+void AudioController::postStreamCommand(AudioBuffer* buffer, bool add)
+{
+    GP_ASSERT(buffer);
+
+    // The streaming thread holds a reference to the buffer until it retires it,
+    // so the buffer outlives any decoding in progress.
+    if (add)
+        buffer->addRef();
+
+    StreamCommand command;
+    command.buffer = buffer;
+    command.add = add;
+    while (!_streamingCommands.push(command))
+    {
+        // The command queue only fills up if the streaming thread falls far behind.
+        wakeStreamingThread();
+        releaseRetiredStreams();
+        std::this_thread::yield();
+    }
+    wakeStreamingThread();
+}
+
+void AudioController::wakeStreamingThread()
+{
+    if (!_streamingMutex.get())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(*_streamingMutex);
+        _streamingWake = true;
+    }
+    _streamingCondition->notify_one();
+}
+
+void AudioController::releaseRetiredStreams()
+{
+    AudioBuffer* buffer;
+    while (_retiredStreams.pop(&buffer))
+    {
+        SAFE_RELEASE(buffer);
+    }
+}
+
 void AudioController::streamingThreadProc(void* arg)
 {
     AudioController* controller = (AudioController*)arg;
 
+    // The streams being decoded are owned by this thread; the main thread only
+    // changes them through the command queue.
+    std::vector<AudioBuffer*>& streams = controller->_streams;
+
     while (controller->_streamingThreadActive)
     {
-        controller->_streamingMutex->lock();
+        StreamCommand command;
+        while (controller->_streamingCommands.pop(&command))
+        {
+            if (command.add)
+            {
+                streams.push_back(command.buffer);
+            }
+            else
+            {
+                std::vector<AudioBuffer*>::iterator itr = std::find(streams.begin(), streams.end(), command.buffer);
+                GP_ASSERT(itr != streams.end());
+                streams.erase(itr);
+
+                // Hand the reference back to the main thread, which releases it.
+                while (!controller->_retiredStreams.push(command.buffer))
+                    std::this_thread::yield();
+            }
+        }
 
-        std::for_each(controller->_streamingSources.begin(), controller->_streamingSources.end(), std::mem_fn(&AudioSource::streamDataIfNeeded));
-        
-        controller->_streamingMutex->unlock();
-   
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Decode ahead of playback outside of any lock.
+        for (size_t i = 0, count = streams.size(); i < count; ++i)
+        {
+            streams[i]->decodeAhead();
+        }
+
+        // Sleep until the main thread consumes decoded data or changes the streams.
+        std::unique_lock<std::mutex> lock(*controller->_streamingMutex);
+        controller->_streamingCondition->wait_for(lock, std::chrono::milliseconds(STREAMING_THREAD_TIMEOUT),
+            [controller] { return controller->_streamingWake || !controller->_streamingThreadActive; });
+        controller->_streamingWake = false;
     }
+
 }
 
 }
@@ -1,14 +1,30 @@
 #ifndef AUDIOCONTROLLER_H_
 #define AUDIOCONTROLLER_H_
 
+#include "LockFreeQueue.h"
+
 namespace egret
 {
 
+class AudioBuffer;
 class AudioListener;
 class AudioSource;
 
 /**
  * Defines a class for controlling game audio.
+ *
+ * Streamed audio sources are decoded ahead of playback on a background thread into
+ * lock-free queues and queued on their OpenAL sources from the main thread once per frame.
+ *
+ * The OpenAL device can be selected with the 'device' property of the 'audio' namespace
+ * in game.config. The special device name 'loopback' opens an OpenAL Soft loopback device,
+ * which produces no output and mixes in step with game time; this allows audio to run on
+ * machines without a sound card.
+ *
+ * Non-streamed audio sources share a fixed pool of voices (OpenAL sources), sized by the
+ * 'voices' property of the 'audio' namespace (32 by default). Once per frame the playing
+ * sources are ranked by priority and audibility and only the top ones are mixed; the
+ * others become virtual voices that just track their playback position.
  */
 class AudioController
 {
@@ -22,7 +38,42 @@ public:
      */
     virtual ~AudioController();
 
+    /**
+     * Gets the total number of times a streamed audio source ran out of decoded
+     * data while playing.
+     *
+     * @return The number of streaming underruns.
+     */
+    unsigned int getStreamingUnderrunCount() const;
+
+    /**
+     * Gets the number of voices shared by the non-streamed audio sources.
+     *
+     * @return The number of voices.
+     */
+    unsigned int getVoiceCount() const;
+
+    /**
+     * Gets the number of playing audio sources that did not get a voice in the last update.
+     *
+     * @return The number of virtual audio sources.
+     */
+    unsigned int getVirtualSourceCount() const;
+
 private:
+
+    /**
+     * A change to the set of streams decoded by the streaming thread.
+     */
+    struct StreamCommand
+    {
+        /** The stream to add or remove. */
+        AudioBuffer* buffer;
+        /** True to start decoding the stream, false to stop. */
+        bool add;
+    };
+
+    enum { STREAMING_COMMAND_QUEUE_SIZE = 64 };
     
     /**
      * Constructor.
@@ -58,17 +109,71 @@ private:
     
     void removePlayingSource(AudioSource* source);
 
+    /**
+     * Advances virtual sources, retires finished ones and gives the voices to the
+     * most audible playing sources.
+     */
+    void updateVoices(float elapsedTime);
+
+    /**
+     * Gives the source a free voice, if there is one.
+     */
+    bool acquireVoice(AudioSource* source);
+
+    /**
+     * Returns the voice of the source, if it has one, to the free voices.
+     */
+    void releaseVoice(AudioSource* source);
+
+    /**
+     * Orders voice candidates by priority and then by audibility, most audible first.
+     */
+    static bool compareVoiceCandidates(const AudioSource* a, const AudioSource* b);
+
+    /**
+     * Queues decoded stream data on the playing streamed sources and releases
+     * streams retired by the streaming thread.
+     */
+    void updateStreaming();
+
+    /**
+     * Sends a stream command to the streaming thread and wakes it.
+     */
+    void postStreamCommand(AudioBuffer* buffer, bool add);
+
+    /**
+     * Wakes the streaming thread so that it refills decode-ahead queues.
+     */
+    void wakeStreamingThread();
+
+    /**
+     * Releases the streams retired by the streaming thread.
+     */
+    void releaseRetiredStreams();
+
     static void streamingThreadProc(void* arg);
 
     ALCdevice* _alcDevice;
     ALCcontext* _alcContext;
+    bool _loopbackDevice;
+    std::vector<short> _loopbackSamples;
     std::set<AudioSource*> _playingSources;
     std::set<AudioSource*> _streamingSources;
     AudioSource* _pausingSource;
+    std::vector<ALuint> _freeVoices;
+    unsigned int _voiceCount;
+    std::vector<AudioSource*> _voiceCandidates;
+    unsigned int _virtualSourceCount;
 
-    bool _streamingThreadActive;
+    std::atomic<bool> _streamingThreadActive;
     std::unique_ptr<std::thread> _streamingThread;
     std::unique_ptr<std::mutex> _streamingMutex;
+    std::unique_ptr<std::condition_variable> _streamingCondition;
+    bool _streamingWake;
+    LockFreeQueue<StreamCommand, STREAMING_COMMAND_QUEUE_SIZE> _streamingCommands;
+    LockFreeQueue<AudioBuffer*, STREAMING_COMMAND_QUEUE_SIZE * 2> _retiredStreams;
+    std::vector<AudioBuffer*> _streams;
+    unsigned int _streamingUnderruns;
 };
 
 }
@@ -10,15 +10,18 @@ namespace egret
 {
 
 AudioSource::AudioSource(AudioBuffer* buffer, ALuint source) 
-    : _alSource(source), _buffer(buffer), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL)
+    : _alSource(source), _buffer(buffer), _looped(false), _gain(1.0f), _pitch(1.0f), _node(NULL), _underrunCount(0), _starved(false),
+      _state(INITIAL), _playPosition(0.0f), _priority(0), _audibility(0.0f)
 {
 	memset(&_velocity, 0, sizeof(float) * 3);
+	memset(&_position, 0, sizeof(float) * 3);
     GP_ASSERT(buffer);
 
-    if (isStreamed())
-        AL_CHECK(alSourceQueueBuffers(_alSource, 1, &buffer->_alBufferQueue[0]));
-    else
-        AL_CHECK(alSourcei(_alSource, AL_BUFFER, buffer->_alBufferQueue[0]));
+    // Non-streamed sources are given a voice by the controller when they play.
+    if (!_alSource)
+        return;
+
+    AL_CHECK(alSourceQueueBuffers(_alSource, buffer->_buffersPrefilledCount, &buffer->_alBufferQueue[0]));
     
     AL_CHECK(alSourcei(_alSource, AL_LOOPING, _looped && !isStreamed()));
     
@@ -29,17 +32,18 @@ AudioSource::AudioSource(AudioBuffer* buffer, ALuint source)
 
 AudioSource::~AudioSource()
 {
+    // Remove the source from the controller's set of currently playing sources
+    // regardless of the source's state. E.g. when the AudioController::pause is called
+    // all sources are paused but still remain in controller's set of currently 
+    // playing sources. When the source is deleted afterwards, it should be removed
+    // from controller's set regardless of its playing state. This also returns
+    // the voice of a non-streamed source to the controller.
+    AudioController* audioController = Game::getInstance()->getAudioController();
+    GP_ASSERT(audioController);
+    audioController->removePlayingSource(this);
+
     if (_alSource)
     {
-        // Remove the source from the controller's set of currently playing sources
-        // regardless of the source's state. E.g. when the AudioController::pause is called
-        // all sources are paused but still remain in controller's set of currently 
-        // playing sources. When the source is deleted afterwards, it should be removed
-        // from controller's set regardless of its playing state.
-        AudioController* audioController = Game::getInstance()->getAudioController();
-        GP_ASSERT(audioController);
-        audioController->removePlayingSource(this);
-
         AL_CHECK(alDeleteSources(1, &_alSource));
         _alSource = 0;
     }
@@ -69,15 +73,17 @@ AudioSource* AudioSource::create(const char* url, bool streamed)
     if (buffer == NULL)
         return NULL;
 
-    // Load the audio source.
+    // Streamed sources own their voice; the others share the controller's voices.
     ALuint alSource = 0;
-
-    AL_CHECK( alGenSources(1, &alSource) );
-    if (AL_LAST_ERROR())
+    if (streamed)
     {
-        SAFE_RELEASE(buffer);
-        GP_ERROR("Error generating audio source.");
-        return NULL;
+        AL_CHECK( alGenSources(1, &alSource) );
+        if (AL_LAST_ERROR())
+        {
+            SAFE_RELEASE(buffer);
+            GP_ERROR("Error generating audio source.");
+            return NULL;
+        }
     }
     
     return new AudioSource(buffer, alSource);
@@ -138,6 +144,9 @@ AudioSource* AudioSource::create(Properties* properties)
 
 AudioSource::State AudioSource::getState() const
 {
+    if (!_alSource)
+        return _state;
+
     ALint state;
     AL_CHECK( alGetSourcei(_alSource, AL_SOURCE_STATE, &state) );
 
@@ -163,7 +172,19 @@ bool AudioSource::isStreamed() const
 
 void AudioSource::play()
 {
-    AL_CHECK( alSourcePlay(_alSource) );
+    // Like OpenAL, playing a source that is not paused restarts it.
+    if (_state != PAUSED)
+        _playPosition = 0.0f;
+
+    // A stream that was played before is decoded again from the start.
+    if (_alSource && isStreamed() && _state != PAUSED && _state != INITIAL)
+    {
+        AL_CHECK( alSourceStop(_alSource) );
+        rewindStream();
+    }
+    _state = PLAYING;
+    if (_alSource)
+        AL_CHECK( alSourcePlay(_alSource) );
 
     // Add the source to the controller's list of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
@@ -173,7 +194,9 @@ void AudioSource::play()
 
 void AudioSource::pause()
 {
-    AL_CHECK( alSourcePause(_alSource) );
+    _state = PAUSED;
+    if (_alSource)
+        AL_CHECK( alSourcePause(_alSource) );
 
     // Remove the source from the controller's set of currently playing sources
     // if the source is being paused by the user and not the controller itself.
@@ -192,7 +215,10 @@ void AudioSource::resume()
 
 void AudioSource::stop()
 {
-    AL_CHECK( alSourceStop(_alSource) );
+    _state = STOPPED;
+    _playPosition = 0.0f;
+    if (_alSource)
+        AL_CHECK( alSourceStop(_alSource) );
 
     // Remove the source from the controller's set of currently playing sources.
     AudioController* audioController = Game::getInstance()->getAudioController();
@@ -202,7 +228,14 @@ void AudioSource::stop()
 
 void AudioSource::rewind()
 {
-    AL_CHECK( alSourceRewind(_alSource) );
+    _state = INITIAL;
+    _playPosition = 0.0f;
+    if (_alSource)
+    {
+        AL_CHECK( alSourceRewind(_alSource) );
+        if (isStreamed())
+            rewindStream();
+    }
 }
 
 bool AudioSource::isLooped() const
@@ -212,12 +245,19 @@ bool AudioSource::isLooped() const
 
 void AudioSource::setLooped(bool looped)
 {
-    AL_CHECK(alSourcei(_alSource, AL_LOOPING, (looped && !isStreamed()) ? AL_TRUE : AL_FALSE));
-    if (AL_LAST_ERROR())
+    if (_alSource)
     {
-        GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        AL_CHECK(alSourcei(_alSource, AL_LOOPING, (looped && !isStreamed()) ? AL_TRUE : AL_FALSE));
+        if (AL_LAST_ERROR())
+        {
+            GP_ERROR("Failed to set audio source's looped attribute with error: %d", AL_LAST_ERROR());
+        }
     }
     _looped = looped;
+
+    // Streamed sources loop by rewinding the stream on the streaming thread
+    if (isStreamed())
+        _buffer->_streamLooped = looped;
 }
 
 float AudioSource::getGain() const
@@ -227,7 +267,8 @@ float AudioSource::getGain() const
 
 void AudioSource::setGain(float gain)
 {
-    AL_CHECK( alSourcef(_alSource, AL_GAIN, gain) );
+    if (_alSource)
+        AL_CHECK( alSourcef(_alSource, AL_GAIN, gain) );
     _gain = gain;
 }
 
@@ -238,7 +279,8 @@ float AudioSource::getPitch() const
 
 void AudioSource::setPitch(float pitch)
 {
-    AL_CHECK( alSourcef(_alSource, AL_PITCH, pitch) );
+    if (_alSource)
+        AL_CHECK( alSourcef(_alSource, AL_PITCH, pitch) );
     _pitch = pitch;
 }
 
@@ -249,7 +291,8 @@ const kmVec3& AudioSource::getVelocity() const
 
 void AudioSource::setVelocity(const kmVec3& velocity)
 {
-    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (ALfloat*)&velocity) );
+    if (_alSource)
+        AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (ALfloat*)&velocity) );
     _velocity = velocity;
 }
 
@@ -258,11 +301,31 @@ void AudioSource::setVelocity(float x, float y, float z)
 	setVelocity({ x, y, z } );
 }
 
+int AudioSource::getPriority() const
+{
+    return _priority;
+}
+
+void AudioSource::setPriority(int priority)
+{
+    _priority = priority;
+}
+
+bool AudioSource::isVirtual() const
+{
+    return _state == PLAYING && !_alSource;
+}
+
 Node* AudioSource::getNode() const
 {
     return _node;
 }
 
+unsigned int AudioSource::getUnderrunCount() const
+{
+    return _underrunCount;
+}
+
 void AudioSource::setNode(Node* node)
 {
     if (_node != node)
@@ -289,8 +352,9 @@ void AudioSource::transformChanged(Transform* transform, long cookie)
 {
     if (_node)
     {
-        kmVec3 translation = _node->getTranslationWorld();
-        AL_CHECK( alSourcefv(_alSource, AL_POSITION, (const ALfloat*)&translation.x) );
+        _position = _node->getTranslationWorld();
+        if (_alSource)
+            AL_CHECK( alSourcefv(_alSource, AL_POSITION, (const ALfloat*)&_position.x) );
     }
 }
 
@@ -299,11 +363,14 @@ AudioSource* AudioSource::clone(NodeCloneContext& context)
     GP_ASSERT(_buffer);
 
     ALuint alSource = 0;
-    AL_CHECK( alGenSources(1, &alSource) );
-    if (AL_LAST_ERROR())
+    if (isStreamed())
     {
-        GP_ERROR("Unable to cloning audio.");
-        return NULL;
+        AL_CHECK( alGenSources(1, &alSource) );
+        if (AL_LAST_ERROR())
+        {
+            GP_ERROR("Unable to cloning audio.");
+            return NULL;
+        }
     }
     AudioSource* audioClone = new AudioSource(_buffer, alSource);
 
@@ -312,6 +379,7 @@ AudioSource* AudioSource::clone(NodeCloneContext& context)
     audioClone->setGain(getGain());
     audioClone->setPitch(getPitch());
     audioClone->setVelocity(getVelocity());
+    audioClone->setPriority(getPriority());
     if (Node* node = getNode())
     {
         Node* clonedNode = context.findClonedNode(node);
@@ -326,40 +394,126 @@ AudioSource* AudioSource::clone(NodeCloneContext& context)
 bool AudioSource::streamDataIfNeeded()
 {
     GP_ASSERT( isStreamed() );
-    if( getState() != PLAYING )
+    State state = getState();
+    if (state == PAUSED || state == INITIAL)
         return false;
 
-    int queuedBuffers;
-    alGetSourcei(_alSource, AL_BUFFERS_QUEUED, &queuedBuffers);
- 
-    int buffersNeeded = std::min<int>(_buffer->_buffersNeededCount, AudioBuffer::STREAMING_BUFFER_QUEUE_SIZE);
-    if (queuedBuffers < buffersNeeded)
+    if (state == STOPPED)
     {
-        while (queuedBuffers < buffersNeeded)
+        // A stopped source has either played the whole stream or has run dry
+        if (_buffer->isStreamFinished())
+            return false;
+
+        if (!_starved)
         {
-            if (!_buffer->streamData(_buffer->_alBufferQueue[queuedBuffers], _looped))
-                return false;
-            
-            AL_CHECK( alSourceQueueBuffers(_alSource, 1, &_buffer->_alBufferQueue[queuedBuffers]) );
-            queuedBuffers++;
+            _starved = true;
+            ++_underrunCount;
+            Game::getInstance()->getAudioController()->_streamingUnderruns++;
+
+            // Detach the played buffers so the queue can be refilled from the start
+            AL_CHECK( alSourcei(_alSource, AL_BUFFER, 0) );
         }
     }
-    else
+
+    int queuedBuffers;
+    AL_CHECK( alGetSourcei(_alSource, AL_BUFFERS_QUEUED, &queuedBuffers) );
+    bool consumed = false;
+
+    // Fill buffers that have not been queued yet
+    int buffersNeeded = std::min<int>(_buffer->_buffersNeededCount, AudioBuffer::STREAMING_BUFFER_QUEUE_SIZE);
+    while (queuedBuffers < buffersNeeded && _buffer->streamData(_buffer->_alBufferQueue[queuedBuffers]))
     {
-        int processedBuffers;
-        alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &processedBuffers);
- 
-        while (processedBuffers-- > 0)
-        {
-            ALuint bufferID;
-            AL_CHECK( alSourceUnqueueBuffers(_alSource, 1, &bufferID) );
-            if (!_buffer->streamData(bufferID, _looped))
-                return false;
-            
-            AL_CHECK( alSourceQueueBuffers(_alSource, 1, &bufferID) );
-        }
+        AL_CHECK( alSourceQueueBuffers(_alSource, 1, &_buffer->_alBufferQueue[queuedBuffers]) );
+        queuedBuffers++;
+        consumed = true;
+    }
+
+    // Refill buffers that have finished playing, as long as decoded data is available
+    int processedBuffers;
+    AL_CHECK( alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &processedBuffers) );
+    while (processedBuffers-- > 0 && _buffer->hasStreamData())
+    {
+        ALuint bufferID;
+        AL_CHECK( alSourceUnqueueBuffers(_alSource, 1, &bufferID) );
+        _buffer->streamData(bufferID);
+        AL_CHECK( alSourceQueueBuffers(_alSource, 1, &bufferID) );
+        consumed = true;
+    }
+
+    // Resume a starved source once the queue is full again or holds the rest of the stream
+    if (_starved && queuedBuffers > 0 && (queuedBuffers >= buffersNeeded || _buffer->isStreamFinished()))
+    {
+        AL_CHECK( alSourcePlay(_alSource) );
+        _starved = false;
+    }
+
+    return consumed;
+}
+
+void AudioSource::rewindStream()
+{
+    GP_ASSERT(isStreamed() && _alSource);
+
+    // Drop the buffers queued from the old position; none of them are playing.
+    AL_CHECK( alSourcei(_alSource, AL_BUFFER, 0) );
+    _buffer->rewindStream();
+    _starved = true;
+
+    Game::getInstance()->getAudioController()->wakeStreamingThread();
+}
+
+void AudioSource::bindVoice(ALuint voice)
+{
+    GP_ASSERT(!isStreamed() && !_alSource && voice);
+    _alSource = voice;
+
+    AL_CHECK( alSourcei(_alSource, AL_BUFFER, _buffer->_alBufferQueue[0]) );
+    AL_CHECK( alSourcei(_alSource, AL_LOOPING, _looped) );
+    AL_CHECK( alSourcef(_alSource, AL_PITCH, _pitch) );
+    AL_CHECK( alSourcef(_alSource, AL_GAIN, _gain) );
+    AL_CHECK( alSourcefv(_alSource, AL_VELOCITY, (const ALfloat*)&_velocity) );
+    AL_CHECK( alSourcefv(_alSource, AL_POSITION, (const ALfloat*)&_position) );
+
+    // Continue from where the source got to while it was virtual.
+    AL_CHECK( alSourcef(_alSource, AL_SEC_OFFSET, _playPosition) );
+    if (_state == PLAYING)
+        AL_CHECK( alSourcePlay(_alSource) );
+    else if (_state == PAUSED)
+        AL_CHECK( alSourcePause(_alSource) );
+}
+
+ALuint AudioSource::unbindVoice()
+{
+    GP_ASSERT(!isStreamed() && _alSource);
+
+    ALint state;
+    AL_CHECK( alGetSourcei(_alSource, AL_SOURCE_STATE, &state) );
+    if (state == AL_PLAYING || state == AL_PAUSED)
+        AL_CHECK( alGetSourcef(_alSource, AL_SEC_OFFSET, &_playPosition) );
+
+    AL_CHECK( alSourceStop(_alSource) );
+    AL_CHECK( alSourcei(_alSource, AL_BUFFER, 0) );
+
+    ALuint voice = _alSource;
+    _alSource = 0;
+    return voice;
+}
+
+bool AudioSource::advanceVirtual(float elapsedTime)
+{
+    GP_ASSERT(!_alSource);
+    _playPosition += elapsedTime * _pitch;
+
+    float duration = _buffer->_duration;
+    if (_playPosition < duration)
+        return true;
+    if (_looped && duration > 0.0f)
+    {
+        _playPosition = fmodf(_playPosition, duration);
+        return true;
     }
-    return true;
+    _playPosition = 0.0f;
+    return false;
 }
 
 }
@@ -17,6 +17,13 @@ class NodeCloneContext;
  *
  * This can be attached to a Node for applying its 3D transformation.
  *
+ * Non-streamed audio sources share a fixed pool of OpenAL voices owned by the
+ * AudioController. Each frame the most audible playing sources (by priority, then by
+ * gain and distance to the AudioListener) are given real voices; the rest keep playing
+ * virtually, advancing their playback position without being mixed, and continue
+ * audibly from that position once they win a voice back. Streamed sources always
+ * own a voice.
+ *
  * @see http://gameplay3d.github.io/GamePlay/docs/file-formats.html#wiki-Audio
  */
 class AudioSource : public Ref, public Transform::Listener
@@ -162,6 +169,30 @@ public:
      */
     void setVelocity(float x, float y, float z);
 
+    /**
+     * Gets the voice priority of the audio source.
+     *
+     * @return The priority.
+     */
+    int getPriority() const;
+
+    /**
+     * Sets the voice priority of the audio source.
+     *
+     * Playing sources with a higher priority are given voices before sources with a
+     * lower priority, regardless of audibility. The default priority is zero.
+     *
+     * @param priority The priority of the source.
+     */
+    void setPriority(int priority);
+
+    /**
+     * Determines whether the audio source is playing virtually, i.e. without a voice.
+     *
+     * @return true if the source is playing but is not currently being mixed, false otherwise.
+     */
+    bool isVirtual() const;
+
     /**
      * Gets the node that this source is attached to.
      * 
@@ -169,6 +200,13 @@ public:
      */
     Node* getNode() const;
 
+    /**
+     * Gets the number of times this streamed source ran out of decoded data while playing.
+     *
+     * @return The number of streaming underruns.
+     */
+    unsigned int getUnderrunCount() const;
+
 private:
 
     /**
@@ -204,8 +242,46 @@ private:
      */
     AudioSource* clone(NodeCloneContext& context);
 
+    /**
+     * Queues audio data decoded ahead by the streaming thread on this source.
+     *
+     * Called from the main thread once per frame; never decodes. Restarts the source
+     * (and counts an underrun) if it ran out of data before the end of the stream.
+     *
+     * @return True if any decoded data was consumed.
+     */
     bool streamDataIfNeeded();
 
+    /**
+     * Restarts a streamed source from the beginning of its stream.
+     *
+     * The source must not be playing. It waits until the queue is refilled before it plays again.
+     */
+    void rewindStream();
+
+    /**
+     * Plays this source on the given voice from its current playback position.
+     *
+     * @param voice The OpenAL source to play on.
+     */
+    void bindVoice(ALuint voice);
+
+    /**
+     * Detaches this source from its voice, keeping its playback position.
+     *
+     * @return The OpenAL source that was released.
+     */
+    ALuint unbindVoice();
+
+    /**
+     * Advances the playback position of a virtual source.
+     *
+     * @param elapsedTime The elapsed time in seconds.
+     *
+     * @return True if the source is still playing, false if it reached its end.
+     */
+    bool advanceVirtual(float elapsedTime);
+
     ALuint _alSource;
     AudioBuffer* _buffer;
     bool _looped;
@@ -213,6 +289,13 @@ private:
     float _pitch;
     kmVec3 _velocity;
     Node* _node;
+    unsigned int _underrunCount;
+    bool _starved;
+    State _state;
+    float _playPosition;
+    kmVec3 _position;
+    int _priority;
+    float _audibility;
 };
 
 }
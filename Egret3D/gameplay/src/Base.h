@@ -23,6 +23,7 @@
 #include <stack>
 #include <map>
 #include <queue>
+#include <deque>
 #include <algorithm>
 #include <limits>
 #include <functional>
@@ -30,6 +31,8 @@
 #include <typeinfo>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <chrono>
 #include "Logger.h"
 
@@ -131,6 +134,9 @@ extern int strcmpnocase(const char* s1, const char* s2);
 // Debug new for memory leak detection
 #include "DebugNew.h"
 
+// Profiler markers
+#include "Profiler.h"
+
 // Object deletion macro
 #define SAFE_DELETE(x) \
     { \
@@ -182,13 +188,16 @@ extern int strcmpnocase(const char* s1, const char* s2);
 #ifdef __ANDROID__
     #include <AL/al.h>
     #include <AL/alc.h>
+    #include <AL/alext.h>
 #elif WIN32
     #define AL_LIBTYPE_STATIC
     #include <AL/al.h>
     #include <AL/alc.h>
+    #include <AL/alext.h>
 #elif __linux__
     #include <AL/al.h>
     #include <AL/alc.h>
+    #include <AL/alext.h>
 #elif __APPLE__
     #include <OpenAL/al.h>
     #include <OpenAL/alc.h>
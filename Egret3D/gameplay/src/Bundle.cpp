@@ -170,6 +170,7 @@ static std::string readString(Stream* stream)
 
 Bundle* Bundle::create(const char* path)
 {
+    GP_PROFILE_SCOPE("Bundle::create");
     GP_ASSERT(path);
 
     // Search the cache for this bundle.
@@ -391,6 +392,7 @@ bool Bundle::readMatrix(float* m)
 
 Scene* Bundle::loadScene(const char* id)
 {
+    GP_PROFILE_SCOPE("Bundle::loadScene");
     clearLoadSession();
 
     Reference* ref = NULL;
@@ -607,6 +609,7 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
 
 Node* Bundle::loadNode(const char* id, Scene* sceneContext, Node* nodeContext)
 {
+    GP_PROFILE_SCOPE("Bundle::loadNode");
     GP_ASSERT(id);
 
     Node* node = NULL;
@@ -1365,6 +1368,7 @@ Mesh* Bundle::loadMesh(const char* id)
 
 Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
 {
+    GP_PROFILE_SCOPE("Bundle::loadMesh");
     GP_ASSERT(_stream);
     GP_ASSERT(id);
 
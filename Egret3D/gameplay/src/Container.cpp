@@ -246,6 +246,7 @@ unsigned int Container::addControl(Control* control)
 
 	sortControls();
     setDirty(Control::DIRTY_BOUNDS);
+    control->setDirty(Control::DIRTY_BOUNDS);
 
 	return (unsigned int)( _controls.size() - 1 );
 }
@@ -266,6 +267,7 @@ void Container::insertControl(Control* control, unsigned int index)
         control->addRef();
         control->_parent = this;
         setDirty(Control::DIRTY_BOUNDS);
+        control->setDirty(Control::DIRTY_BOUNDS);
     }
 }
 
@@ -503,13 +505,22 @@ void Container::setActiveControl(Control* control)
 
 void Container::setChildrenDirty(int bits, bool recursive)
 {
+    // Children that are only moved along with this container, such as when it scrolls, keep
+    // their recorded sprites. They are redrawn if their state changes or they are resized.
+    int childBits = (bits & DIRTY_STATE) ? bits | DIRTY_DRAW : bits;
     for (size_t i = 0, count = _controls.size(); i < count; ++i)
     {
         Control* ctrl = _controls[i];
-        ctrl->setDirty(bits);
+        ctrl->_dirtyBits |= childBits;
         if (recursive && ctrl->isContainer())
             static_cast<Container*>(ctrl)->setChildrenDirty(bits, true);
     }
+
+    if (bits & (DIRTY_BOUNDS | DIRTY_STATE))
+    {
+        for (Control* parent = this; parent && (parent->_dirtyBits & DIRTY_CHILD_BOUNDS) == 0; parent = parent->_parent)
+            parent->_dirtyBits |= DIRTY_CHILD_BOUNDS;
+    }
 }
 
 void Container::update(float elapsedTime)
@@ -664,7 +675,7 @@ unsigned int Container::draw(Form* form, const Rectangle& clip)
         Control* control = _controls[i];
         if (control && control->_absoluteClipBounds.intersects(_absoluteClipBounds))
         {
-            drawCalls += control->draw(form, _viewportClipBounds);
+            drawCalls += control->drawCached(form, _viewportClipBounds);
         }
     }
 
@@ -1191,6 +1202,7 @@ void Container::updateScroll()
     {
         float to = 0;
         _scrollBarOpacity = 0.99f;
+        setDirty(DIRTY_DRAW);
         if (!_scrollBarOpacityClip)
         {
             Animation* animation = createAnimationFromTo("scrollbar-fade-out", ANIMATE_SCROLLBAR_OPACITY, &_scrollBarOpacity, &to, Curve::QUADRATIC_IN_OUT, SCROLLBAR_FADE_TIME);
@@ -1210,9 +1222,13 @@ void Container::updateScroll()
 
 void Container::sortControls()
 {
-    if (_layout->getType() == Layout::LAYOUT_ABSOLUTE)
+    if (_layout->getType() == Layout::LAYOUT_ABSOLUTE &&
+        !std::is_sorted(_controls.begin(), _controls.end(), &sortControlsByZOrder))
     {
         std::sort(_controls.begin(), _controls.end(), &sortControlsByZOrder);
+
+        // The draw cache replays the children in the order they were drawn.
+        setDirty(DIRTY_DRAW);
     }
 }
 
@@ -1238,8 +1254,7 @@ bool Container::touchEventScroll(Touch::TouchEvent evt, int x, int y, unsigned i
                 _scrollBarOpacityClip = NULL;
             }
             _scrollBarOpacity = 1.0f;
-            if (dirty)
-                setDirty(DIRTY_BOUNDS);
+            setDirty(dirty ? DIRTY_BOUNDS : DIRTY_DRAW);
             return false;
         }
         break;
@@ -1581,6 +1596,7 @@ void Container::setAnimationPropertyValue(int propertyId, AnimationValue* value,
     {
     case ANIMATE_SCROLLBAR_OPACITY:
         _scrollBarOpacity = Curve::lerp(blendWeight, _opacity, value->getFloat(0));
+        setDirty(DIRTY_DRAW);
         break;
     default:
         Control::setAnimationPropertyValue(propertyId, value, blendWeight);
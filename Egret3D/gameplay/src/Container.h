@@ -358,6 +358,9 @@ protected:
     /**
      * Sets the specified dirty bits for all children within this container.
      *
+     * Unlike setDirty, this does not mark the children to be drawn again unless their
+     * state is dirtied, since they only move or resize along with this container.
+     *
      * @param bits The bits to set.
      * @param recursive If true, set the bits recursively on all children and their children.
      */
@@ -399,7 +402,7 @@ protected:
     /**
      * Sorts controls by Z-Order (for absolute layouts only).
      * This method is used by controls to notify their parent container when
-     * their Z-Index changes.
+     * their Z-Index changes. The container is redrawn if the order changed.
      */
     void sortControls();
 
@@ -10,7 +10,8 @@ namespace egret
 Control::Control()
     : _id(""), _boundsBits(0), _dirtyBits(DIRTY_BOUNDS | DIRTY_STATE), _consumeInputEvents(true), _alignment(ALIGN_TOP_LEFT),
     _autoSize(AUTO_SIZE_BOTH), _listeners(NULL), _style(NULL), _visible(true), _opacity(0.0f), _zIndex(-1),
-    _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _canFocus(false), _state(NORMAL), _parent(NULL), _styleOverridden(false), _skin(NULL)
+    _contactIndex(INVALID_CONTACT_INDEX), _focusIndex(-1), _canFocus(false), _state(NORMAL), _parent(NULL), _styleOverridden(false), _skin(NULL),
+    _drawCache(NULL), _drawCacheCalls(0)
 {
     GP_REGISTER_SCRIPT_EVENTS();
 }
@@ -39,6 +40,8 @@ Control::~Control()
             SAFE_DELETE(_style);
         }
     }
+
+    SAFE_DELETE(_drawCache);
 }
 
 Control::AutoSize Control::parseAutoSize(const char* str)
@@ -1073,7 +1076,9 @@ void Control::notifyListeners(Control::Listener::EventType eventType)
         }
     }
 
-    fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(Control, controlEvent), dynamic_cast<void*>(this), eventType);
+    const ScriptTarget::Event* scriptEvent = GP_GET_SCRIPT_EVENT(Control, controlEvent);
+    if (hasScriptEventHandler(scriptEvent))
+        fireScriptEvent<void>(scriptEvent, dynamic_cast<void*>(this), eventType);
 
     release();
 }
@@ -1084,7 +1089,15 @@ void Control::controlEvent(Control::Listener::EventType evt)
 
 void Control::setDirty(int bits)
 {
-    _dirtyBits |= bits;
+    _dirtyBits |= bits | DIRTY_DRAW;
+
+    // Ancestors retain the sprites of this control and lay it out, so they are dirtied as well.
+    // An ancestor that already has the bits has passed them on to its own ancestors.
+    int parentBits = DIRTY_DRAW;
+    if (bits & (DIRTY_BOUNDS | DIRTY_STATE))
+        parentBits |= DIRTY_CHILD_BOUNDS;
+    for (Control* parent = _parent; parent && (parent->_dirtyBits & parentBits) != parentBits; parent = parent->_parent)
+        parent->_dirtyBits |= parentBits;
 }
 
 bool Control::isDirty(int bit) const
@@ -1102,9 +1115,14 @@ void Control::update(float elapsedTime)
 
     // Since opacity is pre-multiplied, we compute it every frame so that we don't need to
     // dirty the entire hierarchy any time a state changes (which could affect opacity).
-    _opacity = getOpacity(state);
+    float opacity = getOpacity(state);
     if (_parent)
-        _opacity *= _parent->_opacity;
+        opacity *= _parent->_opacity;
+    if (opacity != _opacity)
+    {
+        _opacity = opacity;
+        setDirty(DIRTY_DRAW);
+    }
 }
 
 void Control::updateState(State state)
@@ -1118,6 +1136,10 @@ void Control::updateState(State state)
 
 bool Control::updateBoundsInternal(const kmVec2& offset)
 {
+    // Nothing to do if neither this control nor any of its descendants changed
+    if ((_dirtyBits & (DIRTY_BOUNDS | DIRTY_STATE | DIRTY_CHILD_BOUNDS)) == 0)
+        return false;
+
     // If our state is currently dirty, update it here so that any rendering state objects needed
     // for bounds computation are accessible.
     State state = getState();
@@ -1131,10 +1153,14 @@ bool Control::updateBoundsInternal(const kmVec2& offset)
     bool dirtyBounds = (_dirtyBits & DIRTY_BOUNDS) != 0;
     _dirtyBits &= ~DIRTY_BOUNDS;
 
-    // If we are a container, always update child bounds first
+    // If we are a container, update dirty child bounds first
     bool changed = false;
-    if (isContainer())
-        changed = static_cast<Container*>(this)->updateChildBounds();
+    if (_dirtyBits & DIRTY_CHILD_BOUNDS)
+    {
+        _dirtyBits &= ~DIRTY_CHILD_BOUNDS;
+        if (isContainer())
+            changed = static_cast<Container*>(this)->updateChildBounds();
+    }
 
     if (dirtyBounds)
     {
@@ -1297,6 +1323,55 @@ unsigned int Control::draw(Form* form, const Rectangle& clip)
     return drawCalls;
 }
 
+unsigned int Control::drawCached(Form* form, const Rectangle& clip)
+{
+    GP_ASSERT(form);
+
+    if (!_visible)
+        return 0;
+
+    // Sprites can only be replayed into batches that are flushed once the whole form is drawn
+    if (!form->isBatchingEnabled())
+    {
+        SAFE_DELETE(_drawCache);
+        return draw(form, clip);
+    }
+
+    // A control that only moved, such as the content of a scrolled container, replays its sprites
+    // at the new position unless they were or would be clipped.
+    kmVec2 offset = { _absoluteBounds.x - _drawCacheBounds.x, _absoluteBounds.y - _drawCacheBounds.y };
+    bool moved = offset.x != 0.0f || offset.y != 0.0f;
+    if (_drawCache && (_dirtyBits & DIRTY_DRAW) == 0 &&
+        _absoluteBounds.width == _drawCacheBounds.width && _absoluteBounds.height == _drawCacheBounds.height &&
+        (moved ? _drawCacheClip.contains(_drawCacheBounds) && clip.contains(_absoluteBounds) : _drawCacheClip == clip) &&
+        _drawCache->isValid())
+    {
+        unsigned int count = _drawCache->getBatchCount();
+        for (unsigned int i = 0; i < count; ++i)
+            startBatch(form, _drawCache->getBatch(i));
+        _drawCache->replay(offset);
+        for (unsigned int i = 0; i < count; ++i)
+            finishBatch(form, _drawCache->getBatch(i));
+        ++Form::_controlsReused;
+        return _drawCacheCalls;
+    }
+
+    // Record the sprites of this control while drawing it; the recording only refers to those of its children
+    if (!_drawCache)
+        _drawCache = new SpriteBatch::Recording();
+    _drawCache->begin();
+    _drawCacheCalls = draw(form, clip);
+    if (_drawCache->end())
+    {
+        _drawCacheClip = clip;
+        _drawCacheBounds = _absoluteBounds;
+        _dirtyBits &= ~DIRTY_DRAW;
+    }
+    ++Form::_controlsRebuilt;
+
+    return _drawCacheCalls;
+}
+
 unsigned int Control::drawBorder(Form* form, const Rectangle& clip)
 {
     if (!form || !_skin || _absoluteBounds.width <= 0 || _absoluteBounds.height <= 0)
@@ -1652,6 +1727,9 @@ Theme::Style::Overlay* Control::getOverlay(State state) const
 
 void Control::overrideStyle()
 {
+    // Every style setter comes through here, so this is where themed visuals change
+    setDirty(DIRTY_DRAW);
+
     if (_styleOverridden)
     {
         return;
@@ -990,6 +990,22 @@ protected:
      */
     static const int DIRTY_STATE = 2;
 
+    /**
+     * Indicates that the control must be drawn again, although its bounds and state are unchanged.
+     *
+     * Setting any dirty bit also sets this bit on the control and all of its ancestors,
+     * except when a container moves its children along with it.
+     */
+    static const int DIRTY_DRAW = 4;
+
+    /**
+     * Indicates that the bounds or state of a descendant of the control are dirty.
+     *
+     * Setting DIRTY_BOUNDS or DIRTY_STATE also sets this bit on all ancestors of the control,
+     * so that bounds updates can skip every subtree in which nothing changed.
+     */
+    static const int DIRTY_CHILD_BOUNDS = 8;
+
     /**
      * Indicates that the x position of the control is a percentage.
      */
@@ -1218,6 +1234,20 @@ protected:
      */
     virtual unsigned int draw(Form* form, const Rectangle& clip);
 
+    /**
+     * Draws the control, replaying the sprites it generated when it was last drawn if
+     * nothing within it changed since. A control that only moved replays them at its
+     * new position, provided it is not clipped.
+     *
+     * Only batched forms retain sprites; otherwise this is the same as calling draw.
+     *
+     * @param form The top level form being drawn.
+     * @param clip The clipping rectangle.
+     *
+     * @return The number of draw calls issued.
+     */
+    unsigned int drawCached(Form* form, const Rectangle& clip);
+
     /**
      * Draws the themed border and background of a control.
      *
@@ -1499,6 +1529,10 @@ private:
 
     bool _styleOverridden;
     Theme::Skin* _skin;
+    SpriteBatch::Recording* _drawCache;
+    Rectangle _drawCacheClip;
+    Rectangle _drawCacheBounds;
+    unsigned int _drawCacheCalls;
 
 };
 
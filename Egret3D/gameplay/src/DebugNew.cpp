@@ -32,6 +32,7 @@ struct MemoryAllocationRecord
 
 MemoryAllocationRecord* __memoryAllocations = 0;
 int __memoryAllocationCount = 0;
+unsigned long long __memoryBytesAllocated = 0;
 
 static std::mutex& getMemoryAllocationMutex()
 {
@@ -114,6 +115,7 @@ void* debugAlloc(std::size_t size, const char* file, int line)
     mem += sizeof(MemoryAllocationRecord);
 
     std::lock_guard<std::mutex> lock(getMemoryAllocationMutex());
+    __memoryBytesAllocated += size;
     rec->address = (unsigned long)mem;
     rec->size = (unsigned int)size;
     rec->file = file;
@@ -280,6 +282,12 @@ void printStackTrace(MemoryAllocationRecord* rec)
 }
 #endif
 
+extern unsigned long long getMemoryBytesAllocated()
+{
+    std::lock_guard<std::mutex> lock(getMemoryAllocationMutex());
+    return __memoryBytesAllocated;
+}
+
 extern void printMemoryLeaks()
 {
     // Dump general heap memory leaks
@@ -14,6 +14,9 @@
 // Prints all heap and reference leaks to stderr.
 extern void printMemoryLeaks();
 
+// Gets the number of bytes allocated since the start of the program.
+extern unsigned long long getMemoryBytesAllocated();
+
 // global new/delete operator overloads
 #ifdef _MSC_VER
 #pragma warning( disable : 4290 ) // C++ exception specification ignored.
@@ -1,25 +1,82 @@
 #include "Base.h"
 #include "Effect.h"
+#include "PerformanceCounters.h"
 #include "FileSystem.h"
 #include "Game.h"
+#include "ShaderPreprocessor.h"
 
 #define OPENGL_ES_DEFINE  "OPENGL_ES"
 
+// Program binaries (OpenGL 4.1 or GL_ARB_get_program_binary) are only available through GLEW.
+#ifdef GLEW_STATIC
+#define GP_USE_PROGRAM_BINARY
+#endif
+
+#define PROGRAM_CACHE_MAGIC "GPSB"
+#define PROGRAM_CACHE_VERSION 2
+#define PROGRAM_CACHE_PATH_DEFAULT "shaders.cache"
+
+// Milliseconds per frame spent creating the effects listed in the shader manifest.
+#define PRECOMPILE_TIME_DEFAULT 4
+
 namespace egret
 {
 
-// Cache of unique effects.
+// Cache of unique effects, and of the effects with the same program.
 static std::map<std::string, Effect*> __effectCache;
+static std::map<unsigned long long, Effect*> __programEffects;
 static Effect* __currentEffect = NULL;
 
-Effect::Effect() : _program(0)
+// Linked programs saved by the driver, keyed by a hash of the expanded shader sources.
+// Only the programs loaded or saved in this session are written back to the file.
+struct ProgramBinary
+{
+    GLenum format;
+    std::vector<unsigned char> data;
+    bool used;
+};
+static std::map<unsigned long long, ProgramBinary> __programCache;
+static std::string __programCachePath;
+static unsigned long long __programCacheDriver = 0;
+static bool __programCacheLoaded = false;
+static bool __programCacheDirty = false;
+static bool __programCacheTrimmed = false;
+
+// Effects listed in the shader manifest that have not been created yet.
+struct PrecompileEntry
+{
+    std::string vshPath;
+    std::string fshPath;
+    std::string defines;
+};
+static std::queue<PrecompileEntry> __precompileQueue;
+static std::vector<Effect*> __precompiledEffects;
+static double __precompileTime = PRECOMPILE_TIME_DEFAULT;
+static double __precompileStart = 0.0;
+
+static unsigned int __programsCompiled = 0;
+static unsigned int __programsLoaded = 0;
+static unsigned int __programsRejected = 0;
+static double __programCompileTime = 0.0;
+static double __programLoadTime = 0.0;
+
+Effect::Effect() : _program(0), _programKey(0)
 {
 }
 
 Effect::~Effect()
 {
-    // Remove this effect from the cache.
-    __effectCache.erase(_id);
+    // Remove this effect from the caches, under each of the ids it was created for.
+    for (std::map<std::string, Effect*>::iterator itr = __effectCache.begin(); itr != __effectCache.end();)
+    {
+        if (itr->second == this)
+            __effectCache.erase(itr++);
+        else
+            ++itr;
+    }
+    std::map<unsigned long long, Effect*>::iterator programItr = __programEffects.find(_programKey);
+    if (programItr != __programEffects.end() && programItr->second == this)
+        __programEffects.erase(programItr);
 
     // Free uniforms.
     for (std::map<std::string, Uniform*>::iterator itr = _uniforms.begin(); itr != _uniforms.end(); ++itr)
@@ -46,15 +103,14 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
     GP_ASSERT(vshPath);
     GP_ASSERT(fshPath);
 
-    // Search the effect cache for an identical effect that is already loaded.
+    // Search the effect cache for an identical effect that is already loaded. Defines are
+    // put in canonical order so that their order does not make a different effect.
+    std::string canonicalDefines = ShaderPreprocessor::canonicalizeDefines(defines);
     std::string uniqueId = vshPath;
     uniqueId += ';';
     uniqueId += fshPath;
     uniqueId += ';';
-    if (defines)
-    {
-        uniqueId += defines;
-    }
+    uniqueId += canonicalDefines;
     std::map<std::string, Effect*>::const_iterator itr = __effectCache.find(uniqueId);
     if (itr != __effectCache.end())
     {
@@ -64,34 +120,31 @@ Effect* Effect::createFromFile(const char* vshPath, const char* fshPath, const c
         return itr->second;
     }
 
-    // Read source from file.
-    char* vshSource = FileSystem::readAll(vshPath);
+    // Get the sources, with their includes resolved.
+    const char* vshSource = ShaderPreprocessor::getSource(vshPath);
     if (vshSource == NULL)
     {
         GP_ERROR("Failed to read vertex shader from file '%s'.", vshPath);
         return NULL;
     }
-    char* fshSource = FileSystem::readAll(fshPath);
+    const char* fshSource = ShaderPreprocessor::getSource(fshPath);
     if (fshSource == NULL)
     {
         GP_ERROR("Failed to read fragment shader from file '%s'.", fshPath);
-        SAFE_DELETE_ARRAY(vshSource);
         return NULL;
     }
 
-    Effect* effect = createFromSource(vshPath, vshSource, fshPath, fshSource, defines);
-    
-    SAFE_DELETE_ARRAY(vshSource);
-    SAFE_DELETE_ARRAY(fshSource);
-
+    Effect* effect = createFromSource(vshPath, vshSource, fshPath, fshSource, canonicalDefines.c_str());
     if (effect == NULL)
     {
         GP_ERROR("Failed to create effect from shaders '%s', '%s'.", vshPath, fshPath);
     }
     else
     {
-        // Store this effect in the cache.
-        effect->_id = uniqueId;
+        // Store this effect in the cache. An effect shared with another permutation keeps
+        // the id it was first created with.
+        if (effect->_id.empty())
+            effect->_id = uniqueId;
         __effectCache[uniqueId] = effect;
     }
 
@@ -103,134 +156,246 @@ Effect* Effect::createFromSource(const char* vshSource, const char* fshSource, c
     return createFromSource(NULL, vshSource, NULL, fshSource, defines);
 }
 
-static void replaceDefines(const char* defines, std::string& out)
+static void getDefines(const char* defines, std::vector<std::string>& out)
 {
     Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
     const char* globalDefines = graphicsConfig ? graphicsConfig->getString("shaderDefines") : NULL;
 
     // Build full semicolon delimited list of defines
 #ifdef OPENGL_ES
-    out = OPENGL_ES_DEFINE;
+    std::string all = OPENGL_ES_DEFINE;
 #else
-    out = "";
+    std::string all = "";
 #endif
     if (globalDefines && strlen(globalDefines) > 0)
     {
-        if (out.length() > 0)
-            out += ';';
-        out += globalDefines;
+        if (all.length() > 0)
+            all += ';';
+        all += globalDefines;
     }
     if (defines && strlen(defines) > 0)
     {
-        if (out.length() > 0)
-            out += ';';
-        out += defines;
+        if (all.length() > 0)
+            all += ';';
+        all += defines;
     }
 
-    // Replace semicolons
-    if (out.length() > 0)
+    // Split the canonical list
+    all = ShaderPreprocessor::canonicalizeDefines(all.c_str());
+    size_t start = 0;
+    while (start < all.length())
     {
-        size_t pos;
-        out.insert(0, "#define ");
-        while ((pos = out.find(';')) != std::string::npos)
-        {
-            out.replace(pos, 1, "\n#define ");
-        }
-        out += "\n";
+        size_t end = all.find(';', start);
+        if (end == std::string::npos)
+            end = all.length();
+        out.push_back(all.substr(start, end - start));
+        start = end + 1;
     }
 }
 
-static void replaceIncludes(const char* filepath, const char* source, std::string& out)
+static void writeShaderToErrorFile(const char* filePath, const char* source)
 {
-    // Replace the #include "xxxx.xxx" with the sourced file contents of "filepath/xxxx.xxx"
-    std::string str = source;
-    size_t lastPos = 0;
-    size_t headPos = 0;
-    size_t fileLen = str.length();
-    size_t tailPos = fileLen;
-    while (headPos < fileLen)
+    std::string path = filePath;
+    path += ".err";
+    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::WRITE));
+    if (stream.get() != NULL && stream->canWrite())
     {
-        lastPos = headPos;
-        if (headPos == 0)
+        stream->write(source, 1, strlen(source));
+    }
+}
+
+static void hashString(unsigned long long& hash, const char* str)
+{
+    // 64 bit FNV-1a, including the terminator so that consecutive strings stay apart
+    const unsigned char* c = (const unsigned char*)str;
+    do
+    {
+        hash ^= *c;
+        hash *= 1099511628211ULL;
+    } while (*c++);
+}
+
+static void loadProgramCache()
+{
+    if (__programCacheLoaded)
+        return;
+    __programCacheLoaded = true;
+
+#ifdef GP_USE_PROGRAM_BINARY
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return;
+    GLint formatCount = 0;
+    GL_ASSERT( glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount) );
+    if (formatCount <= 0)
+        return;
+
+    __programCachePath = PROGRAM_CACHE_PATH_DEFAULT;
+    Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
+    if (graphicsConfig && graphicsConfig->exists("shaderCache"))
+    {
+        const char* path = graphicsConfig->getString("shaderCache");
+        __programCachePath = path ? path : "";
+    }
+    if (__programCachePath.empty())
+        return;
+
+    // Binaries are only valid for the driver that produced them.
+    __programCacheDriver = 14695981039346656037ULL;
+    hashString(__programCacheDriver, (const char*)glGetString(GL_VENDOR));
+    hashString(__programCacheDriver, (const char*)glGetString(GL_RENDERER));
+    hashString(__programCacheDriver, (const char*)glGetString(GL_VERSION));
+
+    const char* path = __programCachePath.c_str();
+    if (!FileSystem::fileExists(path))
+        return;
+    int size = 0;
+    char* data = FileSystem::readAll(path, &size);
+    if (data == NULL)
+        return;
+
+    // "GPSB", version, driver hash, program count, { key, format, length, binary } per program
+    const char* ptr = data;
+    const char* end = data + size;
+    unsigned int version = 0;
+    unsigned long long driver = 0;
+    unsigned int count = 0;
+    if (size < 20 || memcmp(ptr, PROGRAM_CACHE_MAGIC, 4) != 0)
+    {
+        GP_WARN("Ignoring invalid shader cache '%s'.", path);
+    }
+    else
+    {
+        memcpy(&version, ptr + 4, 4);
+        memcpy(&driver, ptr + 8, 8);
+        memcpy(&count, ptr + 16, 4);
+        ptr += 20;
+        if (version != PROGRAM_CACHE_VERSION || driver != __programCacheDriver)
         {
-            // find the first "#include"
-            headPos = str.find("#include");
+            // Rewrite the whole file for this driver.
+            print("Shader cache '%s' was built for another driver; rebuilding it.\n", path);
+            count = 0;
+            __programCacheDirty = true;
         }
-        else
+        for (unsigned int i = 0; i < count; ++i)
         {
-            // find the next "#include"
-            headPos = str.find("#include", headPos + 1);
+            unsigned long long key;
+            unsigned int format;
+            unsigned int length;
+            if (end - ptr < 16)
+                break;
+            memcpy(&key, ptr, 8);
+            memcpy(&format, ptr + 8, 4);
+            memcpy(&length, ptr + 12, 4);
+            ptr += 16;
+            if ((size_t)(end - ptr) < length)
+                break;
+            ProgramBinary& binary = __programCache[key];
+            binary.format = format;
+            binary.data.assign((const unsigned char*)ptr, (const unsigned char*)ptr + length);
+            binary.used = false;
+            ptr += length;
         }
+    }
+    SAFE_DELETE_ARRAY(data);
+#endif
+}
 
-        // If "#include" is found
-        if (headPos != std::string::npos)
-        {
-            // append from our last position for the legth (head - last position) 
-            out.append(str.substr(lastPos,  headPos - lastPos));
+static void saveProgramCache()
+{
+    if (!__programCacheDirty)
+        return;
+    __programCacheDirty = false;
 
-            // find the start quote "
-            size_t startQuote = str.find("\"", headPos) + 1;
-            if (startQuote == std::string::npos)
-            {
-                // We have started an "#include" but missing the leading quote "
-                GP_ERROR("Compile failed for shader '%s' missing leading \".", filepath);
-                return;
-            }
-            // find the end quote "
-            size_t endQuote = str.find("\"", startQuote);
-            if (endQuote == std::string::npos)
-            {
-                // We have a start quote but missing the trailing quote "
-                GP_ERROR("Compile failed for shader '%s' missing trailing \".", filepath);
-                return;
-            }
+    std::unique_ptr<Stream> stream(FileSystem::open(__programCachePath.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_WARN("Failed to write shader cache '%s'.", __programCachePath.c_str());
+        return;
+    }
 
-            // jump the head position past the end quote
-            headPos = endQuote + 1;
-            
-            // File path to include and 'stitch' in the value in the quotes to the file path and source it.
-            std::string filepathStr = filepath;
-            std::string directoryPath = filepathStr.substr(0, filepathStr.rfind('/') + 1);
-            size_t len = endQuote - (startQuote);
-            std::string includeStr = str.substr(startQuote, len);
-            directoryPath.append(includeStr);
-            const char* includedSource = FileSystem::readAll(directoryPath.c_str());
-            if (includedSource == NULL)
-            {
-                GP_ERROR("Compile failed for shader '%s' invalid filepath.", filepathStr.c_str());
-                return;
-            }
-            else
-            {
-                // Valid file so lets attempt to see if we need to append anything to it too (recurse...)
-                replaceIncludes(directoryPath.c_str(), includedSource, out);
-                SAFE_DELETE_ARRAY(includedSource);
-            }
-        }
-        else
-        {
-            // Append the remaining
-            out.append(str.c_str(), lastPos, tailPos);
-        }
+    // Programs of shaders that were changed or removed are never used again, so the
+    // ones not used in this session are dropped rather than kept forever.
+    unsigned int version = PROGRAM_CACHE_VERSION;
+    unsigned int count = 0;
+    for (std::map<unsigned long long, ProgramBinary>::const_iterator itr = __programCache.begin(); itr != __programCache.end(); ++itr)
+    {
+        if (itr->second.used)
+            ++count;
+    }
+    __programCacheTrimmed = count < __programCache.size();
+    stream->write(PROGRAM_CACHE_MAGIC, 1, 4);
+    stream->write(&version, 4, 1);
+    stream->write(&__programCacheDriver, 8, 1);
+    stream->write(&count, 4, 1);
+    for (std::map<unsigned long long, ProgramBinary>::const_iterator itr = __programCache.begin(); itr != __programCache.end(); ++itr)
+    {
+        if (!itr->second.used)
+            continue;
+        unsigned int format = itr->second.format;
+        unsigned int length = (unsigned int)itr->second.data.size();
+        stream->write(&itr->first, 8, 1);
+        stream->write(&format, 4, 1);
+        stream->write(&length, 4, 1);
+        stream->write(&itr->second.data[0], 1, length);
     }
 }
 
-static void writeShaderToErrorFile(const char* filePath, const char* source)
+static GLuint loadProgram(unsigned long long key)
 {
-    std::string path = filePath;
-    path += ".err";
-    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::WRITE));
-    if (stream.get() != NULL && stream->canWrite())
+    GLuint program = 0;
+#ifdef GP_USE_PROGRAM_BINARY
+    std::map<unsigned long long, ProgramBinary>::iterator itr = __programCache.find(key);
+    if (itr == __programCache.end())
+        return 0;
+
+    double startTime = Game::getAbsoluteTime();
+    GLint success;
+    GL_ASSERT( program = glCreateProgram() );
+
+    // A driver is allowed to reject a binary it produced (after an update, for example),
+    // so errors are expected here and the program is compiled from source instead.
+    glProgramBinary(program, itr->second.format, &itr->second.data[0], (GLsizei)itr->second.data.size());
+    glGetError();
+    GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+    if (success != GL_TRUE)
     {
-        stream->write(source, 1, strlen(source));
+        GL_ASSERT( glDeleteProgram(program) );
+        program = 0;
+        __programCache.erase(itr);
+        __programCacheDirty = true;
+        ++__programsRejected;
     }
+    else
+    {
+        // Write the program back if the file was rewritten without it
+        if (!itr->second.used && __programCacheTrimmed)
+            __programCacheDirty = true;
+        itr->second.used = true;
+        ++__programsLoaded;
+    }
+    __programLoadTime += Game::getAbsoluteTime() - startTime;
+#endif
+    return program;
 }
 
-Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+static void saveProgram(unsigned long long key, GLuint program)
 {
-    GP_ASSERT(vshSource);
-    GP_ASSERT(fshSource);
+#ifdef GP_USE_PROGRAM_BINARY
+    GLint length = 0;
+    GL_ASSERT( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+    if (length <= 0)
+        return;
+
+    ProgramBinary& binary = __programCache[key];
+    binary.data.resize(length);
+    GL_ASSERT( glGetProgramBinary(program, length, NULL, &binary.format, &binary.data[0]) );
+    binary.used = true;
+    __programCacheDirty = true;
+#endif
+}
 
+static GLuint compileProgram(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines, bool retrievable)
+{
     const unsigned int SHADER_SOURCE_LENGTH = 3;
     const GLchar* shaderSource[SHADER_SOURCE_LENGTH];
     char* infoLog = NULL;
@@ -240,21 +405,11 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
     GLint length;
     GLint success;
 
-    // Replace all comma separated definitions with #define prefix and \n suffix
-    std::string definesStr = "";
-    replaceDefines(defines, definesStr);
-    
-    shaderSource[0] = definesStr.c_str();
+    double startTime = Game::getAbsoluteTime();
+
+    shaderSource[0] = defines;
     shaderSource[1] = "\n";
-    std::string vshSourceStr = "";
-    if (vshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(vshPath, vshSource, vshSourceStr);
-        if (vshSource && strlen(vshSource) != 0)
-            vshSourceStr += "\n";
-    }
-    shaderSource[2] = vshPath ? vshSourceStr.c_str() :  vshSource;
+    shaderSource[2] = vshSource;
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
@@ -283,19 +438,11 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Compile the fragment shader.
-    std::string fshSourceStr;
-    if (fshPath)
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshPath, fshSource, fshSourceStr);
-        if (fshSource && strlen(fshSource) != 0)
-            fshSourceStr += "\n";
-    }
-    shaderSource[2] = fshPath ? fshSourceStr.c_str() : fshSource;
+    shaderSource[2] = fshSource;
     GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
     GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(fragmentShader) );
@@ -325,13 +472,17 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         GL_ASSERT( glDeleteShader(vertexShader) );
         GL_ASSERT( glDeleteShader(fragmentShader) );
 
-        return NULL;
+        return 0;
     }
 
     // Link program.
     GL_ASSERT( program = glCreateProgram() );
     GL_ASSERT( glAttachShader(program, vertexShader) );
     GL_ASSERT( glAttachShader(program, fragmentShader) );
+#ifdef GP_USE_PROGRAM_BINARY
+    if (retrievable)
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+#endif
     GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
@@ -359,12 +510,59 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
         // Clean up.
         GL_ASSERT( glDeleteProgram(program) );
 
-        return NULL;
+        return 0;
+    }
+
+    ++__programsCompiled;
+    __programCompileTime += Game::getAbsoluteTime() - startTime;
+
+    return program;
+}
+
+Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines)
+{
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    // Strip the blocks this permutation does not use, and the defines it does not refer to.
+    std::vector<std::string> definesList;
+    getDefines(defines, definesList);
+    std::string definesStr;
+    std::string vshSourceStr;
+    std::string fshSourceStr;
+    ShaderPreprocessor::preprocess(definesList, vshSource, fshSource, definesStr, vshSourceStr, fshSourceStr);
+
+    // Permutations that come out the same share a program.
+    unsigned long long key = 14695981039346656037ULL;
+    hashString(key, definesStr.c_str());
+    hashString(key, vshSourceStr.c_str());
+    hashString(key, fshSourceStr.c_str());
+    std::map<unsigned long long, Effect*>::const_iterator itr = __programEffects.find(key);
+    if (itr != __programEffects.end())
+    {
+        itr->second->addRef();
+        return itr->second;
+    }
+
+    // Use the program saved by an earlier run if the driver still accepts it.
+    loadProgramCache();
+    bool cached = !__programCachePath.empty();
+    GLuint program = cached ? loadProgram(key) : 0;
+    if (program == 0)
+    {
+        program = compileProgram(vshPath, vshSourceStr.c_str(), fshPath, fshSourceStr.c_str(), definesStr.c_str(), cached);
+        if (program == 0)
+            return NULL;
+        if (cached)
+            saveProgram(key, program);
     }
 
     // Create and return the new Effect.
     Effect* effect = new Effect();
     effect->_program = program;
+    effect->_programKey = key;
+    __programEffects[key] = effect;
+    GLint length;
 
     // Query and store vertex attribute meta-data from the program.
     // NOTE: Rather than using glBindAttribLocation to explicitly specify our own
@@ -531,6 +729,7 @@ void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniform1f(uniform->_location, value) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
@@ -538,12 +737,14 @@ void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniform1i(uniform->_location, value) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
@@ -551,12 +752,14 @@ void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmMat4& value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.mat) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmMat4* values, unsigned int count)
@@ -564,12 +767,14 @@ void Effect::setValue(Uniform* uniform, const kmMat4* values, unsigned int count
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec2& value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec2* values, unsigned int count)
@@ -577,12 +782,14 @@ void Effect::setValue(Uniform* uniform, const kmVec2* values, unsigned int count
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec3& value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec3* values, unsigned int count)
@@ -590,12 +797,14 @@ void Effect::setValue(Uniform* uniform, const kmVec3* values, unsigned int count
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec4& value)
 {
     GP_ASSERT(uniform);
     GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const kmVec4* values, unsigned int count)
@@ -603,6 +812,7 @@ void Effect::setValue(Uniform* uniform, const kmVec4* values, unsigned int count
     GP_ASSERT(uniform);
     GP_ASSERT(values);
     GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -619,6 +829,7 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     const_cast<Texture::Sampler*>(sampler)->bind();
 
     GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
@@ -643,11 +854,13 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler** values, unsigne
 
     // Pass texture unit array to GL
     GL_ASSERT( glUniform1iv(uniform->_location, count, units) );
+    PerformanceCounters::add(PerformanceCounters::UNIFORM_UPLOADS);
 }
 
 void Effect::bind()
 {
    GL_ASSERT( glUseProgram(_program) );
+    PerformanceCounters::add(PerformanceCounters::STATE_CHANGES);
 
     __currentEffect = this;
 }
@@ -657,6 +870,174 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+bool Effect::precompile(const char* manifestPath)
+{
+    GP_ASSERT(manifestPath);
+
+    Properties* properties = Properties::create(manifestPath);
+    if (properties == NULL)
+    {
+        GP_ERROR("Failed to load shader manifest '%s'.", manifestPath);
+        return false;
+    }
+
+    if (__precompileQueue.empty())
+        __precompileStart = Game::getAbsoluteTime();
+    Properties* space;
+    while ((space = properties->getNextNamespace()) != NULL)
+    {
+        const char* vshPath = space->getString("vertexShader");
+        const char* fshPath = space->getString("fragmentShader");
+        if (vshPath == NULL || fshPath == NULL)
+        {
+            GP_WARN("Effect '%s' in shader manifest '%s' is missing a shader.", space->getId(), manifestPath);
+            continue;
+        }
+        const char* defines = space->getString("defines");
+
+        PrecompileEntry entry;
+        entry.vshPath = vshPath;
+        entry.fshPath = fshPath;
+        entry.defines = defines ? defines : "";
+        __precompileQueue.push(entry);
+    }
+    SAFE_DELETE(properties);
+
+    return true;
+}
+
+bool Effect::writeManifest(const char* manifestPath)
+{
+    GP_ASSERT(manifestPath);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(manifestPath, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_ERROR("Failed to write shader manifest '%s'.", manifestPath);
+        return false;
+    }
+
+    for (std::map<std::string, Effect*>::const_iterator itr = __effectCache.begin(); itr != __effectCache.end(); ++itr)
+    {
+        // The id is "vertex shader;fragment shader;defines".
+        const std::string& id = itr->first;
+        size_t vshEnd = id.find(';');
+        size_t fshEnd = id.find(';', vshEnd + 1);
+        GP_ASSERT(vshEnd != std::string::npos && fshEnd != std::string::npos);
+
+        std::string text = "effect\n{\n";
+        text += "    vertexShader = " + id.substr(0, vshEnd) + "\n";
+        text += "    fragmentShader = " + id.substr(vshEnd + 1, fshEnd - vshEnd - 1) + "\n";
+        if (fshEnd + 1 < id.length())
+            text += "    defines = " + id.substr(fshEnd + 1) + "\n";
+        text += "}\n\n";
+        stream->write(text.c_str(), 1, text.length());
+    }
+
+    return true;
+}
+
+unsigned int Effect::getPrecompilePending()
+{
+    return (unsigned int)__precompileQueue.size();
+}
+
+unsigned int Effect::getPermutationCount()
+{
+    return (unsigned int)__effectCache.size();
+}
+
+unsigned int Effect::getProgramCount()
+{
+    return (unsigned int)__programEffects.size();
+}
+
+unsigned int Effect::getProgramsCompiled()
+{
+    return __programsCompiled;
+}
+
+unsigned int Effect::getProgramsLoaded()
+{
+    return __programsLoaded;
+}
+
+unsigned int Effect::getProgramsRejected()
+{
+    return __programsRejected;
+}
+
+double Effect::getProgramCompileTime()
+{
+    return __programCompileTime;
+}
+
+double Effect::getProgramLoadTime()
+{
+    return __programLoadTime;
+}
+
+void Effect::initialize()
+{
+    const char* manifestPath = NULL;
+    Properties* graphicsConfig = Game::getInstance()->getConfig()->getNamespace("graphics", true);
+    if (graphicsConfig)
+    {
+        if (graphicsConfig->exists("shaderPrecompileTime"))
+            __precompileTime = std::max(graphicsConfig->getFloat("shaderPrecompileTime"), 0.0f);
+        manifestPath = graphicsConfig->getString("shaderManifest");
+    }
+
+    if (manifestPath && strlen(manifestPath) > 0)
+        precompile(manifestPath);
+}
+
+void Effect::updatePrecompile()
+{
+    GP_PROFILE_SCOPE("Effect::updatePrecompile");
+    if (__precompileQueue.empty())
+        return;
+
+    // Effects need the GL context, so they are created on this thread a few at a time.
+    double startTime = Game::getAbsoluteTime();
+    do
+    {
+        const PrecompileEntry& entry = __precompileQueue.front();
+        Effect* effect = createFromFile(entry.vshPath.c_str(), entry.fshPath.c_str(), entry.defines.empty() ? NULL : entry.defines.c_str());
+        if (effect)
+            __precompiledEffects.push_back(effect);
+        __precompileQueue.pop();
+    } while (!__precompileQueue.empty() && Game::getAbsoluteTime() - startTime < __precompileTime);
+
+    if (__precompileQueue.empty())
+    {
+        print("Precompiled %u effects in %.1f ms: %u permutations use %u programs; %u programs compiled in %.1f ms, %u loaded from the shader cache in %.1f ms, %u rejected.\n",
+            (unsigned int)__precompiledEffects.size(), Game::getAbsoluteTime() - __precompileStart,
+            getPermutationCount(), getProgramCount(),
+            __programsCompiled, __programCompileTime, __programsLoaded, __programLoadTime, __programsRejected);
+
+        // Don't wait for shutdown to keep what was compiled.
+        saveProgramCache();
+    }
+}
+
+void Effect::finalize()
+{
+    while (!__precompileQueue.empty())
+        __precompileQueue.pop();
+    for (size_t i = 0, count = __precompiledEffects.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(__precompiledEffects[i]);
+    }
+    __precompiledEffects.clear();
+
+    saveProgramCache();
+    __programCache.clear();
+    __programCachePath.clear();
+    __programCacheLoaded = false;
+    __programCacheTrimmed = false;
+}
+
 Uniform::Uniform() :
     _location(-1), _type(0), _index(0), _effect(NULL)
 {
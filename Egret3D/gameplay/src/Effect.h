@@ -19,12 +19,20 @@ class Uniform;
  * An effect essentially wraps an OpenGL program object, which includes the
  * vertex and fragment shader.
  *
+ * Where the driver supports program binaries, linked programs are saved to a shader
+ * cache file keyed by a hash of their sources, defines and the driver, and later runs
+ * load them from there instead of compiling. The "shaderCache" setting of the "graphics"
+ * section of the game config names the file ("shaders.cache" by default); an empty
+ * name turns the cache off.
+ *
  * In the future, this class may be extended to support additional logic that
  * typical effect systems support, such as GPU render state management,
  * techniques and passes.
  */
 class Effect: public Ref
 {
+    friend class Game;
+
 public:
 
     /**
@@ -32,7 +40,7 @@ public:
      *
      * @param vshPath The path to the vertex shader file.
      * @param fshPath The path to the fragment shader file.
-     * @param defines A new-line delimited list of preprocessor defines. May be NULL.
+     * @param defines A semicolon delimited list of preprocessor defines. May be NULL.
      * 
      * @return The created effect.
      */
@@ -43,7 +51,7 @@ public:
      *
      * @param vshSource The vertex shader source code.
      * @param fshSource The fragment shader source code.
-     * @param defines A new-line delimited list of preprocessor defines. May be NULL.
+     * @param defines A semicolon delimited list of preprocessor defines. May be NULL.
      * 
      * @return The created effect.
      */
@@ -222,6 +230,97 @@ public:
      */
     static Effect* getCurrentEffect();
 
+    /**
+     * Queues the effects listed in a shader manifest to be created over the next frames, so
+     * that their programs are compiled (or loaded from the shader cache) before first use.
+     *
+     * The manifest is a properties file with a namespace per effect:
+     *
+     * effect
+     * {
+     *     vertexShader = res/shaders/textured.vert
+     *     fragmentShader = res/shaders/textured.frag
+     *     defines = DIRECTIONAL_LIGHT_COUNT 1;SPECULAR
+     * }
+     *
+     * The effects stay loaded until the game shuts down. The "shaderManifest" setting of the
+     * "graphics" section of the game config names a manifest that is queued at startup, and
+     * "shaderPrecompileTime" is the number of milliseconds per frame spent creating queued
+     * effects (4 by default; at least one effect is created each frame).
+     *
+     * @param manifestPath The path to the manifest file.
+     *
+     * @return True if the manifest was read.
+     */
+    static bool precompile(const char* manifestPath);
+
+    /**
+     * Writes a shader manifest listing the effects that are currently loaded from files.
+     *
+     * @param manifestPath The path of the manifest file to write.
+     *
+     * @return True if the manifest was written.
+     */
+    static bool writeManifest(const char* manifestPath);
+
+    /**
+     * Gets the number of queued effects that have not been created yet.
+     *
+     * @return The number of pending effects.
+     */
+    static unsigned int getPrecompilePending();
+
+    /**
+     * Gets the number of distinct shader and define combinations that effects are loaded for.
+     *
+     * @return The number of permutations.
+     */
+    static unsigned int getPermutationCount();
+
+    /**
+     * Gets the number of programs that the loaded effects use. Permutations whose sources
+     * are the same once the blocks they do not use are stripped share a program.
+     *
+     * @return The number of unique programs.
+     */
+    static unsigned int getProgramCount();
+
+    /**
+     * Gets the number of programs compiled from source since the game started.
+     *
+     * @return The number of compiled programs.
+     */
+    static unsigned int getProgramsCompiled();
+
+    /**
+     * Gets the number of programs loaded from the shader cache since the game started.
+     *
+     * @return The number of loaded programs.
+     */
+    static unsigned int getProgramsLoaded();
+
+    /**
+     * Gets the number of cached programs the driver refused to load, which were compiled
+     * from source instead.
+     *
+     * @return The number of rejected programs.
+     */
+    static unsigned int getProgramsRejected();
+
+    /**
+     * Gets the total time spent compiling and linking programs from source.
+     *
+     * @return The compile time in milliseconds.
+     */
+    static double getProgramCompileTime();
+
+    /**
+     * Gets the total time spent loading programs from the shader cache.
+     *
+     * @return The load time in milliseconds.
+     */
+    static double getProgramLoadTime();
+
 private:
 
     /**
@@ -241,7 +340,23 @@ private:
 
     static Effect* createFromSource(const char* vshPath, const char* vshSource, const char* fshPath, const char* fshSource, const char* defines = NULL);
 
+    /**
+     * Reads the shader cache settings and queues the startup shader manifest.
+     */
+    static void initialize();
+
+    /**
+     * Creates queued effects until the per frame precompile time is used up.
+     */
+    static void updatePrecompile();
+
+    /**
+     * Releases the precompiled effects and saves the shader cache.
+     */
+    static void finalize();
+
     GLuint _program;
+    unsigned long long _programKey;
     std::string _id;
     std::map<std::string, VertexAttribute> _vertexAttributes;
     mutable std::map<std::string, Uniform*> _uniforms;
@@ -363,6 +363,20 @@ bool FileSystem::fileExists(const char* filePath)
 
 }
 
+time_t FileSystem::getModifiedTime(const char* filePath)
+{
+    GP_ASSERT(filePath);
+
+    // Android assets are packaged and never change, so they have no time.
+    std::string fullPath;
+    getFullPath(filePath, fullPath);
+
+    gp_stat_struct s;
+    if (stat(fullPath.c_str(), &s) != 0)
+        return 0;
+    return s.st_mtime;
+}
+
 Stream* FileSystem::open(const char* path, size_t streamMode)
 {
     char modeStr[] = "rb";
@@ -146,6 +146,15 @@ public:
      */
     static bool fileExists(const char* filePath);
 
+    /**
+     * Gets the time the file at the given path was last modified.
+     *
+     * @param filePath The path to the file.
+     *
+     * @return The modification time, or 0 if the file does not exist or is a read-only asset.
+     */
+    static time_t getModifiedTime(const char* filePath);
+
     /**
      * Opens a byte stream for the given resource path.
      *
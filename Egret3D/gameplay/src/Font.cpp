@@ -5,11 +5,16 @@
 #include "FileSystem.h"
 #include "Bundle.h"
 #include "Material.h"
+#include "GlyphCache.h"
 
 // Default font shaders
 #define FONT_VSH "res/shaders/font.vert"
 #define FONT_FSH "res/shaders/font.frag"
 
+// Default line height and atlas size of fonts rasterised from TrueType files, in pixels.
+#define DYNAMIC_FONT_SIZE 32
+#define GLYPH_ATLAS_SIZE 1024
+
 namespace egret
 {
 
@@ -17,8 +22,122 @@ static std::vector<Font*> __fontCache;
 
 static Effect* __fontEffect = NULL;
 
+static unsigned int hashCharacter(unsigned int code)
+{
+    // Multiplicative hashing spreads runs of consecutive codes over the table.
+    return (code * 2654435761u) >> 8;
+}
+
+// Default size of the text layout cache in kilobytes.
+#define TEXT_LAYOUT_CACHE_SIZE 1024
+
+/**
+ * The positioned glyph quads of drawn text.
+ */
+struct TextLayout
+{
+    /** The font that laid out the text. */
+    const Font* font;
+    /** The key of the layout in the cache index. */
+    const std::string* key;
+    /** The color the vertices were last drawn with. */
+    kmVec4 color;
+    /** The glyph quads, already clipped. */
+    std::vector<SpriteBatch::SpriteVertex> vertices;
+    /** The character codes of the glyphs, kept for fonts with a glyph cache. */
+    std::vector<unsigned int> glyphs;
+    /** The memory used by the layout and its key. */
+    size_t memorySize;
+};
+
+// Cached text layouts, most recently used first.
+static std::list<TextLayout> __textLayouts;
+static std::map<std::string, std::list<TextLayout>::iterator> __textLayoutIndex;
+static size_t __textLayoutMemory = 0;
+static size_t __textLayoutBudget = (size_t)-1;
+static unsigned int __textLayoutHits = 0;
+static unsigned int __textLayoutMisses = 0;
+static unsigned int __textLayoutHitsLastFrame = 0;
+static unsigned int __textLayoutMissesLastFrame = 0;
+
+static size_t getTextLayoutBudget()
+{
+    if (__textLayoutBudget == (size_t)-1)
+    {
+        unsigned int kilobytes = TEXT_LAYOUT_CACHE_SIZE;
+        Properties* config = Game::getInstance()->getConfig()->getNamespace("ui", true);
+        if (config && config->exists("textLayoutCacheSize"))
+        {
+            kilobytes = (unsigned int)std::max(config->getInt("textLayoutCacheSize"), 0);
+        }
+        __textLayoutBudget = (size_t)kilobytes * 1024;
+    }
+    return __textLayoutBudget;
+}
+
+static void getTextLayoutKey(const Font* font, const char* text, const Rectangle& area, unsigned int size,
+                             Font::Justify justify, bool wrap, bool rightToLeft, const Rectangle& clip, std::string* key)
+{
+    // Everything but the text and the color affects where the glyphs go. The parameters
+    // are zeroed first so that padding does not make equal keys differ.
+    struct
+    {
+        const Font* font;
+        float area[4];
+        float clip[4];
+        unsigned int size;
+        int justify;
+        int flags;
+    } params;
+    memset(&params, 0, sizeof(params));
+    params.font = font;
+    params.area[0] = area.x;
+    params.area[1] = area.y;
+    params.area[2] = area.width;
+    params.area[3] = area.height;
+    params.clip[0] = clip.x;
+    params.clip[1] = clip.y;
+    params.clip[2] = clip.width;
+    params.clip[3] = clip.height;
+    params.size = size;
+    params.justify = (int)justify;
+    params.flags = (wrap ? 1 : 0) | (rightToLeft ? 2 : 0);
+
+    key->assign((const char*)&params, sizeof(params));
+    key->append(text);
+}
+
+static void eraseTextLayout(std::list<TextLayout>::iterator layout)
+{
+    __textLayoutMemory -= layout->memorySize;
+    __textLayoutIndex.erase(__textLayoutIndex.find(*layout->key));
+    __textLayouts.erase(layout);
+}
+
+static void evictTextLayouts(size_t budget)
+{
+    while (__textLayoutMemory > budget && !__textLayouts.empty())
+    {
+        eraseTextLayout(--__textLayouts.end());
+    }
+}
+
+static void releaseTextLayouts(const Font* font)
+{
+    std::list<TextLayout>::iterator itr = __textLayouts.begin();
+    while (itr != __textLayouts.end())
+    {
+        std::list<TextLayout>::iterator layout = itr++;
+        if (layout->font == font)
+        {
+            eraseTextLayout(layout);
+        }
+    }
+}
+
 Font::Font() :
-    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL)
+    _format(BITMAP), _style(PLAIN), _size(0), _spacing(0.0f), _glyphs(NULL), _glyphCount(0), _spaceAdvance(0), _texture(NULL), _batch(NULL), _cutoffParam(NULL),
+    _glyphCache(NULL)
 {
 }
 
@@ -31,8 +150,11 @@ Font::~Font()
         __fontCache.erase(itr);
     }
 
+    releaseTextLayouts(this);
+
     SAFE_DELETE(_batch);
     SAFE_DELETE_ARRAY(_glyphs);
+    SAFE_DELETE(_glyphCache);
     SAFE_RELEASE(_texture);
 
     // Free child fonts
@@ -59,6 +181,18 @@ Font* Font::create(const char* path, const char* id)
         }
     }
 
+    // TrueType fonts are rasterised as their characters are drawn.
+    std::string extension = FileSystem::getExtension(path);
+    if (extension == ".TTF" || extension == ".OTF")
+    {
+        Font* font = createTrueType(path);
+        if (font)
+        {
+            __fontCache.push_back(font);
+        }
+        return font;
+    }
+
     // Load the bundle.
     Bundle* bundle = Bundle::create(path);
     if (bundle == NULL)
@@ -101,7 +235,7 @@ Font* Font::create(const char* path, const char* id)
 Font* Font::create(const char* family, Style style, unsigned int size, Glyph* glyphs, int glyphCount, Texture* texture, Font::Format format)
 {
     GP_ASSERT(family);
-    GP_ASSERT(glyphs);
+    GP_ASSERT(glyphs || glyphCount == 0);
     GP_ASSERT(texture);
 
     // Create the effect for the font's sprite batch.
@@ -155,10 +289,79 @@ Font* Font::create(const char* family, Style style, unsigned int size, Glyph* gl
     font->_glyphs = new Glyph[glyphCount];
     memcpy(font->_glyphs, glyphs, sizeof(Glyph) * glyphCount);
     font->_glyphCount = glyphCount;
+    font->_spaceAdvance = glyphCount > 0 ? glyphs[0].advance : 0;
+
+    // Index the glyphs by character code in a table that is at most half full.
+    unsigned int tableSize = 16;
+    while (tableSize < (unsigned int)glyphCount * 2)
+        tableSize <<= 1;
+    font->_glyphTable.resize(tableSize, 0);
+    for (int i = 0; i < glyphCount; ++i)
+    {
+        unsigned int slot = hashCharacter(glyphs[i].code) & (tableSize - 1);
+        while (font->_glyphTable[slot] != 0)
+            slot = (slot + 1) & (tableSize - 1);
+        font->_glyphTable[slot] = i + 1;
+    }
 
     return font;
 }
 
+Font* Font::createTrueType(const char* path)
+{
+#ifdef GP_USE_FREETYPE
+    unsigned int size = DYNAMIC_FONT_SIZE;
+    unsigned int atlasSize = GLYPH_ATLAS_SIZE;
+    Properties* config = Game::getInstance()->getConfig()->getNamespace("ui", true);
+    if (config)
+    {
+        if (config->exists("dynamicFontSize"))
+            size = (unsigned int)std::max(config->getInt("dynamicFontSize"), 0);
+        if (config->exists("glyphAtlasSize"))
+            atlasSize = (unsigned int)std::max(config->getInt("glyphAtlasSize"), 0);
+    }
+
+    GlyphCache* cache = GlyphCache::create(path, size, atlasSize);
+    if (cache == NULL)
+        return NULL;
+
+    Font* font = create(cache->_family.c_str(), PLAIN, size, NULL, 0, cache->_texture, BITMAP);
+    if (font == NULL)
+    {
+        SAFE_DELETE(cache);
+        return NULL;
+    }
+    font->_path = path;
+    font->_glyphCache = cache;
+    font->_spaceAdvance = cache->_spaceAdvance;
+
+    // Replayed text keeps its glyphs in the atlas like text drawn anew.
+    font->_batch->setReplayFunction(&GlyphCache::touchGlyphs, cache);
+
+    // The atlas changes as glyphs come and go, so it has no mipmaps.
+    font->_batch->getSampler()->setFilterMode(Texture::LINEAR, Texture::LINEAR);
+
+    return font;
+#else
+    GP_WARN("Loading TrueType font '%s' requires FreeType; define GP_USE_FREETYPE to enable it.", path);
+    return NULL;
+#endif
+}
+
+void Font::updateGlyphCaches()
+{
+    for (size_t i = 0, count = __fontCache.size(); i < count; ++i)
+    {
+        Font* font = __fontCache[i];
+        if (font->_glyphCache && font->_glyphCache->update())
+        {
+            // Text drawn earlier may lack the new glyphs or refer to moved ones.
+            releaseTextLayouts(font);
+            font->_batch->invalidateRecordings();
+        }
+    }
+}
+
 unsigned int Font::getSize(unsigned int index) const
 {
     GP_ASSERT(index <= _sizes.size());
@@ -179,9 +382,70 @@ Font::Format Font::getFormat()
 
 bool Font::isCharacterSupported(int character) const
 {
-    // TODO: Update this once we support unicode fonts
-    int glyphIndex = character - 32; // HACK for ASCII
-    return (glyphIndex >= 0 && glyphIndex < (int)_glyphCount);
+    if (character < 0)
+        return false;
+    if (_glyphCache)
+        return _glyphCache->hasCharacter((unsigned int)character);
+    return findGlyph((unsigned int)character) != NULL;
+}
+
+const Font::Glyph* Font::findGlyph(unsigned int code) const
+{
+    if (_glyphCache)
+        return _glyphCache->findGlyph(code);
+
+    if (_glyphTable.empty())
+        return NULL;
+
+    unsigned int mask = (unsigned int)_glyphTable.size() - 1;
+    for (unsigned int slot = hashCharacter(code) & mask; _glyphTable[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const Glyph& g = _glyphs[_glyphTable[slot] - 1];
+        if (g.code == code)
+            return &g;
+    }
+    return NULL;
+}
+
+const Font::Glyph* Font::getGlyph(const char* character) const
+{
+    GP_ASSERT(character);
+
+    // Text is UTF-8 encoded. Continuation bytes have no glyph of their own, so walking
+    // text a byte at a time in either direction finds every character exactly once.
+    const unsigned char* bytes = (const unsigned char*)character;
+    unsigned int code = bytes[0];
+    if (code >= 0x80)
+    {
+        int length;
+        if ((code & 0xE0) == 0xC0)
+        {
+            code &= 0x1F;
+            length = 1;
+        }
+        else if ((code & 0xF0) == 0xE0)
+        {
+            code &= 0x0F;
+            length = 2;
+        }
+        else if ((code & 0xF8) == 0xF0)
+        {
+            code &= 0x07;
+            length = 3;
+        }
+        else
+        {
+            return NULL;
+        }
+
+        for (int i = 1; i <= length; ++i)
+        {
+            if ((bytes[i] & 0xC0) != 0x80)
+                return NULL;
+            code = (code << 6) | (bytes[i] & 0x3F);
+        }
+    }
+    return findGlyph(code);
 }
 
 void Font::start()
@@ -224,6 +488,19 @@ void Font::finish()
 
 Font* Font::findClosestSize(int size)
 {
+    // Distance fields scale to any size, so draw every size from the largest one
+    // and keep all text of the font in a single batch.
+    if (_format == DISTANCE_FIELD)
+    {
+        Font* largest = this;
+        for (size_t i = 0, count = _sizes.size(); i < count; ++i)
+        {
+            if (_sizes[i]->_size > largest->_size)
+                largest = _sizes[i];
+        }
+        return largest;
+    }
+
     if (size == (int)_size)
         return this;
 
@@ -295,7 +572,7 @@ void Font::drawText(const char* text, int x, int y, const kmVec4& color, unsigne
                 switch (delimiter)
                 {
                 case ' ':
-                    xPos += _glyphs[0].advance;
+                    xPos += _spaceAdvance;
                     break;
                 case '\r':
                 case '\n':
@@ -303,7 +580,7 @@ void Font::drawText(const char* text, int x, int y, const kmVec4& color, unsigne
                     xPos = x;
                     break;
                 case '\t':
-                    xPos += _glyphs[0].advance * 4;
+                    xPos += _spaceAdvance * 4;
                     break;
                 case 0:
                     done = true;
@@ -346,7 +623,7 @@ void Font::drawText(const char* text, int x, int y, const kmVec4& color, unsigne
             switch (c)
             {
             case ' ':
-                xPos += _glyphs[0].advance;
+                xPos += _spaceAdvance;
                 break;
             case '\r':
             case '\n':
@@ -354,13 +631,13 @@ void Font::drawText(const char* text, int x, int y, const kmVec4& color, unsigne
                 xPos = x;
                 break;
             case '\t':
-                xPos += _glyphs[0].advance * 4;
+                xPos += _spaceAdvance * 4;
                 break;
             default:
-                int index = c - 32; // HACK for ASCII
-                if (index >= 0 && index < (int)_glyphCount)
+                const Glyph* glyph = getGlyph(rightToLeft ? cursor + i : text + i);
+                if (glyph)
                 {
-                    Glyph& g = _glyphs[index];
+                    const Glyph& g = *glyph;
 
                     if (getFormat() == DISTANCE_FIELD )
                     {
@@ -370,6 +647,8 @@ void Font::drawText(const char* text, int x, int y, const kmVec4& color, unsigne
 						_cutoffParam->setVector2({ 1.0, 1.0 });
                     }
                     _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
+                    if (_glyphCache)
+                        _batch->addRecordingKeys(&g.code, 1);
                     xPos += floor(g.advance * scale + spacing);
                     break;
                 }
@@ -415,6 +694,38 @@ void Font::drawText(const char* text, const Rectangle& area, const kmVec4& color
 
     lazyStart();
 
+    // Draw the cached glyphs if the same text was laid out the same way before.
+    static std::string key;
+    size_t budget = getTextLayoutBudget();
+    if (budget > 0)
+    {
+        getTextLayoutKey(this, text, area, size, justify, wrap, rightToLeft, clip, &key);
+        std::map<std::string, std::list<TextLayout>::iterator>::iterator itr = __textLayoutIndex.find(key);
+        if (itr != __textLayoutIndex.end())
+        {
+            ++__textLayoutHits;
+            std::list<TextLayout>::iterator layout = itr->second;
+            __textLayouts.splice(__textLayouts.begin(), __textLayouts, layout);
+            if (!kmVec4AreEqual(&layout->color, &color))
+            {
+                for (size_t i = 0, count = layout->vertices.size(); i < count; ++i)
+                {
+                    SpriteBatch::SpriteVertex& v = layout->vertices[i];
+                    v.r = color.x;
+                    v.g = color.y;
+                    v.b = color.z;
+                    v.a = color.w;
+                }
+                layout->color = color;
+            }
+            drawGlyphs(layout->vertices, layout->glyphs);
+            if (_glyphCache && !layout->glyphs.empty())
+                GlyphCache::touchGlyphs(_glyphCache, &layout->glyphs[0], (unsigned int)layout->glyphs.size());
+            return;
+        }
+        ++__textLayoutMisses;
+    }
+
     float scale = (float)size / _size;
     int spacing = (int)(size * _spacing);
     int yPos = area.y;
@@ -432,6 +743,10 @@ void Font::drawText(const char* text, const Rectangle& area, const kmVec4& color
         xPos = *xPositionsIt++;
     }
 
+    const Rectangle* glyphClip = clip != Rectangle(0, 0, 0, 0) ? &clip : NULL;
+    std::vector<SpriteBatch::SpriteVertex> vertices;
+    std::vector<unsigned int> glyphs;
+
     const char* token = text;
     int iteration = 1;
     unsigned int lineLength;
@@ -508,12 +823,10 @@ void Font::drawText(const char* text, const Rectangle& area, const kmVec4& color
         GP_ASSERT(_batch);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -526,21 +839,9 @@ void Font::drawText(const char* text, const Rectangle& area, const kmVec4& color
                     // Draw this character.
                     if (draw)
                     {
-                        if (getFormat() == DISTANCE_FIELD)
-                        {
-                            if (_cutoffParam == NULL)
-                                _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
-                            // TODO: Fix me so that smaller font are much smoother
-							_cutoffParam->setVector2({ 1.0, 1.0 });
-                        }
-                        if (clip != Rectangle(0, 0, 0, 0))
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color, clip);
-                        }
-                        else
-                        {
-                            _batch->draw(xPos + (int)(g.bearingX * scale), yPos, g.width * scale, size, g.uvs[0], g.uvs[1], g.uvs[2], g.uvs[3], color);
-                        }
+                        addGlyph(g, xPos + (int)(g.bearingX * scale), yPos, scale, size, color, glyphClip, &vertices);
+                        if (_glyphCache)
+                            glyphs.push_back(g.code);
                     }
                 }
                 xPos += (int)(g.advance)*scale + spacing;
@@ -609,6 +910,72 @@ void Font::drawText(const char* text, const Rectangle& area, const kmVec4& color
             }
         }
     }
+
+    drawGlyphs(vertices, glyphs);
+
+    // Keep the layout unless it would not fit in the cache on its own.
+    if (budget > 0)
+    {
+        size_t memorySize = sizeof(TextLayout) + key.size() + vertices.size() * sizeof(SpriteBatch::SpriteVertex) +
+                            glyphs.size() * sizeof(unsigned int);
+        if (memorySize <= budget)
+        {
+            __textLayouts.push_front(TextLayout());
+            TextLayout& layout = __textLayouts.front();
+            layout.font = this;
+            layout.key = &__textLayoutIndex.insert(std::make_pair(key, __textLayouts.begin())).first->first;
+            layout.color = color;
+            layout.vertices.swap(vertices);
+            layout.vertices.shrink_to_fit();
+            layout.glyphs.swap(glyphs);
+            layout.glyphs.shrink_to_fit();
+            layout.memorySize = memorySize;
+            __textLayoutMemory += memorySize;
+            evictTextLayouts(budget);
+        }
+    }
+}
+
+void Font::addGlyph(const Glyph& glyph, float x, float y, float scale, unsigned int size, const kmVec4& color,
+                    const Rectangle* clip, std::vector<SpriteBatch::SpriteVertex>* vertices)
+{
+    GP_ASSERT(vertices);
+
+    float width = glyph.width * scale;
+    float height = (float)size;
+    float u1 = glyph.uvs[0];
+    float v1 = glyph.uvs[1];
+    float u2 = glyph.uvs[2];
+    float v2 = glyph.uvs[3];
+
+    // Only add the glyph if at least part of it is within the clip region.
+    if (clip && !_batch->clipSprite(*clip, x, y, width, height, u1, v1, u2, v2))
+    {
+        return;
+    }
+
+    size_t count = vertices->size();
+    vertices->resize(count + 4);
+    _batch->addSprite(x, y, width, height, u1, v1, u2, v2, color, &(*vertices)[count]);
+}
+
+void Font::drawGlyphs(const std::vector<SpriteBatch::SpriteVertex>& vertices, const std::vector<unsigned int>& glyphs)
+{
+    if (vertices.empty())
+    {
+        return;
+    }
+
+    if (getFormat() == DISTANCE_FIELD)
+    {
+        if (_cutoffParam == NULL)
+            _cutoffParam = _batch->getMaterial()->getParameter("u_cutoff");
+        // TODO: Fix me so that smaller font are much smoother
+        _cutoffParam->setVector2({ 1.0, 1.0 });
+    }
+    _batch->addQuads(&vertices[0], (unsigned int)(vertices.size() / 4));
+    if (!glyphs.empty())
+        _batch->addRecordingKeys(&glyphs[0], (unsigned int)glyphs.size());
 }
 
 void Font::measureText(const char* text, unsigned int size, unsigned int* width, unsigned int* height)
@@ -732,7 +1099,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
                 switch (delimiter)
                 {
                     case ' ':
-                        delimWidth += _glyphs[0].advance;
+                        delimWidth += _spaceAdvance;
                         break;
                     case '\r':
                     case '\n':
@@ -768,7 +1135,7 @@ void Font::measureText(const char* text, const Rectangle& clip, unsigned int siz
                         delimWidth = 0;
                         break;
                     case '\t':
-                        delimWidth += _glyphs[0].advance * 4;
+                        delimWidth += _spaceAdvance * 4;
                         break;
                     case 0:
                         reachedEOF = true;
@@ -1068,7 +1435,7 @@ void Font::getMeasurementInfo(const char* text, const Rectangle& area, unsigned
                     switch (delimiter)
                     {
                         case ' ':
-                            delimWidth += _glyphs[0].advance;
+                            delimWidth += _spaceAdvance;
                             lineLength++;
                             break;
                         case '\r':
@@ -1085,7 +1452,7 @@ void Font::getMeasurementInfo(const char* text, const Rectangle& area, unsigned
                             delimWidth = 0;
                             break;
                         case '\t':
-                            delimWidth += _glyphs[0].advance * 4;
+                            delimWidth += _spaceAdvance * 4;
                             lineLength++;
                             break;
                         case 0:
@@ -1205,8 +1572,35 @@ float Font::getCharacterSpacing() const
     return _spacing;
 }
 
+unsigned int Font::getLayoutCacheHits()
+{
+    return __textLayoutHitsLastFrame;
+}
+
+unsigned int Font::getLayoutCacheMisses()
+{
+    return __textLayoutMissesLastFrame;
+}
+
+size_t Font::getLayoutCacheSize()
+{
+    return __textLayoutMemory;
+}
+
+void Font::resetStatistics()
+{
+    __textLayoutHitsLastFrame = __textLayoutHits;
+    __textLayoutMissesLastFrame = __textLayoutMisses;
+    __textLayoutHits = 0;
+    __textLayoutMisses = 0;
+}
+
 void Font::setCharacterSpacing(float spacing)
 {
+    if (spacing != _spacing)
+    {
+        releaseTextLayouts(this);
+    }
     _spacing = spacing;
 }
 
@@ -1357,12 +1751,10 @@ int Font::getIndexOrLocation(const char* text, const Rectangle& area, unsigned i
         GP_ASSERT(_glyphs);
         for (int i = startIndex; i < (int)tokenLength && i >= 0; i += iteration)
         {
-            char c = token[i];
-            int glyphIndex = c - 32; // HACK for ASCII
-
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
 
                 if (xPos + (int)(g.advance*scale) > area.x + area.width)
                 {
@@ -1485,16 +1877,16 @@ unsigned int Font::getTokenWidth(const char* token, unsigned int length, unsigne
         switch (c)
         {
         case ' ':
-            tokenWidth += _glyphs[0].advance;
+            tokenWidth += _spaceAdvance;
             break;
         case '\t':
-            tokenWidth += _glyphs[0].advance * 4;
+            tokenWidth += _spaceAdvance * 4;
             break;
         default:
-            int glyphIndex = c - 32;
-            if (glyphIndex >= 0 && glyphIndex < (int)_glyphCount)
+            const Glyph* glyph = getGlyph(token + i);
+            if (glyph)
             {
-                Glyph& g = _glyphs[glyphIndex];
+                const Glyph& g = *glyph;
                 tokenWidth += floor(g.advance * scale + spacing);
             }
             break;
@@ -1559,7 +1951,7 @@ int Font::handleDelimiters(const char** token, const unsigned int size, const in
         switch (delimiter)
         {
             case ' ':
-                *xPos += _glyphs[0].advance;
+                *xPos += _spaceAdvance;
                 (*lineLength)++;
                 if (charIndex)
                 {
@@ -1591,7 +1983,7 @@ int Font::handleDelimiters(const char** token, const unsigned int size, const in
                 }
                 break;
             case '\t':
-                *xPos += _glyphs[0].advance * 4;
+                *xPos += _spaceAdvance * 4;
                 (*lineLength)++;
                 if (charIndex)
                 {
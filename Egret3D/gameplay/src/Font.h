@@ -6,12 +6,20 @@
 namespace egret
 {
 
+class GlyphCache;
+
 /**
  * Defines a font for text rendering.
+ *
+ * Text is UTF-8 encoded and may use any character the font has a glyph for. Bitmap
+ * fonts hold a glyph atlas per size and draw with the closest one, while distance
+ * field fonts draw every size from a single atlas and sprite batch.
  */
 class Font : public Ref
 {
     friend class Bundle;
+    friend class Game;
+    friend class GlyphCache;
     friend class Text;
     friend class TextBox;
 
@@ -69,7 +77,14 @@ public:
      * If a font for the given path has already been loaded, the existing font will be
      * returned with its reference count increased.
      *
-     * @param path The path to a bundle file containing a font resource.
+     * A path to a TrueType (.ttf or .otf) file creates a font whose glyphs are rasterised
+     * into a texture atlas as they are first drawn, so it supports every character of the
+     * file. Such glyphs show up from the frame after they are first drawn. The line height
+     * and atlas size are set by the 'dynamicFontSize' (32 by default) and 'glyphAtlasSize'
+     * (1024 by default) properties of the 'ui' config namespace. TrueType fonts require
+     * the engine to be built with GP_USE_FREETYPE defined.
+     *
+     * @param path The path to a bundle file containing a font resource, or to a TrueType font.
      * @param id An optional ID of the font resource within the bundle (NULL for the first/only resource).
      *
      * @return The specified Font or NULL if there was an error.
@@ -144,6 +159,11 @@ public:
      * Draws the specified text within a rectangular area, with a specified alignment and scale.
      * Clips text outside the viewport. Optionally wraps text to fit within the width of the viewport.
      *
+     * The positioned glyphs of recently drawn text are cached, so drawing the same text
+     * within the same area again only copies its vertices into the batch. The size of the
+     * cache is set in kilobytes by the 'textLayoutCacheSize' property of the 'ui' config
+     * namespace (1024 by default, 0 disables it).
+     *
      * @param text The text to draw.
      * @param area The viewport area to draw within.  Text will be clipped outside this rectangle.
      * @param color The color of text.
@@ -240,6 +260,27 @@ public:
      */
     static Justify getJustify(const char* justify);
 
+    /**
+     * Gets the number of times drawn text was found in the text layout cache in the last frame.
+     *
+     * @return The number of text layout cache hits.
+     */
+    static unsigned int getLayoutCacheHits();
+
+    /**
+     * Gets the number of times drawn text had to be laid out in the last frame.
+     *
+     * @return The number of text layout cache misses.
+     */
+    static unsigned int getLayoutCacheMisses();
+
+    /**
+     * Gets the number of bytes used by the text layout cache.
+     *
+     * @return The size of the cached text layouts.
+     */
+    static size_t getLayoutCacheSize();
+
 private:
 
     /**
@@ -331,6 +372,47 @@ private:
 
     Font* findClosestSize(int size);
 
+    /**
+     * Creates a font that rasterises the glyphs of a TrueType file as they are drawn.
+     */
+    static Font* createTrueType(const char* path);
+
+    /**
+     * Adds the glyphs rasterised since the last frame to the atlases of TrueType fonts.
+     */
+    static void updateGlyphCaches();
+
+    /**
+     * Gets the glyph of the given character code, or NULL if the font does not have one.
+     */
+    const Glyph* findGlyph(unsigned int code) const;
+
+    /**
+     * Gets the glyph of the UTF-8 character starting at the given byte.
+     *
+     * @return The glyph, or NULL if the font does not have one or the byte does not start a character.
+     */
+    const Glyph* getGlyph(const char* character) const;
+
+    /**
+     * Adds the quad of a glyph to the given vertices, clipped to the given clip region if any.
+     */
+    void addGlyph(const Glyph& glyph, float x, float y, float scale, unsigned int size, const kmVec4& color,
+                  const Rectangle* clip, std::vector<SpriteBatch::SpriteVertex>* vertices);
+
+    /**
+     * Adds the given glyph quads to the sprite batch of the font.
+     *
+     * The character codes of the glyphs, if any, are recorded along with the quads so that
+     * replaying the recording marks the glyphs as used in the glyph cache.
+     */
+    void drawGlyphs(const std::vector<SpriteBatch::SpriteVertex>& vertices, const std::vector<unsigned int>& glyphs);
+
+    /**
+     * Captures the text layout cache statistics of the frame and starts counting the next one.
+     */
+    static void resetStatistics();
+
     void lazyStart();
 
     Format _format;
@@ -343,10 +425,13 @@ private:
     float _spacing;
     Glyph* _glyphs;
     unsigned int _glyphCount;
+    std::vector<unsigned int> _glyphTable; // glyph index + 1 by hashed character code, 0 if empty
+    unsigned int _spaceAdvance;
     Texture* _texture;
     SpriteBatch* _batch;
     Rectangle _viewport;
     MaterialParameter* _cutoffParam;
+    GlyphCache* _glyphCache;
 };
 
 }
@@ -42,6 +42,11 @@ struct FormInit
 };
 static FormInit __init;
 
+unsigned int Form::_controlsRebuilt = 0;
+unsigned int Form::_controlsReused = 0;
+unsigned int Form::_controlsRebuiltLastFrame = 0;
+unsigned int Form::_controlsReusedLastFrame = 0;
+
 Form::Form() : Drawable(), _batched(true)
 {
 	memset(_projectionMatrix.mat, 0, sizeof(float) * 16);
@@ -271,7 +276,7 @@ unsigned int Form::draw(bool wireframe)
     }
 
     // Draw the form
-    unsigned int drawCalls = Container::draw(this, _absoluteClipBounds);
+    unsigned int drawCalls = drawCached(this, _absoluteClipBounds);
 
     // Flush all batches that were queued during drawing and then empty the batch list
     if (_batched)
@@ -301,6 +306,24 @@ void Form::setBatchingEnabled(bool enabled)
     _batched = enabled;
 }
 
+unsigned int Form::getControlsRebuilt()
+{
+    return _controlsRebuiltLastFrame;
+}
+
+unsigned int Form::getControlsReused()
+{
+    return _controlsReusedLastFrame;
+}
+
+void Form::resetStatistics()
+{
+    _controlsRebuiltLastFrame = _controlsRebuilt;
+    _controlsReusedLastFrame = _controlsReused;
+    _controlsRebuilt = 0;
+    _controlsReused = 0;
+}
+
 void Form::updateInternal(float elapsedTime)
 {
     pollGamepads();
@@ -138,6 +138,25 @@ public:
      */
     void setBatchingEnabled(bool enabled);
 
+    /**
+     * Gets the number of controls whose sprites were generated while drawing forms in the last frame.
+     *
+     * Batched forms retain the sprites generated by every control and only generate them
+     * again for controls that changed, so this is the work saved by drawing unchanged ones.
+     *
+     * @return The number of controls drawn from scratch in the last frame.
+     */
+    static unsigned int getControlsRebuilt();
+
+    /**
+     * Gets the number of controls whose retained sprites were reused while drawing forms in the last frame.
+     *
+     * A reused container accounts for its whole subtree, whose children are not counted.
+     *
+     * @return The number of controls drawn from retained sprites in the last frame.
+     */
+    static unsigned int getControlsReused();
+
 private:
     
     /**
@@ -177,6 +196,11 @@ private:
      */
     static void updateInternal(float elapsedTime);
 
+    /**
+     * Captures the control drawing statistics of the frame and starts counting the next one.
+     */
+    static void resetStatistics();
+
     /**
      * Propagate touch events to enabled forms.
      *
@@ -277,6 +301,11 @@ private:
     kmMat4 _projectionMatrix;           // Projection kmMat4 to be set on SpriteBatch objects when rendering the form
     std::vector<SpriteBatch*> _batches;
     bool _batched;
+
+    static unsigned int _controlsRebuilt;
+    static unsigned int _controlsReused;
+    static unsigned int _controlsRebuiltLastFrame;
+    static unsigned int _controlsReusedLastFrame;
 };
 
 }
@@ -50,7 +50,7 @@ void FrameBuffer::initialize()
 {
     // Query the current/initial FBO handle and store is as out 'default' frame buffer.
     // On many platforms this will simply be the zero (0) handle, but this is not always the case.
-    GLint fbo;
+    GLint fbo = 0;
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
     _defaultFrameBuffer = new FrameBuffer(FRAMEBUFFER_ID_DEFAULT, 0, 0, (FrameBufferHandle)fbo);
     _currentFrameBuffer = _defaultFrameBuffer;
@@ -58,7 +58,7 @@ void FrameBuffer::initialize()
     // Query the max supported color attachments. This glGet operation is not supported
     // on GL ES 2.x, so if the define does not exist, assume a value of 1.
 #ifdef GL_MAX_COLOR_ATTACHMENTS
-        GLint val;
+        GLint val = 1;
         GL_ASSERT( glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &val) );
         _maxRenderTargets = (unsigned int)std::max(1, val);
 #else
@@ -0,0 +1,477 @@
+#include "Base.h"
+#include "FramePacket.h"
+#include "Game.h"
+#include "Material.h"
+#include "MeshPart.h"
+#include "Model.h"
+#include "Technique.h"
+#include "Pass.h"
+#include "PerformanceCounters.h"
+
+// The alignment of values copied into a packet.
+#define FRAMEPACKET_DATA_ALIGNMENT 16
+
+#ifdef _MSC_VER
+#define FRAMEPACKET_THREAD_LOCAL __declspec(thread)
+#else
+#define FRAMEPACKET_THREAD_LOCAL thread_local
+#endif
+
+namespace egret
+{
+
+static FRAMEPACKET_THREAD_LOCAL FramePacket* __recordingPacket = NULL;
+
+FramePacket::Stream::Stream(const VertexFormat& vertexFormat)
+    : format(vertexFormat), mesh(NULL), indexBuffer(0)
+{
+}
+
+FramePacket::FramePacket()
+    : _stateCount(0), _drawCount(0)
+{
+}
+
+FramePacket::~FramePacket()
+{
+    reset();
+
+    for (size_t i = 0, count = _states.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_states[i]);
+    }
+
+    for (size_t i = 0, count = _streams.size(); i < count; ++i)
+    {
+        Stream* stream = _streams[i];
+        for (size_t j = 0, bindingCount = stream->bindings.size(); j < bindingCount; ++j)
+        {
+            SAFE_RELEASE(stream->bindings[j].second);
+        }
+        SAFE_RELEASE(stream->mesh);
+        if (stream->indexBuffer)
+        {
+            GL_ASSERT( glDeleteBuffers(1, &stream->indexBuffer) );
+        }
+        SAFE_DELETE(stream);
+    }
+}
+
+FramePacket* FramePacket::getRecording()
+{
+    return __recordingPacket;
+}
+
+void FramePacket::addCallback(void (*callback)(void* data), const void* data, size_t size)
+{
+    GP_ASSERT(callback);
+
+    Command command;
+    command.type = FUNCTION;
+    command.function.callback = callback;
+    command.function.dataOffset = data && size > 0 ? addData(data, size) : (size_t)-1;
+    _commands.push_back(command);
+}
+
+void FramePacket::setValue(Uniform* uniform, float value)
+{
+    addUniform(uniform, FLOAT, &value, 1, sizeof(float));
+}
+
+void FramePacket::setValue(Uniform* uniform, const float* values, unsigned int count)
+{
+    addUniform(uniform, FLOAT, values, count, count * sizeof(float));
+}
+
+void FramePacket::setValue(Uniform* uniform, int value)
+{
+    addUniform(uniform, INT, &value, 1, sizeof(int));
+}
+
+void FramePacket::setValue(Uniform* uniform, const int* values, unsigned int count)
+{
+    addUniform(uniform, INT, values, count, count * sizeof(int));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmMat4& value)
+{
+    addUniform(uniform, MATRIX, &value, 1, sizeof(kmMat4));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmMat4* values, unsigned int count)
+{
+    addUniform(uniform, MATRIX, values, count, count * sizeof(kmMat4));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec2& value)
+{
+    addUniform(uniform, VECTOR2, &value, 1, sizeof(kmVec2));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec2* values, unsigned int count)
+{
+    addUniform(uniform, VECTOR2, values, count, count * sizeof(kmVec2));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec3& value)
+{
+    addUniform(uniform, VECTOR3, &value, 1, sizeof(kmVec3));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec3* values, unsigned int count)
+{
+    addUniform(uniform, VECTOR3, values, count, count * sizeof(kmVec3));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec4& value)
+{
+    addUniform(uniform, VECTOR4, &value, 1, sizeof(kmVec4));
+}
+
+void FramePacket::setValue(Uniform* uniform, const kmVec4* values, unsigned int count)
+{
+    addUniform(uniform, VECTOR4, values, count, count * sizeof(kmVec4));
+}
+
+void FramePacket::setValue(Uniform* uniform, const Texture::Sampler* sampler)
+{
+    setValue(uniform, &sampler, 1);
+}
+
+void FramePacket::setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count)
+{
+    GP_ASSERT(values);
+
+    // The sampler state is shared, but the textures stay alive until the packet was drawn.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        GP_ASSERT(values[i]);
+        retain(const_cast<Texture::Sampler*>(values[i]));
+    }
+    addUniform(uniform, SAMPLER, values, count, count * sizeof(Texture::Sampler*));
+}
+
+void FramePacket::beginRecording()
+{
+    GP_ASSERT(__recordingPacket == NULL);
+    __recordingPacket = this;
+}
+
+void FramePacket::endRecording()
+{
+    GP_ASSERT(__recordingPacket == this);
+    __recordingPacket = NULL;
+}
+
+void FramePacket::reset()
+{
+    for (size_t i = 0, count = _refs.size(); i < count; ++i)
+    {
+        _refs[i]->release();
+    }
+    _refs.clear();
+    _commands.clear();
+    _uniforms.clear();
+    _data.clear();
+    _stateCount = 0;
+    _drawCount = 0;
+}
+
+void FramePacket::render()
+{
+    Game* game = Game::getInstance();
+    GP_ASSERT(game);
+
+    for (size_t i = 0, count = _commands.size(); i < count; ++i)
+    {
+        const Command& command = _commands[i];
+        switch (command.type)
+        {
+        case CLEAR:
+            {
+                kmVec4 color = { command.clear.color[0], command.clear.color[1], command.clear.color[2], command.clear.color[3] };
+                game->clear((Game::ClearFlags)command.clear.flags, color, command.clear.depth, command.clear.stencil);
+            }
+            break;
+        case VIEWPORT:
+            GL_ASSERT( glViewport((GLuint)command.viewport.x, (GLuint)command.viewport.y, (GLuint)command.viewport.width, (GLuint)command.viewport.height) );
+            break;
+        case DRAW:
+            renderDraw(command);
+            break;
+        case FUNCTION:
+            command.function.callback(command.function.dataOffset != (size_t)-1 ? &_data[command.function.dataOffset] : NULL);
+            break;
+        }
+    }
+}
+
+void FramePacket::clear(int flags, const kmVec4& color, float depth, int stencil)
+{
+    Command command;
+    command.type = CLEAR;
+    command.clear.flags = flags;
+    command.clear.color[0] = color.x;
+    command.clear.color[1] = color.y;
+    command.clear.color[2] = color.z;
+    command.clear.color[3] = color.w;
+    command.clear.depth = depth;
+    command.clear.stencil = stencil;
+    _commands.push_back(command);
+}
+
+void FramePacket::setViewport(const Rectangle& viewport)
+{
+    Command command;
+    command.type = VIEWPORT;
+    command.viewport.x = viewport.x;
+    command.viewport.y = viewport.y;
+    command.viewport.width = viewport.width;
+    command.viewport.height = viewport.height;
+    _commands.push_back(command);
+}
+
+void FramePacket::drawMesh(Material* material, Mesh* mesh, MeshPart* part, bool wireframe)
+{
+    GP_ASSERT(material);
+    GP_ASSERT(mesh);
+
+    Command command;
+    memset(&command, 0, sizeof(command));
+    command.type = DRAW;
+    command.draw.stream = -1;
+    command.draw.wireframe = wireframe;
+    if (part)
+    {
+        command.draw.primitiveType = part->getPrimitiveType();
+        command.draw.count = part->getIndexCount();
+        command.draw.indexFormat = part->getIndexFormat();
+        command.draw.indexBuffer = part->getIndexBuffer();
+    }
+    else
+    {
+        command.draw.primitiveType = mesh->getPrimitiveType();
+        command.draw.count = mesh->getVertexCount();
+    }
+
+    // The mesh owns the vertex and index buffers the draw reads.
+    retain(mesh);
+    addDraw(material, command);
+}
+
+void FramePacket::drawBatch(Material* material, const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType,
+                            const void* vertices, unsigned int vertexCount, const void* indices, unsigned int indexCount,
+                            Mesh::IndexFormat indexFormat)
+{
+    GP_ASSERT(material);
+    GP_ASSERT(vertices);
+
+    Command command;
+    memset(&command, 0, sizeof(command));
+    command.type = DRAW;
+    command.draw.primitiveType = primitiveType;
+    command.draw.stream = getStream(vertexFormat);
+    command.draw.vertexSize = vertexCount * vertexFormat.getVertexSize();
+    command.draw.vertexOffset = addData(vertices, command.draw.vertexSize);
+    if (indices)
+    {
+        command.draw.count = indexCount;
+        command.draw.indexFormat = indexFormat;
+        command.draw.indexSize = indexCount * (indexFormat == Mesh::INDEX32 ? sizeof(unsigned int) : sizeof(unsigned short));
+        command.draw.indexOffset = addData(indices, command.draw.indexSize);
+    }
+    else
+    {
+        command.draw.count = vertexCount;
+    }
+    addDraw(material, command);
+}
+
+void FramePacket::addDraw(Material* material, const Command& command)
+{
+    // Keeps the material's techniques, passes and effects alive.
+    retain(material);
+
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+
+        Command draw = command;
+        draw.draw.pass = pass;
+        draw.draw.state = addState(pass);
+        draw.draw.firstUniform = (unsigned int)_uniforms.size();
+        pass->capture(pass, this);
+        draw.draw.uniformCount = (unsigned int)_uniforms.size() - draw.draw.firstUniform;
+        _commands.push_back(draw);
+        ++_drawCount;
+    }
+}
+
+void FramePacket::renderDraw(const Command& command)
+{
+    Pass* pass = command.draw.pass;
+    GP_ASSERT(pass);
+    Effect* effect = pass->getEffect();
+    GP_ASSERT(effect);
+
+    effect->bind();
+    _states[command.draw.state]->bind();
+
+    for (unsigned int i = command.draw.firstUniform, end = i + command.draw.uniformCount; i < end; ++i)
+    {
+        const UniformValue& value = _uniforms[i];
+        const void* data = &_data[value.dataOffset];
+        switch (value.type)
+        {
+        case FLOAT:
+            effect->setValue(value.uniform, (const float*)data, value.count);
+            break;
+        case INT:
+            effect->setValue(value.uniform, (const int*)data, value.count);
+            break;
+        case VECTOR2:
+            effect->setValue(value.uniform, (const kmVec2*)data, value.count);
+            break;
+        case VECTOR3:
+            effect->setValue(value.uniform, (const kmVec3*)data, value.count);
+            break;
+        case VECTOR4:
+            effect->setValue(value.uniform, (const kmVec4*)data, value.count);
+            break;
+        case MATRIX:
+            effect->setValue(value.uniform, (const kmMat4*)data, value.count);
+            break;
+        case SAMPLER:
+            effect->setValue(value.uniform, (const Texture::Sampler**)data, value.count);
+            break;
+        }
+    }
+
+    Stream* stream = NULL;
+    VertexAttributeBinding* binding = NULL;
+    if (command.draw.stream >= 0)
+    {
+        // Stream the copied vertices, orphaning the storage the last draw read from.
+        stream = _streams[command.draw.stream];
+        if (stream->mesh == NULL)
+            stream->mesh = Mesh::createMesh(stream->format, 0, true);
+        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, stream->mesh->getVertexBuffer()) );
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, command.draw.vertexSize, &_data[command.draw.vertexOffset], GL_STREAM_DRAW) );
+        GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+        binding = getStreamBinding(stream, effect);
+    }
+    else
+    {
+        binding = pass->getVertexAttributeBinding();
+    }
+    if (binding)
+        binding->bind();
+
+    if (command.draw.indexSize > 0)
+    {
+        GP_ASSERT(stream);
+        if (!stream->indexBuffer)
+            GL_ASSERT( glGenBuffers(1, &stream->indexBuffer) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream->indexBuffer) );
+        GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, command.draw.indexSize, &_data[command.draw.indexOffset], GL_STREAM_DRAW) );
+        GL_ASSERT( glDrawElements(command.draw.primitiveType, command.draw.count, command.draw.indexFormat, 0) );
+        PerformanceCounters::addDrawCall(command.draw.primitiveType, command.draw.count);
+    }
+    else if (command.draw.indexBuffer)
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.draw.indexBuffer) );
+        if (!command.draw.wireframe || !Model::drawWireframe(command.draw.primitiveType, command.draw.count, command.draw.indexFormat))
+        {
+            GL_ASSERT( glDrawElements(command.draw.primitiveType, command.draw.count, command.draw.indexFormat, 0) );
+            PerformanceCounters::addDrawCall(command.draw.primitiveType, command.draw.count);
+        }
+    }
+    else
+    {
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+        if (!command.draw.wireframe || !Model::drawWireframe(command.draw.primitiveType, command.draw.count))
+        {
+            GL_ASSERT( glDrawArrays(command.draw.primitiveType, 0, command.draw.count) );
+            PerformanceCounters::addDrawCall(command.draw.primitiveType, command.draw.count);
+        }
+    }
+
+    if (binding)
+        binding->unbind();
+}
+
+unsigned int FramePacket::addState(Pass* pass)
+{
+    GP_ASSERT(pass);
+
+    // State blocks are kept between frames and overwritten.
+    if (_stateCount == _states.size())
+        _states.push_back(RenderState::StateBlock::create());
+    pass->captureStates(_states[_stateCount]);
+    return _stateCount++;
+}
+
+void FramePacket::addUniform(Uniform* uniform, UniformType type, const void* values, unsigned int count, size_t size)
+{
+    GP_ASSERT(uniform);
+    GP_ASSERT(values);
+
+    UniformValue value;
+    value.uniform = uniform;
+    value.type = type;
+    value.count = count;
+    value.dataOffset = addData(values, size);
+    _uniforms.push_back(value);
+}
+
+size_t FramePacket::addData(const void* data, size_t size)
+{
+    size_t offset = (_data.size() + FRAMEPACKET_DATA_ALIGNMENT - 1) & ~(size_t)(FRAMEPACKET_DATA_ALIGNMENT - 1);
+    _data.resize(offset + size);
+    if (size > 0)
+        memcpy(&_data[offset], data, size);
+    return offset;
+}
+
+void FramePacket::retain(Ref* ref)
+{
+    GP_ASSERT(ref);
+    ref->addRef();
+    _refs.push_back(ref);
+}
+
+int FramePacket::getStream(const VertexFormat& vertexFormat)
+{
+    for (size_t i = 0, count = _streams.size(); i < count; ++i)
+    {
+        if (_streams[i]->format == vertexFormat)
+            return (int)i;
+    }
+
+    // The buffers are created by the thread that draws the packet.
+    _streams.push_back(new Stream(vertexFormat));
+    return (int)_streams.size() - 1;
+}
+
+VertexAttributeBinding* FramePacket::getStreamBinding(Stream* stream, Effect* effect)
+{
+    GP_ASSERT(stream);
+    GP_ASSERT(stream->mesh);
+
+    for (size_t i = 0, count = stream->bindings.size(); i < count; ++i)
+    {
+        if (stream->bindings[i].first == effect)
+            return stream->bindings[i].second;
+    }
+
+    // The binding holds a reference to the effect, so it cannot be confused with a later one.
+    VertexAttributeBinding* binding = VertexAttributeBinding::create(stream->mesh, effect);
+    if (binding)
+        stream->bindings.push_back(std::make_pair(effect, binding));
+    return binding;
+}
+
+}
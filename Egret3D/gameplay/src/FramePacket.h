@@ -0,0 +1,372 @@
+#ifndef FRAMEPACKET_H_
+#define FRAMEPACKET_H_
+
+#include "Effect.h"
+#include "Mesh.h"
+#include "RenderState.h"
+#include "Rectangle.h"
+
+namespace egret
+{
+
+class Material;
+class MeshPart;
+class Pass;
+class VertexAttributeBinding;
+
+/**
+ * Holds the draws of a frame, recorded with copies of the state they render, so the
+ * frame can be drawn while the game simulates the next one.
+ *
+ * When frames are pipelined (see FrameScheduler::setPipelined), the game's update and
+ * render run on a simulation thread. Its render does not draw: models, mesh batches and
+ * everything built on them (sprite batches, particle emitters, fonts and forms) record
+ * into the frame packet instead, along with clears and viewport changes. A draw records
+ * the world matrices and every other material parameter it uses by value, evaluating
+ * bound methods right away, along with the render states of its material, and batches
+ * record a copy of their vertices and indices. The next frame then draws the packet on
+ * the thread that owns the graphics context while the game changes its nodes, materials
+ * and batches for the frame after.
+ *
+ * Meshes, effects and textures are shared with the packet rather than copied: a packet
+ * keeps the materials and meshes it draws alive until it was drawn (so releasing them in
+ * update is safe), but changing them in update shows in the frame that is still drawing.
+ * While frames are pipelined update and render must not call the graphics API directly,
+ * which includes creating textures, effects, meshes and batches, and drawing terrain
+ * whose layers or pages change; use addCallback to run such code when the packet is drawn.
+ */
+class FramePacket
+{
+    friend class FrameScheduler;
+    friend class Model;
+    friend class MeshBatch;
+    friend class Game;
+
+public:
+
+    /**
+     * Gets the packet the calling thread records its draws into.
+     *
+     * @return The recording packet, or NULL if draws on this thread go to the graphics device.
+     */
+    static FramePacket* getRecording();
+
+    /**
+     * Records a function to call when the packet is drawn, with a copy of the given data.
+     *
+     * @param callback The function to call on the thread that draws the packet.
+     * @param data The data to copy for the callback, or NULL.
+     * @param size The size of the data in bytes.
+     */
+    void addCallback(void (*callback)(void* data), const void* data = NULL, size_t size = 0);
+
+    /**
+     * Gets the number of commands recorded in the packet, including clears, viewport changes
+     * and callbacks.
+     *
+     * @return The number of commands.
+     */
+    inline unsigned int getCommandCount() const;
+
+    /**
+     * Gets the number of draws recorded in the packet, one for each pass of a drawn model part
+     * or batch.
+     *
+     * @return The number of draws.
+     */
+    inline unsigned int getDrawCount() const;
+
+    /**
+     * Gets the number of uniform values recorded in the packet.
+     *
+     * @return The number of uniform values.
+     */
+    inline unsigned int getUniformCount() const;
+
+    /**
+     * Gets the size of the copied vertices, indices and values in the packet.
+     *
+     * @return The size in bytes.
+     */
+    inline size_t getDataSize() const;
+
+    /**
+     * Records a uniform value of the draw being recorded. Material parameters call these
+     * while a draw is recorded; the arguments match those of Effect::setValue.
+     */
+    void setValue(Uniform* uniform, float value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const float* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, int value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const int* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmMat4& value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmMat4* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec2& value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec2* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec3& value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec3* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec4& value);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const kmVec4* values, unsigned int count = 1);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const Texture::Sampler* sampler);
+
+    /**
+     * @see FramePacket::setValue(Uniform*, float)
+     */
+    void setValue(Uniform* uniform, const Texture::Sampler** values, unsigned int count);
+
+private:
+
+    /**
+     * The kinds of recorded commands.
+     */
+    enum CommandType
+    {
+        CLEAR,
+        VIEWPORT,
+        DRAW,
+        FUNCTION
+    };
+
+    /**
+     * The kinds of recorded uniform values.
+     */
+    enum UniformType
+    {
+        FLOAT,
+        INT,
+        VECTOR2,
+        VECTOR3,
+        VECTOR4,
+        MATRIX,
+        SAMPLER
+    };
+
+    /**
+     * A recorded command.
+     */
+    struct Command
+    {
+        CommandType type;
+        union
+        {
+            struct
+            {
+                int flags;
+                float color[4];
+                float depth;
+                int stencil;
+            } clear;
+            struct
+            {
+                float x;
+                float y;
+                float width;
+                float height;
+            } viewport;
+            struct
+            {
+                Pass* pass;
+                unsigned int state;
+                bool wireframe;
+                unsigned int firstUniform;
+                unsigned int uniformCount;
+                Mesh::PrimitiveType primitiveType;
+                unsigned int count;
+                Mesh::IndexFormat indexFormat;
+                // A model's index buffer, or 0 for arrays and batches.
+                IndexBufferHandle indexBuffer;
+                // Batches: the stream to draw the copied vertices and indices with.
+                int stream;
+                size_t vertexOffset;
+                size_t vertexSize;
+                size_t indexOffset;
+                size_t indexSize;
+            } draw;
+            struct
+            {
+                void (*callback)(void*);
+                size_t dataOffset;
+            } function;
+        };
+    };
+
+    /**
+     * A recorded uniform value, stored in the packet's data.
+     */
+    struct UniformValue
+    {
+        Uniform* uniform;
+        UniformType type;
+        unsigned int count;
+        size_t dataOffset;
+    };
+
+    /**
+     * The buffers a vertex format of batches is drawn from. Only used by the thread that
+     * draws the packet.
+     */
+    struct Stream
+    {
+        Stream(const VertexFormat& vertexFormat);
+
+        VertexFormat format;
+        Mesh* mesh;
+        IndexBufferHandle indexBuffer;
+        std::vector<std::pair<Effect*, VertexAttributeBinding*> > bindings;
+    };
+
+    /**
+     * Constructor.
+     */
+    FramePacket();
+
+    /**
+     * Destructor.
+     */
+    ~FramePacket();
+
+    /**
+     * Hidden copy constructor.
+     */
+    FramePacket(const FramePacket&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    FramePacket& operator=(const FramePacket&);
+
+    /**
+     * Makes the packet the one the calling thread records into.
+     */
+    void beginRecording();
+
+    /**
+     * Stops recording into the packet.
+     */
+    void endRecording();
+
+    /**
+     * Releases what the packet holds and removes its commands. Called on the thread that
+     * owns the graphics context, since the last reference to a mesh may go with it.
+     */
+    void reset();
+
+    /**
+     * Draws the recorded commands. Called on the thread that owns the graphics context.
+     */
+    void render();
+
+    /**
+     * Records a clear. Called by Game::clear.
+     */
+    void clear(int flags, const kmVec4& color, float depth, int stencil);
+
+    /**
+     * Records a viewport change. Called by Game::setViewport.
+     */
+    void setViewport(const Rectangle& viewport);
+
+    /**
+     * Records the passes of a material drawing a mesh, or a part of it.
+     *
+     * @param material The material to draw with.
+     * @param mesh The mesh to draw.
+     * @param part The part of the mesh to draw, or NULL to draw its vertices as arrays.
+     * @param wireframe True to draw the triangles as line loops.
+     */
+    void drawMesh(Material* material, Mesh* mesh, MeshPart* part, bool wireframe);
+
+    /**
+     * Records the passes of a material drawing a copy of batched vertices and indices.
+     *
+     * @param material The material to draw with.
+     * @param vertexFormat The format of the vertices.
+     * @param primitiveType The primitives to draw.
+     * @param vertices The vertices.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices, or NULL to draw the vertices as arrays.
+     * @param indexCount The number of indices.
+     * @param indexFormat The format of the indices.
+     */
+    void drawBatch(Material* material, const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType,
+                   const void* vertices, unsigned int vertexCount, const void* indices, unsigned int indexCount,
+                   Mesh::IndexFormat indexFormat);
+
+    void addDraw(Material* material, const Command& command);
+
+    void renderDraw(const Command& command);
+
+    unsigned int addState(Pass* pass);
+
+    void addUniform(Uniform* uniform, UniformType type, const void* values, unsigned int count, size_t size);
+
+    size_t addData(const void* data, size_t size);
+
+    void retain(Ref* ref);
+
+    int getStream(const VertexFormat& vertexFormat);
+
+    VertexAttributeBinding* getStreamBinding(Stream* stream, Effect* effect);
+
+    std::vector<Command> _commands;
+    std::vector<UniformValue> _uniforms;
+    std::vector<unsigned char> _data;
+    std::vector<Ref*> _refs;
+    std::vector<RenderState::StateBlock*> _states;
+    unsigned int _stateCount;
+    std::vector<Stream*> _streams;
+    unsigned int _drawCount;
+};
+
+}
+
+#include "FramePacket.inl"
+
+#endif
@@ -0,0 +1,26 @@
+#include "FramePacket.h"
+
+namespace egret
+{
+
+inline unsigned int FramePacket::getCommandCount() const
+{
+    return (unsigned int)_commands.size();
+}
+
+inline unsigned int FramePacket::getDrawCount() const
+{
+    return _drawCount;
+}
+
+inline unsigned int FramePacket::getUniformCount() const
+{
+    return (unsigned int)_uniforms.size();
+}
+
+inline size_t FramePacket::getDataSize() const
+{
+    return _data.size();
+}
+
+}
@@ -0,0 +1,314 @@
+#include "Base.h"
+#include "FrameScheduler.h"
+#include "FramePacket.h"
+#include "Game.h"
+#include "FileSystem.h"
+#include "Stream.h"
+#include <thread>
+#include <chrono>
+
+// The most ticks a frame runs by default.
+#define DEFAULT_MAX_TICKS 5
+
+// How long before a frame is due to stop sleeping by default, in milliseconds.
+#define DEFAULT_SPIN_TIME 1.0f
+
+namespace egret
+{
+
+const float FrameScheduler::BUCKET_WIDTH = 0.5f;
+
+FrameScheduler::FrameScheduler()
+    : _simulationRate(0.0f), _maxTicks(DEFAULT_MAX_TICKS), _accumulator(0.0), _tickCount(0), _tickTime(0.0f),
+      _interpolation(1.0f), _frameRateCap(0.0f), _spinTime(DEFAULT_SPIN_TIME), _frameStart(-1.0), _nextFrameTime(-1.0),
+      _pipelined(false), _renderPacket(0), _simulationThreadActive(false), _simulating(false), _simulationTicks(0), _simulationTime(0.0f)
+{
+    _packets[0] = _packets[1] = NULL;
+    resetHistograms();
+}
+
+FrameScheduler::~FrameScheduler()
+{
+    stopSimulation();
+    SAFE_DELETE(_packets[0]);
+    SAFE_DELETE(_packets[1]);
+}
+
+void FrameScheduler::setSimulationRate(float ticksPerSecond)
+{
+    GP_ASSERT(ticksPerSecond >= 0.0f);
+    _simulationRate = std::max(ticksPerSecond, 0.0f);
+    _accumulator = 0.0;
+}
+
+void FrameScheduler::setMaxTicks(unsigned int maxTicks)
+{
+    _maxTicks = std::max(maxTicks, 1u);
+}
+
+void FrameScheduler::setFrameRateCap(float framesPerSecond)
+{
+    GP_ASSERT(framesPerSecond >= 0.0f);
+    _frameRateCap = std::max(framesPerSecond, 0.0f);
+    _nextFrameTime = -1.0;
+}
+
+void FrameScheduler::setSpinTime(float time)
+{
+    _spinTime = std::max(time, 0.0f);
+}
+
+void FrameScheduler::setPipelined(bool pipelined)
+{
+    // Read at the start of each frame, so this can be called from the simulation thread.
+    _pipelined = pipelined;
+}
+
+unsigned int FrameScheduler::getHistogramCount(Histogram histogram, unsigned int bucket) const
+{
+    GP_ASSERT(histogram < HISTOGRAM_COUNT);
+    GP_ASSERT(bucket < BUCKET_COUNT);
+    return _histograms[histogram][bucket];
+}
+
+float FrameScheduler::getHistogramPercentile(Histogram histogram, float fraction) const
+{
+    GP_ASSERT(histogram < HISTOGRAM_COUNT);
+
+    const unsigned int* counts = _histograms[histogram];
+    unsigned long long total = 0;
+    for (unsigned int i = 0; i < BUCKET_COUNT; ++i)
+        total += counts[i];
+    if (total == 0)
+        return 0.0f;
+
+    unsigned long long target = (unsigned long long)ceil(total * MATH_CLAMP(fraction, 0.0f, 1.0f));
+    unsigned long long count = 0;
+    for (unsigned int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        count += counts[i];
+        if (count >= target && count > 0)
+            return (i + 1) * BUCKET_WIDTH;
+    }
+    return BUCKET_COUNT * BUCKET_WIDTH;
+}
+
+void FrameScheduler::resetHistograms()
+{
+    memset(_histograms, 0, sizeof(_histograms));
+}
+
+bool FrameScheduler::writeHistograms(const char* path) const
+{
+    GP_ASSERT(path);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_WARN("Failed to open frame time histogram file '%s' for writing.", path);
+        return false;
+    }
+
+    std::string text = "time,interval,work\n";
+    char row[64];
+    for (unsigned int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        sprintf(row, "%.1f,%u,%u\n", i * BUCKET_WIDTH, _histograms[INTERVAL][i], _histograms[WORK][i]);
+        text += row;
+    }
+    return stream->write(text.c_str(), 1, text.size()) == text.size();
+}
+
+void FrameScheduler::initialize()
+{
+    Properties* config = Game::getInstance()->getConfig()->getNamespace("timing", true);
+    if (config)
+    {
+        if (config->exists("simulationRate"))
+            setSimulationRate(config->getFloat("simulationRate"));
+        if (config->exists("maxTicks"))
+            setMaxTicks((unsigned int)std::max(config->getInt("maxTicks"), 1));
+        if (config->exists("frameRate"))
+            setFrameRateCap(config->getFloat("frameRate"));
+        if (config->exists("spinTime"))
+            setSpinTime(config->getFloat("spinTime"));
+        if (config->exists("pipelined"))
+            setPipelined(config->getBool("pipelined"));
+        const char* histogram = config->getString("histogram");
+        if (histogram)
+            _histogramPath = histogram;
+    }
+}
+
+void FrameScheduler::finalize()
+{
+    stopSimulation();
+
+    if (!_histogramPath.empty())
+        writeHistograms(_histogramPath.c_str());
+}
+
+void FrameScheduler::beginFrame()
+{
+    double now = Game::getAbsoluteTime();
+    if (_frameStart >= 0.0)
+        addToHistogram(INTERVAL, now - _frameStart);
+    _frameStart = now;
+}
+
+unsigned int FrameScheduler::advance(float elapsedTime)
+{
+    if (_simulationRate <= 0.0f)
+    {
+        // One update per frame with the time that passed.
+        _tickCount = 1;
+        _tickTime = elapsedTime;
+        _interpolation = 1.0f;
+        return _tickCount;
+    }
+
+    double tickTime = 1000.0 / _simulationRate;
+    _accumulator += std::max(elapsedTime, 0.0f);
+    _tickCount = (unsigned int)std::min(floor(_accumulator / tickTime), (double)_maxTicks);
+    _accumulator -= _tickCount * tickTime;
+    if (_accumulator >= tickTime)
+    {
+        // Drop the time the frame could not catch up on.
+        _accumulator = fmod(_accumulator, tickTime);
+    }
+    _tickTime = (float)tickTime;
+    _interpolation = (float)(_accumulator / tickTime);
+    return _tickCount;
+}
+
+void FrameScheduler::endFrame()
+{
+    double now = Game::getAbsoluteTime();
+    addToHistogram(WORK, now - _frameStart);
+
+    if (_frameRateCap <= 0.0f)
+        return;
+
+    double frameTime = 1000.0 / _frameRateCap;
+    if (_nextFrameTime < 0.0)
+        _nextFrameTime = _frameStart;
+    _nextFrameTime += frameTime;
+    if (now >= _nextFrameTime)
+    {
+        // Late; keep the next deadline from the current time rather than rushing to catch up.
+        if (now - _nextFrameTime > frameTime)
+            _nextFrameTime = now;
+        return;
+    }
+
+    // Sleep most of the wait, then spin to the deadline.
+    double sleepTime = _nextFrameTime - now - _spinTime;
+    if (sleepTime > 0.0)
+        std::this_thread::sleep_for(std::chrono::microseconds((long long)(sleepTime * 1000.0)));
+    while (Game::getAbsoluteTime() < _nextFrameTime)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void FrameScheduler::startSimulation(unsigned int tickCount, float elapsedTime)
+{
+    if (!_simulationThread)
+    {
+        if (!_packets[0])
+        {
+            _packets[0] = new FramePacket();
+            _packets[1] = new FramePacket();
+        }
+        _simulationMutex.reset(new std::mutex());
+        _simulationCondition.reset(new std::condition_variable());
+        _simulationThreadActive = true;
+        _simulationThread.reset(new std::thread(&simulationThreadProc, this));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(*_simulationMutex);
+        _simulationTicks = tickCount;
+        _simulationTime = elapsedTime;
+        _simulating = true;
+    }
+    _simulationCondition->notify_all();
+}
+
+void FrameScheduler::renderPacket()
+{
+    GP_ASSERT(_packets[_renderPacket]);
+    _packets[_renderPacket]->render();
+}
+
+void FrameScheduler::finishSimulation()
+{
+    GP_ASSERT(_simulationThread);
+    {
+        std::unique_lock<std::mutex> lock(*_simulationMutex);
+        _simulationCondition->wait(lock, [this] { return !_simulating; });
+    }
+
+    // The drawn packet lets go of what it held here, where the graphics context is, and
+    // the packet just recorded is drawn by the next frame.
+    _packets[_renderPacket]->reset();
+    _renderPacket = 1 - _renderPacket;
+}
+
+void FrameScheduler::discardPackets()
+{
+    if (_packets[0])
+    {
+        _packets[0]->reset();
+        _packets[1]->reset();
+    }
+}
+
+void FrameScheduler::stopSimulation()
+{
+    if (!_simulationThread)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(*_simulationMutex);
+        _simulationThreadActive = false;
+    }
+    _simulationCondition->notify_all();
+    _simulationThread->join();
+    _simulationThread.reset();
+    discardPackets();
+}
+
+void FrameScheduler::simulationThreadProc(FrameScheduler* scheduler)
+{
+    Game* game = Game::getInstance();
+    GP_ASSERT(game);
+
+    std::unique_lock<std::mutex> lock(*scheduler->_simulationMutex);
+    while (true)
+    {
+        scheduler->_simulationCondition->wait(lock, [scheduler] { return scheduler->_simulating || !scheduler->_simulationThreadActive; });
+        if (!scheduler->_simulating)
+            return;
+        lock.unlock();
+
+        // Record into the packet that is not being drawn.
+        FramePacket* packet = scheduler->_packets[1 - scheduler->_renderPacket];
+        game->simulate(scheduler->_simulationTicks, scheduler->_simulationTime);
+        packet->beginRecording();
+        game->renderFrame(scheduler->_simulationTime);
+        packet->endRecording();
+
+        lock.lock();
+        scheduler->_simulating = false;
+        scheduler->_simulationCondition->notify_all();
+    }
+}
+
+void FrameScheduler::addToHistogram(Histogram histogram, double time)
+{
+    unsigned int bucket = time > 0.0 ? (unsigned int)std::min(time / BUCKET_WIDTH, (double)(BUCKET_COUNT - 1)) : 0;
+    ++_histograms[histogram][bucket];
+}
+
+}
@@ -0,0 +1,319 @@
+#ifndef FRAMESCHEDULER_H_
+#define FRAMESCHEDULER_H_
+
+namespace egret
+{
+
+class FramePacket;
+
+/**
+ * Schedules the simulation and rendering of the game's frames.
+ *
+ * By default each frame runs one update with the time that passed, followed by one
+ * render, as before. With a simulation rate the game instead updates in fixed ticks
+ * that are decoupled from rendering: a frame runs as many ticks as the time that
+ * passed holds (possibly none), and the time left over is available as an
+ * interpolation factor, so rendering can blend between the last two simulated states.
+ *
+ * Frames can be capped to a frame rate. The scheduler sleeps until shortly before the
+ * next frame is due and then spins, since sleeping alone overshoots by the scheduling
+ * granularity of the operating system.
+ *
+ * Frames can be pipelined, so a frame draws the previous frame while it simulates: the
+ * game's ticks and render run on a simulation thread, which records the draws into a
+ * frame packet (see FramePacket), while the thread that owns the graphics context
+ * draws the packet the last frame recorded. A frame then takes about as long as the
+ * longer of the two instead of their sum, and is shown one frame later.
+ *
+ * The time between frames and the time each frame worked (before pacing) are counted
+ * in histograms, which can be written to a CSV file when the game exits.
+ *
+ * All of these can be set from the game config:
+ *
+ * @code
+ * timing
+ * {
+ *     simulationRate = 60          // ticks per second, 0 for one update per frame
+ *     maxTicks = 5                 // the most ticks a frame runs before it drops time
+ *     frameRate = 144              // the most frames per second, 0 for no cap
+ *     spinTime = 1.5               // milliseconds before a frame is due to stop sleeping
+ *     pipelined = true             // simulate the next frame while drawing the last one
+ *     histogram = frametimes.csv
+ * }
+ * @endcode
+ */
+class FrameScheduler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * The histograms of frame times.
+     */
+    enum Histogram
+    {
+        /** The time from the start of a frame to the start of the next one. */
+        INTERVAL,
+        /** The time a frame worked for, without the time it waited for its frame rate cap. */
+        WORK,
+        /** The number of histograms. */
+        HISTOGRAM_COUNT
+    };
+
+    /**
+     * The number of buckets of each histogram. The last bucket counts all longer frames.
+     */
+    static const unsigned int BUCKET_COUNT = 128;
+
+    /**
+     * The width of a histogram bucket, in milliseconds.
+     */
+    static const float BUCKET_WIDTH;
+
+    /**
+     * Sets the rate of the fixed simulation ticks.
+     *
+     * @param ticksPerSecond The ticks per second, or 0 to run one update per frame with
+     *      the time that passed.
+     */
+    void setSimulationRate(float ticksPerSecond);
+
+    /**
+     * Gets the rate of the fixed simulation ticks.
+     *
+     * @return The ticks per second, or 0 if each frame runs one update.
+     */
+    inline float getSimulationRate() const;
+
+    /**
+     * Sets the most ticks a frame runs. When a frame falls further behind, the time it
+     * cannot catch up on is dropped, so the game slows down instead of stalling.
+     *
+     * @param maxTicks The most ticks per frame (at least 1).
+     */
+    void setMaxTicks(unsigned int maxTicks);
+
+    /**
+     * Gets the most ticks a frame runs.
+     *
+     * @return The most ticks per frame.
+     */
+    inline unsigned int getMaxTicks() const;
+
+    /**
+     * Gets the number of ticks the current frame runs.
+     *
+     * @return The number of ticks of the current frame.
+     */
+    inline unsigned int getTickCount() const;
+
+    /**
+     * Gets the time each tick of the current frame advances the simulation by.
+     *
+     * @return The time of a tick in milliseconds.
+     */
+    inline float getTickTime() const;
+
+    /**
+     * Gets how far the current frame is between the last simulated tick and the next one.
+     *
+     * Render the state as previous * (1 - factor) + current * factor. This is always 1
+     * when there is no simulation rate.
+     *
+     * @return The interpolation factor, from 0 to 1.
+     */
+    inline float getInterpolation() const;
+
+    /**
+     * Caps the rate at which frames run.
+     *
+     * @param framesPerSecond The most frames per second, or 0 for no cap.
+     */
+    void setFrameRateCap(float framesPerSecond);
+
+    /**
+     * Gets the rate at which frames are capped.
+     *
+     * @return The most frames per second, or 0 if there is no cap.
+     */
+    inline float getFrameRateCap() const;
+
+    /**
+     * Sets how long before a frame is due the scheduler stops sleeping and spins.
+     *
+     * @param time The time in milliseconds.
+     */
+    void setSpinTime(float time);
+
+    /**
+     * Gets how long before a frame is due the scheduler stops sleeping and spins.
+     *
+     * @return The time in milliseconds.
+     */
+    inline float getSpinTime() const;
+
+    /**
+     * Sets whether frames are pipelined, simulating and recording a frame on a simulation
+     * thread while the last one is drawn. Frames are only pipelined when the game renders.
+     *
+     * @param pipelined True to pipeline frames, false to update and render each frame in turn.
+     */
+    void setPipelined(bool pipelined);
+
+    /**
+     * Checks whether frames are pipelined.
+     *
+     * @return True if frames are pipelined.
+     */
+    inline bool isPipelined() const;
+
+    /**
+     * Gets the number of frames counted in a bucket of a histogram.
+     *
+     * @param histogram The histogram.
+     * @param bucket The bucket, which counts frames from bucket * BUCKET_WIDTH milliseconds.
+     *
+     * @return The number of frames.
+     */
+    unsigned int getHistogramCount(Histogram histogram, unsigned int bucket) const;
+
+    /**
+     * Gets the frame time below which the given fraction of the frames in a histogram are.
+     *
+     * @param histogram The histogram.
+     * @param fraction The fraction of frames, such as 0.99.
+     *
+     * @return The upper edge of the bucket holding the fraction, in milliseconds, or 0
+     *      if no frames were counted.
+     */
+    float getHistogramPercentile(Histogram histogram, float fraction) const;
+
+    /**
+     * Clears the histograms.
+     */
+    void resetHistograms();
+
+    /**
+     * Writes the histograms to a CSV file, one row per bucket.
+     *
+     * @param path The path of the file to write.
+     *
+     * @return True if the file was written.
+     */
+    bool writeHistograms(const char* path) const;
+
+private:
+
+    /**
+     * Constructor.
+     */
+    FrameScheduler();
+
+    /**
+     * Destructor.
+     */
+    ~FrameScheduler();
+
+    /**
+     * Hidden copy constructor.
+     */
+    FrameScheduler(const FrameScheduler&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    FrameScheduler& operator=(const FrameScheduler&);
+
+    /**
+     * Reads the timing config.
+     */
+    void initialize();
+
+    /**
+     * Writes the histograms if the config names a file.
+     */
+    void finalize();
+
+    /**
+     * Counts the interval since the last frame. Called at the start of each frame.
+     */
+    void beginFrame();
+
+    /**
+     * Works out the ticks of a running frame.
+     *
+     * @param elapsedTime The game time that passed since the last running frame, in milliseconds.
+     *
+     * @return The number of ticks to run.
+     */
+    unsigned int advance(float elapsedTime);
+
+    /**
+     * Counts the work time of the frame and waits for the frame rate cap. Called at the
+     * end of each frame.
+     */
+    void endFrame();
+
+    /**
+     * Starts simulating and recording a frame on the simulation thread.
+     *
+     * @param tickCount The number of ticks to run.
+     * @param elapsedTime The game time that passed since the last running frame, in milliseconds.
+     */
+    void startSimulation(unsigned int tickCount, float elapsedTime);
+
+    /**
+     * Draws the packet the last pipelined frame recorded.
+     */
+    void renderPacket();
+
+    /**
+     * Waits for the simulation thread to finish the frame, then swaps the packets.
+     */
+    void finishSimulation();
+
+    /**
+     * Drops the recorded packets once frames are no longer pipelined, so pipelining again
+     * does not draw a stale frame.
+     */
+    void discardPackets();
+
+    /**
+     * Stops the simulation thread.
+     */
+    void stopSimulation();
+
+    static void simulationThreadProc(FrameScheduler* scheduler);
+
+    void addToHistogram(Histogram histogram, double time);
+
+    float _simulationRate;
+    unsigned int _maxTicks;
+    double _accumulator;
+    unsigned int _tickCount;
+    float _tickTime;
+    float _interpolation;
+    float _frameRateCap;
+    float _spinTime;
+    double _frameStart;
+    double _nextFrameTime;
+    unsigned int _histograms[HISTOGRAM_COUNT][BUCKET_COUNT];
+    std::string _histogramPath;
+    bool _pipelined;
+    FramePacket* _packets[2];
+    unsigned int _renderPacket;
+    std::unique_ptr<std::thread> _simulationThread;
+    std::unique_ptr<std::mutex> _simulationMutex;
+    std::unique_ptr<std::condition_variable> _simulationCondition;
+    bool _simulationThreadActive;
+    bool _simulating;
+    unsigned int _simulationTicks;
+    float _simulationTime;
+};
+
+}
+
+#include "FrameScheduler.inl"
+
+#endif
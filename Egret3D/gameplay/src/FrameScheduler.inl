@@ -0,0 +1,46 @@
+#include "FrameScheduler.h"
+
+namespace egret
+{
+
+inline float FrameScheduler::getSimulationRate() const
+{
+    return _simulationRate;
+}
+
+inline unsigned int FrameScheduler::getMaxTicks() const
+{
+    return _maxTicks;
+}
+
+inline unsigned int FrameScheduler::getTickCount() const
+{
+    return _tickCount;
+}
+
+inline float FrameScheduler::getTickTime() const
+{
+    return _tickTime;
+}
+
+inline float FrameScheduler::getInterpolation() const
+{
+    return _interpolation;
+}
+
+inline float FrameScheduler::getFrameRateCap() const
+{
+    return _frameRateCap;
+}
+
+inline float FrameScheduler::getSpinTime() const
+{
+    return _spinTime;
+}
+
+inline bool FrameScheduler::isPipelined() const
+{
+    return _pipelined;
+}
+
+}
@@ -4,10 +4,13 @@
 #include "RenderState.h"
 #include "FileSystem.h"
 #include "FrameBuffer.h"
+#include "ShaderPreprocessor.h"
+#include "PerformanceCounters.h"
 #include "SceneLoader.h"
 #include "ControlFactory.h"
 #include "Theme.h"
 #include "Form.h"
+#include "ImageLoader.h"
 
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
@@ -61,10 +64,10 @@ public:
 
 Game::Game()
     : _initialized(false), _state(UNINITIALIZED), _pausedCount(0),
-      _frameLastFPS(0), _frameCount(0), _frameRate(0), _width(0), _height(0),
+      _frameLastFPS(0), _frameCount(0), _frameRate(0), _fixedTimeStep(0.0f), _lastFrameTime(0.0), _renderingEnabled(true), _exitCode(0), _width(0), _height(0),
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL),
-      _physicsController(NULL), _aiController(NULL), _audioListener(NULL),
+      _physicsController(NULL), _aiController(NULL), _frameScheduler(NULL), _audioListener(NULL),
       _timeEvents(NULL), _scriptController(NULL), _scriptTarget(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
@@ -126,6 +129,12 @@ double Game::getGameTime()
     return Platform::getAbsoluteTime() - _pausedTimeTotal;
 }
 
+void Game::setFixedTimeStep(float timeStep)
+{
+    GP_ASSERT(timeStep >= 0.0f);
+    _fixedTimeStep = timeStep;
+}
+
 void Game::setVsync(bool enable)
 {
     Platform::setVsync(enable);
@@ -164,6 +173,9 @@ bool Game::startup()
     setViewport(Rectangle(0.0f, 0.0f, (float)_width, (float)_height));
     RenderState::initialize();
     FrameBuffer::initialize();
+    if (_renderingEnabled)
+        Effect::initialize();
+    PerformanceCounters::initialize();
 
     _animationController = new AnimationController();
     _animationController->initialize();
@@ -177,6 +189,9 @@ bool Game::startup()
     _aiController = new AIController();
     _aiController->initialize();
 
+    _frameScheduler = new FrameScheduler();
+    _frameScheduler->initialize();
+
     _scriptController = new ScriptController();
     _scriptController->initialize();
 
@@ -270,20 +285,32 @@ void Game::shutdown()
         SAFE_DELETE(_physicsController);
         _aiController->finalize();
         SAFE_DELETE(_aiController);
+
+        _frameScheduler->finalize();
+        SAFE_DELETE(_frameScheduler);
         
         ControlFactory::finalize();
 
         Theme::finalize();
 
+        ImageLoader::finalize();
+
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
 
         SAFE_DELETE(_audioListener);
 
+        PerformanceCounters::finalize();
         FrameBuffer::finalize();
         RenderState::finalize();
+        Effect::finalize();
+        ShaderPreprocessor::finalize();
+#ifdef GP_USE_PROFILER
+        Profiler::finalize();
+#endif
 
         SAFE_DELETE(_properties);
+        Properties::finalize();
 
 		_state = UNINITIALIZED;
     }
@@ -330,13 +357,15 @@ void Game::resume()
     }
 }
 
-void Game::exit()
+void Game::exit(int exitCode)
 {
+    _exitCode = exitCode;
+
     // Only perform a full/clean shutdown if GP_USE_MEM_LEAK_DETECTION is defined.
 	// Every modern OS is able to handle reclaiming process memory hundreds of times
 	// faster than it would take us to go through every pointer in the engine and
 	// release them nicely. For large games, shutdown can end up taking long time,
-    // so we'll just call ::exit(0) to force an instant shutdown.
+    // so we'll just call ::exit to force an instant shutdown.
 
 #ifdef GP_USE_MEM_LEAK_DETECTION
 
@@ -349,7 +378,7 @@ void Game::exit()
 #else
 
     // End the process immediately without a full shutdown
-    ::exit(0);
+    ::exit(exitCode);
 
 #endif
 }
@@ -357,6 +386,15 @@ void Game::exit()
 
 void Game::frame()
 {
+#ifdef GP_USE_PROFILER
+    // Collect the scopes of the last frame before this frame's scopes start.
+    Profiler::newFrame();
+#endif
+    GP_PROFILE_SCOPE("Game::frame");
+
+    GP_ASSERT(_frameScheduler);
+    _frameScheduler->beginFrame();
+
     if (!_initialized)
     {
         // Perform lazy first time initialization
@@ -367,10 +405,16 @@ void Game::frame()
 
         // Fire first game resize event
         Platform::resizeEventInternal(_width, _height);
+
+        // The first frame starts now, not when loading started.
+        _lastFrameTime = getGameTime();
     }
 
-	static double lastFrameTime = Game::getGameTime();
-	double frameTime = getGameTime();
+    // Create some of the effects queued by the shader manifest.
+    if (_renderingEnabled)
+        Effect::updatePrecompile();
+
+    double frameTime = getGameTime();
 
     // Fire time events to scheduled TimeListeners
     fireTimeEvents(frameTime);
@@ -383,40 +427,50 @@ void Game::frame()
         GP_ASSERT(_aiController);
 
         // Update Time.
-        float elapsedTime = (frameTime - lastFrameTime);
-        lastFrameTime = frameTime;
-
-        // Update the scheduled and running animations.
-        _animationController->update(elapsedTime);
-
-        // Update the physics.
-        _physicsController->update(elapsedTime);
-
-        // Update AI.
-        _aiController->update(elapsedTime);
-
-        // Update gamepads.
-        Gamepad::updateInternal(elapsedTime);
-
-        // Application Update.
-        update(elapsedTime);
-
-        // Update forms.
-        Form::updateInternal(elapsedTime);
+        float elapsedTime = (float)(frameTime - _lastFrameTime);
+        _lastFrameTime = frameTime;
+        if (_fixedTimeStep > 0.0f)
+            elapsedTime = _fixedTimeStep;
+
+        unsigned int tickCount = _frameScheduler->advance(elapsedTime);
+        bool pipelined = _frameScheduler->isPipelined() && _renderingEnabled;
+        if (pipelined)
+        {
+            // Simulate and record this frame on the simulation thread while the frame
+            // recorded last time is drawn here.
+            _frameScheduler->startSimulation(tickCount, elapsedTime);
+            {
+                GP_PROFILE_SCOPE("FramePacket::render");
+                _frameScheduler->renderPacket();
+            }
+            {
+                GP_PROFILE_SCOPE("FrameScheduler::finishSimulation");
+                _frameScheduler->finishSimulation();
+            }
 
-        // Run script update.
-        if (_scriptTarget)
-            _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, update), elapsedTime);
+            // The overlay creates its font on first use and must not be counted, so it is
+            // drawn here over the packet once the simulation thread is idle.
+            PerformanceCounters::drawOverlay();
+        }
+        else
+        {
+            _frameScheduler->discardPackets();
+            simulate(tickCount, elapsedTime);
+        }
 
         // Audio Rendering.
-        _audioController->update(elapsedTime);
+        {
+            GP_PROFILE_SCOPE("AudioController::update");
+            _audioController->update(elapsedTime);
+        }
 
-        // Graphics Rendering.
-        render(elapsedTime);
+        if (_renderingEnabled && !pipelined)
+        {
+            renderFrame(elapsedTime);
 
-        // Run script render.
-        if (_scriptTarget)
-            _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), elapsedTime);
+            // Draw the performance counters of the last frame.
+            PerformanceCounters::drawOverlay();
+        }
 
         // Update FPS.
         ++_frameCount;
@@ -426,6 +480,19 @@ void Game::frame()
             _frameCount = 0;
             _frameLastFPS = getGameTime();
         }
+
+        // Capture script event, batch streaming and form drawing statistics for this frame.
+        ScriptTarget::resetScriptEventCounters();
+        MeshBatch::resetStatistics();
+        Form::resetStatistics();
+        Font::resetStatistics();
+
+        // Add the glyphs rasterised during this frame to the font atlases.
+        if (_renderingEnabled)
+            Font::updateGlyphCaches();
+
+        // Capture the performance counters of this frame.
+        PerformanceCounters::newFrame(elapsedTime);
     }
 	else if (_state == Game::PAUSED)
     {
@@ -442,12 +509,100 @@ void Game::frame()
         if (_scriptTarget)
             _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, update), 0);
 
-        // Graphics Rendering.
-        render(0);
+        if (_renderingEnabled)
+        {
+            // Graphics Rendering.
+            render(0);
+
+            // Script render.
+            if (_scriptTarget)
+                _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), 0);
 
-        // Script render.
-        if (_scriptTarget)
-            _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), 0);
+            // Draw the performance counters of the last frame.
+            PerformanceCounters::drawOverlay();
+        }
+
+        // Capture batch streaming and form drawing statistics for this frame.
+        MeshBatch::resetStatistics();
+        Form::resetStatistics();
+        Font::resetStatistics();
+
+        // Add the glyphs rasterised during this frame to the font atlases.
+        if (_renderingEnabled)
+            Font::updateGlyphCaches();
+
+        // Capture the performance counters of this frame.
+        PerformanceCounters::newFrame(0);
+    }
+
+    // Wait for the frame rate cap, unless the game shut down during the frame.
+    if (_frameScheduler)
+    {
+        GP_PROFILE_SCOPE("FrameScheduler::endFrame");
+        _frameScheduler->endFrame();
+    }
+}
+
+void Game::simulate(unsigned int tickCount, float elapsedTime)
+{
+    // Run the simulation ticks that are due.
+    for (unsigned int i = 0; i < tickCount; ++i)
+        tick(_frameScheduler->getTickTime());
+
+    // Update forms.
+    {
+        GP_PROFILE_SCOPE("Form::updateInternal");
+        Form::updateInternal(elapsedTime);
+    }
+}
+
+void Game::renderFrame(float elapsedTime)
+{
+    // Graphics Rendering.
+    {
+        GP_PROFILE_SCOPE("Game::render");
+        render(elapsedTime);
+    }
+
+    // Run script render.
+    if (_scriptTarget)
+    {
+        GP_PROFILE_SCOPE("GameScriptTarget::render");
+        _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, render), elapsedTime);
+    }
+}
+
+void Game::tick(float elapsedTime)
+{
+    // Update the scheduled and running animations.
+    {
+        GP_PROFILE_SCOPE("AnimationController::update");
+        _animationController->update(elapsedTime);
+    }
+
+    // Update the physics.
+    _physicsController->update(elapsedTime);
+
+    // Update AI.
+    {
+        GP_PROFILE_SCOPE("AIController::update");
+        _aiController->update(elapsedTime);
+    }
+
+    // Update gamepads.
+    Gamepad::updateInternal(elapsedTime);
+
+    // Application Update.
+    {
+        GP_PROFILE_SCOPE("Game::update");
+        update(elapsedTime);
+    }
+
+    // Run script update.
+    if (_scriptTarget)
+    {
+        GP_PROFILE_SCOPE("GameScriptTarget::update");
+        _scriptTarget->fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(GameScriptTarget, update), elapsedTime);
     }
 }
 
@@ -482,11 +637,24 @@ void Game::updateOnce()
 void Game::setViewport(const Rectangle& viewport)
 {
     _viewport = viewport;
+    FramePacket* packet = FramePacket::getRecording();
+    if (packet)
+    {
+        packet->setViewport(viewport);
+        return;
+    }
     glViewport((GLuint)viewport.x, (GLuint)viewport.y, (GLuint)viewport.width, (GLuint)viewport.height);
 }
 
 void Game::clear(ClearFlags flags, const kmVec4& clearColor, float clearDepth, int clearStencil)
 {
+    FramePacket* packet = FramePacket::getRecording();
+    if (packet)
+    {
+        packet->clear(flags, clearColor, clearDepth, clearStencil);
+        return;
+    }
+
     GLbitfield bits = 0;
     if (flags & CLEAR_COLOR)
     {
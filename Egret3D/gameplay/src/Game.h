@@ -10,6 +10,7 @@
 #include "AnimationController.h"
 #include "PhysicsController.h"
 #include "AIController.h"
+#include "FrameScheduler.h"
 #include "AudioListener.h"
 #include "Rectangle.h"
 #include "kazmath/vec4.h"
@@ -149,14 +150,20 @@ public:
 
     /**
      * Exits the game.
+     *
+     * @param exitCode The status the process exits with.
      */
-    void exit();
+    void exit(int exitCode = 0);
 
     /**
      * Platform frame delegate.
      *
      * This is called every frame from the platform.
-     * This in turn calls back on the user implemented game methods: update() then render()
+     * This in turn calls back on the user implemented game methods: update() then render().
+     * With a simulation rate on the frame scheduler, update() runs once for each fixed
+     * tick that is due, which may be none or several times per frame. When the frame
+     * scheduler pipelines frames, update() and render() run on its simulation thread and
+     * render() records into a FramePacket that the next frame draws.
      */
     void frame();
 
@@ -167,6 +174,39 @@ public:
      */
     inline unsigned int getFrameRate() const;
 
+    /**
+     * Gets the frame scheduler that paces frames and runs fixed simulation ticks.
+     *
+     * @return The frame scheduler for this game.
+     */
+    inline FrameScheduler* getFrameScheduler() const;
+
+    /**
+     * Sets a fixed time step that each frame advances the game by, instead of the time
+     * that passed since the last frame. Use for deterministic runs such as benchmarks.
+     *
+     * @param timeStep The time step in milliseconds, or 0 to use the time that passed (the default).
+     */
+    void setFixedTimeStep(float timeStep);
+
+    /**
+     * Gets the fixed time step that each frame advances the game by.
+     *
+     * @return The time step in milliseconds, or 0 if frames use the time that passed.
+     */
+    inline float getFixedTimeStep() const;
+
+    /**
+     * Checks whether the game has a graphics context to render with.
+     *
+     * This is false when the platform runs headless with the null renderer, for
+     * simulation-only instances such as dedicated servers. The game's render method is
+     * then not called, and the game must not create textures, effects, meshes or fonts.
+     *
+     * @return True if the game renders frames.
+     */
+    inline bool isRenderingEnabled() const;
+
     /**
      * Gets the game window width.
      * 
@@ -632,8 +672,10 @@ protected:
     /**
      * Update callback for handling update routines.
      *
-     * Called just before render, once per frame when game is running.
-     * Ideal for non-render code and game logic such as input and animation.
+     * Called before render, once per simulation tick when game is running (see
+     * FrameScheduler). Ideal for non-render code and game logic such as input and animation.
+     * The forms are updated once per frame after all of the frame's ticks, so after both
+     * this and the script update, rather than between them.
      *
      * @param elapsedTime The elapsed game time.
      */
@@ -719,6 +761,31 @@ private:
      */
     void fireTimeEvents(double frameTime);
 
+    /**
+     * Runs the simulation ticks of a frame and then updates the forms, once, after the last
+     * tick's script update. Called on the simulation thread when frames are pipelined.
+     *
+     * @param tickCount The number of ticks to run.
+     * @param elapsedTime The game time that passed since the last running frame, in milliseconds.
+     */
+    void simulate(unsigned int tickCount, float elapsedTime);
+
+    /**
+     * Runs the game's render and the script render. Records into the frame packet when
+     * frames are pipelined.
+     *
+     * @param elapsedTime The game time that passed since the last running frame, in milliseconds.
+     */
+    void renderFrame(float elapsedTime);
+
+    /**
+     * Runs one simulation tick: the controllers, the gamepads, the game's update and the script
+     * update. The forms are not updated by a tick; see simulate.
+     *
+     * @param elapsedTime The time the tick advances by, in milliseconds.
+     */
+    void tick(float elapsedTime);
+
     /**
      * Loads the game configuration.
      */
@@ -749,6 +816,10 @@ private:
     double _frameLastFPS;                       // The last time the frame count was updated.
     unsigned int _frameCount;                   // The current frame count.
     unsigned int _frameRate;                    // The current frame rate.
+    float _fixedTimeStep;                       // The time each frame advances by, or 0 for the time that passed.
+    double _lastFrameTime;                      // The game time of the last running frame.
+    bool _renderingEnabled;                     // False when the platform has no graphics context.
+    int _exitCode;                              // The status the process exits with.
     unsigned int _width;                        // The game's display width.
     unsigned int _height;                       // The game's display height.
     Rectangle _viewport;                        // the games's current viewport.
@@ -760,6 +831,7 @@ private:
     AudioController* _audioController;          // Controls audio sources that are playing in the game.
     PhysicsController* _physicsController;      // Controls the simulation of a physics scene and entities.
     AIController* _aiController;                // Controls AI simulation.
+    FrameScheduler* _frameScheduler;            // Paces frames and schedules simulation ticks.
     AudioListener* _audioListener;              // The audio listener in 3D space.
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;            // Controls the scripting engine.
@@ -768,6 +840,7 @@ private:
     // Note: Do not add STL object member variables on the stack; this will cause false memory leaks to be reported.
 
     friend class ScreenDisplayer;
+    friend class FrameScheduler;
 };
 
 }
@@ -19,6 +19,16 @@ inline unsigned int Game::getFrameRate() const
     return _frameRate;
 }
 
+inline float Game::getFixedTimeStep() const
+{
+    return _fixedTimeStep;
+}
+
+inline bool Game::isRenderingEnabled() const
+{
+    return _renderingEnabled;
+}
+
 inline unsigned int Game::getWidth() const
 {
     return _width;
@@ -63,6 +73,11 @@ inline AIController* Game::getAIController() const
     return _aiController;
 }
 
+inline FrameScheduler* Game::getFrameScheduler() const
+{
+    return _frameScheduler;
+}
+
 template <class T>
 void Game::renderOnce(T* instance, void (T::*method)(void*), void* cookie)
 {
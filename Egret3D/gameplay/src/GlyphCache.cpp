@@ -0,0 +1,474 @@
+#include "Base.h"
+#include "GlyphCache.h"
+#include "FileSystem.h"
+
+#ifdef GP_USE_FREETYPE
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// Milliseconds the raster thread sleeps when there are no glyphs to rasterise.
+#define RASTER_THREAD_TIMEOUT 100
+
+// Empty pixels around every glyph so that filtering does not pick up its neighbours.
+#define GLYPH_CACHE_PADDING 1
+
+namespace egret
+{
+
+GlyphCache::GlyphCache()
+    : _library(NULL), _face(NULL), _rasterFace(NULL), _size(0), _baseline(0), _spaceAdvance(0), _texture(NULL),
+      _atlasSize(0), _dirtyTop(0), _dirtyBottom(0), _frame(0), _rasterThreadActive(true), _rasterWake(false)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+    if (_rasterThread.get())
+    {
+        _rasterThreadActive = false;
+        {
+            std::lock_guard<std::mutex> lock(*_rasterMutex);
+            _rasterWake = true;
+        }
+        _rasterCondition->notify_one();
+        _rasterThread->join();
+        _rasterThread.reset(NULL);
+    }
+
+    RasterGlyph raster;
+    while (_rasterResults.pop(&raster))
+    {
+        SAFE_DELETE_ARRAY(raster.bitmap);
+    }
+
+    if (_rasterFace)
+        FT_Done_Face(_rasterFace);
+    if (_face)
+        FT_Done_Face(_face);
+    if (_library)
+        FT_Done_FreeType(_library);
+    SAFE_RELEASE(_texture);
+}
+
+GlyphCache* GlyphCache::create(const char* path, unsigned int size, unsigned int atlasSize)
+{
+    GP_ASSERT(path);
+
+    if (size == 0 || size + GLYPH_CACHE_PADDING > atlasSize)
+    {
+        GP_WARN("Invalid glyph size %u for an atlas of size %u: %s.", size, atlasSize, path);
+        return NULL;
+    }
+
+    int length = 0;
+    char* data = FileSystem::readAll(path, &length);
+    if (data == NULL)
+    {
+        GP_WARN("Failed to read TrueType font: %s.", path);
+        return NULL;
+    }
+
+    GlyphCache* cache = new GlyphCache();
+    cache->_data.assign((unsigned char*)data, (unsigned char*)data + length);
+    SAFE_DELETE_ARRAY(data);
+
+    // FreeType faces must not be shared between threads, so the raster thread gets
+    // its own face of the font while the other one answers character map queries.
+    if (FT_Init_FreeType(&cache->_library) != 0 ||
+        FT_New_Memory_Face(cache->_library, &cache->_data[0], length, 0, &cache->_face) != 0 ||
+        FT_New_Memory_Face(cache->_library, &cache->_data[0], length, 0, &cache->_rasterFace) != 0)
+    {
+        GP_WARN("Failed to open TrueType font: %s.", path);
+        SAFE_DELETE(cache);
+        return NULL;
+    }
+
+    // Scale the font so that a line fits within the requested size.
+    FT_Face face = cache->_face;
+    unsigned int pixelSize = size;
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
+    int lineHeight = (int)((face->size->metrics.ascender - face->size->metrics.descender) >> 6);
+    if (lineHeight > (int)size)
+    {
+        pixelSize = std::max(size * size / lineHeight, 1u);
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
+    }
+    FT_Set_Pixel_Sizes(cache->_rasterFace, 0, pixelSize);
+
+    cache->_family = face->family_name ? face->family_name : "";
+    cache->_size = size;
+    cache->_baseline = (int)(face->size->metrics.ascender >> 6);
+    if (FT_Load_Char(face, ' ', FT_LOAD_DEFAULT) == 0)
+        cache->_spaceAdvance = (unsigned int)(face->glyph->advance.x >> 6);
+    else
+        cache->_spaceAdvance = size / 4;
+
+    // The atlas is redrawn as glyphs come and go, so it is not mipmapped.
+    cache->_atlasSize = atlasSize;
+    cache->_atlas.resize(atlasSize * atlasSize, 0);
+    cache->_texture = Texture::create(Texture::ALPHA, atlasSize, atlasSize, &cache->_atlas[0], false);
+    if (cache->_texture == NULL)
+    {
+        GP_WARN("Failed to create glyph atlas for TrueType font: %s.", path);
+        SAFE_DELETE(cache);
+        return NULL;
+    }
+    cache->resetSkyline();
+
+    cache->_rasterMutex.reset(new std::mutex());
+    cache->_rasterCondition.reset(new std::condition_variable());
+    cache->_rasterThread.reset(new std::thread(&rasterThreadProc, cache));
+
+    return cache;
+}
+
+const Font::Glyph* GlyphCache::findGlyph(unsigned int code)
+{
+    std::map<unsigned int, Entry>::iterator itr = _glyphs.find(code);
+    if (itr != _glyphs.end())
+    {
+        itr->second.lastUsed = _frame;
+        return &itr->second.glyph;
+    }
+
+    FT_UInt index = FT_Get_Char_Index(_face, code);
+    if (index == 0 || FT_Load_Glyph(_face, index, FT_LOAD_DEFAULT) != 0)
+        return NULL;
+
+    // Ask again once the raster thread has caught up.
+    if (!_rasterRequests.push(code))
+        return NULL;
+    {
+        std::lock_guard<std::mutex> lock(*_rasterMutex);
+        _rasterWake = true;
+    }
+    _rasterCondition->notify_one();
+
+    // Text is laid out with the metrics of the glyph right away, while its pixels
+    // are drawn once the raster thread has rendered them.
+    Entry& entry = _glyphs[code];
+    entry.glyph.code = code;
+    entry.glyph.width = 0;
+    entry.glyph.bearingX = (int)(_face->glyph->metrics.horiBearingX >> 6);
+    entry.glyph.advance = (unsigned int)(_face->glyph->advance.x >> 6);
+    memset(entry.glyph.uvs, 0, sizeof(entry.glyph.uvs));
+    entry.lastUsed = _frame;
+    return &entry.glyph;
+}
+
+void GlyphCache::touchGlyphs(void* cache, const unsigned int* codes, unsigned int count)
+{
+    GlyphCache* glyphCache = (GlyphCache*)cache;
+    GP_ASSERT(glyphCache);
+    GP_ASSERT(codes || count == 0);
+
+    // Glyphs evicted since the text was drawn are not requested again here: evicting
+    // them invalidated the text, which finds them again when it is laid out anew.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        std::map<unsigned int, Entry>::iterator itr = glyphCache->_glyphs.find(codes[i]);
+        if (itr != glyphCache->_glyphs.end())
+            itr->second.lastUsed = glyphCache->_frame;
+    }
+}
+
+bool GlyphCache::hasCharacter(unsigned int code) const
+{
+    return code == ' ' || FT_Get_Char_Index(_face, code) != 0;
+}
+
+bool GlyphCache::update()
+{
+    bool changed = false;
+    RasterGlyph raster;
+    while (_rasterResults.pop(&raster))
+    {
+        if (raster.loaded && raster.width > 0)
+        {
+            addGlyph(raster);
+            changed = true;
+        }
+        SAFE_DELETE_ARRAY(raster.bitmap);
+    }
+
+    // Upload the rows of the atlas that changed in a single update.
+    if (_dirtyBottom > _dirtyTop)
+    {
+        _texture->setData(&_atlas[_dirtyTop * _atlasSize], 0, _dirtyTop, _atlasSize, _dirtyBottom - _dirtyTop);
+        _dirtyTop = _dirtyBottom = 0;
+    }
+
+    // Glyphs drawn from here on belong to the next frame.
+    ++_frame;
+
+    return changed;
+}
+
+void GlyphCache::addGlyph(const RasterGlyph& raster)
+{
+    Entry& entry = _glyphs[raster.code];
+    entry.glyph.code = raster.code;
+    entry.glyph.width = raster.width;
+    entry.glyph.bearingX = raster.bearingX;
+    entry.glyph.advance = raster.advance;
+    entry.bitmap.assign(raster.bitmap, raster.bitmap + raster.width * _size);
+    entry.lastUsed = _frame;
+
+    int x, y;
+    if (pack(raster.width + GLYPH_CACHE_PADDING, _size + GLYPH_CACHE_PADDING, &x, &y))
+    {
+        placeGlyph(&entry, x, y);
+    }
+    else
+    {
+        // The new glyph counts as used in this frame, so it is kept when repacking.
+        repack();
+    }
+}
+
+void GlyphCache::repack()
+{
+    // Order the glyphs from the most to the least recently used.
+    std::vector<std::pair<unsigned int, unsigned int> > order;
+    order.reserve(_glyphs.size());
+    for (std::map<unsigned int, Entry>::const_iterator itr = _glyphs.begin(); itr != _glyphs.end(); ++itr)
+    {
+        order.push_back(std::make_pair(itr->second.lastUsed, itr->first));
+    }
+    std::sort(order.begin(), order.end(), std::greater<std::pair<unsigned int, unsigned int> >());
+
+    resetSkyline();
+    memset(&_atlas[0], 0, _atlas.size());
+    _dirtyTop = 0;
+    _dirtyBottom = (int)_atlasSize;
+
+    // Keep the glyphs used in this frame and fill up to half of the atlas with the most
+    // recently used others, leaving room for new glyphs before the next repack.
+    size_t halfArea = (size_t)_atlasSize * _atlasSize / 2;
+    size_t area = 0;
+    for (size_t i = 0, count = order.size(); i < count; ++i)
+    {
+        Entry& entry = _glyphs[order[i].second];
+        if (entry.glyph.width == 0)
+            continue;
+
+        int x, y;
+        int width = (int)entry.glyph.width + GLYPH_CACHE_PADDING;
+        int height = (int)_size + GLYPH_CACHE_PADDING;
+        if ((entry.lastUsed == _frame || area < halfArea) && pack(width, height, &x, &y))
+        {
+            placeGlyph(&entry, x, y);
+            area += (size_t)width * height;
+        }
+        else
+        {
+            _glyphs.erase(order[i].second);
+        }
+    }
+}
+
+void GlyphCache::placeGlyph(Entry* entry, int x, int y)
+{
+    GP_ASSERT(entry);
+
+    unsigned int width = entry->glyph.width;
+    for (unsigned int row = 0; row < _size; ++row)
+    {
+        memcpy(&_atlas[(y + row) * _atlasSize + x], &entry->bitmap[row * width], width);
+    }
+
+    if (_dirtyBottom <= _dirtyTop)
+    {
+        _dirtyTop = y;
+        _dirtyBottom = y + (int)_size;
+    }
+    else
+    {
+        _dirtyTop = std::min(_dirtyTop, y);
+        _dirtyBottom = std::max(_dirtyBottom, y + (int)_size);
+    }
+
+    entry->glyph.uvs[0] = (float)x / _atlasSize;
+    entry->glyph.uvs[1] = (float)y / _atlasSize;
+    entry->glyph.uvs[2] = (float)(x + width) / _atlasSize;
+    entry->glyph.uvs[3] = (float)(y + _size) / _atlasSize;
+}
+
+bool GlyphCache::pack(int width, int height, int* x, int* y)
+{
+    // Place the rectangle where it leaves the skyline lowest, preferring narrower segments.
+    int bestIndex = -1;
+    int bestBottom = (int)_atlasSize + 1;
+    int bestWidth = (int)_atlasSize + 1;
+    for (size_t i = 0, count = _skyline.size(); i < count; ++i)
+    {
+        int top = fitSkyline(i, width, height);
+        if (top >= 0 && (top + height < bestBottom || (top + height == bestBottom && _skyline[i].width < bestWidth)))
+        {
+            bestIndex = (int)i;
+            bestBottom = top + height;
+            bestWidth = _skyline[i].width;
+            *x = _skyline[i].x;
+            *y = top;
+        }
+    }
+    if (bestIndex < 0)
+        return false;
+
+    // Raise the skyline under the rectangle.
+    SkylineNode node = { *x, *y + height, width };
+    _skyline.insert(_skyline.begin() + bestIndex, node);
+    for (size_t i = bestIndex + 1; i < _skyline.size(); ++i)
+    {
+        SkylineNode& previous = _skyline[i - 1];
+        SkylineNode& current = _skyline[i];
+        int overlap = previous.x + previous.width - current.x;
+        if (overlap <= 0)
+            break;
+
+        current.x += overlap;
+        current.width -= overlap;
+        if (current.width > 0)
+            break;
+        _skyline.erase(_skyline.begin() + i);
+        --i;
+    }
+
+    // Merge segments of the same height.
+    for (size_t i = 0; i + 1 < _skyline.size(); ++i)
+    {
+        if (_skyline[i].y == _skyline[i + 1].y)
+        {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + i + 1);
+            --i;
+        }
+    }
+    return true;
+}
+
+int GlyphCache::fitSkyline(size_t index, int width, int height) const
+{
+    // Gets the top of a rectangle resting on the skyline from the given segment on,
+    // or -1 if it does not fit.
+    if (_skyline[index].x + width > (int)_atlasSize)
+        return -1;
+
+    int top = 0;
+    int remaining = width;
+    for (size_t i = index; remaining > 0; ++i)
+    {
+        if (i == _skyline.size())
+            return -1;
+        top = std::max(top, _skyline[i].y);
+        if (top + height > (int)_atlasSize)
+            return -1;
+        remaining -= _skyline[i].width;
+    }
+    return top;
+}
+
+void GlyphCache::resetSkyline()
+{
+    _skyline.clear();
+    SkylineNode node = { 0, 0, (int)_atlasSize };
+    _skyline.push_back(node);
+}
+
+void GlyphCache::rasterThreadProc(void* arg)
+{
+    GlyphCache* cache = (GlyphCache*)arg;
+    FT_Face face = cache->_rasterFace;
+    unsigned int size = cache->_size;
+
+    while (cache->_rasterThreadActive)
+    {
+        unsigned int code;
+        while (cache->_rasterThreadActive && cache->_rasterRequests.pop(&code))
+        {
+            RasterGlyph raster;
+            raster.code = code;
+            raster.loaded = false;
+            raster.width = 0;
+            raster.bearingX = 0;
+            raster.advance = 0;
+            raster.bitmap = NULL;
+
+            if (FT_Load_Char(face, code, FT_LOAD_RENDER) == 0)
+            {
+                // Draw the glyph into a cell a line high with its baseline where the font's is.
+                const FT_GlyphSlot slot = face->glyph;
+                const FT_Bitmap& bitmap = slot->bitmap;
+                raster.loaded = true;
+                raster.width = std::min((unsigned int)bitmap.width, cache->_atlasSize - GLYPH_CACHE_PADDING);
+                raster.bearingX = slot->bitmap_left;
+                raster.advance = (unsigned int)(slot->advance.x >> 6);
+                raster.bitmap = new unsigned char[std::max(raster.width * size, 1u)];
+                memset(raster.bitmap, 0, raster.width * size);
+
+                int top = cache->_baseline - slot->bitmap_top;
+                for (int row = 0; row < (int)bitmap.rows; ++row)
+                {
+                    int y = top + row;
+                    if (y >= 0 && y < (int)size)
+                    {
+                        memcpy(&raster.bitmap[y * raster.width], bitmap.buffer + row * bitmap.pitch, raster.width);
+                    }
+                }
+            }
+
+            while (!cache->_rasterResults.push(raster))
+            {
+                if (!cache->_rasterThreadActive)
+                {
+                    SAFE_DELETE_ARRAY(raster.bitmap);
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        // Sleep until the main thread requests more glyphs.
+        std::unique_lock<std::mutex> lock(*cache->_rasterMutex);
+        cache->_rasterCondition->wait_for(lock, std::chrono::milliseconds(RASTER_THREAD_TIMEOUT),
+            [cache] { return cache->_rasterWake || !cache->_rasterThreadActive; });
+        cache->_rasterWake = false;
+    }
+}
+
+}
+
+#else
+
+namespace egret
+{
+
+// Without FreeType no glyph cache is ever created, but fonts still refer to it.
+
+GlyphCache::~GlyphCache()
+{
+}
+
+const Font::Glyph* GlyphCache::findGlyph(unsigned int code)
+{
+    return NULL;
+}
+
+void GlyphCache::touchGlyphs(void* cache, const unsigned int* codes, unsigned int count)
+{
+}
+
+bool GlyphCache::hasCharacter(unsigned int code) const
+{
+    return false;
+}
+
+bool GlyphCache::update()
+{
+    return false;
+}
+
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef GLYPHCACHE_H_
+#define GLYPHCACHE_H_
+
+#include "Font.h"
+#include "LockFreeQueue.h"
+
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+
+namespace egret
+{
+
+/**
+ * Defines the glyph atlas of a font rasterised from a TrueType file while it is used.
+ *
+ * Glyphs are rasterised with FreeType on a worker thread the first time they are drawn
+ * and are drawn from the frame after they are ready. Ready glyphs are packed into the
+ * atlas with a skyline packer and the changed rows of the atlas are uploaded once per
+ * frame. When the atlas is full it is repacked with the most recently used glyphs and
+ * the rest are evicted, to be rasterised again if they are drawn later.
+ *
+ * Requires FreeType, enabled by defining GP_USE_FREETYPE.
+ *
+ * @script{ignore}
+ */
+class GlyphCache
+{
+    friend class Font;
+
+private:
+
+    /**
+     * A glyph in the atlas.
+     */
+    struct Entry
+    {
+        /** The glyph drawn by the font. */
+        Font::Glyph glyph;
+        /** The glyph cell, a line high, kept to repack the atlas; empty until rasterised. */
+        std::vector<unsigned char> bitmap;
+        /** The frame the glyph was last drawn in. */
+        unsigned int lastUsed;
+    };
+
+    /**
+     * A glyph rasterised by the worker thread.
+     */
+    struct RasterGlyph
+    {
+        unsigned int code;
+        bool loaded;
+        unsigned int width;
+        int bearingX;
+        unsigned int advance;
+        unsigned char* bitmap;
+    };
+
+    /**
+     * A segment of the skyline of the packed atlas.
+     */
+    struct SkylineNode
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    /**
+     * Constructor.
+     */
+    GlyphCache();
+
+    /**
+     * Hidden copy constructor.
+     */
+    GlyphCache(const GlyphCache&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    GlyphCache& operator=(const GlyphCache&);
+
+    /**
+     * Destructor.
+     */
+    ~GlyphCache();
+
+    /**
+     * Opens a TrueType font for rasterising glyphs.
+     *
+     * @param path The path to the font file.
+     * @param size The line height to rasterise glyphs at, in pixels.
+     * @param atlasSize The width and height of the atlas texture.
+     *
+     * @return The glyph cache, or NULL if the font could not be opened.
+     */
+    static GlyphCache* create(const char* path, unsigned int size, unsigned int atlasSize);
+
+    /**
+     * Gets the glyph of the given character code and marks it as used in this frame.
+     *
+     * Characters seen for the first time are queued for rasterisation. Their glyphs
+     * have the metrics of the character but no width until they are in the atlas.
+     *
+     * @return The glyph, or NULL if the font does not have the character.
+     */
+    const Font::Glyph* findGlyph(unsigned int code);
+
+    /**
+     * Marks glyphs drawn again from a cached text layout or a replayed sprite recording as
+     * used in this frame, so that repacking the atlas keeps them.
+     *
+     * Passed to the sprite batch of the font as its replay function.
+     *
+     * @param cache The glyph cache.
+     * @param codes The character codes of the glyphs.
+     * @param count The number of character codes.
+     */
+    static void touchGlyphs(void* cache, const unsigned int* codes, unsigned int count);
+
+    /**
+     * Determines whether the font has a glyph for the given character code.
+     */
+    bool hasCharacter(unsigned int code) const;
+
+    /**
+     * Adds the glyphs rasterised since the last frame to the atlas and uploads the changed rows.
+     *
+     * @return True if glyphs were added or moved, so text drawn earlier is out of date.
+     */
+    bool update();
+
+    /**
+     * Adds a rasterised glyph to the atlas, repacking the atlas if it is full.
+     */
+    void addGlyph(const RasterGlyph& raster);
+
+    /**
+     * Repacks the atlas with the most recently used glyphs and evicts the others.
+     */
+    void repack();
+
+    /**
+     * Copies a glyph cell into the atlas and sets the texture coordinates of the glyph.
+     */
+    void placeGlyph(Entry* entry, int x, int y);
+
+    bool pack(int width, int height, int* x, int* y);
+
+    int fitSkyline(size_t index, int width, int height) const;
+
+    void resetSkyline();
+
+    static void rasterThreadProc(void* arg);
+
+    std::vector<unsigned char> _data;
+    std::string _family;
+    FT_LibraryRec_* _library;
+    FT_FaceRec_* _face;
+    FT_FaceRec_* _rasterFace;
+    unsigned int _size;
+    int _baseline;
+    unsigned int _spaceAdvance;
+    Texture* _texture;
+    unsigned int _atlasSize;
+    std::vector<unsigned char> _atlas;
+    std::vector<SkylineNode> _skyline;
+    int _dirtyTop;
+    int _dirtyBottom;
+    std::map<unsigned int, Entry> _glyphs;
+    unsigned int _frame;
+    std::atomic<bool> _rasterThreadActive;
+    std::unique_ptr<std::thread> _rasterThread;
+    std::unique_ptr<std::mutex> _rasterMutex;
+    std::unique_ptr<std::condition_variable> _rasterCondition;
+    bool _rasterWake;
+    LockFreeQueue<unsigned int, 1024> _rasterRequests;
+    LockFreeQueue<RasterGlyph, 1024> _rasterResults;
+};
+
+}
+
+#endif
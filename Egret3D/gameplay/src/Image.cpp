@@ -1,34 +1,112 @@
 #include "Base.h"
 #include "FileSystem.h"
 #include "Image.h"
+#include "ImageLoader.h"
 
 namespace egret
 {
-// Callback for reading a png image using Stream
-static void readStream(png_structp png, png_bytep data, png_size_t length)
+
+/**
+ * A PNG file being decoded from memory.
+ */
+struct PNGReadBuffer
+{
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+};
+
+// Callback for reading a png image from memory
+static void readBuffer(png_structp png, png_bytep data, png_size_t length)
 {
-    Stream* stream = reinterpret_cast<Stream*>(png_get_io_ptr(png));
-    if (stream == NULL || stream->read(data, 1, length) != length)
+    PNGReadBuffer* buffer = reinterpret_cast<PNGReadBuffer*>(png_get_io_ptr(png));
+    if (buffer == NULL || buffer->size - buffer->offset < length)
     {
         png_error(png, "Error reading PNG.");
     }
+    memcpy(data, buffer->data + buffer->offset, length);
+    buffer->offset += length;
+}
+
+// Averages 2x2 blocks of pixels into the next mipmap level. The second row or column
+// of a block is clamped to the edge of odd sized images. The channel loop is unrolled
+// for the pixel size, which lets the compiler vectorise the rows.
+template <unsigned int BPP>
+static void downsample(const unsigned char* src, unsigned int width, unsigned int height,
+                       unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight)
+{
+    for (unsigned int y = 0; y < dstHeight; ++y)
+    {
+        const unsigned char* row0 = src + (2 * y) * width * BPP;
+        const unsigned char* row1 = src + std::min(2 * y + 1, height - 1) * width * BPP;
+        unsigned char* out = dst + y * dstWidth * BPP;
+        for (unsigned int x = 0; x < dstWidth; ++x)
+        {
+            unsigned int x0 = 2 * x * BPP;
+            unsigned int x1 = std::min(2 * x + 1, width - 1) * BPP;
+            for (unsigned int c = 0; c < BPP; ++c)
+            {
+                out[x * BPP + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
 }
 
 Image* Image::create(const char* path)
+{
+    // Images shared with the cache are copied, so that the caller can modify the pixels.
+    Image* image = createShared(path);
+    if (image && image->getRefCount() > 1)
+    {
+        Image* copy = image->clone();
+        SAFE_RELEASE(image);
+        image = copy;
+    }
+    return image;
+}
+
+Image* Image::createShared(const char* path)
 {
     GP_ASSERT(path);
 
-    // Open the file.
-    std::unique_ptr<Stream> stream(FileSystem::open(path));
-    if (stream.get() == NULL || !stream->canRead())
+    // Files queued with ImageLoader::load are decoded by the loader threads.
+    Image* image = NULL;
+    if (ImageLoader::take(path, &image))
+    {
+        return image;
+    }
+
+    // Read the whole file, which is needed for the content hash and is decoded from memory.
+    int size = 0;
+    unsigned char* data = reinterpret_cast<unsigned char*>(FileSystem::readAll(path, &size));
+    if (data == NULL)
     {
         GP_ERROR("Failed to open image file '%s'.", path);
         return NULL;
     }
 
+    // Files with the same contents share one decoded image.
+    unsigned long long hash = ImageLoader::hash(data, size);
+    image = ImageLoader::findCached(hash);
+    if (image == NULL)
+    {
+        image = decode(data, size, path);
+        if (image)
+        {
+            ImageLoader::addToCache(hash, image);
+        }
+    }
+    SAFE_DELETE_ARRAY(data);
+
+    return image;
+}
+
+Image* Image::decode(const unsigned char* data, size_t size, const char* path)
+{
+    GP_ASSERT(data);
+
     // Verify PNG signature.
-    unsigned char sig[8];
-    if (stream->read(sig, 1, 8) != 8 || png_sig_cmp(sig, 0, 8) != 0)
+    if (size < 8 || png_sig_cmp(const_cast<png_bytep>(data), 0, 8) != 0)
     {
         GP_ERROR("Failed to load file '%s'; not a valid PNG.", path);
         return NULL;
@@ -51,24 +129,32 @@ Image* Image::create(const char* path)
         return NULL;
     }
 
+    Image* image = new Image();
+    std::vector<png_bytep> rows;
+
     // Set up error handling (required without using custom error handlers above).
     if (setjmp(png_jmpbuf(png)))
     {
-        GP_ERROR("Failed to set up error handling for reading PNG file '%s'.", path);
+        GP_ERROR("Failed to decode PNG file '%s'.", path);
         png_destroy_read_struct(&png, &info, NULL);
+        SAFE_RELEASE(image);
         return NULL;
     }
 
-    // Initialize file io.
-    png_set_read_fn(png, stream.get(), readStream);
-
-    // Indicate that we already read the first 8 bytes (signature).
+    // Read from memory, past the signature.
+    PNGReadBuffer buffer = { data, size, 8 };
+    png_set_read_fn(png, &buffer, readBuffer);
     png_set_sig_bytes(png, 8);
+    png_read_info(png, info);
 
-    // Read the entire image into memory.
-    png_read_png(png, info, PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_PACKING | PNG_TRANSFORM_EXPAND | PNG_TRANSFORM_GRAY_TO_RGB, NULL);
+    // Convert to 8 bit RGB or RGBA.
+    png_set_strip_16(png);
+    png_set_packing(png);
+    png_set_expand(png);
+    png_set_gray_to_rgb(png);
+    png_set_interlace_handling(png);
+    png_read_update_info(png, info);
 
-    Image* image = new Image();
     image->_width = png_get_image_width(png, info);
     image->_height = png_get_image_height(png, info);
 
@@ -86,6 +172,7 @@ Image* Image::create(const char* path)
     default:
         GP_ERROR("Unsupported PNG color type (%d) for image file '%s'.", (int)colorType, path);
         png_destroy_read_struct(&png, &info, NULL);
+        SAFE_RELEASE(image);
         return NULL;
     }
 
@@ -94,12 +181,15 @@ Image* Image::create(const char* path)
     // Allocate image data.
     image->_data = new unsigned char[stride * image->_height];
 
-    // Read rows into image data.
-    png_bytepp rows = png_get_rows(png, info);
+    // Decode the rows straight into the image data, bottom row first, rather than
+    // through rows allocated by libpng.
+    rows.resize(image->_height);
     for (unsigned int i = 0; i < image->_height; ++i)
     {
-        memcpy(image->_data+(stride * (image->_height-1-i)), rows[i], stride);
+        rows[i] = image->_data + stride * (image->_height - 1 - i);
     }
+    png_read_image(png, &rows[0]);
+    png_read_end(png, NULL);
 
     // Clean up.
     png_destroy_read_struct(&png, &info, NULL);
@@ -144,6 +234,81 @@ Image::Image() : _data(NULL), _format(RGB), _width(0), _height(0)
 Image::~Image()
 {
     SAFE_DELETE_ARRAY(_data);
+    for (size_t i = 0, count = _mipmaps.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_mipmaps[i]);
+    }
+}
+
+unsigned char* Image::getMipmapData(unsigned int level) const
+{
+    GP_ASSERT(level <= _mipmaps.size());
+
+    return level == 0 ? _data : _mipmaps[level - 1];
+}
+
+void Image::generateMipmaps()
+{
+    if (!_mipmaps.empty())
+        return;
+
+    const unsigned char* src = _data;
+    unsigned int width = _width;
+    unsigned int height = _height;
+    while (width > 1 || height > 1)
+    {
+        unsigned int mipWidth = std::max(width / 2, 1u);
+        unsigned int mipHeight = std::max(height / 2, 1u);
+        unsigned char* mip;
+        if (_format == RGBA)
+        {
+            mip = new unsigned char[mipWidth * mipHeight * 4];
+            downsample<4>(src, width, height, mip, mipWidth, mipHeight);
+        }
+        else
+        {
+            mip = new unsigned char[mipWidth * mipHeight * 3];
+            downsample<3>(src, width, height, mip, mipWidth, mipHeight);
+        }
+        _mipmaps.push_back(mip);
+
+        src = mip;
+        width = mipWidth;
+        height = mipHeight;
+    }
+}
+
+Image* Image::clone() const
+{
+    Image* image = create(_width, _height, _format, _data);
+    size_t pixelSize = _format == RGBA ? 4 : 3;
+    unsigned int width = _width;
+    unsigned int height = _height;
+    for (size_t i = 0, count = _mipmaps.size(); i < count; ++i)
+    {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        size_t size = width * height * pixelSize;
+        unsigned char* mip = new unsigned char[size];
+        memcpy(mip, _mipmaps[i], size);
+        image->_mipmaps.push_back(mip);
+    }
+    return image;
+}
+
+size_t Image::getDataSize() const
+{
+    size_t pixelSize = _format == RGBA ? 4 : 3;
+    size_t size = 0;
+    unsigned int width = _width;
+    unsigned int height = _height;
+    for (unsigned int level = 0; level < getMipmapCount(); ++level)
+    {
+        size += width * height * pixelSize;
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    return size;
 }
 
 }
@@ -9,10 +9,16 @@ namespace egret
 /**
  * Defines an image buffer of RGB or RGBA color data.
  *
- * Currently only supports loading from .png image files.
+ * Currently only supports loading from .png image files. Images decoded from files are
+ * kept in the decoded image cache of the ImageLoader. Image::create always returns an
+ * image private to the caller (a copy, if the cached image is shared), so its pixels may
+ * be modified. Only createShared returns the cached image itself, which must not be.
  */
 class Image : public Ref
 {
+    friend class ImageLoader;
+    friend class Texture;
+
 public:
 
     /**
@@ -27,6 +33,10 @@ public:
     /**
      * Creates an image from the image file at the given path.
      *
+     * Takes the image decoded by a loader thread if the file was queued with
+     * ImageLoader::load, waiting for it if it has not been decoded yet. The image
+     * belongs to the caller; an image found in the decoded image cache is copied.
+     *
      * @param path The path to the image file.
      * @return The newly created image.
      * @script{create}
@@ -74,6 +84,31 @@ public:
      */
     inline unsigned int getWidth() const;
 
+    /**
+     * Gets the number of mipmap levels of the image, including the image itself.
+     *
+     * @return 1 until mipmaps are generated.
+     */
+    inline unsigned int getMipmapCount() const;
+
+    /**
+     * Gets the pixel data of a mipmap level of the image.
+     *
+     * @param level The mipmap level, where 0 is the image itself. Each level is half the
+     *        width and height of the one before, and at least one pixel.
+     *
+     * @return The pixel data of the level.
+     * @script{ignore}
+     */
+    unsigned char* getMipmapData(unsigned int level) const;
+
+    /**
+     * Generates the full mipmap chain of the image with a box filter.
+     *
+     * Does nothing if the mipmaps have already been generated.
+     */
+    void generateMipmaps();
+
 private:
 
     /**
@@ -91,10 +126,45 @@ private:
      */
     Image& operator=(const Image&);
 
+    /**
+     * Decodes a PNG file held in memory.
+     *
+     * Safe to call from loader threads.
+     *
+     * @param data The contents of the file.
+     * @param size The size of the file.
+     * @param path The path of the file, for error messages.
+     *
+     * @return The decoded image, or NULL if it could not be decoded.
+     */
+    static Image* decode(const unsigned char* data, size_t size, const char* path);
+
+    /**
+     * Creates an image from the image file at the given path, sharing it with the decoded image cache.
+     *
+     * The image may be returned to other callers as well, so it must not be modified.
+     *
+     * @param path The path to the image file.
+     *
+     * @return The image, or NULL if it could not be loaded.
+     */
+    static Image* createShared(const char* path);
+
+    /**
+     * Creates a copy of the image and its mipmaps.
+     */
+    Image* clone() const;
+
+    /**
+     * Gets the number of bytes the pixels of the image and its mipmaps take.
+     */
+    size_t getDataSize() const;
+
     unsigned char* _data;
     Format _format;
     unsigned int _width;
     unsigned int _height;
+    std::vector<unsigned char*> _mipmaps;
 };
 
 }
@@ -23,4 +23,9 @@ inline unsigned int Image::getWidth() const
     return _width;
 }
 
+inline unsigned int Image::getMipmapCount() const
+{
+    return (unsigned int)_mipmaps.size() + 1;
+}
+
 }
@@ -1,12 +1,13 @@
 #include "Base.h"
 #include "ImageControl.h"
+#include "TextureAtlas.h"
 
 namespace egret
 {
 
 ImageControl::ImageControl() :
     _srcRegion(Rectangle::empty()), _dstRegion(Rectangle::empty()), _batch(NULL),
-    _tw(0.0f), _th(0.0f), _uvs(Theme::UVs::full())
+    _imageRegion(Rectangle::empty()), _tw(0.0f), _th(0.0f), _uvs(Theme::UVs::full())
 {
 }
 
@@ -70,20 +71,40 @@ void ImageControl::setImage(const char* path)
     _batch = SpriteBatch::create(texture);
     _tw = 1.0f / texture->getWidth();
     _th = 1.0f / texture->getHeight();
+    _imageRegion.set(0, 0, texture->getWidth(), texture->getHeight());
+    if (const TextureAtlas::Region* region = TextureAtlas::findRegion(path))
+        _imageRegion = region->bounds;
     texture->release();
 
-    if (_autoSize != AUTO_SIZE_NONE)
-        setDirty(DIRTY_BOUNDS);
+    // Without a source region the whole image is drawn
+    if (_srcRegion.isEmpty())
+    {
+        _uvs.u1 = _imageRegion.x * _tw;
+        _uvs.u2 = (_imageRegion.x + _imageRegion.width) * _tw;
+        _uvs.v1 = 1.0f - (_imageRegion.y * _th);
+        _uvs.v2 = 1.0f - ((_imageRegion.y + _imageRegion.height) * _th);
+    }
+    else
+    {
+        setRegionSrc(_srcRegion);
+    }
+
+    // Retained sprites refer to the old batch, so the image must be drawn again either way
+    setDirty(_autoSize != AUTO_SIZE_NONE ? DIRTY_BOUNDS : DIRTY_DRAW);
 }
 
 void ImageControl::setRegionSrc(float x, float y, float width, float height)
 {
     _srcRegion.set(x, y, width, height);
 
+    // The source region is relative to the image, which may be in an atlas
+    x += _imageRegion.x;
+    y += _imageRegion.y;
     _uvs.u1 = x * _tw;
     _uvs.u2 = (x + width) * _tw;
     _uvs.v1 = 1.0f - (y * _th);
     _uvs.v2 = 1.0f - ((y + height) * _th);
+    setDirty(DIRTY_DRAW);
 }
 
 void ImageControl::setRegionSrc(const Rectangle& region)
@@ -99,6 +120,7 @@ const Rectangle& ImageControl::getRegionSrc() const
 void ImageControl::setRegionDst(float x, float y, float width, float height)
 {
     _dstRegion.set(x, y, width, height);
+    setDirty(DIRTY_DRAW);
 }
 
 void ImageControl::setRegionDst(const Rectangle& region)
@@ -144,12 +166,12 @@ void ImageControl::updateBounds()
     {
         if (_autoSize & AUTO_SIZE_WIDTH)
         {
-            setWidthInternal(_batch->getSampler()->getTexture()->getWidth());
+            setWidthInternal(_imageRegion.width);
         }
 
         if (_autoSize & AUTO_SIZE_HEIGHT)
         {
-            setHeightInternal(_batch->getSampler()->getTexture()->getWidth());
+            setHeightInternal(_imageRegion.height);
         }
     }
 
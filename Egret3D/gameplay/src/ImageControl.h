@@ -46,7 +46,8 @@ public:
     /**
      * Set the path of the image for this ImageControl to display.
      *
-     * @param path The path to the image.
+     * @param path The path to the image, or "sheet.atlas#name" for an image in a texture
+     *        atlas, in which case the source region is relative to the image.
      */
     void setImage(const char* path);
 
@@ -142,6 +143,9 @@ private:
     Rectangle _dstRegion;
     SpriteBatch* _batch;
 
+    // Region of the image on the texture, the whole texture unless the image is in an atlas.
+    Rectangle _imageRegion;
+
     // One over texture width and height, for use when calculating UVs from a new source region.
     float _tw;
     float _th;
@@ -0,0 +1,355 @@
+#include "Base.h"
+#include "ImageLoader.h"
+#include "FileSystem.h"
+#include "Game.h"
+
+// Default size of the decoded image cache, in kilobytes.
+#define IMAGE_CACHE_SIZE_DEFAULT 16384
+
+namespace egret
+{
+
+/**
+ * A file queued for decoding.
+ */
+struct ImageLoadJob
+{
+    bool generateMipmaps;
+    bool done;
+    Image* image;
+    unsigned long long hash;
+};
+
+/**
+ * An image in the decoded image cache.
+ */
+struct CachedImage
+{
+    unsigned long long hash;
+    Image* image;
+    size_t size;
+};
+
+// The queue and jobs are shared with the loader threads and guarded by the mutex.
+static std::mutex __loaderMutex;
+static std::condition_variable __loaderWork;
+static std::condition_variable __loaderDone;
+static std::vector<std::unique_ptr<std::thread> > __loaderThreads;
+static std::queue<std::string> __loaderQueue;
+static std::map<std::string, ImageLoadJob> __loaderJobs;
+static unsigned int __loaderPending = 0;
+static bool __loaderStopping = false;
+static unsigned int __loaderThreadCount = 0;
+static bool __loaderConfigured = false;
+
+// The cache is only used by the main thread. Most recently used images are first.
+static std::list<CachedImage> __imageCache;
+static std::map<unsigned long long, std::list<CachedImage>::iterator> __imageCacheIndex;
+static size_t __imageCacheUsed = 0;
+static size_t __imageCacheSize = 0;
+static unsigned int __imageCacheHits = 0;
+
+static void configure()
+{
+    if (__loaderConfigured)
+        return;
+    __loaderConfigured = true;
+
+    // Leave a core for the main thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    __loaderThreadCount = cores > 1 ? cores - 1 : 1;
+    __imageCacheSize = IMAGE_CACHE_SIZE_DEFAULT * 1024;
+
+    Game* game = Game::getInstance();
+    Properties* config = game && game->getConfig() ? game->getConfig()->getNamespace("graphics", true) : NULL;
+    if (config)
+    {
+        if (config->exists("imageLoaderThreads"))
+            __loaderThreadCount = (unsigned int)std::max(config->getInt("imageLoaderThreads"), 0);
+        if (config->exists("imageCacheSize"))
+            __imageCacheSize = (size_t)std::max(config->getInt("imageCacheSize"), 0) * 1024;
+    }
+}
+
+static void evictImages(size_t size)
+{
+    while (__imageCacheUsed > size)
+    {
+        CachedImage& cached = __imageCache.back();
+        __imageCacheUsed -= cached.size;
+        SAFE_RELEASE(cached.image);
+        __imageCacheIndex.erase(cached.hash);
+        __imageCache.pop_back();
+    }
+}
+
+ImageLoader::ImageLoader()
+{
+}
+
+void ImageLoader::load(const char* path, bool generateMipmaps)
+{
+    GP_ASSERT(path);
+
+    configure();
+
+    std::unique_lock<std::mutex> lock(__loaderMutex);
+    if (__loaderJobs.find(path) != __loaderJobs.end())
+        return;
+
+    ImageLoadJob& job = __loaderJobs[path];
+    job.generateMipmaps = generateMipmaps;
+    job.done = false;
+    job.image = NULL;
+    job.hash = 0;
+
+    if (__loaderThreadCount == 0)
+    {
+        // No threads, so decode now
+        lock.unlock();
+        decodeFile(path, generateMipmaps, &job.image, &job.hash);
+        job.done = true;
+        return;
+    }
+
+    ++__loaderPending;
+    __loaderQueue.push(path);
+    lock.unlock();
+
+    if (__loaderThreads.empty())
+        startThreads();
+    __loaderWork.notify_one();
+}
+
+void ImageLoader::finish()
+{
+    std::unique_lock<std::mutex> lock(__loaderMutex);
+    __loaderDone.wait(lock, []{ return __loaderPending == 0; });
+}
+
+void ImageLoader::setThreadCount(unsigned int count)
+{
+    configure();
+    if (count == __loaderThreadCount)
+        return;
+
+    finish();
+    stopThreads();
+    __loaderThreadCount = count;
+}
+
+unsigned int ImageLoader::getThreadCount()
+{
+    configure();
+    return __loaderThreadCount;
+}
+
+void ImageLoader::setCacheSize(size_t size)
+{
+    configure();
+    __imageCacheSize = size;
+    evictImages(size);
+}
+
+size_t ImageLoader::getCacheSize()
+{
+    configure();
+    return __imageCacheSize;
+}
+
+unsigned int ImageLoader::getCacheHits()
+{
+    return __imageCacheHits;
+}
+
+bool ImageLoader::take(const char* path, Image** image)
+{
+    GP_ASSERT(path && image);
+
+    std::unique_lock<std::mutex> lock(__loaderMutex);
+    std::map<std::string, ImageLoadJob>::iterator itr = __loaderJobs.find(path);
+    if (itr == __loaderJobs.end())
+        return false;
+
+    ImageLoadJob& job = itr->second;
+    __loaderDone.wait(lock, [&job]{ return job.done; });
+    Image* decoded = job.image;
+    unsigned long long hash = job.hash;
+    __loaderJobs.erase(itr);
+    lock.unlock();
+
+    if (decoded)
+    {
+        // Share the cached image of the same contents unless it lacks the mipmaps decoded here
+        Image* cached = findCached(hash, decoded->getMipmapCount());
+        if (cached)
+        {
+            SAFE_RELEASE(decoded);
+            decoded = cached;
+        }
+        else
+        {
+            addToCache(hash, decoded);
+        }
+    }
+    *image = decoded;
+    return true;
+}
+
+unsigned long long ImageLoader::hash(const unsigned char* data, size_t size)
+{
+    // 64 bit FNV-1a
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+Image* ImageLoader::findCached(unsigned long long hash, unsigned int mipmapCount)
+{
+    std::map<unsigned long long, std::list<CachedImage>::iterator>::iterator itr = __imageCacheIndex.find(hash);
+    if (itr == __imageCacheIndex.end() || itr->second->image->getMipmapCount() < mipmapCount)
+        return NULL;
+
+    __imageCache.splice(__imageCache.begin(), __imageCache, itr->second);
+    ++__imageCacheHits;
+
+    Image* image = itr->second->image;
+    image->addRef();
+    return image;
+}
+
+void ImageLoader::addToCache(unsigned long long hash, Image* image)
+{
+    GP_ASSERT(image);
+
+    configure();
+    size_t size = image->getDataSize();
+    if (size > __imageCacheSize)
+        return;
+
+    std::map<unsigned long long, std::list<CachedImage>::iterator>::iterator itr = __imageCacheIndex.find(hash);
+    if (itr != __imageCacheIndex.end())
+    {
+        __imageCacheUsed -= itr->second->size;
+        SAFE_RELEASE(itr->second->image);
+        __imageCache.erase(itr->second);
+        __imageCacheIndex.erase(itr);
+    }
+
+    CachedImage cached;
+    cached.hash = hash;
+    cached.image = image;
+    cached.size = size;
+    image->addRef();
+    __imageCache.push_front(cached);
+    __imageCacheIndex[hash] = __imageCache.begin();
+    __imageCacheUsed += size;
+    evictImages(__imageCacheSize);
+}
+
+void ImageLoader::finalize()
+{
+    // Files not started yet are dropped
+    {
+        std::lock_guard<std::mutex> lock(__loaderMutex);
+        while (!__loaderQueue.empty())
+        {
+            __loaderJobs.erase(__loaderQueue.front());
+            __loaderQueue.pop();
+            --__loaderPending;
+        }
+    }
+    finish();
+    stopThreads();
+
+    for (std::map<std::string, ImageLoadJob>::iterator itr = __loaderJobs.begin(); itr != __loaderJobs.end(); ++itr)
+    {
+        SAFE_RELEASE(itr->second.image);
+    }
+    __loaderJobs.clear();
+
+    evictImages(0);
+    __imageCacheHits = 0;
+    __loaderConfigured = false;
+}
+
+void ImageLoader::startThreads()
+{
+    for (unsigned int i = 0; i < __loaderThreadCount; ++i)
+    {
+        __loaderThreads.push_back(std::unique_ptr<std::thread>(new std::thread(&loaderThreadProc)));
+    }
+}
+
+void ImageLoader::stopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(__loaderMutex);
+        __loaderStopping = true;
+    }
+    __loaderWork.notify_all();
+    for (size_t i = 0, count = __loaderThreads.size(); i < count; ++i)
+    {
+        __loaderThreads[i]->join();
+    }
+    __loaderThreads.clear();
+    __loaderStopping = false;
+}
+
+void ImageLoader::decodeFile(const std::string& path, bool generateMipmaps, Image** image, unsigned long long* hash)
+{
+    GP_PROFILE_SCOPE("ImageLoader::decodeFile");
+    *image = NULL;
+    *hash = 0;
+
+    int size = 0;
+    unsigned char* data = reinterpret_cast<unsigned char*>(FileSystem::readAll(path.c_str(), &size));
+    if (data == NULL)
+        return;
+
+    *hash = ImageLoader::hash(data, size);
+    *image = Image::decode(data, size, path.c_str());
+    if (*image && generateMipmaps)
+    {
+        (*image)->generateMipmaps();
+    }
+    SAFE_DELETE_ARRAY(data);
+}
+
+void ImageLoader::loaderThreadProc()
+{
+    for (;;)
+    {
+        std::string path;
+        bool generateMipmaps;
+        {
+            std::unique_lock<std::mutex> lock(__loaderMutex);
+            __loaderWork.wait(lock, []{ return __loaderStopping || !__loaderQueue.empty(); });
+            if (__loaderQueue.empty())
+                return;
+            path = __loaderQueue.front();
+            __loaderQueue.pop();
+            generateMipmaps = __loaderJobs[path].generateMipmaps;
+        }
+
+        Image* image;
+        unsigned long long hash;
+        decodeFile(path, generateMipmaps, &image, &hash);
+
+        {
+            std::lock_guard<std::mutex> lock(__loaderMutex);
+            ImageLoadJob& job = __loaderJobs[path];
+            job.image = image;
+            job.hash = hash;
+            job.done = true;
+            --__loaderPending;
+        }
+        __loaderDone.notify_all();
+    }
+}
+
+}
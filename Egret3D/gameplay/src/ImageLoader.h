@@ -0,0 +1,136 @@
+#ifndef IMAGELOADER_H_
+#define IMAGELOADER_H_
+
+#include "Image.h"
+
+namespace egret
+{
+
+/**
+ * Decodes image files on worker threads and caches decoded images.
+ *
+ * Loading a level typically creates many textures one after another, each of which
+ * reads and decodes its file on the main thread. Queueing the files with load() first
+ * decodes them in parallel on the loader threads; Image::create, and so Texture::create,
+ * then takes the decoded image, waiting only for images that are not done yet.
+ *
+ * Decoded images are kept in a cache keyed by a hash of the file contents, so loading
+ * the same file again, or another file with the same contents, does not decode it again.
+ * The cache keeps the most recently used images up to its size; images still referenced
+ * elsewhere stay alive after they are evicted.
+ *
+ * The number of threads and the cache size default to the 'imageLoaderThreads' and
+ * 'imageCacheSize' (in kilobytes) properties of the 'graphics' config namespace.
+ *
+ * @script{ignore}
+ */
+class ImageLoader
+{
+    friend class Image;
+    friend class Game;
+
+public:
+
+    /**
+     * Queues an image file to be decoded on a loader thread.
+     *
+     * Does nothing if the file is already queued.
+     *
+     * @param path The path to the PNG file.
+     * @param generateMipmaps True to also generate the mipmaps of the image on the loader thread.
+     */
+    static void load(const char* path, bool generateMipmaps = false);
+
+    /**
+     * Waits until all queued files have been decoded.
+     */
+    static void finish();
+
+    /**
+     * Sets the number of loader threads.
+     *
+     * Waits for the queued files to be decoded first. With no threads, files are decoded
+     * by load() on the calling thread.
+     *
+     * @param count The number of loader threads.
+     */
+    static void setThreadCount(unsigned int count);
+
+    /**
+     * Gets the number of loader threads.
+     */
+    static unsigned int getThreadCount();
+
+    /**
+     * Sets the size of the decoded image cache, evicting images if it is smaller.
+     *
+     * @param size The size of the cache, in bytes; 0 disables the cache.
+     */
+    static void setCacheSize(size_t size);
+
+    /**
+     * Gets the size of the decoded image cache, in bytes.
+     */
+    static size_t getCacheSize();
+
+    /**
+     * Gets the number of images found in the decoded image cache instead of being decoded.
+     */
+    static unsigned int getCacheHits();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ImageLoader();
+
+    /**
+     * Takes the image decoded for a queued file, waiting for it if necessary.
+     *
+     * @param path The path of the file.
+     * @param image Set to the image, or NULL if it could not be decoded.
+     *
+     * @return True if the file was queued.
+     */
+    static bool take(const char* path, Image** image);
+
+    /**
+     * Computes the hash of file contents the cache is keyed by.
+     */
+    static unsigned long long hash(const unsigned char* data, size_t size);
+
+    /**
+     * Finds the decoded image of file contents in the cache.
+     *
+     * Only counts a cache hit if the image is returned.
+     *
+     * @param hash The hash of the file contents.
+     * @param mipmapCount The number of mipmap levels the image must have at least.
+     *
+     * @return The image, with a reference added for the caller, or NULL.
+     */
+    static Image* findCached(unsigned long long hash, unsigned int mipmapCount = 0);
+
+    /**
+     * Adds a decoded image to the cache.
+     */
+    static void addToCache(unsigned long long hash, Image* image);
+
+    /**
+     * Stops the loader threads and empties the cache.
+     */
+    static void finalize();
+
+    static void startThreads();
+
+    static void stopThreads();
+
+    static void decodeFile(const std::string& path, bool generateMipmaps, Image** image, unsigned long long* hash);
+
+    static void loaderThreadProc();
+};
+
+}
+
+#endif
@@ -120,6 +120,7 @@ const kmVec2& JoystickControl::getOuterRegionSize(bool* isWidthPercentage, bool*
 void JoystickControl::setRelative(bool relative)
 {
     _relative = relative;
+    setDirty(DIRTY_DRAW);
 }
 
 bool JoystickControl::isRelative() const
@@ -339,6 +340,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
                 }
 
 				_displacement = { dx, dy };
+                setDirty(DIRTY_DRAW);
 
                 // If the displacement is greater than the radius, then cap the displacement to the
                 // radius.
@@ -381,6 +383,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
                 float dy = -(y - ((_relative) ? _screenRegionPixels.y - _bounds.y : 0.0f) - _screenRegionPixels.height * 0.5f);
 
 				_displacement = { dx, dy };
+                setDirty(DIRTY_DRAW);
 
                 kmVec2 value = vec2Zero;
                 if ((fabs(_displacement.x) > _radiusPixels) || (fabs(_displacement.y) > _radiusPixels))
@@ -419,6 +422,7 @@ bool JoystickControl::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned i
 
                 // Reset displacement and direction vectors.
 				_displacement = { 0.0f, 0.0f };
+                setDirty(DIRTY_DRAW);
                 kmVec2 value =_displacement;
                 if ( !kmVec2AreEqual(&value, &_value ))
                 {
@@ -6,6 +6,10 @@ namespace egret
 
 Label::Label() : _text(""), _font(NULL)
 {
+    _measurement.font = NULL;
+    _measurement.fontSize = 0;
+    _measurement.width = 0;
+    _measurement.height = 0;
 	_textColor = vec4Zero;
 }
 
@@ -67,8 +71,7 @@ void Label::setText(const char* text)
     if ((text == NULL && _text.length() > 0) || strcmp(text, _text.c_str()) != 0)
     {
         _text = text ? text : "";
-        if (_autoSize != AUTO_SIZE_NONE)
-            setDirty(DIRTY_BOUNDS);
+        setDirty(_autoSize != AUTO_SIZE_NONE ? DIRTY_BOUNDS : DIRTY_DRAW);
     }
 }
 
@@ -103,7 +106,7 @@ void Label::updateBounds()
         // This is a trade-off for functionality vs performance, but changing the size of UI controls on hover/focus/etc
         // is a pretty bad practice so we'll prioritize performance here.
         unsigned int w, h;
-        _font->measureText(_text.c_str(), getFontSize(NORMAL), &w, &h);
+        measureText(_font, getFontSize(NORMAL), &w, &h);
         if (_autoSize & AUTO_SIZE_WIDTH)
         {
             setWidthInternal(w + getBorder(NORMAL).left + getBorder(NORMAL).right + getPadding().left + getPadding().right);
@@ -115,6 +118,22 @@ void Label::updateBounds()
     }
 }
 
+void Label::measureText(Font* font, unsigned int fontSize, unsigned int* width, unsigned int* height)
+{
+    GP_ASSERT(font && width && height);
+
+    // Layout passes run whenever the bounds of a control are dirty, which mostly leaves the text as it was
+    if (font != _measurement.font || fontSize != _measurement.fontSize || _text != _measurement.text)
+    {
+        font->measureText(_text.c_str(), fontSize, &_measurement.width, &_measurement.height);
+        _measurement.text = _text;
+        _measurement.font = font;
+        _measurement.fontSize = fontSize;
+    }
+    *width = _measurement.width;
+    *height = _measurement.height;
+}
+
 void Label::updateAbsoluteBounds(const kmVec2& offset)
 {
     Control::updateAbsoluteBounds(offset);
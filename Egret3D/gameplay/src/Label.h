@@ -142,10 +142,29 @@ protected:
 
 private:
 
+    /**
+     * The size of the text measured for auto sizing, and the arguments it was measured with.
+     */
+    struct TextMeasurement
+    {
+        std::string text;
+        Font* font;
+        unsigned int fontSize;
+        unsigned int width;
+        unsigned int height;
+    };
+
     /**
      * Constructor.
      */
     Label(const Label& copy);
+
+    /**
+     * Measures the text in the given font, reusing the last measurement if nothing changed since.
+     */
+    void measureText(Font* font, unsigned int fontSize, unsigned int* width, unsigned int* height);
+
+    TextMeasurement _measurement;
 };
 
 }
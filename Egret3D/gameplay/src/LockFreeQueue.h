@@ -0,0 +1,154 @@
+#ifndef LOCKFREEQUEUE_H_
+#define LOCKFREEQUEUE_H_
+
+namespace egret
+{
+
+/**
+ * Defines a fixed capacity, single-producer single-consumer queue.
+ *
+ * Exactly one thread may push items and exactly one (other) thread may pop them;
+ * neither side ever blocks or takes a lock. Items can also be produced and consumed
+ * in place (see beginWrite/endWrite and front/popFront), which avoids copying large
+ * items such as decoded audio chunks.
+ *
+ * The capacity must be a power of two.
+ *
+ * @script{ignore}
+ */
+template <typename T, unsigned int CAPACITY>
+class LockFreeQueue
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "LockFreeQueue capacity must be a power of two.");
+
+public:
+
+    /**
+     * Constructor.
+     */
+    LockFreeQueue() : _head(0), _tail(0)
+    {
+    }
+
+    /**
+     * Pushes a copy of the given item (producer only).
+     *
+     * @param item The item to push.
+     * @return True if the item was pushed, false if the queue is full.
+     */
+    bool push(const T& item)
+    {
+        T* slot = beginWrite();
+        if (!slot)
+            return false;
+        *slot = item;
+        endWrite();
+        return true;
+    }
+
+    /**
+     * Pops the oldest item (consumer only).
+     *
+     * @param item Populated with the popped item.
+     * @return True if an item was popped, false if the queue is empty.
+     */
+    bool pop(T* item)
+    {
+        T* slot = front();
+        if (!slot)
+            return false;
+        *item = *slot;
+        popFront();
+        return true;
+    }
+
+    /**
+     * Gets the next free slot to write an item into (producer only).
+     *
+     * The item becomes visible to the consumer once endWrite is called.
+     *
+     * @return The free slot, or NULL if the queue is full.
+     */
+    T* beginWrite()
+    {
+        unsigned int tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) >= CAPACITY)
+            return NULL;
+        return &_items[tail & (CAPACITY - 1)];
+    }
+
+    /**
+     * Publishes the slot returned by the last call to beginWrite (producer only).
+     */
+    void endWrite()
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Gets the oldest item without removing it (consumer only).
+     *
+     * @return The oldest item, or NULL if the queue is empty.
+     */
+    T* front()
+    {
+        unsigned int head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return NULL;
+        return &_items[head & (CAPACITY - 1)];
+    }
+
+    /**
+     * Removes the item returned by the last call to front (consumer only).
+     */
+    void popFront()
+    {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Gets the number of items currently in the queue.
+     *
+     * The result is only a snapshot when called while the other thread is active.
+     *
+     * @return The number of items in the queue.
+     */
+    unsigned int size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Determines whether the queue is empty.
+     *
+     * @return True if the queue is empty.
+     */
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Gets the maximum number of items the queue can hold.
+     *
+     * @return The queue capacity.
+     */
+    unsigned int capacity() const
+    {
+        return CAPACITY;
+    }
+
+private:
+
+    LockFreeQueue(const LockFreeQueue& copy);
+
+    LockFreeQueue& operator=(const LockFreeQueue&);
+
+    T _items[CAPACITY];
+    std::atomic<unsigned int> _head;
+    std::atomic<unsigned int> _tail;
+};
+
+}
+
+#endif
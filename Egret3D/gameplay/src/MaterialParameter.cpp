@@ -446,7 +446,7 @@ void MaterialParameter::setSamplerArray(const Texture::Sampler** values, unsigne
     _type = MaterialParameter::SAMPLER_ARRAY;
 }
 
-void MaterialParameter::bind(Effect* effect)
+bool MaterialParameter::updateUniform(Effect* effect)
 {
     GP_ASSERT(effect);
 
@@ -464,9 +464,16 @@ void MaterialParameter::bind(Effect* effect)
                 GP_WARN("Material parameter for uniform '%s' not found in effect: '%s'.", _name.c_str(), effect->getId());
                 _loggerDirtyBits |= UNIFORM_NOT_FOUND;
             }
-            return;
+            return false;
         }
     }
+    return true;
+}
+
+void MaterialParameter::bind(Effect* effect)
+{
+    if (!updateUniform(effect))
+        return;
 
     switch (_type)
     {
@@ -516,6 +523,55 @@ void MaterialParameter::bind(Effect* effect)
     }
 }
 
+void MaterialParameter::capture(Effect* effect, FramePacket* packet)
+{
+    GP_ASSERT(packet);
+
+    if (!updateUniform(effect))
+        return;
+
+    // The same values bind() sets, copied so the packet does not see later changes.
+    switch (_type)
+    {
+    case MaterialParameter::FLOAT:
+        packet->setValue(_uniform, _value.floatValue);
+        break;
+    case MaterialParameter::FLOAT_ARRAY:
+        packet->setValue(_uniform, _value.floatPtrValue, _count);
+        break;
+    case MaterialParameter::INT:
+        packet->setValue(_uniform, _value.intValue);
+        break;
+    case MaterialParameter::INT_ARRAY:
+        packet->setValue(_uniform, _value.intPtrValue, _count);
+        break;
+    case MaterialParameter::VECTOR2:
+        packet->setValue(_uniform, reinterpret_cast<kmVec2*>(_value.floatPtrValue), _count);
+        break;
+    case MaterialParameter::VECTOR3:
+        packet->setValue(_uniform, reinterpret_cast<kmVec3*>(_value.floatPtrValue), _count);
+        break;
+    case MaterialParameter::VECTOR4:
+        packet->setValue(_uniform, reinterpret_cast<kmVec4*>(_value.floatPtrValue), _count);
+        break;
+    case MaterialParameter::MATRIX:
+        packet->setValue(_uniform, reinterpret_cast<kmMat4*>(_value.floatPtrValue), _count);
+        break;
+    case MaterialParameter::SAMPLER:
+        packet->setValue(_uniform, _value.samplerValue);
+        break;
+    case MaterialParameter::SAMPLER_ARRAY:
+        packet->setValue(_uniform, _value.samplerArrayValue, _count);
+        break;
+    case MaterialParameter::METHOD:
+        if (_value.method)
+            _value.method->capture(packet);
+        break;
+    default:
+        break;
+    }
+}
+
 void MaterialParameter::bindValue(Node* node, const char* binding)
 {
     GP_ASSERT(binding);
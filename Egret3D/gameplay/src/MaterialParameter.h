@@ -8,6 +8,7 @@
 #include "kazmath/mat4.h"
 #include "Texture.h"
 #include "Effect.h"
+#include "FramePacket.h"
 
 namespace egret
 {
@@ -374,6 +375,8 @@ private:
 
         virtual void setValue(Effect* effect) = 0;
 
+        virtual void capture(FramePacket* packet) = 0;
+
     protected:
 
         /**
@@ -405,6 +408,7 @@ private:
     public:
         MethodValueBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod);
         void setValue(Effect* effect);
+        void capture(FramePacket* packet);
     private:
         ClassType* _instance;
         ValueMethod _valueMethod;
@@ -422,6 +426,7 @@ private:
     public:
         MethodArrayBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod, CountMethod countMethod);
         void setValue(Effect* effect);
+        void capture(FramePacket* packet);
     private:
         ClassType* _instance;
         ValueMethod _valueMethod;
@@ -430,8 +435,12 @@ private:
 
     void clearValue();
 
+    bool updateUniform(Effect* effect);
+
     void bind(Effect* effect);
 
+    void capture(Effect* effect, FramePacket* packet);
+
     void applyAnimationValue(AnimationValue* value, float blendWeight, int components);
 
     void cloneInto(MaterialParameter* materialParameter) const;
@@ -515,6 +524,12 @@ void MaterialParameter::MethodValueBinding<ClassType, ParameterType>::setValue(E
     effect->setValue(_parameter->_uniform, (_instance->*_valueMethod)());
 }
 
+template <class ClassType, class ParameterType>
+void MaterialParameter::MethodValueBinding<ClassType, ParameterType>::capture(FramePacket* packet)
+{
+    packet->setValue(_parameter->_uniform, (_instance->*_valueMethod)());
+}
+
 template <class ClassType, class ParameterType>
 MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::MethodArrayBinding(MaterialParameter* param, ClassType* instance, ValueMethod valueMethod, CountMethod countMethod) :
     MethodBinding(param), _instance(instance), _valueMethod(valueMethod), _countMethod(countMethod)
@@ -527,6 +542,12 @@ void MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::setValue(E
     effect->setValue(_parameter->_uniform, (_instance->*_valueMethod)(), (_instance->*_countMethod)());
 }
 
+template <class ClassType, class ParameterType>
+void MaterialParameter::MethodArrayBinding<ClassType, ParameterType>::capture(FramePacket* packet)
+{
+    packet->setValue(_parameter->_uniform, (_instance->*_valueMethod)(), (_instance->*_countMethod)());
+}
+
 }
 
 #endif
@@ -1,13 +1,113 @@
 #include "Base.h"
 #include "MeshBatch.h"
+#include "PerformanceCounters.h"
 #include "Material.h"
+#include "FramePacket.h"
+
+// The number of batches worth of data held by the streaming vertex and index buffers.
+#define MESHBATCH_STREAMING_BATCHES 4
 
 namespace egret
 {
 
+unsigned int MeshBatch::_bytesStreamed = 0;
+unsigned int MeshBatch::_flushCount = 0;
+unsigned int MeshBatch::_bytesStreamedLastFrame = 0;
+unsigned int MeshBatch::_flushCountLastFrame = 0;
+
+static bool isIndex32Supported()
+{
+#ifdef OPENGL_ES
+    static int supported = -1;
+    if (supported < 0)
+    {
+        const char* extString = (const char*)glGetString(GL_EXTENSIONS);
+        supported = (extString && strstr(extString, "GL_OES_element_index_uint") != 0) ? 1 : 0;
+    }
+    return supported == 1;
+#else
+    return true;
+#endif
+}
+
+template <class T>
+static T* addIndices(T* dst, const unsigned short* indices, unsigned int indexCount, unsigned int vertexCount, bool connectStrips)
+{
+    if (vertexCount == 0 && sizeof(T) == sizeof(unsigned short))
+    {
+        // Simply copy values directly into the start of the index array.
+        memcpy(dst, indices, indexCount * sizeof(unsigned short));
+        return dst + indexCount;
+    }
+
+    if (connectStrips)
+    {
+        // Create a degenerate triangle to connect separate triangle strips
+        // by duplicating the previous and next vertices.
+        dst[0] = dst[-1];
+        dst[1] = (T)vertexCount;
+        dst += 2;
+    }
+
+    // Loop through all indices and insert them, with their values offset by
+    // 'vertexCount' so that they are relative to the first newly inserted vertex.
+    for (unsigned int i = 0; i < indexCount; ++i)
+    {
+        dst[i] = (T)(indices[i] + vertexCount);
+    }
+    return dst + indexCount;
+}
+
+template <class T>
+static T* addQuadIndices(T* dst, unsigned int quadCount, unsigned int vertexCount, bool strip)
+{
+    for (unsigned int i = 0; i < quadCount; ++i)
+    {
+        T base = (T)(vertexCount + i * 4);
+        if (strip)
+        {
+            if (base > 0)
+            {
+                // Connect to the previous strip with a degenerate triangle.
+                dst[0] = dst[-1];
+                dst[1] = base;
+                dst += 2;
+            }
+            dst[0] = base;
+            dst[1] = base + 1;
+            dst[2] = base + 2;
+            dst[3] = base + 3;
+            dst += 4;
+        }
+        else
+        {
+            dst[0] = base;
+            dst[1] = base + 1;
+            dst[2] = base + 2;
+            dst[3] = base + 2;
+            dst[4] = base + 1;
+            dst[5] = base + 3;
+            dst += 6;
+        }
+    }
+    return dst;
+}
+
+template <class T>
+static void rebaseIndices(T* dst, const T* src, unsigned int indexCount, unsigned int baseVertex)
+{
+    for (unsigned int i = 0; i < indexCount; ++i)
+    {
+        dst[i] = (T)(src[i] + baseVertex);
+    }
+}
+
 MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, Material* material, bool indexed, unsigned int initialCapacity, unsigned int growSize)
     : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(material), _indexed(indexed), _capacity(0), _growSize(growSize),
-    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _started(false)
+    _vertexCapacity(0), _indexCapacity(0), _vertexCount(0), _indexCount(0), _indexFormat(Mesh::INDEX16), _indexSize(sizeof(unsigned short)),
+    _vertices(NULL), _verticesPtr(NULL), _indices(NULL), _indicesPtr(NULL), _vertexBuffer(NULL), _indexBuffer(0),
+    _vertexBufferCapacity(0), _indexBufferCapacity(0), _vertexBufferOffset(0), _indexBufferOffset(0), _drawVertexOffset(0), _drawIndexOffset(0),
+    _uploaded(false), _started(false)
 {
     resize(initialCapacity);
 }
@@ -15,6 +115,12 @@ MeshBatch::MeshBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primi
 MeshBatch::~MeshBatch()
 {
     SAFE_RELEASE(_material);
+    SAFE_RELEASE(_vertexBuffer);
+    if (_indexBuffer)
+    {
+        glDeleteBuffers(1, &_indexBuffer);
+        _indexBuffer = 0;
+    }
     SAFE_DELETE_ARRAY(_vertices);
     SAFE_DELETE_ARRAY(_indices);
 }
@@ -53,13 +159,8 @@ void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount,
         newIndexCount += 2; // need an extra 2 indices for connecting strips with degenerate triangles
     
     // Do we need to grow the batch?
-    while (newVertexCount > _vertexCapacity || (_indexed && newIndexCount > _indexCapacity))
-    {
-        if (_growSize == 0)
-            return; // growing disabled, just clip batch
-        if (!resize(_capacity + _growSize))
-            return; // failed to grow
-    }
+    if (!grow(newVertexCount, newIndexCount))
+        return; // growing disabled or failed, just clip batch
     
     // Copy vertex data.
     GP_ASSERT(_verticesPtr);
@@ -72,35 +173,83 @@ void MeshBatch::add(const void* vertices, size_t size, unsigned int vertexCount,
         GP_ASSERT(indices);
         GP_ASSERT(_indicesPtr);
 
-        if (_vertexCount == 0)
-        {
-            // Simply copy values directly into the start of the index array.
-            memcpy(_indicesPtr, indices, indexCount * sizeof(unsigned short));
-        }
+        bool connectStrips = _primitiveType == Mesh::TRIANGLE_STRIP && _vertexCount > 0;
+        if (_indexFormat == Mesh::INDEX32)
+            _indicesPtr = (unsigned char*)addIndices((unsigned int*)_indicesPtr, indices, indexCount, _vertexCount, connectStrips);
         else
-        {
-            if (_primitiveType == Mesh::TRIANGLE_STRIP)
-            {
-                // Create a degenerate triangle to connect separate triangle strips
-                // by duplicating the previous and next vertices.
-                _indicesPtr[0] = *(_indicesPtr-1);
-                _indicesPtr[1] = _vertexCount;
-                _indicesPtr += 2;
-            }
-            
-            // Loop through all indices and insert them, with their values offset by
-            // 'vertexCount' so that they are relative to the first newly inserted vertex.
-            for (unsigned int i = 0; i < indexCount; ++i)
-            {
-                _indicesPtr[i] = indices[i] + _vertexCount;
-            }
-        }
-        _indicesPtr += indexCount;
+            _indicesPtr = (unsigned char*)addIndices((unsigned short*)_indicesPtr, indices, indexCount, _vertexCount, connectStrips);
         _indexCount = newIndexCount;
     }
     
     _verticesPtr += vBytes;
     _vertexCount = newVertexCount;
+    _uploaded = false;
+}
+
+void* MeshBatch::addQuads(unsigned int quadCount)
+{
+    GP_ASSERT(_indexed);
+    GP_ASSERT(_primitiveType == Mesh::TRIANGLE_STRIP || _primitiveType == Mesh::TRIANGLES);
+
+    // Strips need an extra 2 indices per quad for connecting them with degenerate triangles
+    bool strip = _primitiveType == Mesh::TRIANGLE_STRIP;
+    unsigned int newVertexCount = _vertexCount + quadCount * 4;
+    unsigned int newIndexCount = _indexCount + quadCount * 6;
+    if (strip && _vertexCount == 0)
+        newIndexCount -= 2;
+
+    if (quadCount == 0 || !grow(newVertexCount, newIndexCount))
+        return NULL;
+
+    GP_ASSERT(_indicesPtr);
+    if (_indexFormat == Mesh::INDEX32)
+        _indicesPtr = (unsigned char*)addQuadIndices((unsigned int*)_indicesPtr, quadCount, _vertexCount, strip);
+    else
+        _indicesPtr = (unsigned char*)addQuadIndices((unsigned short*)_indicesPtr, quadCount, _vertexCount, strip);
+
+    // The caller fills in the vertices
+    void* vertices = _verticesPtr;
+    _verticesPtr += quadCount * 4 * _vertexFormat.getVertexSize();
+    _vertexCount = newVertexCount;
+    _indexCount = newIndexCount;
+    _uploaded = false;
+
+    return vertices;
+}
+
+bool MeshBatch::grow(unsigned int vertexCount, unsigned int indexCount)
+{
+    // Find the smallest capacity that fits, then resize once.
+    unsigned int capacity = _capacity;
+    for (;;)
+    {
+        unsigned int vertexCapacity = getVertexCapacity(capacity);
+        if (vertexCapacity >= vertexCount && (!_indexed || vertexCapacity >= indexCount))
+            break;
+        if (_growSize == 0 || vertexCapacity == 0)
+            return false;
+        capacity += _growSize;
+    }
+    return resize(capacity);
+}
+
+unsigned int MeshBatch::getVertexCapacity(unsigned int capacity) const
+{
+    switch (_primitiveType)
+    {
+    case Mesh::LINES:
+        return capacity * 2;
+    case Mesh::LINE_STRIP:
+        return capacity + 1;
+    case Mesh::POINTS:
+        return capacity;
+    case Mesh::TRIANGLES:
+        return capacity * 3;
+    case Mesh::TRIANGLE_STRIP:
+        return capacity + 2;
+    default:
+        return 0;
+    }
 }
 
 void MeshBatch::updateVertexAttributeBinding()
@@ -116,7 +265,7 @@ void MeshBatch::updateVertexAttributeBinding()
         {
             Pass* p = t->getPassByIndex(j);
             GP_ASSERT(p);
-            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexFormat, _vertices, p->getEffect());
+            VertexAttributeBinding* b = VertexAttributeBinding::create(_vertexBuffer, p->getEffect());
             p->setVertexAttributeBinding(b);
             SAFE_RELEASE(b);
         }
@@ -146,27 +295,13 @@ bool MeshBatch::resize(unsigned int capacity)
 
     // Store old batch data.
     unsigned char* oldVertices = _vertices;
-    unsigned short* oldIndices = _indices;
+    unsigned char* oldIndices = _indices;
+    Mesh::IndexFormat oldIndexFormat = _indexFormat;
+    unsigned int oldIndexSize = _indexSize;
 
-    unsigned int vertexCapacity = 0;
-    switch (_primitiveType)
+    unsigned int vertexCapacity = getVertexCapacity(capacity);
+    if (vertexCapacity == 0)
     {
-    case Mesh::LINES:
-        vertexCapacity = capacity * 2;
-        break;
-    case Mesh::LINE_STRIP:
-        vertexCapacity = capacity + 1;
-        break;
-    case Mesh::POINTS:
-        vertexCapacity = capacity;
-        break;
-    case Mesh::TRIANGLES:
-        vertexCapacity = capacity * 3;
-        break;
-    case Mesh::TRIANGLE_STRIP:
-        vertexCapacity = capacity + 2;
-        break;
-    default:
         GP_ERROR("Unsupported primitive type for mesh batch (%d).", _primitiveType);
         return false;
     }
@@ -175,11 +310,19 @@ bool MeshBatch::resize(unsigned int capacity)
     // (we only know how many indices will be stored). Assume the worst case
     // for now, which is the same number of vertices as indices.
     unsigned int indexCapacity = vertexCapacity;
-    if (_indexed && indexCapacity > USHRT_MAX)
+
+    // Switch to 32-bit indices once vertices can no longer be addressed with 16 bits.
+    Mesh::IndexFormat indexFormat = Mesh::INDEX16;
+    if (_indexed && vertexCapacity > USHRT_MAX + 1)
     {
-        GP_ERROR("Index capacity is greater than the maximum unsigned short value (%d > %d).", indexCapacity, USHRT_MAX);
-        return false;
+        if (!isIndex32Supported())
+        {
+            GP_ERROR("Vertex capacity is greater than 16-bit indices can address and 32-bit indices are not supported (%d > %d).", vertexCapacity, USHRT_MAX + 1);
+            return false;
+        }
+        indexFormat = Mesh::INDEX32;
     }
+    unsigned int indexSize = indexFormat == Mesh::INDEX32 ? sizeof(unsigned int) : sizeof(unsigned short);
 
     // Allocate new data and reset pointers.
     unsigned int voffset = _verticesPtr - _vertices;
@@ -191,11 +334,11 @@ bool MeshBatch::resize(unsigned int capacity)
 
     if (_indexed)
     {
-        unsigned int ioffset = _indicesPtr - _indices;
-        _indices = new unsigned short[indexCapacity];
+        unsigned int ioffset = (_indicesPtr - _indices) / oldIndexSize;
+        _indices = new unsigned char[indexCapacity * indexSize];
         if (ioffset >= indexCapacity)
             ioffset = indexCapacity - 1;
-        _indicesPtr = _indices + ioffset;
+        _indicesPtr = _indices + ioffset * indexSize;
     }
 
     // Copy old data back in
@@ -203,20 +346,121 @@ bool MeshBatch::resize(unsigned int capacity)
         memcpy(_vertices, oldVertices, std::min(_vertexCapacity, vertexCapacity) * _vertexFormat.getVertexSize());
     SAFE_DELETE_ARRAY(oldVertices);
     if (oldIndices)
-        memcpy(_indices, oldIndices, std::min(_indexCapacity, indexCapacity) * sizeof(unsigned short));
+    {
+        unsigned int count = std::min(_indexCapacity, indexCapacity);
+        if (oldIndexFormat == indexFormat)
+        {
+            memcpy(_indices, oldIndices, count * indexSize);
+        }
+        else
+        {
+            // Only growing can change the format, so widen 16-bit indices to 32 bits
+            GP_ASSERT(indexFormat == Mesh::INDEX32);
+            const unsigned short* src = (const unsigned short*)oldIndices;
+            unsigned int* dst = (unsigned int*)_indices;
+            for (unsigned int i = 0; i < count; ++i)
+                dst[i] = src[i];
+        }
+    }
     SAFE_DELETE_ARRAY(oldIndices);
 
     // Assign new capacities
     _capacity = capacity;
     _vertexCapacity = vertexCapacity;
     _indexCapacity = indexCapacity;
+    _indexFormat = indexFormat;
+    _indexSize = indexSize;
+    _uploaded = false;
 
-    // Update our vertex attribute bindings now that our client array pointers have changed
-    updateVertexAttributeBinding();
+    // Recreate the streaming buffers for the new capacity when the batch is next uploaded,
+    // since pipelined frames fill batches on a thread without the graphics context.
+    _vertexBufferCapacity = 0;
 
     return true;
 }
 
+void MeshBatch::createStreamingBuffers()
+{
+    // Room for several batches, but never more vertices than 16-bit indices can address
+    _vertexBufferCapacity = _vertexCapacity * MESHBATCH_STREAMING_BATCHES;
+    if (_indexed && _indexFormat == Mesh::INDEX16)
+        _vertexBufferCapacity = std::min(_vertexBufferCapacity, (unsigned int)USHRT_MAX + 1);
+    _indexBufferCapacity = _indexed ? _indexCapacity * MESHBATCH_STREAMING_BATCHES : 0;
+    _vertexBufferOffset = 0;
+    _indexBufferOffset = 0;
+
+    SAFE_RELEASE(_vertexBuffer);
+    _vertexBuffer = Mesh::createMesh(_vertexFormat, _vertexBufferCapacity, true);
+
+    if (_indexed)
+    {
+        if (!_indexBuffer)
+            GL_ASSERT( glGenBuffers(1, &_indexBuffer) );
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+        GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexBufferCapacity * _indexSize, NULL, GL_STREAM_DRAW) );
+    }
+}
+
+void MeshBatch::upload()
+{
+    if (_vertexBufferCapacity == 0)
+    {
+        createStreamingBuffers();
+        updateVertexAttributeBinding();
+    }
+    GP_ASSERT(_vertexBuffer);
+
+    unsigned int vertexSize = _vertexFormat.getVertexSize();
+
+    // Wrap around when the batch does not fit behind the previous one. Orphaning the buffers
+    // lets the driver hand out new storage instead of waiting for draws still reading them.
+    bool wrap = _vertexBufferOffset + _vertexCount > _vertexBufferCapacity ||
+        (_indexed && _indexBufferOffset + _indexCount > _indexBufferCapacity);
+    if (wrap)
+    {
+        _vertexBufferOffset = 0;
+        _indexBufferOffset = 0;
+    }
+
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer->getVertexBuffer()) );
+    if (wrap)
+    {
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, _vertexBufferCapacity * vertexSize, NULL, GL_STREAM_DRAW) );
+    }
+    GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, _vertexBufferOffset * vertexSize, _vertexCount * vertexSize, _vertices) );
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+    _bytesStreamed += _vertexCount * vertexSize;
+
+    if (_indexed)
+    {
+        // Indices are relative to the start of the batch, so offset them to where its vertices were written
+        const void* indices = _indices;
+        if (_vertexBufferOffset > 0)
+        {
+            _rebasedIndices.resize(_indexCount * _indexSize);
+            if (_indexFormat == Mesh::INDEX32)
+                rebaseIndices((unsigned int*)&_rebasedIndices[0], (const unsigned int*)_indices, _indexCount, _vertexBufferOffset);
+            else
+                rebaseIndices((unsigned short*)&_rebasedIndices[0], (const unsigned short*)_indices, _indexCount, _vertexBufferOffset);
+            indices = &_rebasedIndices[0];
+        }
+
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+        if (wrap)
+        {
+            GL_ASSERT( glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indexBufferCapacity * _indexSize, NULL, GL_STREAM_DRAW) );
+        }
+        GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, _indexBufferOffset * _indexSize, _indexCount * _indexSize, indices) );
+        _bytesStreamed += _indexCount * _indexSize;
+    }
+
+    _drawVertexOffset = _vertexBufferOffset;
+    _drawIndexOffset = _indexBufferOffset;
+    _vertexBufferOffset += _vertexCount;
+    _indexBufferOffset += _indexCount;
+    _uploaded = true;
+}
+
 void MeshBatch::add(const float* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount)
 {
     add(vertices, sizeof(float), vertexCount, indices, indexCount);
@@ -228,6 +472,7 @@ void MeshBatch::start()
     _indexCount = 0;
     _verticesPtr = _vertices;
     _indicesPtr = _indices;
+    _uploaded = false;
     _started = true;
 }
 
@@ -246,14 +491,24 @@ void MeshBatch::draw()
     if (_vertexCount == 0 || (_indexed && _indexCount == 0))
         return; // nothing to draw
 
-    // Not using VBOs, so unbind the element array buffer.
-    // ARRAY_BUFFER will be unbound automatically during pass->bind().
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-
     GP_ASSERT(_material);
     if (_indexed)
         GP_ASSERT(_indices);
 
+    // Pipelined frames record a copy of the batch, drawn while the next frame refills it.
+    FramePacket* packet = FramePacket::getRecording();
+    if (packet)
+    {
+        packet->drawBatch(_material, _vertexFormat, _primitiveType, _vertices, _vertexCount,
+                          _indexed ? _indices : NULL, _indexCount, _indexFormat);
+        ++_flushCount;
+        return;
+    }
+
+    // Stream the batch to the graphics device once, even if it is drawn several times.
+    if (!_uploaded)
+        upload();
+
     // Bind the material.
     Technique* technique = _material->getTechnique();
     GP_ASSERT(technique);
@@ -266,16 +521,37 @@ void MeshBatch::draw()
 
         if (_indexed)
         {
-            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, (GLvoid*)_indices) );
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+            GL_ASSERT( glDrawElements(_primitiveType, _indexCount, _indexFormat, (GLvoid*)(size_t)(_drawIndexOffset * _indexSize)) );
+            PerformanceCounters::addDrawCall(_primitiveType, _indexCount);
         }
         else
         {
-            GL_ASSERT( glDrawArrays(_primitiveType, 0, _vertexCount) );
+            GL_ASSERT( glDrawArrays(_primitiveType, _drawVertexOffset, _vertexCount) );
+            PerformanceCounters::addDrawCall(_primitiveType, _vertexCount);
         }
 
         pass->unbind();
     }
+    ++_flushCount;
+}
+
+unsigned int MeshBatch::getBytesStreamed()
+{
+    return _bytesStreamedLastFrame;
+}
+
+unsigned int MeshBatch::getFlushCount()
+{
+    return _flushCountLastFrame;
+}
+
+void MeshBatch::resetStatistics()
+{
+    _bytesStreamedLastFrame = _bytesStreamed;
+    _flushCountLastFrame = _flushCount;
+    _bytesStreamed = 0;
+    _flushCount = 0;
 }
-    
 
 }
@@ -10,9 +10,18 @@ class Material;
 
 /**
  * Defines a class for rendering multiple mesh into a single draw call on the graphics device.
+ *
+ * Batched primitives are streamed to the graphics device through vertex and index buffers
+ * that hold several batches worth of data. Every draw writes to the range following the
+ * previous one and the buffers are orphaned when they wrap, so uploading a batch never waits
+ * for the device to finish drawing an earlier one. Indexed batches switch to 32-bit indices
+ * when they grow beyond 65536 vertices.
  */
 class MeshBatch
 {
+    friend class Game;
+    friend class SpriteBatch;
+
 public:
 
     /**
@@ -141,6 +150,21 @@ public:
      */
     void draw();
 
+    /**
+     * Gets the number of bytes of vertex and index data all mesh batches streamed to the
+     * graphics device during the last frame.
+     *
+     * @return The number of bytes streamed.
+     */
+    static unsigned int getBytesStreamed();
+
+    /**
+     * Gets the number of times all mesh batches were drawn during the last frame.
+     *
+     * @return The number of batch flushes.
+     */
+    static unsigned int getFlushCount();
+
 private:
 
     /**
@@ -160,10 +184,34 @@ private:
 
     void add(const void* vertices, size_t size, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
 
+    /**
+     * Appends quads to an indexed triangle or triangle strip batch and returns their vertices
+     * for the caller to fill in, four per quad in strip order (bottom-left, bottom-right,
+     * top-left, top-right).
+     *
+     * @param quadCount The number of quads to add.
+     *
+     * @return The vertices of the new quads, or NULL if the batch could not grow to fit them.
+     */
+    void* addQuads(unsigned int quadCount);
+
     void updateVertexAttributeBinding();
 
+    bool grow(unsigned int vertexCount, unsigned int indexCount);
+
+    unsigned int getVertexCapacity(unsigned int capacity) const;
+
     bool resize(unsigned int capacity);
 
+    void createStreamingBuffers();
+
+    void upload();
+
+    /**
+     * Stores the streaming statistics of the frame that just ended and resets them.
+     */
+    static void resetStatistics();
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -174,12 +222,29 @@ private:
     unsigned int _indexCapacity;
     unsigned int _vertexCount;
     unsigned int _indexCount;
+    Mesh::IndexFormat _indexFormat;
+    unsigned int _indexSize;
     unsigned char* _vertices;
     unsigned char* _verticesPtr;
-    unsigned short* _indices;
-    unsigned short* _indicesPtr;
+    unsigned char* _indices;
+    unsigned char* _indicesPtr;
+    std::vector<unsigned char> _rebasedIndices;
+    Mesh* _vertexBuffer;
+    IndexBufferHandle _indexBuffer;
+    unsigned int _vertexBufferCapacity;
+    unsigned int _indexBufferCapacity;
+    unsigned int _vertexBufferOffset;
+    unsigned int _indexBufferOffset;
+    unsigned int _drawVertexOffset;
+    unsigned int _drawIndexOffset;
+    bool _uploaded;
     bool _started;
 
+    static unsigned int _bytesStreamed;
+    static unsigned int _flushCount;
+    static unsigned int _bytesStreamedLastFrame;
+    static unsigned int _flushCountLastFrame;
+
 };
 
 }
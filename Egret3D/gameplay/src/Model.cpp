@@ -1,10 +1,12 @@
 #include "Base.h"
 #include "Model.h"
+#include "PerformanceCounters.h"
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Technique.h"
 #include "Pass.h"
 #include "Node.h"
+#include "FramePacket.h"
 
 namespace egret
 {
@@ -250,26 +252,26 @@ void Model::setNode(Node* node)
     }
 }
 
-static bool drawWireframe(Mesh* mesh)
+bool Model::drawWireframe(Mesh::PrimitiveType primitiveType, unsigned int vertexCount)
 {
-    switch (mesh->getPrimitiveType())
+    switch (primitiveType)
     {
     case Mesh::TRIANGLES:
         {
-            unsigned int vertexCount = mesh->getVertexCount();
             for (unsigned int i = 0; i < vertexCount; i += 3)
             {
                 GL_ASSERT( glDrawArrays(GL_LINE_LOOP, i, 3) );
+                PerformanceCounters::addDrawCall(GL_LINE_LOOP, 3);
             }
         }
         return true;
 
     case Mesh::TRIANGLE_STRIP:
         {
-            unsigned int vertexCount = mesh->getVertexCount();
             for (unsigned int i = 2; i < vertexCount; ++i)
             {
                 GL_ASSERT( glDrawArrays(GL_LINE_LOOP, i-2, 3) );
+                PerformanceCounters::addDrawCall(GL_LINE_LOOP, 3);
             }
         }
         return true;
@@ -280,11 +282,10 @@ static bool drawWireframe(Mesh* mesh)
     }
 }
 
-static bool drawWireframe(MeshPart* part)
+bool Model::drawWireframe(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat)
 {
-    unsigned int indexCount = part->getIndexCount();
     unsigned int indexSize = 0;
-    switch (part->getIndexFormat())
+    switch (indexFormat)
     {
     case Mesh::INDEX8:
         indexSize = 1;
@@ -296,17 +297,18 @@ static bool drawWireframe(MeshPart* part)
         indexSize = 4;
         break;
     default:
-        GP_ERROR("Unsupported index format (%d).", part->getIndexFormat());
+        GP_ERROR("Unsupported index format (%d).", indexFormat);
         return false;
     }
 
-    switch (part->getPrimitiveType())
+    switch (primitiveType)
     {
     case Mesh::TRIANGLES:
         {
             for (size_t i = 0; i < indexCount; i += 3)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(i*indexSize))) );
+                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, indexFormat, ((const GLvoid*)(i*indexSize))) );
+                PerformanceCounters::addDrawCall(GL_LINE_LOOP, 3);
             }
         }
         return true;
@@ -315,7 +317,8 @@ static bool drawWireframe(MeshPart* part)
         {
             for (size_t i = 2; i < indexCount; ++i)
             {
-                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)((i-2)*indexSize))) );
+                GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, indexFormat, ((const GLvoid*)((i-2)*indexSize))) );
+                PerformanceCounters::addDrawCall(GL_LINE_LOOP, 3);
             }
         }
         return true;
@@ -328,9 +331,29 @@ static bool drawWireframe(MeshPart* part)
 
 unsigned int Model::draw(bool wireframe)
 {
+    GP_PROFILE_SCOPE("Model::draw");
     GP_ASSERT(_mesh);
 
     unsigned int partCount = _mesh->getPartCount();
+
+    // Pipelined frames record the draw, with the values of its parameters, instead of drawing.
+    FramePacket* packet = FramePacket::getRecording();
+    if (packet)
+    {
+        if (partCount == 0)
+        {
+            if (_material)
+                packet->drawMesh(_material, _mesh, NULL, wireframe);
+        }
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            Material* material = getMaterial(i);
+            if (material)
+                packet->drawMesh(material, _mesh, _mesh->getPart(i), wireframe);
+        }
+        return partCount;
+    }
+
     if (partCount == 0)
     {
         // No mesh parts (index buffers).
@@ -345,9 +368,10 @@ unsigned int Model::draw(bool wireframe)
                 GP_ASSERT(pass);
                 pass->bind();
                 GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (!wireframe || !drawWireframe(_mesh))
+                if (!wireframe || !drawWireframe(_mesh->getPrimitiveType(), _mesh->getVertexCount()))
                 {
                     GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+                    PerformanceCounters::addDrawCall(_mesh->getPrimitiveType(), _mesh->getVertexCount());
                 }
                 pass->unbind();
             }
@@ -373,9 +397,10 @@ unsigned int Model::draw(bool wireframe)
                     GP_ASSERT(pass);
                     pass->bind();
                     GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (!wireframe || !drawWireframe(part))
+                    if (!wireframe || !drawWireframe(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat()))
                     {
                         GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+                        PerformanceCounters::addDrawCall(part->getPrimitiveType(), part->getIndexCount());
                     }
                     pass->unbind();
                 }
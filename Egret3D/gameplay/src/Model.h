@@ -25,6 +25,7 @@ class Model : public Ref, public Drawable
     friend class Scene;
     friend class Mesh;
     friend class Bundle;
+    friend class FramePacket;
 
 public:
 
@@ -187,6 +188,20 @@ private:
 
     void validatePartCount();
 
+    /**
+     * Draws the triangles of the bound vertices as line loops.
+     *
+     * @return False if the primitive type has no wireframe.
+     */
+    static bool drawWireframe(Mesh::PrimitiveType primitiveType, unsigned int vertexCount);
+
+    /**
+     * Draws the triangles of the bound indices as line loops.
+     *
+     * @return False if the primitive type or index format has no wireframe.
+     */
+    static bool drawWireframe(Mesh::PrimitiveType primitiveType, unsigned int indexCount, Mesh::IndexFormat indexFormat);
+
     Mesh* _mesh;
     Material* _material;
     unsigned int _partCount;
@@ -407,7 +407,11 @@ void Node::update(float elapsedTime)
             node->update(elapsedTime);
         }
     }
-    fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(Node, update), dynamic_cast<void*>(this), elapsedTime);
+
+    // Only pay for the script event when a handler is registered
+    const ScriptTarget::Event* updateEvent = GP_GET_SCRIPT_EVENT(Node, update);
+    if (hasScriptEventHandler(updateEvent))
+        fireScriptEvent<void>(updateEvent, dynamic_cast<void*>(this), elapsedTime);
 }
 
 bool Node::isStatic() const
@@ -1,10 +1,12 @@
 #include "Base.h"
 #include "ParticleEmitter.h"
+#include "PerformanceCounters.h"
 #include "Game.h"
 #include "Node.h"
 #include "Scene.h"
 #include "kazmath/quaternion.h"
 #include "Properties.h"
+#include "TextureAtlas.h"
 //#include "kazmath/MathUtil.h"
 
 
@@ -30,7 +32,7 @@ ParticleEmitter::ParticleEmitter(unsigned int particleCountMax) : Drawable(),
 	_rotationAxis(vec3Zero), _rotation(mat4Identity),
     _spriteBatch(NULL), _spriteBlendMode(BLEND_ALPHA),  _spriteTextureWidth(0),
 	_spriteTextureHeight(0), _spriteTextureWidthRatio(0), 
-	_spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
+	_spriteTextureHeightRatio(0), _spriteRegion(), _spriteTextureCoords(NULL),
     _spriteAnimated(false),  _spriteLooped(false), _spriteFrameCount(1),
 	_spriteFrameRandomOffset(0),_spriteFrameDuration(0L),
 	_spriteFrameDurationSecs(0.0f), _spritePercentPerFrame(0.0f),
@@ -62,6 +64,7 @@ ParticleEmitter* ParticleEmitter::create(const char* textureFile, BlendMode blen
     GP_ASSERT(texture->getHeight());
 
     ParticleEmitter* emitter = ParticleEmitter::create(texture, blendMode, particleCountMax);
+    emitter->setTextureRegion(textureFile);
     SAFE_RELEASE(texture);
     return emitter;
 }
@@ -216,6 +219,7 @@ void ParticleEmitter::setTexture(const char* texturePath, BlendMode blendMode)
     if (texture)
     {
         setTexture(texture, blendMode);
+        setTextureRegion(texturePath);
         texture->release();
     }
     else
@@ -243,12 +247,25 @@ void ParticleEmitter::setTexture(Texture* texture, BlendMode blendMode)
     _spriteTextureHeight = texture->getHeight();
     _spriteTextureWidthRatio = 1.0f / (float)texture->getWidth();
     _spriteTextureHeightRatio = 1.0f / (float)texture->getHeight();
+    _spriteRegion.set(0, 0, (float)texture->getWidth(), (float)texture->getHeight());
 
     // By default assume only one frame which uses the entire texture.
     Rectangle texCoord((float)texture->getWidth(), (float)texture->getHeight());
     setSpriteFrameCoords(1, &texCoord);
 }
 
+void ParticleEmitter::setTextureRegion(const char* texturePath)
+{
+    const TextureAtlas::Region* region = TextureAtlas::findRegion(texturePath);
+    if (region)
+    {
+        // Frames of an image in an atlas are relative to the image, which is the default frame
+        _spriteRegion = region->bounds;
+        Rectangle texCoord(region->bounds.width, region->bounds.height);
+        setSpriteFrameCoords(1, &texCoord);
+    }
+}
+
 Texture* ParticleEmitter::getTexture() const
 {
     Texture::Sampler* sampler = _spriteBatch ? _spriteBatch->getSampler() : NULL;
@@ -691,8 +708,8 @@ void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, Rectangle* f
     // Pre-compute texture coordinates from rects.
     for (unsigned int i = 0; i < frameCount; i++)
     {
-        _spriteTextureCoords[i*4] = _spriteTextureWidthRatio * frameCoords[i].x;
-        _spriteTextureCoords[i*4 + 1] = 1.0f - _spriteTextureHeightRatio * frameCoords[i].y;
+        _spriteTextureCoords[i*4] = _spriteTextureWidthRatio * (_spriteRegion.x + frameCoords[i].x);
+        _spriteTextureCoords[i*4 + 1] = 1.0f - _spriteTextureHeightRatio * (_spriteRegion.y + frameCoords[i].y);
         _spriteTextureCoords[i*4 + 2] = _spriteTextureCoords[i*4] + _spriteTextureWidthRatio * frameCoords[i].width;
         _spriteTextureCoords[i*4 + 3] = _spriteTextureCoords[i*4 + 1] - _spriteTextureHeightRatio * frameCoords[i].height;
     }
@@ -704,8 +721,8 @@ void ParticleEmitter::setSpriteFrameCoords(unsigned int frameCount, int width, i
     GP_ASSERT(height);
 
     Rectangle* frameCoords = new Rectangle[frameCount];
-    unsigned int cols = _spriteTextureWidth / width;
-    unsigned int rows = _spriteTextureHeight / height;
+    unsigned int cols = _spriteRegion.width / width;
+    unsigned int rows = _spriteRegion.height / height;
 
     unsigned int n = 0;
     for (unsigned int i = 0; i < rows; ++i)
@@ -877,6 +894,8 @@ void ParticleEmitter::update(float elapsedTime)
     if (!isActive())
         return;
 
+    PerformanceCounters::add(PerformanceCounters::PARTICLES_ALIVE, _particleCount);
+
     // Cap particle updates at a maximum rate. This saves processing
     // and also improves precision since updating with very small
     // time increments is more lossy.
@@ -1019,29 +1038,44 @@ unsigned int ParticleEmitter::draw(bool wireframe)
         // Begin sprite batch drawing
         _spriteBatch->start();
 
-        // 2D Rotation.
-		static const kmVec2 pivot = { 0.5f, 0.5f };
-
         // 3D Rotation so that particles always face the camera.
         GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
         const kmMat4& cameraWorldMatrix = _node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
 
         kmVec3 right = vec3Zero;
-        //cameraWorldMatrix.getRightVector(&right);
         kmVec3 up = vec3Zero;
-        //cameraWorldMatrix.getUpVector(&up);
 		kmMat4GetRight(&right, &cameraWorldMatrix);
 		kmMat4GetUp(&up, &cameraWorldMatrix);
 
+        // Gather the particles into arrays and draw them all at once, rotated about their centers.
+        _drawValues.resize(_particleCount * 5);
+        _drawTexCoords.resize(_particleCount);
+        _drawColors.resize(_particleCount);
+        float* x = &_drawValues[0];
+        float* y = x + _particleCount;
+        float* z = y + _particleCount;
+        float* size = z + _particleCount;
+        float* angle = size + _particleCount;
         for (unsigned int i = 0; i < _particleCount; i++)
         {
-            Particle* p = &_particles[i];
-
-            _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                p->_color, pivot, p->_angle);
+            const Particle* p = &_particles[i];
+            const float* texCoords = &_spriteTextureCoords[p->_frame * 4];
+
+            x[i] = p->_position.x;
+            y[i] = p->_position.y;
+            z[i] = p->_position.z;
+            size[i] = p->_size;
+            angle[i] = p->_angle;
+            _drawTexCoords[i].x = texCoords[0];
+            _drawTexCoords[i].y = texCoords[1];
+            _drawTexCoords[i].z = texCoords[2];
+            _drawTexCoords[i].w = texCoords[3];
+            _drawColors[i] = p->_color;
         }
 
+        SpriteBatch::SpriteArrays sprites = { _particleCount, x, y, z, size, NULL, angle, &_drawTexCoords[0], &_drawColors[0] };
+        _spriteBatch->drawMany(sprites, right, up);
+
         // Render.
         _spriteBatch->finish();
     }
@@ -1078,6 +1112,7 @@ Drawable* ParticleEmitter::clone(NodeCloneContext& context)
     clone->_rotationSpeedMax = _rotationSpeedMax;
     clone->_rotationAxis = _rotationAxis;
     clone->_rotationAxisVar = _rotationAxisVar;
+    clone->_spriteRegion = _spriteRegion;
     clone->setSpriteTexCoords(_spriteFrameCount, _spriteTextureCoords);
     clone->_spriteAnimated = _spriteAnimated;
     clone->_spriteLooped = _spriteLooped;
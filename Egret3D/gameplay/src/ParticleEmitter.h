@@ -630,7 +630,8 @@ public:
      *
      * @param frameCount The number of frames to set texture coordinates for.
      * @param frameCoords A rectangle for each frame representing its position and size
-     *  within the texture image, measured in pixels.
+     *  within the texture image, measured in pixels. For an image in a texture atlas,
+     *  "sheet.atlas#name", positions are relative to the image.
      */
     void setSpriteFrameCoords(unsigned int frameCount, Rectangle* frameCoords);
 
@@ -745,6 +746,9 @@ private:
      */
     ParticleEmitter& operator=(const ParticleEmitter&);
 
+    // Makes sprite frames relative to the image a texture path names in a texture atlas, if it does.
+    void setTextureRegion(const char* texturePath);
+
     // Generates a scalar within the range defined by min and max.
     float generateScalar(float min, float max);
 
@@ -845,7 +849,11 @@ private:
     float _spriteTextureHeight;
     float _spriteTextureWidthRatio;
     float _spriteTextureHeightRatio;
+    Rectangle _spriteRegion;
     float* _spriteTextureCoords;
+    std::vector<float> _drawValues;
+    std::vector<kmVec4> _drawTexCoords;
+    std::vector<kmVec4> _drawColors;
     bool _spriteAnimated;
     bool _spriteLooped;
     unsigned int _spriteFrameCount;
@@ -0,0 +1,270 @@
+#include "Base.h"
+#include "PerformanceCounters.h"
+#include "Game.h"
+#include "FileSystem.h"
+#include "Stream.h"
+#include "Font.h"
+#include "SpriteBatch.h"
+#include "Texture.h"
+
+// The size of the text the overlay is drawn with; 0 uses the font's size.
+#define OVERLAY_TEXT_SIZE 0
+
+namespace egret
+{
+
+unsigned long long PerformanceCounters::_values[PerformanceCounters::MAX_COUNTERS];
+
+static const char* __counterNames[PerformanceCounters::MAX_COUNTERS] =
+{
+    "drawCalls",
+    "triangles",
+    "stateChanges",
+    "uniformUploads",
+    "textureBinds",
+    "liveRefs",
+    "particlesAlive",
+    "physicsBodiesActive",
+    "animationClipsRunning",
+    "bytesAllocated"
+};
+static unsigned int __counterCount = PerformanceCounters::COUNTER_COUNT;
+static PerformanceCounters::Snapshot __snapshot;
+static unsigned int __frame = 0;
+static unsigned long long __bytesAllocated = 0;
+static Stream* __csv = NULL;
+static bool __overlayEnabled = false;
+static std::string __overlayFontPath;
+static Font* __overlayFont = NULL;
+static SpriteBatch* __overlayBackground = NULL;
+
+PerformanceCounters::PerformanceCounters()
+{
+}
+
+unsigned int PerformanceCounters::registerCounter(const char* name)
+{
+    GP_ASSERT(name);
+
+    if (__counterCount >= MAX_COUNTERS)
+    {
+        GP_WARN("Failed to register counter '%s'; there are %u counters already.", name, MAX_COUNTERS);
+        return INVALID_COUNTER;
+    }
+    __counterNames[__counterCount] = name;
+    return __counterCount++;
+}
+
+unsigned int PerformanceCounters::getCounterCount()
+{
+    return __counterCount;
+}
+
+const char* PerformanceCounters::getName(unsigned int counter)
+{
+    GP_ASSERT(counter < __counterCount);
+    return __counterNames[counter];
+}
+
+const PerformanceCounters::Snapshot& PerformanceCounters::getSnapshot()
+{
+    return __snapshot;
+}
+
+static bool compareRefCounts(const std::pair<std::string, unsigned int>& a, const std::pair<std::string, unsigned int>& b)
+{
+    if (a.second != b.second)
+        return a.second > b.second;
+    return a.first < b.first;
+}
+
+void PerformanceCounters::getRefCounts(std::vector<std::pair<std::string, unsigned int> >& counts)
+{
+    std::map<std::string, unsigned int> types;
+    Ref::getLiveCounts(types);
+    counts.assign(types.begin(), types.end());
+    std::sort(counts.begin(), counts.end(), compareRefCounts);
+}
+
+bool PerformanceCounters::startRecording(const char* path)
+{
+    GP_ASSERT(path);
+
+    stopRecording();
+    __csv = FileSystem::open(path, FileSystem::WRITE);
+    if (__csv == NULL || !__csv->canWrite())
+    {
+        GP_WARN("Failed to open performance counter file '%s' for writing.", path);
+        SAFE_DELETE(__csv);
+        return false;
+    }
+
+    std::string header = "frame,frameTime";
+    for (unsigned int i = 0; i < __counterCount; ++i)
+    {
+        header += ',';
+        header += __counterNames[i];
+    }
+    header += '\n';
+    __csv->write(header.c_str(), 1, header.size());
+    return true;
+}
+
+void PerformanceCounters::stopRecording()
+{
+    if (__csv)
+    {
+        __csv->close();
+        SAFE_DELETE(__csv);
+    }
+}
+
+bool PerformanceCounters::isRecording()
+{
+    return __csv != NULL;
+}
+
+void PerformanceCounters::setOverlayEnabled(bool enabled)
+{
+    __overlayEnabled = enabled;
+}
+
+bool PerformanceCounters::isOverlayEnabled()
+{
+    return __overlayEnabled;
+}
+
+void PerformanceCounters::initialize()
+{
+    memset(_values, 0, sizeof(_values));
+    memset(&__snapshot, 0, sizeof(__snapshot));
+    __frame = 0;
+#ifdef GP_USE_MEM_LEAK_DETECTION
+    __bytesAllocated = getMemoryBytesAllocated();
+#endif
+
+    __overlayFontPath = "res/ui/arial.gpb";
+    Properties* config = Game::getInstance()->getConfig()->getNamespace("stats", true);
+    if (config)
+    {
+        __overlayEnabled = config->getBool("overlay");
+        if (config->exists("font"))
+            __overlayFontPath = config->getString("font");
+        const char* csv = config->getString("csv");
+        if (csv && *csv)
+            startRecording(csv);
+    }
+}
+
+void PerformanceCounters::drawOverlay()
+{
+    if (!__overlayEnabled)
+        return;
+
+    if (__overlayFont == NULL)
+    {
+        __overlayFont = Font::create(__overlayFontPath.c_str());
+        if (__overlayFont == NULL)
+        {
+            GP_WARN("Failed to load the performance counter overlay font '%s'.", __overlayFontPath.c_str());
+            __overlayEnabled = false;
+            return;
+        }
+
+        const unsigned char white[] = { 255, 255, 255, 255 };
+        Texture* texture = Texture::create(Texture::RGBA, 1, 1, white);
+        if (texture)
+        {
+            __overlayBackground = SpriteBatch::create(texture);
+            SAFE_RELEASE(texture);
+        }
+    }
+
+    // What the overlay draws is not counted.
+    unsigned long long values[MAX_COUNTERS];
+    memcpy(values, _values, sizeof(values));
+
+    Game* game = Game::getInstance();
+    char line[128];
+    std::string names;
+    std::string counts;
+    sprintf(line, "%u fps\n", game->getFrameRate());
+    names += line;
+    sprintf(line, "%.2f ms\n", __snapshot.frameTime);
+    counts += line;
+    for (unsigned int i = 0; i < __counterCount; ++i)
+    {
+        names += __counterNames[i];
+        names += '\n';
+        sprintf(line, "%llu\n", __snapshot.values[i]);
+        counts += line;
+    }
+
+    const int margin = 4;
+    unsigned int namesWidth, countsWidth, height;
+    __overlayFont->measureText(names.c_str(), OVERLAY_TEXT_SIZE, &namesWidth, &height);
+    __overlayFont->measureText(counts.c_str(), OVERLAY_TEXT_SIZE, &countsWidth, &height);
+    unsigned int spacing = __overlayFont->getSize();
+
+    if (__overlayBackground)
+    {
+        const Rectangle& vp = game->getViewport();
+        kmMat4 projection;
+        kmMat4OrthographicProjection(&projection, vp.x, vp.width, vp.height, vp.y, 0, 1);
+        __overlayBackground->setProjectionMatrix(projection);
+
+        kmVec4 color = { 0.0f, 0.0f, 0.0f, 0.6f };
+        __overlayBackground->start();
+        __overlayBackground->draw(0.0f, 0.0f, (float)(namesWidth + spacing + countsWidth + margin * 2), (float)(height + margin * 2),
+                                  0.0f, 0.0f, 1.0f, 1.0f, color);
+        __overlayBackground->finish();
+    }
+
+    kmVec4 nameColor = { 0.8f, 0.8f, 0.8f, 1.0f };
+    kmVec4 countColor = { 1.0f, 1.0f, 0.4f, 1.0f };
+    __overlayFont->start();
+    __overlayFont->drawText(names.c_str(), margin, margin, nameColor, OVERLAY_TEXT_SIZE);
+    __overlayFont->drawText(counts.c_str(), margin + namesWidth + spacing, margin, countColor, OVERLAY_TEXT_SIZE);
+    __overlayFont->finish();
+
+    memcpy(_values, values, sizeof(values));
+}
+
+void PerformanceCounters::newFrame(float elapsedTime)
+{
+    _values[LIVE_REFS] = Ref::getLiveCount();
+#ifdef GP_USE_MEM_LEAK_DETECTION
+    unsigned long long bytesAllocated = getMemoryBytesAllocated();
+    _values[BYTES_ALLOCATED] = bytesAllocated - __bytesAllocated;
+    __bytesAllocated = bytesAllocated;
+#endif
+
+    __snapshot.frame = __frame++;
+    __snapshot.frameTime = elapsedTime;
+    memcpy(__snapshot.values, _values, sizeof(_values));
+    memset(_values, 0, sizeof(_values));
+
+    if (__csv)
+    {
+        char text[32];
+        std::string row;
+        sprintf(text, "%u,%.3f", __snapshot.frame, __snapshot.frameTime);
+        row += text;
+        for (unsigned int i = 0; i < __counterCount; ++i)
+        {
+            sprintf(text, ",%llu", __snapshot.values[i]);
+            row += text;
+        }
+        row += '\n';
+        __csv->write(row.c_str(), 1, row.size());
+    }
+}
+
+void PerformanceCounters::finalize()
+{
+    stopRecording();
+    SAFE_DELETE(__overlayBackground);
+    SAFE_RELEASE(__overlayFont);
+}
+
+}
@@ -0,0 +1,224 @@
+#ifndef PERFORMANCECOUNTERS_H_
+#define PERFORMANCECOUNTERS_H_
+
+namespace egret
+{
+
+/**
+ * Counts what the engine does in each frame (draw calls, triangles, state changes, ...).
+ *
+ * Counters are added to while a frame runs and are captured into a snapshot when it ends,
+ * so reading them costs nothing while the game runs. Games can register their own
+ * counters next to the engine's.
+ *
+ * The snapshots can be written to a CSV file, one row per frame, for automated
+ * performance runs, and drawn in an overlay at the top left of the screen. Both can be
+ * turned on from the game config:
+ *
+ * @code
+ * stats
+ * {
+ *     overlay = true
+ *     font = res/ui/arial.gpb
+ *     csv = stats.csv
+ * }
+ * @endcode
+ *
+ * Counters must only be added to on the game's thread.
+ *
+ * @script{ignore}
+ */
+class PerformanceCounters
+{
+    friend class Game;
+
+public:
+
+    /**
+     * The counters of the engine.
+     */
+    enum Counter
+    {
+        /** The number of draw calls. */
+        DRAW_CALLS,
+        /** The number of triangles drawn. */
+        TRIANGLES,
+        /** The number of render states and shader programs applied. */
+        STATE_CHANGES,
+        /** The number of uniform values set. */
+        UNIFORM_UPLOADS,
+        /** The number of textures bound. */
+        TEXTURE_BINDS,
+        /** The number of Ref objects alive at the end of the frame. */
+        LIVE_REFS,
+        /** The number of particles alive in the particle emitters that were updated. */
+        PARTICLES_ALIVE,
+        /** The number of physics bodies that are not sleeping. */
+        PHYSICS_BODIES_ACTIVE,
+        /** The number of animation clips running. */
+        ANIMATION_CLIPS_RUNNING,
+        /** The number of bytes allocated with new (only with GP_USE_MEM_LEAK_DETECTION). */
+        BYTES_ALLOCATED,
+        /** The number of engine counters; registered counters follow. */
+        COUNTER_COUNT
+    };
+
+    /**
+     * The largest number of counters, including the registered ones.
+     */
+    static const unsigned int MAX_COUNTERS = 64;
+
+    /**
+     * The index returned when a counter cannot be registered. Adding to it does nothing.
+     */
+    static const unsigned int INVALID_COUNTER = MAX_COUNTERS;
+
+    /**
+     * The counters of a frame.
+     */
+    struct Snapshot
+    {
+        /**
+         * The index of the frame, counted from the start of the game.
+         */
+        unsigned int frame;
+
+        /**
+         * The time the frame took, in milliseconds.
+         */
+        float frameTime;
+
+        /**
+         * The values of the counters, indexed by Counter or by the index of a registered counter.
+         */
+        unsigned long long values[MAX_COUNTERS];
+    };
+
+    /**
+     * Adds a counter. Counters registered after a recording started are not written to it.
+     *
+     * @param name The name of the counter, which must stay valid (a string literal).
+     *
+     * @return The index of the counter, or INVALID_COUNTER if there are MAX_COUNTERS already.
+     */
+    static unsigned int registerCounter(const char* name);
+
+    /**
+     * Gets the number of counters, including the registered ones.
+     *
+     * @return The number of counters.
+     */
+    static unsigned int getCounterCount();
+
+    /**
+     * Gets the name of a counter.
+     *
+     * @param counter The counter.
+     *
+     * @return The name of the counter.
+     */
+    static const char* getName(unsigned int counter);
+
+    /**
+     * Adds to a counter of the current frame.
+     *
+     * @param counter The counter; INVALID_COUNTER is ignored.
+     * @param value The value to add.
+     */
+    static void add(unsigned int counter, unsigned int value = 1);
+
+    /**
+     * Counts a draw call and the triangles it draws.
+     *
+     * @param mode The GL primitive type that is drawn.
+     * @param count The number of vertices or indices that are drawn.
+     */
+    static void addDrawCall(GLenum mode, unsigned int count);
+
+    /**
+     * Gets the counters of the last frame that ended.
+     *
+     * @return The snapshot of the last frame.
+     */
+    static const Snapshot& getSnapshot();
+
+    /**
+     * Gets the number of Ref objects alive of each type. Types are only known when the
+     * engine is built with GP_USE_MEM_LEAK_DETECTION; otherwise this is empty.
+     *
+     * @param counts Set to the type names and counts, the most common type first.
+     */
+    static void getRefCounts(std::vector<std::pair<std::string, unsigned int> >& counts);
+
+    /**
+     * Starts writing the snapshot of each frame to a CSV file.
+     *
+     * @param path The path of the file to write.
+     *
+     * @return True if the file could be opened.
+     */
+    static bool startRecording(const char* path);
+
+    /**
+     * Stops writing snapshots and closes the CSV file.
+     */
+    static void stopRecording();
+
+    /**
+     * Checks whether snapshots are written to a CSV file.
+     *
+     * @return True if snapshots are written.
+     */
+    static bool isRecording();
+
+    /**
+     * Shows or hides the overlay.
+     *
+     * @param enabled True to draw the overlay at the end of each frame.
+     */
+    static void setOverlayEnabled(bool enabled);
+
+    /**
+     * Checks whether the overlay is shown.
+     *
+     * @return True if the overlay is shown.
+     */
+    static bool isOverlayEnabled();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    PerformanceCounters();
+
+    /**
+     * Reads the stats config.
+     */
+    static void initialize();
+
+    /**
+     * Draws the counters of the last frame, without counting what the overlay draws.
+     */
+    static void drawOverlay();
+
+    /**
+     * Captures the counters of the frame that ended and starts counting the next one.
+     *
+     * @param elapsedTime The time the frame took, in milliseconds.
+     */
+    static void newFrame(float elapsedTime);
+
+    /**
+     * Stops recording and releases the overlay.
+     */
+    static void finalize();
+
+    static unsigned long long _values[MAX_COUNTERS];
+};
+
+}
+
+#include "PerformanceCounters.inl"
+
+#endif
@@ -0,0 +1,21 @@
+#include "PerformanceCounters.h"
+
+namespace egret
+{
+
+inline void PerformanceCounters::add(unsigned int counter, unsigned int value)
+{
+    if (counter < MAX_COUNTERS)
+        _values[counter] += value;
+}
+
+inline void PerformanceCounters::addDrawCall(GLenum mode, unsigned int count)
+{
+    ++_values[DRAW_CALLS];
+    if (mode == GL_TRIANGLES)
+        _values[TRIANGLES] += count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        _values[TRIANGLES] += count - 2;
+}
+
+}
@@ -283,12 +283,13 @@ void PhysicsCollisionObject::PhysicsMotionState::setCenterOfMassOffset(const kmV
 }
 
 PhysicsCollisionObject::ScriptListener::ScriptListener()
-    : script(NULL)
+    : script(NULL), functionRef(LUA_NOREF)
 {
 }
 
 PhysicsCollisionObject::ScriptListener::~ScriptListener()
 {
+    Game::getInstance()->getScriptController()->unbindFunction(functionRef);
     SAFE_RELEASE(script);
 }
 
@@ -324,9 +325,24 @@ PhysicsCollisionObject::ScriptListener* PhysicsCollisionObject::ScriptListener::
 void PhysicsCollisionObject::ScriptListener::collisionEvent(PhysicsCollisionObject::CollisionListener::EventType type,
     const PhysicsCollisionObject::CollisionPair& collisionPair, const kmVec3& contactPointA, const kmVec3& contactPointB)
 {
-    Game::getInstance()->getScriptController()->executeFunction<void>(function.c_str(), 
-        "[PhysicsCollisionObject::CollisionListener::EventType]<PhysicsCollisionObject::CollisionPair><kmVec3><kmVec3>",
-        type, &collisionPair, &contactPointA, &contactPointB);
+    ScriptController* sc = Game::getInstance()->getScriptController();
+
+    // Bind the callback function on first use, so collisions don't resolve it by name every call.
+    if (functionRef == LUA_NOREF)
+        functionRef = sc->bindFunction(function.c_str());
+
+    if (functionRef != LUA_NOREF)
+    {
+        sc->executeFunctionRef<void>(NULL, functionRef,
+            "[PhysicsCollisionObject::CollisionListener::EventType]<PhysicsCollisionObject::CollisionPair><kmVec3><kmVec3>",
+            type, &collisionPair, &contactPointA, &contactPointB);
+    }
+    else
+    {
+        sc->executeFunction<void>(function.c_str(),
+            "[PhysicsCollisionObject::CollisionListener::EventType]<PhysicsCollisionObject::CollisionPair><kmVec3><kmVec3>",
+            type, &collisionPair, &contactPointA, &contactPointB);
+    }
 }
 
 }
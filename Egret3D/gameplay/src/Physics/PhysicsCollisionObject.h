@@ -297,6 +297,8 @@ protected:
         Script* script;
         /** The name of the Lua script function to use as the callback. */
         std::string function;
+        /** The bound reference to the Lua script function (or LUA_NOREF if not yet bound). */
+        int functionRef;
 
     private:
 
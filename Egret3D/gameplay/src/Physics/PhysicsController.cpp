@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "PhysicsController.h"
+#include "PerformanceCounters.h"
 #include "PhysicsRigidBody.h"
 #include "PhysicsCharacter.h"
 #include "Game.h"
@@ -483,6 +484,7 @@ void PhysicsController::resume()
 
 void PhysicsController::update(float elapsedTime)
 {
+    GP_PROFILE_SCOPE("PhysicsController::update");
     GP_ASSERT(_world);
     _isUpdating = true;
 
@@ -493,6 +495,15 @@ void PhysicsController::update(float elapsedTime)
     // so we divide by 1000 to convert from milliseconds.
     _world->stepSimulation(elapsedTime * 0.001f, 10);
 
+    unsigned int activeCount = 0;
+    for (int i = 0; i < _world->getNumCollisionObjects(); i++)
+    {
+        GP_ASSERT(_world->getCollisionObjectArray()[i]);
+        if (_world->getCollisionObjectArray()[i]->isActive())
+            ++activeCount;
+    }
+    PerformanceCounters::add(PerformanceCounters::PHYSICS_BODIES_ACTIVE, activeCount);
+
     // If we have status listeners, then check if our status has changed.
     if (_listeners || hasScriptListener(GP_GET_SCRIPT_EVENT(PhysicsController, statusEvent)))
     {
@@ -914,6 +925,8 @@ PhysicsCollisionShape* PhysicsController::createShape(Node* node, const PhysicsC
                 // Build the heightfield from an attached terrain's height array
                 if (dynamic_cast<Terrain*>(node->getDrawable()) == NULL)
                     GP_ERROR("Empty heightfield collision shapes can only be used on nodes that have an attached Terrain.");
+                else if (dynamic_cast<Terrain*>(node->getDrawable())->isStreamed())
+                    GP_ERROR("Empty heightfield collision shapes cannot be used with streamed terrains.");
                 else
                     collisionShape = createHeightfield(node, dynamic_cast<Terrain*>(node->getDrawable())->_heightfield, centerOfMassOffset);
             }
@@ -13,6 +13,7 @@
 #include <X11/keysym.h>
 #include <sys/time.h>
 #include <GL/glxew.h>
+#include <EGL/egl.h>
 #include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -95,6 +96,24 @@ static GLXContext __context;
 static Atom __atomWmDeleteWindow;
 static list<ConnectedGamepadDevInfo> __connectedGamepads;
 
+// Headless mode runs the game without a window or X11 display, for dedicated servers,
+// bots and automated runs. It is turned on with --headless[=offscreen|null] on the
+// command line or in the game config:
+//
+// headless
+// {
+//     enabled = true
+//     renderer = offscreen     // an EGL pbuffer context (default), or null for no context
+// }
+//
+// The size of the offscreen surface is read from the window namespace. Frames run back
+// to back unless the timing namespace caps the frame rate (see FrameScheduler).
+static bool __headless = false;
+static bool __nullRenderer = false;
+static EGLDisplay __eglDisplay = EGL_NO_DISPLAY;
+static EGLSurface __eglSurface = EGL_NO_SURFACE;
+static EGLContext __eglContext = EGL_NO_CONTEXT;
+
 // Gets the egret::Keyboard::Key enumeration constant that corresponds to the given X11 key symbol.
 static egret::Keyboard::Key getKey(KeySym sym)
 {
@@ -561,6 +580,133 @@ Platform::~Platform()
 {
 }
 
+static void readHeadlessConfig(Game* game)
+{
+    const char* renderer = NULL;
+    Properties* config = game->getConfig() ? game->getConfig()->getNamespace("headless", true) : NULL;
+    if (config)
+    {
+        __headless = config->getBool("enabled");
+        renderer = config->getString("renderer");
+    }
+
+    // The command line overrides the config.
+    for (int i = 1; i < __argc; ++i)
+    {
+        const char* arg = __argv[i];
+        if (strncmp(arg, "--headless", 10) == 0 && (arg[10] == '\0' || arg[10] == '='))
+        {
+            __headless = true;
+            if (arg[10] == '=')
+                renderer = arg + 11;
+        }
+    }
+
+    __nullRenderer = false;
+    if (renderer && strcmp(renderer, "null") == 0)
+        __nullRenderer = true;
+    else if (renderer && strcmp(renderer, "offscreen") != 0)
+        GP_WARN("Unknown headless renderer '%s'; using an offscreen context.", renderer);
+}
+
+static void cleanupEGL()
+{
+    if (__eglDisplay != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(__eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (__eglContext != EGL_NO_CONTEXT)
+            eglDestroyContext(__eglDisplay, __eglContext);
+        if (__eglSurface != EGL_NO_SURFACE)
+            eglDestroySurface(__eglDisplay, __eglSurface);
+
+        eglTerminate(__eglDisplay);
+    }
+    __eglDisplay = EGL_NO_DISPLAY;
+    __eglSurface = EGL_NO_SURFACE;
+    __eglContext = EGL_NO_CONTEXT;
+}
+
+static bool createHeadlessContext(int width, int height)
+{
+    __windowSize[0] = width;
+    __windowSize[1] = height;
+
+    if (__nullRenderer)
+    {
+        printf("Running headless without a renderer.\n");
+        return true;
+    }
+
+    // Render into a pbuffer surface, which needs no display server.
+    __eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (__eglDisplay == EGL_NO_DISPLAY || !eglInitialize(__eglDisplay, NULL, NULL))
+    {
+        perror("eglInitialize");
+        __eglDisplay = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    EGLint configAttribs[] =
+    {
+        EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE,    EGL_OPENGL_BIT,
+        EGL_RED_SIZE,           8,
+        EGL_GREEN_SIZE,         8,
+        EGL_BLUE_SIZE,          8,
+        EGL_DEPTH_SIZE,         24,
+        EGL_STENCIL_SIZE,       8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(__eglDisplay, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        perror("eglChooseConfig");
+        cleanupEGL();
+        return false;
+    }
+
+    EGLint surfaceAttribs[] =
+    {
+        EGL_WIDTH,  width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    __eglSurface = eglCreatePbufferSurface(__eglDisplay, config, surfaceAttribs);
+    eglBindAPI(EGL_OPENGL_API);
+    __eglContext = eglCreateContext(__eglDisplay, config, EGL_NO_CONTEXT, NULL);
+    if (__eglSurface == EGL_NO_SURFACE || __eglContext == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(__eglDisplay, __eglSurface, __eglSurface, __eglContext))
+    {
+        perror("eglCreateContext");
+        cleanupEGL();
+        return false;
+    }
+
+    // Use OpenGL 2.x with GLEW
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // There is no GLX display without X11, but the GL functions are loaded.
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)
+        glewStatus = GLEW_OK;
+#endif
+    if (glewStatus != GLEW_OK)
+    {
+        perror("glewInit");
+        cleanupEGL();
+        return false;
+    }
+
+    int versionGL[2] = {-1, -1};
+    glGetIntegerv(GL_MAJOR_VERSION, versionGL);
+    glGetIntegerv(GL_MINOR_VERSION, versionGL + 1);
+    printf("Running headless with GL version: %d.%d\n", versionGL[0], versionGL[1]);
+
+    return true;
+}
+
 Platform* Platform::create(Game* game)
 {
 
@@ -569,6 +715,28 @@ Platform* Platform::create(Game* game)
     FileSystem::setResourcePath("./");
     Platform* platform = new Platform(game);
 
+    readHeadlessConfig(game);
+    if (__headless)
+    {
+        int width = 1280, height = 800;
+        Properties* config = game->getConfig() ? game->getConfig()->getNamespace("window", true) : NULL;
+        if (config)
+        {
+            if (config->getInt("width") > 0)
+                width = config->getInt("width");
+            if (config->getInt("height") > 0)
+                height = config->getInt("height");
+        }
+
+        if (!createHeadlessContext(width, height))
+        {
+            SAFE_DELETE(platform);
+            return NULL;
+        }
+        game->_renderingEnabled = !__nullRenderer;
+        return platform;
+    }
+
     // Get the display and initialize
     __display = XOpenDisplay(NULL);
     if (__display == NULL)
@@ -1122,7 +1290,8 @@ int Platform::enterMessagePump()
 {
     GP_ASSERT(_game);
 
-    updateWindowSize();
+    if (!__headless)
+        updateWindowSize();
 
     static bool shiftDown = false;
     static bool capsOn = false;
@@ -1136,6 +1305,22 @@ int Platform::enterMessagePump()
     // Run the game.
     _game->run();
 
+    if (__headless)
+    {
+        // There are no window events; just run frames.
+        while (_game->getState() != Game::UNINITIALIZED)
+        {
+            _game->frame();
+
+            if (__eglContext != EGL_NO_CONTEXT)
+                eglSwapBuffers(__eglDisplay, __eglSurface);
+        }
+
+        cleanupEGL();
+
+        return _game->_exitCode;
+    }
+
     // Setup select for message handling (to allow non-blocking)
     int x11_fd = ConnectionNumber(__display);
 
@@ -1338,7 +1523,7 @@ int Platform::enterMessagePump()
 
     cleanupX11();
 
-    return 0;
+    return _game->_exitCode;
 }
 
 void Platform::signalShutdown()
@@ -1384,6 +1569,9 @@ void Platform::setVsync(bool enable)
 {
     __vsync = enable;
 
+    if (__headless)
+        return;
+
     if (glXSwapIntervalEXT)
         glXSwapIntervalEXT(__display, __window, __vsync ? 1 : 0);
     else if(glXSwapIntervalMESA)
@@ -1392,7 +1580,10 @@ void Platform::setVsync(bool enable)
 
 void Platform::swapBuffers()
 {
-    glXSwapBuffers(__display, __window);
+    if (__eglContext != EGL_NO_CONTEXT)
+        eglSwapBuffers(__eglDisplay, __eglSurface);
+    else if (!__headless)
+        glXSwapBuffers(__display, __window);
 }
 
 void Platform::sleep(long ms)
@@ -1488,6 +1679,9 @@ bool Platform::hasMouse()
 
 void Platform::setMouseCaptured(bool captured)
 {
+    if (__headless)
+        return;
+
     if (captured != __mouseCaptured)
     {
         if (captured)
@@ -1517,6 +1711,9 @@ bool Platform::isMouseCaptured()
 
 void Platform::setCursorVisible(bool visible)
 {
+    if (__headless)
+        return;
+
     if (visible != __cursorVisible)
     {
         if (visible==false)
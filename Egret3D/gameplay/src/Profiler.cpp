@@ -0,0 +1,439 @@
+#include "Base.h"
+#include "Profiler.h"
+#include "FileSystem.h"
+#include "Stream.h"
+
+#ifdef GP_USE_PROFILER
+
+// Scopes a thread can finish between two frames; a power of two.
+#define PROFILER_BUFFER_SIZE 8192
+
+// Frames the statistics cover.
+#define PROFILER_FRAMES 120
+
+// Frames kept for the trace.
+#define PROFILER_TRACE_FRAMES 300
+
+#ifdef _MSC_VER
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL thread_local
+#endif
+
+namespace egret
+{
+
+/**
+ * A finished scope.
+ */
+struct ProfilerEvent
+{
+    const char* name;
+    long long start;
+    long long end;
+    unsigned int depth;
+    unsigned int thread;
+};
+
+/**
+ * The scopes a thread finished, written by that thread and read by the game's thread.
+ */
+struct ProfilerBuffer
+{
+    ProfilerEvent events[PROFILER_BUFFER_SIZE];
+    std::atomic<unsigned int> write;
+    std::atomic<unsigned int> read;
+    unsigned int thread;
+    unsigned int depth;
+};
+
+/**
+ * A scope in the tree of nested scopes, with its time in each of the last frames.
+ */
+struct ProfilerNode
+{
+    const char* name;
+    unsigned int depth;
+    std::vector<ProfilerNode*> children;
+    long long frameTime;
+    unsigned int frameCalls;
+    float times[PROFILER_FRAMES];
+    unsigned int calls[PROFILER_FRAMES];
+};
+
+static std::atomic<bool> __enabled(true);
+static std::atomic<unsigned int> __dropped(0);
+static std::mutex __buffersMutex;
+static std::vector<ProfilerBuffer*> __buffers;
+static PROFILER_THREAD_LOCAL ProfilerBuffer* __threadBuffer = NULL;
+static const long long __epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+// Only used by the game's thread.
+static ProfilerBuffer* __gameBuffer = NULL;
+static std::vector<ProfilerNode*> __roots;
+static std::vector<ProfilerEvent> __events;
+static unsigned int __frameIndex = 0;
+static unsigned int __frameCount = 0;
+static std::deque<ProfilerEvent> __trace;
+static std::deque<size_t> __traceFrames;
+
+static long long now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - __epoch;
+}
+
+static ProfilerBuffer* getThreadBuffer()
+{
+    if (__threadBuffer == NULL)
+    {
+        ProfilerBuffer* buffer = new ProfilerBuffer();
+        buffer->write.store(0);
+        buffer->read.store(0);
+        buffer->depth = 0;
+
+        std::lock_guard<std::mutex> lock(__buffersMutex);
+        buffer->thread = (unsigned int)__buffers.size();
+        __buffers.push_back(buffer);
+        __threadBuffer = buffer;
+    }
+    return __threadBuffer;
+}
+
+static ProfilerNode* createNode(const char* name, unsigned int depth)
+{
+    ProfilerNode* node = new ProfilerNode();
+    node->name = name;
+    node->depth = depth;
+    node->frameTime = 0;
+    node->frameCalls = 0;
+    memset(node->times, 0, sizeof(node->times));
+    memset(node->calls, 0, sizeof(node->calls));
+    return node;
+}
+
+static ProfilerNode* getChild(ProfilerNode* parent, const char* name)
+{
+    // Names are usually the same literal, so compare pointers before text.
+    std::vector<ProfilerNode*>& children = parent->children;
+    for (size_t i = 0, count = children.size(); i < count; ++i)
+    {
+        if (children[i]->name == name)
+            return children[i];
+    }
+    for (size_t i = 0, count = children.size(); i < count; ++i)
+    {
+        if (strcmp(children[i]->name, name) == 0)
+            return children[i];
+    }
+    ProfilerNode* child = createNode(name, parent->depth + 1);
+    children.push_back(child);
+    return child;
+}
+
+static void deleteNode(ProfilerNode* node)
+{
+    for (size_t i = 0, count = node->children.size(); i < count; ++i)
+    {
+        deleteNode(node->children[i]);
+    }
+    SAFE_DELETE(node);
+}
+
+static void storeFrame(ProfilerNode* node)
+{
+    node->times[__frameIndex] = (float)(node->frameTime / 1000000.0);
+    node->calls[__frameIndex] = node->frameCalls;
+    node->frameTime = 0;
+    node->frameCalls = 0;
+    for (size_t i = 0, count = node->children.size(); i < count; ++i)
+    {
+        storeFrame(node->children[i]);
+    }
+}
+
+static bool compareEvents(const ProfilerEvent& a, const ProfilerEvent& b)
+{
+    if (a.start != b.start)
+        return a.start < b.start;
+    return a.depth < b.depth;
+}
+
+static float getNodeFrameTime(const ProfilerNode* node, const char* name, unsigned int frame)
+{
+    float time = (node->name == name || strcmp(node->name, name) == 0) ? node->times[frame] : 0.0f;
+    for (size_t i = 0, count = node->children.size(); i < count; ++i)
+    {
+        time += getNodeFrameTime(node->children[i], name, frame);
+    }
+    return time;
+}
+
+static void addStatistics(const ProfilerNode* node, unsigned int thread, const std::string& parentPath, std::vector<Profiler::Statistics>& statistics)
+{
+    std::string path = parentPath.empty() ? node->name : parentPath + "/" + node->name;
+
+    unsigned int calls = 0;
+    float times[PROFILER_FRAMES];
+    for (unsigned int i = 0; i < __frameCount; ++i)
+    {
+        times[i] = node->times[i];
+        calls += node->calls[i];
+    }
+    if (calls > 0)
+    {
+        std::sort(times, times + __frameCount);
+        float total = 0.0f;
+        for (unsigned int i = 0; i < __frameCount; ++i)
+            total += times[i];
+
+        Profiler::Statistics s;
+        s.path = path;
+        s.name = node->name;
+        s.depth = node->depth - 1;
+        s.thread = thread;
+        s.calls = (float)calls / __frameCount;
+        s.minTime = times[0];
+        s.avgTime = total / __frameCount;
+        s.p99Time = times[(__frameCount * 99 + 99) / 100 - 1];
+        s.maxTime = times[__frameCount - 1];
+        statistics.push_back(s);
+    }
+
+    for (size_t i = 0, count = node->children.size(); i < count; ++i)
+    {
+        addStatistics(node->children[i], thread, path, statistics);
+    }
+}
+
+static void writeString(Stream* stream, const char* str)
+{
+    stream->write("\"", 1, 1);
+    for (const char* c = str; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            stream->write("\\", 1, 1);
+        if ((unsigned char)*c >= 0x20)
+            stream->write(c, 1, 1);
+    }
+    stream->write("\"", 1, 1);
+}
+
+Profiler::Scope::Scope(const char* name) : _name(name), _start(0), _depth(0)
+{
+    if (__enabled.load(std::memory_order_relaxed))
+    {
+        _depth = getThreadBuffer()->depth++;
+        _start = now();
+    }
+}
+
+Profiler::Scope::~Scope()
+{
+    if (_start == 0)
+        return;
+    long long end = now();
+
+    ProfilerBuffer* buffer = __threadBuffer;
+    --buffer->depth;
+    unsigned int write = buffer->write.load(std::memory_order_relaxed);
+    if (write - buffer->read.load(std::memory_order_acquire) >= PROFILER_BUFFER_SIZE)
+    {
+        __dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ProfilerEvent& e = buffer->events[write & (PROFILER_BUFFER_SIZE - 1)];
+    e.name = _name;
+    e.start = _start;
+    e.end = end;
+    e.depth = _depth;
+    e.thread = buffer->thread;
+    buffer->write.store(write + 1, std::memory_order_release);
+}
+
+Profiler::Profiler()
+{
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    __enabled.store(enabled);
+}
+
+bool Profiler::isEnabled()
+{
+    return __enabled.load();
+}
+
+void Profiler::newFrame()
+{
+    if (__gameBuffer == NULL)
+        __gameBuffer = getThreadBuffer();
+
+    std::vector<ProfilerBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(__buffersMutex);
+        buffers = __buffers;
+    }
+    while (__roots.size() < buffers.size())
+    {
+        __roots.push_back(createNode("", 0));
+    }
+
+    size_t traceSize = __trace.size();
+    for (size_t i = 0, count = buffers.size(); i < count; ++i)
+    {
+        ProfilerBuffer* buffer = buffers[i];
+        unsigned int read = buffer->read.load(std::memory_order_relaxed);
+        unsigned int write = buffer->write.load(std::memory_order_acquire);
+        __events.clear();
+        for (unsigned int j = read; j != write; ++j)
+        {
+            __events.push_back(buffer->events[j & (PROFILER_BUFFER_SIZE - 1)]);
+        }
+        buffer->read.store(write, std::memory_order_release);
+
+        // Nest each scope in the last scope that started before it at a lower depth and had not ended.
+        std::sort(__events.begin(), __events.end(), compareEvents);
+        std::vector<std::pair<ProfilerNode*, const ProfilerEvent*> > open;
+        ProfilerNode* root = __roots[buffer->thread];
+        for (size_t j = 0, eventCount = __events.size(); j < eventCount; ++j)
+        {
+            const ProfilerEvent& e = __events[j];
+            while (!open.empty() && (open.back().second->depth >= e.depth || open.back().second->end < e.start))
+                open.pop_back();
+            ProfilerNode* node = getChild(open.empty() ? root : open.back().first, e.name);
+            node->frameTime += e.end - e.start;
+            ++node->frameCalls;
+            open.push_back(std::make_pair(node, &e));
+            __trace.push_back(e);
+        }
+    }
+
+    for (size_t i = 0, count = __roots.size(); i < count; ++i)
+    {
+        storeFrame(__roots[i]);
+    }
+    __frameIndex = (__frameIndex + 1) % PROFILER_FRAMES;
+    if (__frameCount < PROFILER_FRAMES)
+        ++__frameCount;
+
+    __traceFrames.push_back(__trace.size() - traceSize);
+    while (__traceFrames.size() > PROFILER_TRACE_FRAMES)
+    {
+        __trace.erase(__trace.begin(), __trace.begin() + __traceFrames.front());
+        __traceFrames.pop_front();
+    }
+}
+
+void Profiler::getStatistics(std::vector<Statistics>& statistics)
+{
+    statistics.clear();
+    if (__frameCount == 0)
+        return;
+
+    // The game's thread comes first.
+    std::vector<unsigned int> threads;
+    if (__gameBuffer && __gameBuffer->thread < __roots.size())
+        threads.push_back(__gameBuffer->thread);
+    for (unsigned int i = 0; i < __roots.size(); ++i)
+    {
+        if (__gameBuffer == NULL || i != __gameBuffer->thread)
+            threads.push_back(i);
+    }
+    for (size_t i = 0, count = threads.size(); i < count; ++i)
+    {
+        const ProfilerNode* root = __roots[threads[i]];
+        for (size_t j = 0, childCount = root->children.size(); j < childCount; ++j)
+        {
+            addStatistics(root->children[j], (unsigned int)i, std::string(), statistics);
+        }
+    }
+}
+
+float Profiler::getFrameTime(const char* name)
+{
+    GP_ASSERT(name);
+    if (__frameCount == 0)
+        return 0.0f;
+
+    unsigned int frame = (__frameIndex + PROFILER_FRAMES - 1) % PROFILER_FRAMES;
+    float time = 0.0f;
+    for (size_t i = 0, count = __roots.size(); i < count; ++i)
+    {
+        time += getNodeFrameTime(__roots[i], name, frame);
+    }
+    return time;
+}
+
+unsigned int Profiler::getFrameCount()
+{
+    return __frameCount;
+}
+
+unsigned int Profiler::getDroppedCount()
+{
+    return __dropped.load();
+}
+
+bool Profiler::writeTrace(const char* path)
+{
+    GP_ASSERT(path);
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_ERROR("Failed to write profiler trace '%s'.", path);
+        return false;
+    }
+
+    char text[256];
+    const char* separator = "";
+    const char* begin = "{\"traceEvents\":[\n";
+    stream->write(begin, 1, strlen(begin));
+    for (unsigned int i = 0; i < __roots.size(); ++i)
+    {
+        bool game = __gameBuffer && i == __gameBuffer->thread;
+        sprintf(text, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s%u\"}}", separator, i, game ? "Game " : "Thread ", i);
+        stream->write(text, 1, strlen(text));
+        separator = ",\n";
+    }
+    for (std::deque<ProfilerEvent>::const_iterator itr = __trace.begin(); itr != __trace.end(); ++itr)
+    {
+        const ProfilerEvent& e = *itr;
+        stream->write(separator, 1, strlen(separator));
+        stream->write("{\"name\":", 1, 8);
+        writeString(stream.get(), e.name);
+        sprintf(text, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", e.thread, e.start / 1000.0, (e.end - e.start) / 1000.0);
+        stream->write(text, 1, strlen(text));
+        separator = ",\n";
+    }
+    const char* end = "\n],\"displayTimeUnit\":\"ms\"}\n";
+    stream->write(end, 1, strlen(end));
+
+    return true;
+}
+
+void Profiler::finalize()
+{
+    for (size_t i = 0, count = __roots.size(); i < count; ++i)
+    {
+        deleteNode(__roots[i]);
+    }
+    __roots.clear();
+    __events.clear();
+    __trace.clear();
+    __traceFrames.clear();
+    __frameIndex = 0;
+    __frameCount = 0;
+
+    // The buffers stay, since threads that are still running keep writing to theirs.
+    std::lock_guard<std::mutex> lock(__buffersMutex);
+    for (size_t i = 0, count = __buffers.size(); i < count; ++i)
+    {
+        __buffers[i]->read.store(__buffers[i]->write.load());
+    }
+}
+
+}
+
+#endif
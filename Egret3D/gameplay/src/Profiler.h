@@ -0,0 +1,196 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+/**
+ * CPU profiler markers.
+ *
+ * The profiler is only built when the pre-processor definition GP_USE_PROFILER is set
+ * (the GP_USE_PROFILER CMake option). Otherwise the markers expand to nothing and the
+ * Profiler class is not declared, so code that uses the class directly must check
+ * GP_USE_PROFILER too.
+ */
+#ifdef GP_USE_PROFILER
+
+#define GP_PROFILE_CONCAT_(a, b) a##b
+#define GP_PROFILE_CONCAT(a, b) GP_PROFILE_CONCAT_(a, b)
+
+/**
+ * Times the rest of the enclosing block as a scope with the given name, which must be a
+ * string literal.
+ */
+#define GP_PROFILE_SCOPE(name) egret::Profiler::Scope GP_PROFILE_CONCAT(__profileScope, __LINE__)(name)
+
+namespace egret
+{
+
+/**
+ * Records how long the scopes marked with GP_PROFILE_SCOPE take, on any thread.
+ *
+ * Each thread writes the scopes it finishes to its own buffer without taking a lock.
+ * At the start of every frame the game collects the buffers and adds each scope to a
+ * tree of the scopes it was nested in, which keeps the time spent in it over the last
+ * frames. A scope that is still open when its thread's buffer is collected (a worker
+ * thread job that spans frames, for example) is added below the thread instead of below
+ * the scopes that enclose it.
+ *
+ * The scopes of the last few hundred frames can be written out as a Chrome trace
+ * ("chrome://tracing" or https://ui.perfetto.dev).
+ *
+ * @script{ignore}
+ */
+class Profiler
+{
+    friend class Game;
+
+public:
+
+    /**
+     * Times a scope from its construction to its destruction. Use GP_PROFILE_SCOPE.
+     */
+    class Scope
+    {
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param name The name of the scope, which must stay valid (a string literal).
+         */
+        explicit Scope(const char* name);
+
+        /**
+         * Destructor.
+         */
+        ~Scope();
+
+    private:
+
+        Scope(const Scope& copy);
+        Scope& operator=(const Scope&);
+
+        const char* _name;
+        long long _start;
+        unsigned int _depth;
+    };
+
+    /**
+     * The time spent in a scope, per frame, over the frames the profiler keeps.
+     */
+    struct Statistics
+    {
+        /**
+         * The names of the scope and of the scopes it is nested in, separated by '/'.
+         */
+        std::string path;
+
+        /**
+         * The name of the scope.
+         */
+        const char* name;
+
+        /**
+         * The number of scopes the scope is nested in.
+         */
+        unsigned int depth;
+
+        /**
+         * The thread the scope ran on; 0 is the game's thread.
+         */
+        unsigned int thread;
+
+        /**
+         * The average number of times the scope ran in a frame.
+         */
+        float calls;
+
+        /**
+         * The least, average, 99th percentile and most time spent in the scope in a frame,
+         * in milliseconds.
+         */
+        float minTime;
+        float avgTime;
+        float p99Time;
+        float maxTime;
+    };
+
+    /**
+     * Starts or stops recording scopes.
+     *
+     * @param enabled True to record scopes (the default).
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * Checks whether scopes are recorded.
+     *
+     * @return True if scopes are recorded.
+     */
+    static bool isEnabled();
+
+    /**
+     * Gets the statistics of the scopes, in the order of the scope tree (each scope
+     * followed by the scopes nested in it).
+     *
+     * @param statistics Set to the statistics of the scopes that ran in the frames kept.
+     */
+    static void getStatistics(std::vector<Statistics>& statistics);
+
+    /**
+     * Gets the time spent in the scopes with the given name in the last frame, on all threads.
+     *
+     * @param name The name of the scopes.
+     *
+     * @return The time, in milliseconds.
+     */
+    static float getFrameTime(const char* name);
+
+    /**
+     * Gets the number of frames the statistics cover.
+     *
+     * @return The number of frames.
+     */
+    static unsigned int getFrameCount();
+
+    /**
+     * Gets the number of scopes that were not recorded because a thread's buffer was full.
+     *
+     * @return The number of dropped scopes.
+     */
+    static unsigned int getDroppedCount();
+
+    /**
+     * Writes the scopes of the last frames as a Chrome trace (JSON).
+     *
+     * @param path The path of the file to write.
+     *
+     * @return True if the file was written.
+     */
+    static bool writeTrace(const char* path);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    Profiler();
+
+    /**
+     * Collects the scopes the threads finished since the last frame.
+     */
+    static void newFrame();
+
+    /**
+     * Releases the statistics and the trace.
+     */
+    static void finalize();
+};
+
+}
+
+#else
+
+#define GP_PROFILE_SCOPE(name)
+
+#endif
+
+#endif
@@ -1,23 +1,227 @@
 #include "Base.h"
 #include "Properties.h"
 #include "FileSystem.h"
+#include "Ref.h"
 #include "kazmath/quaternion.h"
 #include "kazmath/vec3.h"
+#include <climits>
+
+// Identifies the binary form of properties files written by the encoder.
+#define PROPERTIES_BINARY_MAGIC "GPPB"
+#define PROPERTIES_BINARY_VERSION 1
+
+// Size of the blocks the strings of a file are allocated from.
+#define PROPERTIES_ARENA_BLOCK_SIZE 4096
+
+// Index of the current property when iteration has not started or has finished.
+#define PROPERTIES_END ((size_t)-1)
 
 namespace egret
 {
 
 /**
- * Reads the next character from the stream. Returns EOF if the end of the stream is reached.
+ * Owns the strings of the namespaces of a file.
+ *
+ * Each distinct string is stored once, so names can be compared by address. Clones of
+ * the namespaces keep the arena alive after the file leaves the cache. Once the file is
+ * parsed the arena is frozen and strings set later go to the overflow arena of the
+ * namespace they are set on.
+ */
+class Properties::Arena : public Ref
+{
+public:
+
+    Arena(size_t size);
+
+    ~Arena();
+
+    /**
+     * Gets the stored copy of a string, storing it if it has not been seen.
+     */
+    const char* intern(const char* str, size_t length);
+
+    /**
+     * Gets the stored copy of a string, or NULL if it has not been stored.
+     */
+    const char* find(const char* str) const;
+
+    /**
+     * Set once the file is parsed, when the arena is shared by clones of its namespaces.
+     */
+    bool frozen;
+
+private:
+
+    struct Entry
+    {
+        const char* str;
+        unsigned int hash;
+    };
+
+    static unsigned int hash(const char* str, size_t length);
+
+    std::vector<char*> _blocks;
+    size_t _blockSize;
+    size_t _blockUsed;
+    std::vector<Entry> _table;
+    size_t _count;
+};
+
+Properties::Arena::Arena(size_t size)
+    : frozen(false), _blockSize(std::max(size, (size_t)PROPERTIES_ARENA_BLOCK_SIZE)), _blockUsed(0), _count(0)
+{
+    // Most files fit in their first block
+    _blocks.push_back(new char[_blockSize]);
+    Entry empty = { NULL, 0 };
+    _table.resize(64, empty);
+}
+
+Properties::Arena::~Arena()
+{
+    for (size_t i = 0, count = _blocks.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_blocks[i]);
+    }
+}
+
+unsigned int Properties::Arena::hash(const char* str, size_t length)
+{
+    // 32 bit FNV-1a
+    unsigned int hash = 2166136261U;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+const char* Properties::Arena::intern(const char* str, size_t length)
+{
+    GP_ASSERT(str || length == 0);
+
+    unsigned int h = hash(str, length);
+    size_t mask = _table.size() - 1;
+    size_t i = h & mask;
+    while (_table[i].str)
+    {
+        if (_table[i].hash == h && strncmp(_table[i].str, str, length) == 0 && _table[i].str[length] == 0)
+            return _table[i].str;
+        i = (i + 1) & mask;
+    }
+
+    if (_blockUsed + length + 1 > _blockSize)
+    {
+        _blockSize = std::max(length + 1, (size_t)PROPERTIES_ARENA_BLOCK_SIZE);
+        _blocks.push_back(new char[_blockSize]);
+        _blockUsed = 0;
+    }
+    char* copy = _blocks.back() + _blockUsed;
+    _blockUsed += length + 1;
+    if (length > 0)
+        memcpy(copy, str, length);
+    copy[length] = 0;
+
+    _table[i].str = copy;
+    _table[i].hash = h;
+    if (++_count * 2 > _table.size())
+    {
+        // Keep the table at most half full
+        std::vector<Entry> table = _table;
+        Entry empty = { NULL, 0 };
+        _table.assign(table.size() * 2, empty);
+        mask = _table.size() - 1;
+        for (size_t j = 0, count = table.size(); j < count; ++j)
+        {
+            if (table[j].str)
+            {
+                size_t k = table[j].hash & mask;
+                while (_table[k].str)
+                    k = (k + 1) & mask;
+                _table[k] = table[j];
+            }
+        }
+    }
+    return copy;
+}
+
+const char* Properties::Arena::find(const char* str) const
+{
+    GP_ASSERT(str);
+
+    size_t length = strlen(str);
+    unsigned int h = hash(str, length);
+    size_t mask = _table.size() - 1;
+    for (size_t i = h & mask; _table[i].str; i = (i + 1) & mask)
+    {
+        if (_table[i].hash == h && strcmp(_table[i].str, str) == 0)
+            return _table[i].str;
+    }
+    return NULL;
+}
+
+/**
+ * A parsed properties file.
+ */
+struct PropertiesFile
+{
+    Properties* properties;
+    time_t modified;
+};
+
+static std::map<std::string, PropertiesFile> __propertiesFiles;
+
+/**
+ * Reads the next number of a binary properties file, checking it is less than the limit.
+ */
+static bool readBinaryIndex(const unsigned char** data, const unsigned char* end, size_t limit, unsigned int* value)
+{
+    if ((size_t)(end - *data) < sizeof(unsigned int))
+        return false;
+    memcpy(value, *data, sizeof(unsigned int));
+    *data += sizeof(unsigned int);
+    return *value < limit;
+}
+
+/**
+ * Skips whitespace at the start of a string.
+ */
+static const char* trimStart(const char* str, const char* end)
+{
+    while (str < end && isspace((unsigned char)*str))
+        ++str;
+    return str;
+}
+
+/**
+ * Skips whitespace at the end of a string.
  */
-static signed char readChar(Stream* stream)
+static const char* trimEnd(const char* str, const char* end)
 {
-    if (stream->eof())
-        return EOF;
-    signed char c;
-    if (stream->read(&c, 1, 1) != 1)
-        return EOF;
-    return c;
+    while (end > str && isspace((unsigned char)end[-1]))
+        --end;
+    return end;
+}
+
+/**
+ * Gets the next token of a line like strtok(), moving past the delimiter that ends it.
+ */
+static bool nextToken(const char** position, const char* end, const char* delimiters, const char** token, const char** tokenEnd)
+{
+    const char* p = *position;
+    while (p < end && strchr(delimiters, *p))
+        ++p;
+    if (p == end)
+    {
+        *position = end;
+        return false;
+    }
+    *token = p;
+    while (p < end && !strchr(delimiters, *p))
+        ++p;
+    *tokenEnd = p;
+    *position = p < end ? p + 1 : end;
+    return true;
 }
 
 // Utility functions (shared with SceneLoader).
@@ -27,13 +231,29 @@ void calculateNamespacePath(const std::string& urlString, std::string& fileStrin
 Properties* getPropertiesFromNamespacePath(Properties* properties, const std::vector<std::string>& namespacePath);
 
 Properties::Properties()
-    : _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
+    : _arena(new Arena(0)), _overflow(NULL), _propertiesIndex(0), _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
 {
+    _namespace = _id = _parentID = _arena->intern("", 0);
+    rewind();
+}
+
+Properties::Properties(Arena* arena)
+    : _arena(arena), _overflow(NULL), _propertiesIndex(0), _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
+{
+    GP_ASSERT(arena);
+    _arena->addRef();
+    _namespace = _id = _parentID = _arena->intern("", 0);
+    rewind();
 }
 
 Properties::Properties(const Properties& copy)
-    : _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID), _properties(copy._properties), _variables(NULL), _dirPath(NULL), _visited(false), _parent(copy._parent)
+    : _arena(copy._arena), _overflow(NULL), _namespace(copy._namespace), _id(copy._id), _parentID(copy._parentID),
+      _properties(copy._properties), _values(copy._values), _propertiesIndex(0), _variables(NULL), _dirPath(NULL), _visited(false),
+      _parent(copy._parent)
 {
+    _arena->addRef();
+    if (copy._overflow)
+        internStrings();
     setDirectoryPath(copy._dirPath);
     _namespaces = std::vector<Properties*>();
     std::vector<Properties*>::const_iterator it;
@@ -45,25 +265,14 @@ Properties::Properties(const Properties& copy)
     rewind();
 }
 
-Properties::Properties(Stream* stream)
-    : _variables(NULL), _dirPath(NULL), _visited(false), _parent(NULL)
-{
-    readProperties(stream);
-    rewind();
-}
-
-Properties::Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent)
-    : _namespace(name), _variables(NULL), _dirPath(NULL), _visited(false), _parent(parent)
+Properties::Properties(Arena* arena, const char* name, const char* id, const char* parentID, Properties* parent)
+    : _arena(arena), _overflow(NULL), _propertiesIndex(0), _variables(NULL), _dirPath(NULL), _visited(false), _parent(parent)
 {
-    if (id)
-    {
-        _id = id;
-    }
-    if (parentID)
-    {
-        _parentID = parentID;
-    }
-    readProperties(stream);
+    GP_ASSERT(arena && name);
+    _arena->addRef();
+    _namespace = name;
+    _id = id ? id : _arena->intern("", 0);
+    _parentID = parentID ? parentID : _arena->intern("", 0);
     rewind();
 }
 
@@ -81,302 +290,345 @@ Properties* Properties::create(const char* url)
     std::vector<std::string> namespacePath;
     calculateNamespacePath(urlString, fileString, namespacePath);
 
-    std::unique_ptr<Stream> stream(FileSystem::open(fileString.c_str()));
-    if (stream.get() == NULL)
-    {
-        GP_WARN("Failed to open file '%s'.", fileString.c_str());
+    Properties* properties = loadFile(fileString.c_str());
+    if (properties == NULL)
         return NULL;
-    }
-
-    Properties* properties = new Properties(stream.get());
-    properties->resolveInheritance();
-    stream->close();
 
     // Get the specified properties object.
     Properties* p = getPropertiesFromNamespacePath(properties, namespacePath);
     if (!p)
     {
         GP_WARN("Failed to load properties from url '%s'.", url);
-        SAFE_DELETE(properties);
         return NULL;
     }
 
-    // If the loaded properties object is not the root namespace,
-    // then we have to clone it and delete the root namespace
-    // so that we don't leak memory.
-    if (p != properties)
+    // The parsed file stays in the cache, so return a copy of the namespace.
+    p = p->clone();
+    p->setDirectoryPath(FileSystem::getDirectoryName(fileString.c_str()));
+    return p;
+}
+
+Properties* Properties::loadFile(const char* path)
+{
+    GP_ASSERT(path);
+
+    time_t modified = FileSystem::getModifiedTime(path);
+    std::map<std::string, PropertiesFile>::iterator itr = __propertiesFiles.find(path);
+    if (itr != __propertiesFiles.end())
+    {
+        if (itr->second.modified == modified)
+            return itr->second.properties;
+
+        // Changed since it was read
+        SAFE_DELETE(itr->second.properties);
+        __propertiesFiles.erase(itr);
+    }
+
+    // The whole file is read at once and parsed from memory
+    int size = 0;
+    char* data = FileSystem::readAll(path, &size);
+    if (data == NULL)
+    {
+        GP_WARN("Failed to open file '%s'.", path);
+        return NULL;
+    }
+
+    Properties* properties = NULL;
+    if (size >= 4 && memcmp(data, PROPERTIES_BINARY_MAGIC, 4) == 0)
+    {
+        properties = loadBinary(reinterpret_cast<const unsigned char*>(data) + 4, size - 4, path);
+    }
+    else
+    {
+        // Names and values are usually shorter than the text they are parsed from
+        Arena* arena = new Arena(size);
+        properties = new Properties(arena);
+        arena->release();
+
+        const char* text = data;
+        properties->readProperties(&text, data + size);
+        properties->rewind();
+        properties->resolveInheritance();
+    }
+    SAFE_DELETE_ARRAY(data);
+    if (properties == NULL)
+        return NULL;
+
+    // The cached namespaces are only cloned from now on
+    properties->_arena->frozen = true;
+
+    PropertiesFile& file = __propertiesFiles[path];
+    file.properties = properties;
+    file.modified = modified;
+    return properties;
+}
+
+Properties* Properties::loadBinary(const unsigned char* data, size_t size, const char* path)
+{
+    GP_ASSERT(data);
+
+    const unsigned char* end = data + size;
+    unsigned int version;
+    unsigned int stringCount;
+    if (!readBinaryIndex(&data, end, UINT_MAX, &version) || version != PROPERTIES_BINARY_VERSION)
+    {
+        GP_ERROR("Failed to read binary properties file '%s': unsupported version.", path);
+        return NULL;
+    }
+
+    // Names and values refer to a table of the distinct strings of the file
+    if (!readBinaryIndex(&data, end, size, &stringCount))
+    {
+        GP_ERROR("Failed to read binary properties file '%s': file is truncated.", path);
+        return NULL;
+    }
+    Arena* arena = new Arena(size);
+    std::vector<const char*> strings(stringCount);
+    for (unsigned int i = 0; i < stringCount; ++i)
+    {
+        unsigned int length;
+        if (!readBinaryIndex(&data, end, end - data + 1, &length) || (size_t)(end - data) < length)
+        {
+            GP_ERROR("Failed to read binary properties file '%s': file is truncated.", path);
+            SAFE_RELEASE(arena);
+            return NULL;
+        }
+        strings[i] = arena->intern(reinterpret_cast<const char*>(data), length);
+        data += length;
+    }
+
+    Properties* properties = new Properties(arena);
+    arena->release();
+    if (!properties->readBinary(&data, end, strings))
     {
-        p = p->clone();
+        GP_ERROR("Failed to read binary properties file '%s': invalid namespace.", path);
         SAFE_DELETE(properties);
+        return NULL;
     }
-    p->setDirectoryPath(FileSystem::getDirectoryName(fileString.c_str()));
-    return p;
+    properties->rewind();
+    return properties;
+}
+
+bool Properties::readBinary(const unsigned char** data, const unsigned char* end, const std::vector<const char*>& strings)
+{
+    GP_ASSERT(data && *data);
+
+    // Counts can be no more than the bytes left
+    size_t stringCount = strings.size();
+    size_t limit = end - *data;
+    unsigned int name, id, count, value;
+    if (!readBinaryIndex(data, end, stringCount, &name) || !readBinaryIndex(data, end, stringCount, &id))
+        return false;
+    _namespace = strings[name];
+    _id = strings[id];
+
+    if (!readBinaryIndex(data, end, limit, &count))
+        return false;
+    _properties.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!readBinaryIndex(data, end, stringCount, &name) || !readBinaryIndex(data, end, stringCount, &value))
+            return false;
+        _properties.push_back(Property(strings[name], strings[value]));
+    }
+
+    if (!readBinaryIndex(data, end, limit, &count))
+        return false;
+    if (count > 0)
+    {
+        _variables = new std::vector<Property>();
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (!readBinaryIndex(data, end, stringCount, &name) || !readBinaryIndex(data, end, stringCount, &value))
+                return false;
+            _variables->push_back(Property(strings[name], strings[value]));
+        }
+    }
+
+    if (!readBinaryIndex(data, end, limit, &count))
+        return false;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Properties* space = new Properties(_arena);
+        space->_parent = this;
+        _namespaces.push_back(space);
+        if (!space->readBinary(data, end, strings))
+            return false;
+        space->rewind();
+    }
+    return true;
+}
+
+void Properties::finalize()
+{
+    for (std::map<std::string, PropertiesFile>::iterator itr = __propertiesFiles.begin(); itr != __propertiesFiles.end(); ++itr)
+    {
+        SAFE_DELETE(itr->second.properties);
+    }
+    __propertiesFiles.clear();
 }
 
 static bool isVariable(const char* str, char* outName, size_t outSize)
 {
+    // Most strings are not variables
+    if (str[0] != '$' || str[1] != '{')
+        return false;
+
     size_t len = strlen(str);
-    if (len > 3 && str[0] == '$' && str[1] == '{' && str[len - 1] == '}')
+    if (len > 3 && str[len - 1] == '}')
     {
         size_t size = len - 3;
         if (size > (outSize - 1))
             size = outSize - 1;
-        strncpy(outName, str + 2, len - 3);
-        outName[len - 3] = 0;
+        strncpy(outName, str + 2, size);
+        outName[size] = 0;
         return true;
     }
 
     return false;
 }
 
-void Properties::readProperties(Stream* stream)
+void Properties::readProperties(const char** text, const char* end)
 {
-    GP_ASSERT(stream);
+    GP_ASSERT(text && *text);
 
-    char line[2048];
-    char variable[256];
-    int c;
-    char* name;
-    char* value;
-    char* parentID;
-    char* rc;
-    char* rcc;
-    char* rccc;
+    const char* position = *text;
     bool comment = false;
-
     while (true)
     {
         // Skip whitespace at the start of lines
-        skipWhiteSpace(stream);
+        position = trimStart(position, end);
 
         // Stop when we have reached the end of the file.
-        if (stream->eof())
+        if (position == end)
             break;
 
         // Read the next line.
-        rc = stream->readLine(line, 2048);
-        if (rc == NULL)
-        {
-            GP_ERROR("Error reading line from file.");
-            return;
-        }
+        const char* line = position;
+        const char* lineEnd = (const char*)memchr(line, '\n', end - line);
+        if (lineEnd == NULL)
+            lineEnd = end;
+        position = lineEnd < end ? lineEnd + 1 : end;
+        const char* trimmedEnd = trimEnd(line, lineEnd);
+        size_t length = lineEnd - line;
 
         // Ignore comments
         if (comment)
         {
             // Check for end of multi-line comment at either start or end of line
-            if (strncmp(line, "*/", 2) == 0)
+            if ((length >= 2 && strncmp(line, "*/", 2) == 0) ||
+                (trimmedEnd - line >= 2 && strncmp(trimmedEnd - 2, "*/", 2) == 0))
                 comment = false;
-            else
-            {
-                trimWhiteSpace(line);
-                const int len = strlen(line);
-                if (len >= 2 && strncmp(line + (len - 2), "*/", 2) == 0)
-                    comment = false;
-            }
+            continue;
         }
-        else if (strncmp(line, "/*", 2) == 0)
+        if (length >= 2 && strncmp(line, "/*", 2) == 0)
         {
             // Start of multi-line comment (must be at start of line)
             comment = true;
+            continue;
         }
-        else if (strncmp(line, "//", 2) != 0)
+        if (length >= 2 && strncmp(line, "//", 2) == 0)
+            continue;
+
+        const char* p = line;
+        const char* name;
+        const char* nameEnd;
+        if (memchr(line, '=', length))
         {
-            // If an '=' appears on this line, parse it as a name/value pair.
-            // Note: strchr() has to be called before strtok(), or a backup of line has to be kept.
-            rc = strchr(line, '=');
-            if (rc != NULL)
+            // First token should be the property name.
+            if (!nextToken(&p, lineEnd, "=", &name, &nameEnd))
             {
-                // First token should be the property name.
-                name = strtok(line, "=");
-                if (name == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: attribute without name.");
-                    return;
-                }
-
-                // Remove white-space from name.
-                name = trimWhiteSpace(name);
-
-                // Scan for next token, the property's value.
-                value = strtok(NULL, "");
-                if (value == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: attribute with name ('%s') but no value.", name);
-                    return;
-                }
+                GP_ERROR("Error parsing properties file: attribute without name.");
+                break;
+            }
+            nameEnd = trimEnd(name, nameEnd);
 
-                // Remove white-space from value.
-                value = trimWhiteSpace(value);
+            // The rest of the line is the property's value.
+            const char* value = trimStart(p, lineEnd);
+            const char* valueEnd = trimEnd(value, lineEnd);
 
-                // Is this a variable assignment?
-                if (isVariable(name, variable, 256))
-                {
-                    setVariable(variable, value);
-                }
-                else
-                {
-                    // Normal name/value pair
-                    _properties.push_back(Property(name, value));
-                }
+            // Is this a variable assignment?
+            if (nameEnd - name > 3 && name[0] == '$' && name[1] == '{' && nameEnd[-1] == '}')
+            {
+                std::string variable(name + 2, nameEnd - 1);
+                setVariable(variable.c_str(), std::string(value, valueEnd).c_str());
             }
             else
             {
-                parentID = NULL;
-
-                // Get the last character on the line (ignoring whitespace).
-                const char* lineEnd = trimWhiteSpace(line) + (strlen(trimWhiteSpace(line)) - 1);
-
-                // This line might begin or end a namespace,
-                // or it might be a key/value pair without '='.
-
-                // Check for '{' on same line.
-                rc = strchr(line, '{');
-
-                // Check for inheritance: ':'
-                rcc = strchr(line, ':');
-
-                // Check for '}' on same line.
-                rccc = strchr(line, '}');
-            
-                // Get the name of the namespace.
-                name = strtok(line, " \t\n{");
-                name = trimWhiteSpace(name);
-                if (name == NULL)
-                {
-                    GP_ERROR("Error parsing properties file: failed to determine a valid token for line '%s'.", line);
-                    return;
-                }
-                else if (name[0] == '}')
-                {
-                    // End of namespace.
-                    return;
-                }
+                // Normal name/value pair
+                _properties.push_back(Property(_arena->intern(name, nameEnd - name), _arena->intern(value, valueEnd - value)));
+            }
+            continue;
+        }
 
-                // Get its ID if it has one.
-                value = strtok(NULL, ":{");
-                value = trimWhiteSpace(value);
+        // This line might begin or end a namespace,
+        // or it might be a key/value pair without '='.
+        const char* openBrace = (const char*)memchr(line, '{', length);
+        const char* closeBrace = (const char*)memchr(line, '}', length);
+        bool inherits = memchr(line, ':', length) != NULL;
 
-                // Get its parent ID if it has one.
-                if (rcc != NULL)
-                {
-                    parentID = strtok(NULL, "{");
-                    parentID = trimWhiteSpace(parentID);
-                }
+        // The namespace ends on this line if the first '}' is the last character.
+        bool endsOnLine = closeBrace && closeBrace == trimmedEnd - 1;
 
-                if (value != NULL && value[0] == '{')
-                {
-                    // If the namespace ends on this line, seek back to right before the '}' character.
-                    if (rccc && rccc == lineEnd)
-                    {
-                        if (stream->seek(-1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                            return;
-                        }
-                        while (readChar(stream) != '}')
-                        {
-                            if (stream->seek(-2, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                        }
-                        if (stream->seek(-1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                            return;
-                        }
-                    }
+        // Get the name of the namespace.
+        if (!nextToken(&p, lineEnd, " \t\r{", &name, &nameEnd))
+        {
+            GP_ERROR("Error parsing properties file: failed to determine a valid token for line '%.*s'.", (int)length, line);
+            break;
+        }
+        if (name[0] == '}')
+        {
+            // End of namespace.
+            break;
+        }
 
-                    // New namespace without an ID.
-                    Properties* space = new Properties(stream, name, NULL, parentID, this);
-                    _namespaces.push_back(space);
+        // Get its ID and its parent ID if it has them.
+        const char* id = NULL;
+        const char* idEnd = NULL;
+        const char* parentID = NULL;
+        const char* parentIDEnd = NULL;
+        if (nextToken(&p, lineEnd, ":{", &id, &idEnd))
+        {
+            id = trimStart(id, idEnd);
+            idEnd = trimEnd(id, idEnd);
+        }
+        if (inherits && nextToken(&p, lineEnd, "{", &parentID, &parentIDEnd))
+        {
+            parentID = trimStart(parentID, parentIDEnd);
+            parentIDEnd = trimEnd(parentID, parentIDEnd);
+        }
 
-                    // If the namespace ends on this line, seek to right after the '}' character.
-                    if (rccc && rccc == lineEnd)
-                    {
-                        if (stream->seek(1, SEEK_CUR) == false)
-                        {
-                            GP_ERROR("Failed to seek to immediately after a '}' character in properties file.");
-                            return;
-                        }
-                    }
-                }
-                else
-                {
-                    // If '{' appears on the same line.
-                    if (rc != NULL)
-                    {
-                        // If the namespace ends on this line, seek back to right before the '}' character.
-                        if (rccc && rccc == lineEnd)
-                        {
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                            while (readChar(stream) != '}')
-                            {
-                                if (stream->seek(-2, SEEK_CUR) == false)
-                                {
-                                    GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                    return;
-                                }
-                            }
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek back to before a '}' character in properties file.");
-                                return;
-                            }
-                        }
-
-                        // Create new namespace.
-                        Properties* space = new Properties(stream, name, value, parentID, this);
-                        _namespaces.push_back(space);
-
-                        // If the namespace ends on this line, seek to right after the '}' character.
-                        if (rccc && rccc == lineEnd)
-                        {
-                            if (stream->seek(1, SEEK_CUR) == false)
-                            {
-                                GP_ERROR("Failed to seek to immediately after a '}' character in properties file.");
-                                return;
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // Find out if the next line starts with "{"
-                        skipWhiteSpace(stream);
-                        c = readChar(stream);
-                        if (c == '{')
-                        {
-                            // Create new namespace.
-                            Properties* space = new Properties(stream, name, value, parentID, this);
-                            _namespaces.push_back(space);
-                        }
-                        else
-                        {
-                            // Back up from fgetc()
-                            if (stream->seek(-1, SEEK_CUR) == false)
-                                GP_ERROR("Failed to seek backwards a single character after testing if the next line starts with '{'.");
-
-                            // Store "name value" as a name/value pair, or even just "name".
-                            if (value != NULL)
-                            {
-                                _properties.push_back(Property(name, value));
-                            }
-                            else
-                            {
-                                _properties.push_back(Property(name, ""));
-                            }
-                        }
-                    }
-                }
+        bool isNamespace = openBrace != NULL;
+        if (!isNamespace)
+        {
+            // Find out if the next line starts with "{"
+            const char* next = trimStart(position, end);
+            if (next < end && *next == '{')
+            {
+                position = next + 1;
+                isNamespace = true;
+                endsOnLine = false;
             }
         }
+
+        if (isNamespace)
+        {
+            Properties* space = new Properties(_arena, _arena->intern(name, nameEnd - name),
+                id ? _arena->intern(id, idEnd - id) : NULL, parentID ? _arena->intern(parentID, parentIDEnd - parentID) : NULL, this);
+            _namespaces.push_back(space);
+
+            // A namespace that ends on the line it starts is empty.
+            if (!endsOnLine)
+                space->readProperties(&position, end);
+            space->rewind();
+        }
+        else
+        {
+            // Store "name value" as a name/value pair, or even just "name".
+            _properties.push_back(Property(_arena->intern(name, nameEnd - name), id ? _arena->intern(id, idEnd - id) : _arena->intern("", 0)));
+        }
     }
+    *text = position;
 }
 
 Properties::~Properties()
@@ -388,55 +640,8 @@ Properties::~Properties()
     }
 
     SAFE_DELETE(_variables);
-}
-
-void Properties::skipWhiteSpace(Stream* stream)
-{
-    signed char c;
-    do
-    {
-        c = readChar(stream);
-    } while (isspace(c) && c != EOF);
-
-    // If we are not at the end of the file, then since we found a
-    // non-whitespace character, we put the cursor back in front of it.
-    if (c != EOF)
-    {
-        if (stream->seek(-1, SEEK_CUR) == false)
-        {
-            GP_ERROR("Failed to seek backwards one character after skipping whitespace.");
-        }
-    }
-}
-
-char* Properties::trimWhiteSpace(char *str)
-{
-    if (str == NULL)
-    {
-        return str;
-    }
-
-    char *end;
-
-    // Trim leading space.
-    while (isspace(*str))
-        str++;
-
-    // All spaces?
-    if (*str == 0)  
-    {
-        return str;
-    }
-
-    // Trim trailing space.
-    end = str + strlen(str) - 1;
-    while (end > str && isspace(*end))
-        end--;
-
-    // Write new null terminator.
-    *(end+1) = 0;
-
-    return str;
+    SAFE_RELEASE(_overflow);
+    SAFE_RELEASE(_arena);
 }
 
 void Properties::resolveInheritance(const char* id)
@@ -458,10 +663,10 @@ void Properties::resolveInheritance(const char* id)
     while (derived)
     {
         // If the namespace has a parent ID, find the parent.
-        if (!derived->_parentID.empty())
+        if (derived->_parentID[0])
         {
             derived->_visited = true;
-            Properties* parent = getNamespace(derived->_parentID.c_str());
+            Properties* parent = getNamespace(derived->_parentID);
             if (parent)
             {
                 GP_ASSERT(!parent->_visited);
@@ -523,7 +728,7 @@ void Properties::mergeWith(Properties* overrides)
         this->setString(name, overrides->getString());
         name = overrides->getNextProperty();
     }
-    this->_propertiesItr = this->_properties.end();
+    this->_propertiesIndex = PROPERTIES_END;
 
     // Merge all common nested namespaces, add new ones.
     Properties* overridesNamespace = overrides->getNextNamespace();
@@ -560,18 +765,23 @@ void Properties::mergeWith(Properties* overrides)
 
 const char* Properties::getNextProperty()
 {
-    if (_propertiesItr == _properties.end())
+    if (_propertiesIndex >= _properties.size())
     {
         // Restart from the beginning
-        _propertiesItr = _properties.begin();
+        _propertiesIndex = 0;
     }
     else
     {
         // Move to the next property
-        ++_propertiesItr;
+        ++_propertiesIndex;
     }
 
-    return _propertiesItr == _properties.end() ? NULL : _propertiesItr->name.c_str();
+    if (_propertiesIndex >= _properties.size())
+    {
+        _propertiesIndex = PROPERTIES_END;
+        return NULL;
+    }
+    return _properties[_propertiesIndex].name;
 }
 
 Properties* Properties::getNextNamespace()
@@ -597,7 +807,7 @@ Properties* Properties::getNextNamespace()
 
 void Properties::rewind()
 {
-    _propertiesItr = _properties.end();
+    _propertiesIndex = PROPERTIES_END;
     _namespacesItr = _namespaces.end();
 }
 
@@ -608,7 +818,7 @@ Properties* Properties::getNamespace(const char* id, bool searchNames, bool recu
     for (std::vector<Properties*>::const_iterator it = _namespaces.begin(); it < _namespaces.end(); ++it)
     {
         Properties* p = *it;
-        if (strcmp(searchNames ? p->_namespace.c_str() : p->_id.c_str(), id) == 0)
+        if (strcmp(searchNames ? p->_namespace : p->_id, id) == 0)
             return p;
         
         if (recurse)
@@ -625,12 +835,12 @@ Properties* Properties::getNamespace(const char* id, bool searchNames, bool recu
 
 const char* Properties::getNamespace() const
 {
-    return _namespace.c_str();
+    return _namespace;
 }
 
 const char* Properties::getId() const
 {
-    return _id.c_str();
+    return _id;
 }
 
 bool Properties::exists(const char* name) const
@@ -638,13 +848,89 @@ bool Properties::exists(const char* name) const
     if (name == NULL)
         return false;
 
-    for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+    return findProperty(name) != NULL;
+}
+
+Properties::Property* Properties::findProperty(const char* name) const
+{
+    if (name == NULL)
     {
-        if (itr->name == name)
-            return true;
+        // The current property
+        if (_propertiesIndex < _properties.size())
+            return const_cast<Property*>(&_properties[_propertiesIndex]);
+        return NULL;
     }
 
-    return false;
+    // A name that is not in the file is not a property of any namespace; otherwise
+    // the names of the namespace are compared by address.
+    const char* key = _arena->find(name);
+    if (key == NULL && _overflow)
+        key = _overflow->find(name);
+    if (key == NULL)
+        return NULL;
+    for (size_t i = 0, count = _properties.size(); i < count; ++i)
+    {
+        if (_properties[i].name == key)
+            return const_cast<Property*>(&_properties[i]);
+    }
+    return NULL;
+}
+
+const float* Properties::getCachedValues(const char* name, unsigned int count) const
+{
+    const Property* property = findProperty(name);
+    if (property == NULL || property->cacheCount != count)
+        return NULL;
+    return &_values[property->cacheOffset];
+}
+
+void Properties::setCachedValues(const char* name, const float* values, unsigned int count) const
+{
+    // Values that refer to variables may change with the variable
+    Property* property = findProperty(name);
+    if (property == NULL || property->cacheCount != 0 || (property->value[0] == '$' && property->value[1] == '{'))
+        return;
+
+    // A property set again reuses the room of the numbers parsed from its old value
+    if (property->cacheSize < count)
+    {
+        property->cacheOffset = (unsigned int)_values.size();
+        property->cacheSize = count;
+        _values.resize(_values.size() + count);
+    }
+    property->cacheCount = count;
+    std::copy(values, values + count, _values.begin() + property->cacheOffset);
+}
+
+const char* Properties::intern(const char* str)
+{
+    GP_ASSERT(str);
+
+    const char* stored = _arena->find(str);
+    if (stored)
+        return stored;
+    if (!_arena->frozen)
+        return _arena->intern(str, strlen(str));
+    if (!_overflow)
+        _overflow = new Arena(0);
+    return _overflow->intern(str, strlen(str));
+}
+
+void Properties::internStrings()
+{
+    for (size_t i = 0, count = _properties.size(); i < count; ++i)
+    {
+        _properties[i].name = intern(_properties[i].name);
+        _properties[i].value = intern(_properties[i].value);
+    }
+    if (_variables)
+    {
+        for (size_t i = 0, count = _variables->size(); i < count; ++i)
+        {
+            (*_variables)[i].name = intern((*_variables)[i].name);
+            (*_variables)[i].value = intern((*_variables)[i].value);
+        }
+    }
 }
 
 static const bool isStringNumeric(const char* str)
@@ -720,30 +1006,17 @@ const char* Properties::getString(const char* name, const char* defaultValue) co
     char variable[256];
     const char* value = NULL;
 
-    if (name)
+    // If 'name' is a variable, return the variable value
+    if (name && isVariable(name, variable, 256))
     {
-        // If 'name' is a variable, return the variable value
-        if (isVariable(name, variable, 256))
-        {
-            return getVariable(variable, defaultValue);
-        }
-
-        for (std::list<Property>::const_iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
-        {
-            if (itr->name == name)
-            {
-                value = itr->value.c_str();
-                break;
-            }
-        }
+        return getVariable(variable, defaultValue);
     }
-    else
+
+    // If no name is provided, get the value at the current iterator position
+    const Property* property = findProperty(name);
+    if (property)
     {
-        // No name provided - get the value at the current iterator position
-        if (_propertiesItr != _properties.end())
-        {
-            value = _propertiesItr->value.c_str();
-        }
+        value = property->value;
     }
 
     if (value)
@@ -760,28 +1033,24 @@ const char* Properties::getString(const char* name, const char* defaultValue) co
 
 bool Properties::setString(const char* name, const char* value)
 {
-    if (name)
+    // Update the first property that matches this name, or the current property
+    Property* property = findProperty(name);
+    if (property == NULL && name == NULL)
+        return false;
+
+    const char* str = intern(value ? value : "");
+    if (property)
     {
-        for (std::list<Property>::iterator itr = _properties.begin(); itr != _properties.end(); ++itr)
+        if (property->value != str)
         {
-            if (itr->name == name)
-            {
-                // Update the first property that matches this name
-                itr->value = value ? value : "";
-                return true;
-            }
+            property->value = str;
+            property->cacheCount = 0;
         }
-
-        // There is no property with this name, so add one
-        _properties.push_back(Property(name, value ? value : ""));
     }
     else
     {
-        // If there's a current property, set its value
-        if (_propertiesItr == _properties.end())
-            return false;
-
-        _propertiesItr->value = value ? value : "";
+        // There is no property with this name, so add one
+        _properties.push_back(Property(intern(name), str));
     }
 
     return true;
@@ -819,6 +1088,10 @@ int Properties::getInt(const char* name) const
 
 float Properties::getFloat(const char* name) const
 {
+    const float* cached = getCachedValues(name, 1);
+    if (cached)
+        return *cached;
+
     const char* valueString = getString(name);
     if (valueString)
     {
@@ -830,6 +1103,7 @@ float Properties::getFloat(const char* name) const
             GP_ERROR("Error attempting to parse property '%s' as a float.", name);
             return 0.0f;
         }
+        setCachedValues(name, &value, 1);
         return value;
     }
 
@@ -859,6 +1133,13 @@ bool Properties::getMatrix(const char* name, kmMat4* out) const
 {
     GP_ASSERT(out);
 
+    const float* cached = getCachedValues(name, 16);
+    if (cached)
+    {
+        memcpy(out->mat, cached, sizeof(float) * 16);
+        return true;
+    }
+
     const char* valueString = getString(name);
     if (valueString)
     {
@@ -878,6 +1159,7 @@ bool Properties::getMatrix(const char* name, kmMat4* out) const
 
 		//out->set(m);
 		memcpy(out->mat, m, sizeof(float) * 16);
+        setCachedValues(name, m, 16);
         return true;
     }
 
@@ -888,17 +1170,71 @@ bool Properties::getMatrix(const char* name, kmMat4* out) const
 
 bool Properties::getVector2(const char* name, kmVec2* out) const
 {
-    return parseVector2(getString(name), out);
+    const float* cached = getCachedValues(name, 2);
+    if (cached)
+    {
+        if (out)
+            kmVec2Fill(out, cached[0], cached[1]);
+        return true;
+    }
+
+    kmVec2 value;
+    if (!parseVector2(getString(name), &value))
+    {
+        if (out)
+            *out = value;
+        return false;
+    }
+    setCachedValues(name, &value.x, 2);
+    if (out)
+        *out = value;
+    return true;
 }
 
 bool Properties::getVector3(const char* name, kmVec3* out) const
 {
-    return parseVector3(getString(name), out);
+    const float* cached = getCachedValues(name, 3);
+    if (cached)
+    {
+        if (out)
+            kmVec3Fill(out, cached[0], cached[1], cached[2]);
+        return true;
+    }
+
+    kmVec3 value;
+    if (!parseVector3(getString(name), &value))
+    {
+        if (out)
+            *out = value;
+        return false;
+    }
+    setCachedValues(name, &value.x, 3);
+    if (out)
+        *out = value;
+    return true;
 }
 
 bool Properties::getVector4(const char* name, kmVec4* out) const
 {
-    return parseVector4(getString(name), out);
+    const float* cached = getCachedValues(name, 4);
+    if (cached)
+    {
+        if (out)
+            kmVec4Fill(out, cached[0], cached[1], cached[2], cached[3]);
+        return true;
+    }
+
+    kmVec4 value;
+    if (!parseVector4(getString(name), &value))
+    {
+        if (out)
+            *out = value;
+        return false;
+    }
+    setCachedValues(name, &value.x, 4);
+    if (out)
+        *out = value;
+    return true;
 }
 
 bool Properties::getQuaternionFromAxisAngle(const char* name, kmQuaternion* out) const
@@ -922,7 +1258,10 @@ bool Properties::getPath(const char* name, std::string* path) const
     const char* valueString = getString(name);
     if (valueString)
     {
-        if (FileSystem::fileExists(valueString))
+        // A path may name something within the file after a '#', such as an image in a texture atlas
+        const char* fragment = strchr(valueString, '#');
+        std::string file(valueString, fragment ? fragment - valueString : strlen(valueString));
+        if (FileSystem::fileExists(file.c_str()))
         {
             path->assign(valueString);
             return true;
@@ -937,9 +1276,11 @@ bool Properties::getPath(const char* name, std::string* path) const
                 if (dirPath != NULL && !dirPath->empty())
                 {
                     std::string relativePath = *dirPath;
-                    relativePath.append(valueString);
+                    relativePath.append(file);
                     if (FileSystem::fileExists(relativePath.c_str()))
                     {
+                        if (fragment)
+                            relativePath.append(fragment);
                         path->assign(relativePath);
                         return true;
                     }
@@ -962,8 +1303,8 @@ const char* Properties::getVariable(const char* name, const char* defaultValue)
         for (size_t i = 0, count = _variables->size(); i < count; ++i)
         {
             Property& prop = (*_variables)[i];
-            if (prop.name == name)
-                return prop.value.c_str();
+            if (strcmp(prop.name, name) == 0)
+                return prop.value;
         }
     }
 
@@ -976,6 +1317,7 @@ void Properties::setVariable(const char* name, const char* value)
     GP_ASSERT(name);
 
     Property* prop = NULL;
+    Properties* owner = NULL;
 
     // Search for variable in this Properties object and parents
     Properties* current = const_cast<Properties*>(this);
@@ -986,9 +1328,10 @@ void Properties::setVariable(const char* name, const char* value)
             for (size_t i = 0, count = current->_variables->size(); i < count; ++i)
             {
                 Property* p = &(*current->_variables)[i];
-                if (p->name == name)
+                if (strcmp(p->name, name) == 0)
                 {
                     prop = p;
+                    owner = current;
                     break;
                 }
             }
@@ -999,27 +1342,36 @@ void Properties::setVariable(const char* name, const char* value)
     if (prop)
     {
         // Found an existing property, set it
-        prop->value = value ? value : "";
+        value = value ? value : "";
+        prop->value = owner->intern(value);
     }
     else
     {
         // Add a new variable with this name
         if (!_variables)
             _variables = new std::vector<Property>();
-        _variables->push_back(Property(name, value ? value : ""));
+        value = value ? value : "";
+        _variables->push_back(Property(intern(name), intern(value)));
     }
 }
 
 Properties* Properties::clone()
 {
-    Properties* p = new Properties();
+    // The clone shares the strings of the file and copies the numbers parsed so far.
+    // Strings set on this namespace since go to the clone's own overflow arena.
+    Properties* p = new Properties(_arena);
     
     p->_namespace = _namespace;
     p->_id = _id;
     p->_parentID = _parentID;
     p->_properties = _properties;
-    p->_propertiesItr = p->_properties.end();
+    p->_values = _values;
+    p->_propertiesIndex = PROPERTIES_END;
     p->setDirectoryPath(_dirPath);
+    if (_variables)
+        p->_variables = new std::vector<Property>(*_variables);
+    if (_overflow)
+        p->internStrings();
 
     for (size_t i = 0, count = _namespaces.size(); i < count; i++)
     {
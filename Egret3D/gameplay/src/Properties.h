@@ -148,6 +148,10 @@ public:
      * Creates a Properties runtime settings from the specified URL, where the URL is of
      * the format "<file-path>.<extension>#<namespace-id>/<namespace-id>/.../<namespace-id>"
      * (and "#<namespace-id>/<namespace-id>/.../<namespace-id>" is optional).
+     *
+     * Each file is parsed once and kept until it is modified, so creating Properties from
+     * many namespaces of one file does not read it again. The file may also be in the binary
+     * form written by the encoder, which is already inheritance-resolved.
      * 
      * @param url The URL to create the properties from.
      * 
@@ -405,6 +409,8 @@ public:
      * 
      * This method will first search for the file relative to the working directory.
      * If the file is not found then it will search relative to the directory the bundle file is in.
+     * Anything after a '#' in the path, such as the name of an image in a texture atlas, is kept
+     * but not part of the file looked for.
      * 
      * @param name The name of the property.
      * @param path The string to copy the path to if the file exists.
@@ -509,39 +515,100 @@ public:
 
 private:
     
+    class Arena;
+
     /**
      * Internal structure containing a single property.
+     *
+     * The name and value are interned in the arena of the file, or in the overflow arena
+     * of the namespace for strings set after the file was parsed. Numbers parsed from the
+     * value are kept by the namespace, so they are parsed once.
      */
     struct Property
     {
-        std::string name;
-        std::string value;
-        Property(const char* name, const char* value) : name(name), value(value) { }
+        const char* name;
+        const char* value;
+        unsigned int cacheOffset;
+        unsigned int cacheCount;
+        unsigned int cacheSize;
+        Property(const char* name, const char* value) : name(name), value(value), cacheOffset(0), cacheCount(0), cacheSize(0) { }
     };
 
     /**
-     * Constructor.
+     * Constructor. Creates an empty namespace with an arena of its own.
      */
     Properties();
 
     /**
-     * Constructs the Properties class from a file.
-     *
-     * @param stream The stream used for reading the properties from file.
+     * Constructor. Creates an empty namespace sharing the arena of a file.
      */
-    Properties(Stream* stream);
+    Properties(Arena* arena);
+
     Properties(const Properties& copy);
 
     /**
-     * Constructor. Read from the beginning of namespace specified.
+     * Constructor. Creates a named namespace of a file, to be read by readProperties().
+     */
+    Properties(Arena* arena, const char* name, const char* id, const char* parentID, Properties* parent);
+
+    /**
+     * Parses the text of a namespace up to its closing brace.
+     */
+    void readProperties(const char** text, const char* end);
+
+    /**
+     * Reads a namespace of the binary form written by the encoder.
+     *
+     * @return True if the namespace was read.
+     */
+    bool readBinary(const unsigned char** data, const unsigned char* end, const std::vector<const char*>& strings);
+
+    /**
+     * Gets the parsed, inheritance-resolved contents of a file, reading it if it is not cached or has changed.
+     *
+     * @return The root namespace of the file, owned by the cache, or NULL if it could not be read.
+     */
+    static Properties* loadFile(const char* path);
+
+    /**
+     * Reads a file in the binary form written by the encoder.
+     */
+    static Properties* loadBinary(const unsigned char* data, size_t size, const char* path);
+
+    /**
+     * Empties the cache of parsed files.
+     */
+    static void finalize();
+
+    /**
+     * Gets the stored copy of a string for this namespace.
+     *
+     * Strings not in the arena of the file once it is parsed are stored in the overflow
+     * arena of the namespace, so the arena shared by clones of the file never changes.
+     */
+    const char* intern(const char* str);
+
+    /**
+     * Stores the strings of the properties and variables in the arenas of this namespace.
+     *
+     * Called on copies of namespaces whose strings may be in the overflow arena of another.
      */
-    Properties(Stream* stream, const char* name, const char* id, const char* parentID, Properties* parent);
+    void internStrings();
 
-    void readProperties(Stream* stream);
+    /**
+     * Finds a property by name, or the current property if the name is NULL.
+     */
+    Property* findProperty(const char* name) const;
 
-    void skipWhiteSpace(Stream* stream);
+    /**
+     * Gets the numbers parsed from a property before, or NULL if they have not been parsed.
+     */
+    const float* getCachedValues(const char* name, unsigned int count) const;
 
-    char* trimWhiteSpace(char* str);
+    /**
+     * Keeps the numbers parsed from a property.
+     */
+    void setCachedValues(const char* name, const float* values, unsigned int count) const;
 
     // Called after create(); copies info from parents into derived namespaces.
     void resolveInheritance(const char* id = NULL);
@@ -555,11 +622,14 @@ private:
     void setDirectoryPath(const std::string* path);
     void setDirectoryPath(const std::string& path);
 
-    std::string _namespace;
-    std::string _id;
-    std::string _parentID;
-    std::list<Property> _properties;
-    std::list<Property>::iterator _propertiesItr;
+    Arena* _arena;
+    Arena* _overflow;
+    const char* _namespace;
+    const char* _id;
+    const char* _parentID;
+    std::vector<Property> _properties;
+    mutable std::vector<float> _values;
+    size_t _propertiesIndex;
     std::vector<Properties*> _namespaces;
     std::vector<Properties*>::const_iterator _namespacesItr;
     std::vector<Property>* _variables;
@@ -10,9 +10,12 @@ void* trackRef(Ref* ref);
 void untrackRef(Ref* ref, void* record);
 #endif
 
+static std::atomic<unsigned int> __liveCount(0);
+
 Ref::Ref() :
     _refCount(1)
 {
+    ++__liveCount;
 #ifdef GP_USE_MEM_LEAK_DETECTION
     __record = trackRef(this);
 #endif
@@ -21,6 +24,7 @@ Ref::Ref() :
 Ref::Ref(const Ref& copy) :
     _refCount(1)
 {
+    ++__liveCount;
 #ifdef GP_USE_MEM_LEAK_DETECTION
     __record = trackRef(this);
 #endif
@@ -28,6 +32,7 @@ Ref::Ref(const Ref& copy) :
 
 Ref::~Ref()
 {
+    --__liveCount;
 }
 
 void Ref::addRef()
@@ -51,6 +56,18 @@ unsigned int Ref::getRefCount() const
     return _refCount;
 }
 
+unsigned int Ref::getLiveCount()
+{
+    return __liveCount.load();
+}
+
+#ifndef GP_USE_MEM_LEAK_DETECTION
+void Ref::getLiveCounts(std::map<std::string, unsigned int>& counts)
+{
+    counts.clear();
+}
+#endif
+
 #ifdef GP_USE_MEM_LEAK_DETECTION
 
 struct RefAllocationRecord
@@ -83,6 +100,17 @@ void Ref::printLeaks()
     }
 }
 
+void Ref::getLiveCounts(std::map<std::string, unsigned int>& counts)
+{
+    counts.clear();
+    for (RefAllocationRecord* rec = __refAllocations; rec != NULL; rec = rec->next)
+    {
+        GP_ASSERT(rec->ref);
+        const char* type = typeid(*rec->ref).name();
+        ++counts[type ? type : ""];
+    }
+}
+
 void* trackRef(Ref* ref)
 {
     GP_ASSERT(ref);
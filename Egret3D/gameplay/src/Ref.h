@@ -64,6 +64,18 @@ protected:
 
 private:
 
+    friend class PerformanceCounters;
+
+    /**
+     * Gets the number of Ref objects alive.
+     */
+    static unsigned int getLiveCount();
+
+    /**
+     * Gets the number of Ref objects alive of each type (only with GP_USE_MEM_LEAK_DETECTION).
+     */
+    static void getLiveCounts(std::map<std::string, unsigned int>& counts);
+
     unsigned int _refCount;
 
     // Memory leak diagnostic data (only included when GP_USE_MEM_LEAK_DETECTION is defined)
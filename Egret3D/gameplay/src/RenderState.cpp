@@ -1,5 +1,6 @@
 #include "Base.h"
 #include "RenderState.h"
+#include "PerformanceCounters.h"
 #include "Node.h"
 #include "Pass.h"
 #include "Technique.h"
@@ -405,6 +406,23 @@ void RenderState::bind(Pass* pass)
 {
     GP_ASSERT(pass);
 
+    bindStates();
+
+    // Apply parameter bindings for the entire hierarchy, top-down.
+    RenderState* rs = NULL;
+    Effect* effect = pass->getEffect();
+    while ((rs = getTopmost(rs)))
+    {
+        for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
+        {
+            GP_ASSERT(rs->_parameters[i]);
+            rs->_parameters[i]->bind(effect);
+        }
+    }
+}
+
+void RenderState::bindStates()
+{
     // Get the combined modified state bits for our RenderState hierarchy.
     long stateOverrideBits = _state ? _state->_bits : 0;
     RenderState* rs = _parent;
@@ -420,20 +438,46 @@ void RenderState::bind(Pass* pass)
     // Restore renderer state to its default, except for explicitly specified states
     StateBlock::restore(stateOverrideBits);
 
-    // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
+    // Apply renderer state for the entire hierarchy, top-down.
     rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
+        if (rs->_state)
+        {
+            rs->_state->bindNoRestore();
+        }
+    }
+}
+
+void RenderState::capture(Pass* pass, FramePacket* packet)
+{
+    GP_ASSERT(pass);
+    GP_ASSERT(packet);
+
+    RenderState* rs = NULL;
     Effect* effect = pass->getEffect();
     while ((rs = getTopmost(rs)))
     {
         for (size_t i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
             GP_ASSERT(rs->_parameters[i]);
-            rs->_parameters[i]->bind(effect);
+            rs->_parameters[i]->capture(effect, packet);
         }
+    }
+}
+
+void RenderState::captureStates(StateBlock* state)
+{
+    GP_ASSERT(state);
 
+    // Lower states override the ones above them, as they do when bound top-down.
+    state->_bits = 0;
+    RenderState* rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
         if (rs->_state)
         {
-            rs->_state->bindNoRestore();
+            rs->_state->mergeInto(state);
         }
     }
 }
@@ -536,9 +580,12 @@ void RenderState::StateBlock::bindNoRestore()
 {
     GP_ASSERT(_defaultState);
 
+    unsigned int changes = 0;
+
     // Update any state that differs from _defaultState and flip _defaultState bits
     if ((_bits & RS_BLEND) && (_blendEnabled != _defaultState->_blendEnabled))
     {
+        ++changes;
         if (_blendEnabled)
             GL_ASSERT( glEnable(GL_BLEND) );
         else
@@ -547,12 +594,14 @@ void RenderState::StateBlock::bindNoRestore()
     }
     if ((_bits & RS_BLEND_FUNC) && (_blendSrc != _defaultState->_blendSrc || _blendDst != _defaultState->_blendDst))
     {
+        ++changes;
         GL_ASSERT( glBlendFunc((GLenum)_blendSrc, (GLenum)_blendDst) );
         _defaultState->_blendSrc = _blendSrc;
         _defaultState->_blendDst = _blendDst;
     }
     if ((_bits & RS_CULL_FACE) && (_cullFaceEnabled != _defaultState->_cullFaceEnabled))
     {
+        ++changes;
         if (_cullFaceEnabled)
             GL_ASSERT( glEnable(GL_CULL_FACE) );
         else
@@ -561,16 +610,19 @@ void RenderState::StateBlock::bindNoRestore()
     }
     if ((_bits & RS_CULL_FACE_SIDE) && (_cullFaceSide != _defaultState->_cullFaceSide))
     {
+        ++changes;
         GL_ASSERT( glCullFace((GLenum)_cullFaceSide) );
         _defaultState->_cullFaceSide = _cullFaceSide;
     }
     if ((_bits & RS_FRONT_FACE) && (_frontFace != _defaultState->_frontFace))
     {
+        ++changes;
         GL_ASSERT( glFrontFace((GLenum)_frontFace) );
         _defaultState->_frontFace = _frontFace;
     }
     if ((_bits & RS_DEPTH_TEST) && (_depthTestEnabled != _defaultState->_depthTestEnabled))
     {
+        ++changes;
         if (_depthTestEnabled)
             GL_ASSERT( glEnable(GL_DEPTH_TEST) );
         else
@@ -579,16 +631,19 @@ void RenderState::StateBlock::bindNoRestore()
     }
     if ((_bits & RS_DEPTH_WRITE) && (_depthWriteEnabled != _defaultState->_depthWriteEnabled))
     {
+        ++changes;
         GL_ASSERT( glDepthMask(_depthWriteEnabled ? GL_TRUE : GL_FALSE) );
         _defaultState->_depthWriteEnabled = _depthWriteEnabled;
     }
     if ((_bits & RS_DEPTH_FUNC) && (_depthFunction != _defaultState->_depthFunction))
     {
+        ++changes;
         GL_ASSERT( glDepthFunc((GLenum)_depthFunction) );
         _defaultState->_depthFunction = _depthFunction;
     }
 	if ((_bits & RS_STENCIL_TEST) && (_stencilTestEnabled != _defaultState->_stencilTestEnabled))
     {
+        ++changes;
         if (_stencilTestEnabled)
 			GL_ASSERT( glEnable(GL_STENCIL_TEST) );
         else
@@ -597,6 +652,7 @@ void RenderState::StateBlock::bindNoRestore()
     }
 	if ((_bits & RS_STENCIL_WRITE) && (_stencilWrite != _defaultState->_stencilWrite))
     {
+        ++changes;
 		GL_ASSERT( glStencilMask(_stencilWrite) );
         _defaultState->_stencilWrite = _stencilWrite;
     }
@@ -604,6 +660,7 @@ void RenderState::StateBlock::bindNoRestore()
 										_stencilFunctionRef != _defaultState->_stencilFunctionRef ||
 										_stencilFunctionMask != _defaultState->_stencilFunctionMask))
     {
+        ++changes;
 		GL_ASSERT( glStencilFunc((GLenum)_stencilFunction, _stencilFunctionRef, _stencilFunctionMask) );
         _defaultState->_stencilFunction = _stencilFunction;
 		_defaultState->_stencilFunctionRef = _stencilFunctionRef;
@@ -613,6 +670,7 @@ void RenderState::StateBlock::bindNoRestore()
 									_stencilOpDpfail != _defaultState->_stencilOpDpfail ||
 									_stencilOpDppass != _defaultState->_stencilOpDppass))
     {
+        ++changes;
 		GL_ASSERT( glStencilOp((GLenum)_stencilOpSfail, (GLenum)_stencilOpDpfail, (GLenum)_stencilOpDppass) );
         _defaultState->_stencilOpSfail = _stencilOpSfail;
 		_defaultState->_stencilOpDpfail = _stencilOpDpfail;
@@ -620,6 +678,7 @@ void RenderState::StateBlock::bindNoRestore()
     }
 
     _defaultState->_bits |= _bits;
+    PerformanceCounters::add(PerformanceCounters::STATE_CHANGES, changes);
 }
 
 void RenderState::StateBlock::restore(long stateOverrideBits)
@@ -633,14 +692,17 @@ void RenderState::StateBlock::restore(long stateOverrideBits)
     }
 
     // Restore any state that is not overridden and is not default
+    unsigned int changes = 0;
     if (!(stateOverrideBits & RS_BLEND) && (_defaultState->_bits & RS_BLEND))
     {
+        ++changes;
         GL_ASSERT( glDisable(GL_BLEND) );
         _defaultState->_bits &= ~RS_BLEND;
         _defaultState->_blendEnabled = false;
     }
     if (!(stateOverrideBits & RS_BLEND_FUNC) && (_defaultState->_bits & RS_BLEND_FUNC))
     {
+        ++changes;
         GL_ASSERT( glBlendFunc(GL_ONE, GL_ZERO) );
         _defaultState->_bits &= ~RS_BLEND_FUNC;
         _defaultState->_blendSrc = RenderState::BLEND_ONE;
@@ -648,54 +710,63 @@ void RenderState::StateBlock::restore(long stateOverrideBits)
     }
     if (!(stateOverrideBits & RS_CULL_FACE) && (_defaultState->_bits & RS_CULL_FACE))
     {
+        ++changes;
         GL_ASSERT( glDisable(GL_CULL_FACE) );
         _defaultState->_bits &= ~RS_CULL_FACE;
         _defaultState->_cullFaceEnabled = false;
     }
     if (!(stateOverrideBits & RS_CULL_FACE_SIDE) && (_defaultState->_bits & RS_CULL_FACE_SIDE))
     {
+        ++changes;
         GL_ASSERT( glCullFace((GLenum)GL_BACK) );
         _defaultState->_bits &= ~RS_CULL_FACE_SIDE;
         _defaultState->_cullFaceSide = RenderState::CULL_FACE_SIDE_BACK;
     }
     if (!(stateOverrideBits & RS_FRONT_FACE) && (_defaultState->_bits & RS_FRONT_FACE))
     {
+        ++changes;
         GL_ASSERT( glFrontFace((GLenum)GL_CCW) );
         _defaultState->_bits &= ~RS_FRONT_FACE;
         _defaultState->_frontFace = RenderState::FRONT_FACE_CCW;
     }
     if (!(stateOverrideBits & RS_DEPTH_TEST) && (_defaultState->_bits & RS_DEPTH_TEST))
     {
+        ++changes;
         GL_ASSERT( glDisable(GL_DEPTH_TEST) );
         _defaultState->_bits &= ~RS_DEPTH_TEST;
         _defaultState->_depthTestEnabled = false;
     }
     if (!(stateOverrideBits & RS_DEPTH_WRITE) && (_defaultState->_bits & RS_DEPTH_WRITE))
     {
+        ++changes;
         GL_ASSERT( glDepthMask(GL_TRUE) );
         _defaultState->_bits &= ~RS_DEPTH_WRITE;
         _defaultState->_depthWriteEnabled = true;
     }
     if (!(stateOverrideBits & RS_DEPTH_FUNC) && (_defaultState->_bits & RS_DEPTH_FUNC))
     {
+        ++changes;
         GL_ASSERT( glDepthFunc((GLenum)GL_LESS) );
         _defaultState->_bits &= ~RS_DEPTH_FUNC;
         _defaultState->_depthFunction = RenderState::DEPTH_LESS;
     }
 	if (!(stateOverrideBits & RS_STENCIL_TEST) && (_defaultState->_bits & RS_STENCIL_TEST))
     {
+        ++changes;
         GL_ASSERT( glDisable(GL_STENCIL_TEST) );
         _defaultState->_bits &= ~RS_STENCIL_TEST;
         _defaultState->_stencilTestEnabled = false;
     }
 	if (!(stateOverrideBits & RS_STENCIL_WRITE) && (_defaultState->_bits & RS_STENCIL_WRITE))
     {
+        ++changes;
 		GL_ASSERT( glStencilMask(RS_ALL_ONES) );
         _defaultState->_bits &= ~RS_STENCIL_WRITE;
 		_defaultState->_stencilWrite = RS_ALL_ONES;
     }
 	if (!(stateOverrideBits & RS_STENCIL_FUNC) && (_defaultState->_bits & RS_STENCIL_FUNC))
     {
+        ++changes;
 		GL_ASSERT( glStencilFunc((GLenum)RenderState::STENCIL_ALWAYS, 0, RS_ALL_ONES) );
         _defaultState->_bits &= ~RS_STENCIL_FUNC;
         _defaultState->_stencilFunction = RenderState::STENCIL_ALWAYS;
@@ -704,12 +775,15 @@ void RenderState::StateBlock::restore(long stateOverrideBits)
     }
 	if (!(stateOverrideBits & RS_STENCIL_OP) && (_defaultState->_bits & RS_STENCIL_OP))
     {
+        ++changes;
 		GL_ASSERT( glStencilOp((GLenum)RenderState::STENCIL_OP_KEEP, (GLenum)RenderState::STENCIL_OP_KEEP, (GLenum)RenderState::STENCIL_OP_KEEP) );
         _defaultState->_bits &= ~RS_STENCIL_OP;
         _defaultState->_stencilOpSfail = RenderState::STENCIL_OP_KEEP;
 		_defaultState->_stencilOpDpfail = RenderState::STENCIL_OP_KEEP;
 		_defaultState->_stencilOpDppass = RenderState::STENCIL_OP_KEEP;
     }
+
+    PerformanceCounters::add(PerformanceCounters::STATE_CHANGES, changes);
 }
 
 void RenderState::StateBlock::enableDepthWrite()
@@ -751,6 +825,48 @@ void RenderState::StateBlock::cloneInto(StateBlock* state)
     state->_bits = _bits;
 }
 
+void RenderState::StateBlock::mergeInto(StateBlock* state) const
+{
+    GP_ASSERT(state);
+
+    if (_bits & RS_BLEND)
+        state->_blendEnabled = _blendEnabled;
+    if (_bits & RS_BLEND_FUNC)
+    {
+        state->_blendSrc = _blendSrc;
+        state->_blendDst = _blendDst;
+    }
+    if (_bits & RS_CULL_FACE)
+        state->_cullFaceEnabled = _cullFaceEnabled;
+    if (_bits & RS_CULL_FACE_SIDE)
+        state->_cullFaceSide = _cullFaceSide;
+    if (_bits & RS_FRONT_FACE)
+        state->_frontFace = _frontFace;
+    if (_bits & RS_DEPTH_TEST)
+        state->_depthTestEnabled = _depthTestEnabled;
+    if (_bits & RS_DEPTH_WRITE)
+        state->_depthWriteEnabled = _depthWriteEnabled;
+    if (_bits & RS_DEPTH_FUNC)
+        state->_depthFunction = _depthFunction;
+    if (_bits & RS_STENCIL_TEST)
+        state->_stencilTestEnabled = _stencilTestEnabled;
+    if (_bits & RS_STENCIL_WRITE)
+        state->_stencilWrite = _stencilWrite;
+    if (_bits & RS_STENCIL_FUNC)
+    {
+        state->_stencilFunction = _stencilFunction;
+        state->_stencilFunctionRef = _stencilFunctionRef;
+        state->_stencilFunctionMask = _stencilFunctionMask;
+    }
+    if (_bits & RS_STENCIL_OP)
+    {
+        state->_stencilOpSfail = _stencilOpSfail;
+        state->_stencilOpDpfail = _stencilOpDpfail;
+        state->_stencilOpDppass = _stencilOpDppass;
+    }
+    state->_bits |= _bits;
+}
+
 static bool parseBoolean(const char* value)
 {
     GP_ASSERT(value);
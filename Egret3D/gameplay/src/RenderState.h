@@ -12,6 +12,7 @@ class MaterialParameter;
 class Node;
 class NodeCloneContext;
 class Pass;
+class FramePacket;
 
 /**
  * Defines the rendering state of the graphics device.
@@ -23,6 +24,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class FramePacket;
 
 public:
 
@@ -442,6 +444,8 @@ public:
 
         void cloneInto(StateBlock* state);
 
+        void mergeInto(StateBlock* state) const;
+
         // States
         bool _cullFaceEnabled;
         bool _depthTestEnabled;
@@ -607,6 +611,24 @@ protected:
      */
     void bind(Pass* pass);
 
+    /**
+     * Binds the fixed-function render states of this RenderState and any of its parents,
+     * without their parameters.
+     */
+    void bindStates();
+
+    /**
+     * Records the parameter values of this RenderState and any of its parents, top-down,
+     * for the given pass into a frame packet.
+     */
+    void capture(Pass* pass, FramePacket* packet);
+
+    /**
+     * Copies the fixed-function render states of this RenderState and any of its parents
+     * into a single state block, so that binding the block sets the same states as bindStates.
+     */
+    void captureStates(StateBlock* state);
+
     /**
      * Returns the topmost RenderState in the hierarchy below the given RenderState.
      */
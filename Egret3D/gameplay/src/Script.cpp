@@ -4,7 +4,7 @@
 namespace egret
 {
 
-Script::Script() : _scope(GLOBAL), _env(0)
+Script::Script() : _scope(GLOBAL), _env(0), _version(0)
 {
 }
 
@@ -13,6 +13,7 @@ namespace egret
 class Script : public Ref
 {
     friend class ScriptController;
+    friend class ScriptTarget;
 
 public:
 
@@ -111,6 +112,7 @@ private:
     std::string _path;
     Scope _scope;
     int _env;
+    unsigned int _version;
 
 };
 
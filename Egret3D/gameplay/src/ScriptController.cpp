@@ -221,6 +221,9 @@ bool ScriptController::loadScript(Script* script)
     std::vector<Script*>& scripts = _scripts[script->_path];
     scripts.push_back(script);
 
+    // Invalidate any functions bound against a previous load of this script
+    ++script->_version;
+
     // Load the contents of the script, but don't execute it yet
     const char* scriptSource = FileSystem::readAll(script->_path.c_str());
     int ret = luaL_loadstring(_lua, scriptSource); // [chunk]
@@ -802,6 +805,34 @@ void ScriptController::executeFunctionHelper(int resultCount, const char* func,
         return;
     }
 
+    callFunctionHelper(resultCount, func, args, list, script);
+}
+
+void ScriptController::executeFunctionRefHelper(int resultCount, int functionRef, const char* args, va_list* list, Script* script)
+{
+    if (!_lua)
+        return; // handles calling this method after script is finalized
+
+    if (functionRef == LUA_NOREF || functionRef == LUA_REFNIL)
+    {
+        GP_ERROR("Lua function reference must be valid.");
+        return;
+    }
+
+    if (!script && !_envStack.empty())
+    {
+        // Execute in the currently running script's environment
+        script = _envStack.back();
+    }
+
+    // Push the bound function directly; no name lookup is needed.
+    lua_rawgeti(_lua, LUA_REGISTRYINDEX, functionRef);
+
+    callFunctionHelper(resultCount, NULL, args, list, script);
+}
+
+void ScriptController::callFunctionHelper(int resultCount, const char* func, const char* args, va_list* list, Script* script)
+{
     const char* sig = args;
     int argumentCount = 0;
 
@@ -906,11 +937,37 @@ void ScriptController::executeFunctionHelper(int resultCount, const char* func,
 
     // Perform the function call.
     if (lua_pcall(_lua, argumentCount, resultCount, 0) != 0)
-        GP_WARN("Failed to call function '%s' with error '%s'.", func, lua_tostring(_lua, -1));
+        GP_WARN("Failed to call function '%s' with error '%s'.", func ? func : "<bound>", lua_tostring(_lua, -1));
 
     popScript();
 }
 
+int ScriptController::bindFunction(const char* func, Script* script)
+{
+    GP_ASSERT(func);
+
+    if (!_lua)
+        return LUA_NOREF;
+
+    int top = lua_gettop(_lua);
+    int ref = LUA_NOREF;
+    if (getNestedVariable(_lua, func, script ? script->_env : 0) && lua_isfunction(_lua, -1))
+    {
+        // Store the function in the registry (this pops it).
+        ref = luaL_ref(_lua, LUA_REGISTRYINDEX);
+    }
+    lua_settop(_lua, top);
+
+    return ref;
+}
+
+void ScriptController::unbindFunction(int functionRef)
+{
+    // The registry is freed along with the Lua state, so refs released after finalize are ignored.
+    if (_lua && functionRef != LUA_NOREF && functionRef != LUA_REFNIL)
+        luaL_unref(_lua, LUA_REGISTRYINDEX, functionRef);
+}
+
 int ScriptController::convert(lua_State* state)
 {
     // Get the number of parameters.
@@ -1426,6 +1483,44 @@ template<> bool ScriptController::executeFunction<bool>(Script* script, const ch
     SCRIPT_EXECUTE_FUNCTION_PARAM_LIST(script, bool, ScriptUtil::luaCheckBool);
 }
 
+/** Template specialization. */
+template<> void ScriptController::executeFunctionRef<void>(Script* script, int functionRef, const char* args, ...)
+{
+    va_list list;
+    va_start(list, args);
+    executeFunctionRefHelper(0, functionRef, args, &list, script);
+    va_end(list);
+}
+
+/** Template specialization. */
+template<> bool ScriptController::executeFunctionRef<bool>(Script* script, int functionRef, const char* args, ...)
+{
+    int top = lua_gettop(_lua);
+    va_list list;
+    va_start(list, args);
+    executeFunctionRefHelper(1, functionRef, args, &list, script);
+    bool value = ScriptUtil::luaCheckBool(_lua, -1);
+    va_end(list);
+    lua_settop(_lua, top);
+    return value;
+}
+
+/** Template specialization. */
+template<> void ScriptController::executeFunctionRef<void>(Script* script, int functionRef, const char* args, va_list* list)
+{
+    executeFunctionRefHelper(0, functionRef, args, list, script);
+}
+
+/** Template specialization. */
+template<> bool ScriptController::executeFunctionRef<bool>(Script* script, int functionRef, const char* args, va_list* list)
+{
+    int top = lua_gettop(_lua);
+    executeFunctionRefHelper(1, functionRef, args, list, script);
+    bool value = ScriptUtil::luaCheckBool(_lua, -1);
+    lua_settop(_lua, top);
+    return value;
+}
+
 /** Template specialization. */
 template<> char ScriptController::executeFunction<char>(Script* script, const char* func, const char* args, va_list* list)
 {
@@ -175,6 +175,59 @@ public:
      */
     template<typename T> T executeFunction(Script* script, const char* func, const char* args, va_list* list);
 
+    /**
+     * Resolves the specified script function once and binds it to a reference in the
+     * Lua registry, so that it can later be called through executeFunctionRef without
+     * any name parsing or table lookups.
+     *
+     * Bound references must be released with unbindFunction when no longer needed.
+     *
+     * @param func The name of the function to bind (may be a '.' separated list of nested tables).
+     * @param script Optional script to resolve the function in, or NULL for the global script environment.
+     *
+     * @return The bound function reference, or LUA_NOREF if no such function exists.
+     *
+     * @script{ignore}
+     */
+    int bindFunction(const char* func, Script* script = NULL);
+
+    /**
+     * Releases a function reference previously returned from bindFunction.
+     *
+     * @param functionRef The bound function reference to release.
+     *
+     * @script{ignore}
+     */
+    void unbindFunction(int functionRef);
+
+    /**
+     * Calls a function previously bound with bindFunction using the given parameters.
+     *
+     * @param script Optional script to execute the function in, or NULL for the global script environment.
+     * @param functionRef The bound function reference.
+     * @param args The optional argument signature of the function (see executeFunction).
+     * @param ... The variable argument list containing the function's parameters.
+     *
+     * @return The return value of the executed Lua function.
+     *
+     * @script{ignore}
+     */
+    template<typename T> T executeFunctionRef(Script* script, int functionRef, const char* args, ...);
+
+    /**
+     * Calls a function previously bound with bindFunction using the given parameters.
+     *
+     * @param script Optional script to execute the function in, or NULL for the global script environment.
+     * @param functionRef The bound function reference.
+     * @param args The optional argument signature of the function (see executeFunction).
+     * @param list The variable argument list containing the function's parameters, or NULL for an empty parameter list.
+     *
+     * @return The return value of the executed Lua function.
+     *
+     * @script{ignore}
+     */
+    template<typename T> T executeFunctionRef(Script* script, int functionRef, const char* args, va_list* list);
+
     /**
      * Gets the global boolean script variable with the given name.
      * 
@@ -644,6 +697,28 @@ private:
      */
     void executeFunctionHelper(int resultCount, const char* func, const char* args, va_list* list, Script* script = NULL);
 
+    /**
+     * Calls the bound Lua function using the given parameters.
+     *
+     * @param resultCount The expected number of returned values.
+     * @param functionRef The function reference returned from bindFunction.
+     * @param args The optional argument signature of the function (see executeFunctionHelper).
+     * @param list The variable argument list.
+     * @param script Optional script to execute the function in, or NULL for to execute it in the global environment.
+     */
+    void executeFunctionRefHelper(int resultCount, int functionRef, const char* args, va_list* list, Script* script = NULL);
+
+    /**
+     * Pushes the given arguments and calls the function that is on the top of the Lua stack.
+     *
+     * @param resultCount The expected number of returned values.
+     * @param func The name of the function, used for error reporting.
+     * @param args The optional argument signature of the function (see executeFunctionHelper).
+     * @param list The variable argument list.
+     * @param script The script to execute the function in, or NULL for the global environment.
+     */
+    void callFunctionHelper(int resultCount, const char* func, const char* args, va_list* list, Script* script);
+
     /**
      * Converts a Gameplay userdata value to the type with the given class name.
      * This function will change the metatable of the userdata value to the metatable that matches the given string.
@@ -854,6 +929,15 @@ template<> double ScriptController::executeFunction<double>(Script* script, cons
 /** Template specialization. */
 template<> std::string ScriptController::executeFunction<std::string>(Script* script, const char* func, const char* args, va_list* list);
 
+/** Template specialization. */
+template<> void ScriptController::executeFunctionRef<void>(Script* script, int functionRef, const char* args, ...);
+/** Template specialization. */
+template<> bool ScriptController::executeFunctionRef<bool>(Script* script, int functionRef, const char* args, ...);
+/** Template specialization. */
+template<> void ScriptController::executeFunctionRef<void>(Script* script, int functionRef, const char* args, va_list* list);
+/** Template specialization. */
+template<> bool ScriptController::executeFunctionRef<bool>(Script* script, int functionRef, const char* args, va_list* list);
+
 /**
  * Functions and structures used by the generated Lua script bindings.
  *
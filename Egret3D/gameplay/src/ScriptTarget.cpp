@@ -9,6 +9,12 @@ namespace egret
 
 extern void splitURL(const std::string& url, std::string* file, std::string* id);
 
+unsigned int ScriptTarget::_scriptEventsFired = 0;
+unsigned int ScriptTarget::_scriptEventsSkipped = 0;
+unsigned int ScriptTarget::_scriptEventsFiredLastFrame = 0;
+unsigned int ScriptTarget::_scriptEventsSkippedLastFrame = 0;
+bool ScriptTarget::_scriptCallbackBinding = true;
+
 const char* ScriptTarget::Event::getName() const
 {
     return name.c_str();
@@ -35,9 +41,13 @@ const ScriptTarget::Event* ScriptTarget::EventRegistry::addEvent(const char* nam
 {
     GP_ASSERT(name);
 
+    // Assign each event a mask bit, shared by all ScriptTargets
+    static unsigned int eventCount = 0;
+
     Event* evt = new Event;
     evt->name = name;
     evt->args = args ? args : "";
+    evt->mask = 1u << (eventCount++ % 32);
 
     _events.push_back(evt);
 
@@ -69,13 +79,23 @@ const ScriptTarget::Event* ScriptTarget::EventRegistry::getEvent(const char* nam
     return NULL;
 }
 
-ScriptTarget::ScriptTarget() : _scriptRegistries(NULL), _scripts(NULL), _scriptCallbacks(NULL)
+ScriptTarget::ScriptTarget() : _scriptRegistries(NULL), _scripts(NULL), _scriptCallbacks(NULL), _scriptEventMask(0)
 {
 }
 
 ScriptTarget::~ScriptTarget()
 {
     // Free callbacks
+    if (_scriptCallbacks)
+    {
+        std::map<const Event*, std::vector<CallbackFunction>>::iterator itr = _scriptCallbacks->begin();
+        for (; itr != _scriptCallbacks->end(); ++itr)
+        {
+            std::vector<CallbackFunction>& callbacks = itr->second;
+            for (size_t i = 0, count = callbacks.size(); i < count; ++i)
+                unbindScriptCallback(callbacks[i]);
+        }
+    }
     SAFE_DELETE(_scriptCallbacks);
 
     // Free scripts
@@ -160,6 +180,7 @@ Script* ScriptTarget::addScript(const char* path)
                 if (!_scriptCallbacks)
                     _scriptCallbacks = new std::map<const Event*, std::vector<CallbackFunction>>();
                 (*_scriptCallbacks)[event].push_back(CallbackFunction(script, event->name.c_str()));
+                _scriptEventMask |= event->mask;
             }
         }
         re = re->next;
@@ -222,11 +243,15 @@ void ScriptTarget::removeScript(ScriptEntry* se)
             while (itr2 != callbacks.end())
             {
                 if (itr2->script == script)
+                {
+                    unbindScriptCallback(*itr2);
                     itr2 = callbacks.erase(itr2);
+                }
                 else
                     ++itr2;
             }
         }
+        updateScriptEventMask();
     }
 
     // Free the script
@@ -301,6 +326,7 @@ void ScriptTarget::addScriptCallback(const Event* event, const char* function)
         if (!_scriptCallbacks)
             _scriptCallbacks = new std::map<const Event*, std::vector<CallbackFunction>>();
         (*_scriptCallbacks)[event].push_back(CallbackFunction(script, func.c_str()));
+        _scriptEventMask |= event->mask;
     }
 }
 
@@ -352,6 +378,7 @@ void ScriptTarget::removeScriptCallback(const Event* event, const char* function
                     ++totalCallbacks; // sum total number of callbacks found for this script
                     if (forEvent && itr2->function == func)
                     {
+                        unbindScriptCallback(*itr2);
                         itr2 = callbacks.erase(itr2);
                         ++removedCallbacks; // sum number of callbacks removed
                     }
@@ -362,6 +389,9 @@ void ScriptTarget::removeScriptCallback(const Event* event, const char* function
         }
     }
 
+    if (removedCallbacks > 0)
+        updateScriptEventMask();
+
     // Cleanup the script if there are no remaining callbacks for it
     if (scriptEntry && (totalCallbacks - removedCallbacks) <= 0)
     {
@@ -404,7 +434,7 @@ bool ScriptTarget::hasScriptListener(const Event* event) const
 {
     GP_ASSERT(event);
 
-    if (_scriptCallbacks)
+    if (_scriptCallbacks && (_scriptEventMask & event->mask))
     {
         std::map<const Event*, std::vector<CallbackFunction>>::iterator itr = _scriptCallbacks->find(event);
         if (itr != _scriptCallbacks->end())
@@ -416,11 +446,74 @@ bool ScriptTarget::hasScriptListener(const Event* event) const
     return false;
 }
 
+bool ScriptTarget::bindScriptCallback(CallbackFunction& callback)
+{
+    // Re-bind if the owning script has been reloaded since the function was bound
+    unsigned int version = callback.script ? callback.script->_version : 0;
+    if (callback.resolved && callback.version == version)
+        return callback.functionRef != LUA_NOREF;
+
+    ScriptController* sc = Game::getInstance()->getScriptController();
+    sc->unbindFunction(callback.functionRef);
+    callback.functionRef = sc->bindFunction(callback.function.c_str(), callback.script);
+    callback.version = version;
+    callback.resolved = true;
+
+    return callback.functionRef != LUA_NOREF;
+}
+
+void ScriptTarget::unbindScriptCallback(CallbackFunction& callback)
+{
+    if (callback.functionRef != LUA_NOREF)
+    {
+        Game::getInstance()->getScriptController()->unbindFunction(callback.functionRef);
+        callback.functionRef = LUA_NOREF;
+    }
+    callback.resolved = false;
+}
+
+void ScriptTarget::updateScriptEventMask()
+{
+    _scriptEventMask = 0;
+    if (_scriptCallbacks)
+    {
+        std::map<const Event*, std::vector<CallbackFunction>>::iterator itr = _scriptCallbacks->begin();
+        for (; itr != _scriptCallbacks->end(); ++itr)
+        {
+            if (!itr->second.empty())
+                _scriptEventMask |= itr->first->mask;
+        }
+    }
+}
+
+unsigned int ScriptTarget::getScriptEventsFired()
+{
+    return _scriptEventsFiredLastFrame;
+}
+
+unsigned int ScriptTarget::getScriptEventsSkipped()
+{
+    return _scriptEventsSkippedLastFrame;
+}
+
+void ScriptTarget::setScriptCallbackBinding(bool enabled)
+{
+    _scriptCallbackBinding = enabled;
+}
+
+void ScriptTarget::resetScriptEventCounters()
+{
+    _scriptEventsFiredLastFrame = _scriptEventsFired;
+    _scriptEventsSkippedLastFrame = _scriptEventsSkipped;
+    _scriptEventsFired = 0;
+    _scriptEventsSkipped = 0;
+}
+
 template<> void ScriptTarget::fireScriptEvent<void>(const Event* event, ...)
 {
     GP_ASSERT(event);
 
-    if (!_scriptCallbacks)
+    if (!hasScriptEventHandler(event))
         return; // no registered callbacks
 
     va_list list;
@@ -428,14 +521,20 @@ template<> void ScriptTarget::fireScriptEvent<void>(const Event* event, ...)
 
     // Lookup registered callbacks for this event and fire them
     std::map<const Event*, std::vector<CallbackFunction>>::iterator itr = _scriptCallbacks->find(event);
-    if (itr != _scriptCallbacks->end())
+    if (itr != _scriptCallbacks->end() && !itr->second.empty())
     {
+        ++_scriptEventsFired;
         ScriptController* sc = Game::getInstance()->getScriptController();
         std::vector<CallbackFunction>& callbacks = itr->second;
         for (size_t i = 0, count = callbacks.size(); i < count; ++i)
         {
             CallbackFunction& cb = callbacks[i];
-            sc->executeFunction<void>(cb.script, cb.function.c_str(), event->args.c_str(), &list);
+            // An unresolved function is called by name, which can still find a global
+            // callback in the environment of the script that is currently running.
+            if (_scriptCallbackBinding && bindScriptCallback(cb))
+                sc->executeFunctionRef<void>(cb.script, cb.functionRef, event->args.c_str(), &list);
+            else
+                sc->executeFunction<void>(cb.script, cb.function.c_str(), event->args.c_str(), &list);
         }
     }
 
@@ -446,7 +545,7 @@ template<> bool ScriptTarget::fireScriptEvent<bool>(const Event* event, ...)
 {
     GP_ASSERT(event);
 
-    if (!_scriptCallbacks)
+    if (!hasScriptEventHandler(event))
         return false; // no registered callbacks
 
     va_list list;
@@ -454,14 +553,18 @@ template<> bool ScriptTarget::fireScriptEvent<bool>(const Event* event, ...)
 
     // Lookup registered callbacks for this event and fire them
     std::map<const Event*, std::vector<CallbackFunction>>::iterator itr = _scriptCallbacks->find(event);
-    if (itr != _scriptCallbacks->end())
+    if (itr != _scriptCallbacks->end() && !itr->second.empty())
     {
+        ++_scriptEventsFired;
         ScriptController* sc = Game::getInstance()->getScriptController();
         std::vector<CallbackFunction>& callbacks = itr->second;
         for (size_t i = 0, count = callbacks.size(); i < count; ++i)
         {
             CallbackFunction& cb = callbacks[i];
-            if (sc->executeFunction<bool>(cb.script, cb.function.c_str(), event->args.c_str(), &list))
+            bool handled = _scriptCallbackBinding && bindScriptCallback(cb) ?
+                sc->executeFunctionRef<bool>(cb.script, cb.functionRef, event->args.c_str(), &list) :
+                sc->executeFunction<bool>(cb.script, cb.function.c_str(), event->args.c_str(), &list);
+            if (handled)
             {
                 va_end(list);
                 return true;
@@ -148,6 +148,13 @@ public:
          */
         std::string args;
 
+        /**
+         * The bit identifying this event in a ScriptTarget's handler mask.
+         * Bits are shared between events once more than 32 events are registered,
+         * which only costs a redundant callback lookup.
+         */
+        unsigned int mask;
+
     };
 
     /**
@@ -285,6 +292,52 @@ public:
      */
     bool hasScriptListener(const Event* event) const;
 
+    /**
+     * Quickly determines whether a callback may be registered for the given script event.
+     *
+     * This costs a single branch and is intended for hot paths that fire script events
+     * every frame, allowing them to skip building the event arguments when nothing is
+     * listening. Events skipped this way are counted in the script event frame statistics.
+     *
+     * @param event The script event to check.
+     * @return True if a callback may be registered for the event, false if none is.
+     *
+     * @script{ignore}
+     */
+    inline bool hasScriptEventHandler(const Event* event) const
+    {
+        if (_scriptEventMask & event->mask)
+            return true;
+        ++_scriptEventsSkipped;
+        return false;
+    }
+
+    /**
+     * Gets the number of script events that were fired to at least one callback during the last frame.
+     *
+     * @return The number of script events fired.
+     */
+    static unsigned int getScriptEventsFired();
+
+    /**
+     * Gets the number of script events that were skipped during the last frame because
+     * no callback was registered for them.
+     *
+     * @return The number of script events skipped.
+     */
+    static unsigned int getScriptEventsSkipped();
+
+    /**
+     * Sets whether script callbacks are called through their bound function references
+     * (the default). When disabled, every callback is looked up by name each time it is
+     * fired, which is only useful to measure the cost of the lookup.
+     *
+     * @param enabled True to call bound function references, false to look callbacks up by name.
+     *
+     * @script{ignore}
+     */
+    static void setScriptCallbackBinding(bool enabled);
+
     /**
      * Gets the event object for the given event name, if it exists.
      *
@@ -359,13 +412,19 @@ protected:
         Script* script;
         /** The function within the script to call. */
         std::string function;
+        /** The bound function reference (or LUA_NOREF if the function has not been bound yet). */
+        int functionRef;
+        /** The load version of the script at the time the function was bound. */
+        unsigned int version;
+        /** Whether the function was looked up for version (functionRef stays LUA_NOREF if it was not found). */
+        bool resolved;
 
         /**
          * The callback function to registry script function to.
          * @param script The script.
          * @param function The script function.
          */
-        CallbackFunction(Script* script, const char* function) : script(script), function(function) { }
+        CallbackFunction(Script* script, const char* function) : script(script), function(function), functionRef(LUA_NOREF), version(0), resolved(false) { }
     };
 
     /**
@@ -400,12 +459,47 @@ protected:
      */
     void registerEvents(EventRegistry* registry);
 
+    /**
+     * Binds the function of the given callback so that it can be called without resolving
+     * its name. The function is bound on first use and is re-bound if its script is reloaded.
+     * A function that could not be resolved is not looked up again until its script is reloaded.
+     *
+     * @param callback The callback to bind.
+     * @return True if the callback function is bound, false if it could not be resolved.
+     */
+    bool bindScriptCallback(CallbackFunction& callback);
+
+    /**
+     * Releases the bound function reference held by the given callback (if any).
+     *
+     * @param callback The callback to release.
+     */
+    void unbindScriptCallback(CallbackFunction& callback);
+
+    /**
+     * Recomputes the mask of events that have registered callbacks.
+     */
+    void updateScriptEventMask();
+
+    /**
+     * Stores the script event counters of the frame that just ended and resets them.
+     */
+    static void resetScriptEventCounters();
+
     /** Holds the event registries for this script target. */
     RegistryEntry* _scriptRegistries;
     /** Holds the list of scripts referenced by this ScriptTarget. */
     ScriptEntry* _scripts;
     /** Holds the list of callback functions registered for this ScriptTarget. */
     std::map<const Event*, std::vector<CallbackFunction> >* _scriptCallbacks;
+    /** Holds the mask of events that have at least one registered callback. */
+    unsigned int _scriptEventMask;
+
+    static unsigned int _scriptEventsFired;
+    static unsigned int _scriptEventsSkipped;
+    static unsigned int _scriptEventsFiredLastFrame;
+    static unsigned int _scriptEventsSkippedLastFrame;
+    static bool _scriptCallbackBinding;
 };
 
 /**
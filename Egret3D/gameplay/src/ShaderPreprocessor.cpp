@@ -0,0 +1,859 @@
+#include "Base.h"
+#include "ShaderPreprocessor.h"
+#include "FileSystem.h"
+
+// Deepest nesting of #include directives, to stop include cycles.
+#define INCLUDE_DEPTH_MAX 16
+
+// Deepest nesting of macros expanded in a condition.
+#define MACRO_DEPTH_MAX 16
+
+namespace egret
+{
+
+// Shader sources with their includes resolved, keyed by a hash of the text, and the
+// hash of the text of each file.
+static std::map<unsigned long long, std::string> __sources;
+static std::map<std::string, unsigned long long> __sourcePaths;
+static size_t __sourceSize = 0;
+
+static unsigned long long hashText(const std::string& text)
+{
+    // 64 bit FNV-1a
+    unsigned long long hash = 14695981039346656037ULL;
+    for (size_t i = 0, length = text.length(); i < length; ++i)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool isIdentifierStart(char c)
+{
+    return isalpha((unsigned char)c) || c == '_';
+}
+
+static bool isIdentifierChar(char c)
+{
+    return isalnum((unsigned char)c) || c == '_';
+}
+
+static void trim(std::string& str)
+{
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+    {
+        str.clear();
+        return;
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    str = str.substr(start, end - start + 1);
+}
+
+/**
+ * The value of a condition, which is unknown when it depends on something only the shader
+ * compiler knows.
+ */
+struct Value
+{
+    bool known;
+    long long value;
+};
+
+static Value knownValue(long long value)
+{
+    Value v = { true, value };
+    return v;
+}
+
+static Value unknownValue()
+{
+    Value v = { false, 0 };
+    return v;
+}
+
+/**
+ * Evaluates the expression of an #if or #elif directive.
+ */
+class ConditionParser
+{
+public:
+
+    ConditionParser(const std::map<std::string, std::string>& macros, const std::set<std::string>& unknowns, unsigned int depth)
+        : _macros(macros), _unknowns(unknowns), _depth(depth), _position(0), _failed(false)
+    {
+    }
+
+    Value evaluate(const std::string& expression)
+    {
+        tokenize(expression);
+        if (_failed || _tokens.empty())
+            return unknownValue();
+        Value v = parseBinary(1);
+        if (_failed || _position != _tokens.size())
+            return unknownValue();
+        return v;
+    }
+
+private:
+
+    void tokenize(const std::string& expression)
+    {
+        static const char* operators[] = { "&&", "||", "==", "!=", "<=", ">=", "<<", ">>" };
+        size_t i = 0;
+        size_t length = expression.length();
+        while (i < length)
+        {
+            char c = expression[i];
+            if (isspace((unsigned char)c))
+            {
+                ++i;
+            }
+            else if (isIdentifierStart(c))
+            {
+                size_t start = i;
+                while (i < length && isIdentifierChar(expression[i]))
+                    ++i;
+                _tokens.push_back(expression.substr(start, i - start));
+            }
+            else if (isdigit((unsigned char)c))
+            {
+                size_t start = i;
+                while (i < length && (isalnum((unsigned char)expression[i]) || expression[i] == '.'))
+                    ++i;
+                _tokens.push_back(expression.substr(start, i - start));
+            }
+            else
+            {
+                std::string op(1, c);
+                if (i + 1 < length)
+                {
+                    std::string pair = expression.substr(i, 2);
+                    for (size_t j = 0; j < sizeof(operators) / sizeof(operators[0]); ++j)
+                    {
+                        if (pair == operators[j])
+                        {
+                            op = pair;
+                            break;
+                        }
+                    }
+                }
+                if (op.length() == 1 && strchr("()!~+-*/%<>&|^", c) == NULL)
+                {
+                    _failed = true;
+                    return;
+                }
+                _tokens.push_back(op);
+                i += op.length();
+            }
+        }
+    }
+
+    bool accept(const char* token)
+    {
+        if (_position < _tokens.size() && _tokens[_position] == token)
+        {
+            ++_position;
+            return true;
+        }
+        return false;
+    }
+
+    static int precedence(const std::string& op)
+    {
+        if (op == "||") return 1;
+        if (op == "&&") return 2;
+        if (op == "|") return 3;
+        if (op == "^") return 4;
+        if (op == "&") return 5;
+        if (op == "==" || op == "!=") return 6;
+        if (op == "<" || op == ">" || op == "<=" || op == ">=") return 7;
+        if (op == "<<" || op == ">>") return 8;
+        if (op == "+" || op == "-") return 9;
+        if (op == "*" || op == "/" || op == "%") return 10;
+        return 0;
+    }
+
+    Value parseBinary(int minPrecedence)
+    {
+        Value left = parseUnary();
+        while (!_failed && _position < _tokens.size())
+        {
+            std::string op = _tokens[_position];
+            int p = precedence(op);
+            if (p == 0 || p < minPrecedence)
+                break;
+            ++_position;
+            Value right = parseBinary(p + 1);
+
+            // A known operand can decide && and || on its own.
+            if (op == "&&")
+            {
+                if ((left.known && left.value == 0) || (right.known && right.value == 0))
+                    left = knownValue(0);
+                else if (left.known && right.known)
+                    left = knownValue(1);
+                else
+                    left = unknownValue();
+                continue;
+            }
+            if (op == "||")
+            {
+                if ((left.known && left.value != 0) || (right.known && right.value != 0))
+                    left = knownValue(1);
+                else if (left.known && right.known)
+                    left = knownValue(0);
+                else
+                    left = unknownValue();
+                continue;
+            }
+            if (!left.known || !right.known)
+            {
+                left = unknownValue();
+                continue;
+            }
+
+            long long a = left.value;
+            long long b = right.value;
+            if ((op == "/" || op == "%") && b == 0)
+            {
+                left = unknownValue();
+                continue;
+            }
+            if (op == "|") left.value = a | b;
+            else if (op == "^") left.value = a ^ b;
+            else if (op == "&") left.value = a & b;
+            else if (op == "==") left.value = a == b;
+            else if (op == "!=") left.value = a != b;
+            else if (op == "<") left.value = a < b;
+            else if (op == ">") left.value = a > b;
+            else if (op == "<=") left.value = a <= b;
+            else if (op == ">=") left.value = a >= b;
+            else if (op == "<<") left.value = (b >= 0 && b < 63) ? a << b : 0;
+            else if (op == ">>") left.value = (b >= 0 && b < 63) ? a >> b : 0;
+            else if (op == "+") left.value = a + b;
+            else if (op == "-") left.value = a - b;
+            else if (op == "*") left.value = a * b;
+            else if (op == "/") left.value = a / b;
+            else if (op == "%") left.value = a % b;
+        }
+        return left;
+    }
+
+    Value parseUnary()
+    {
+        if (accept("!"))
+        {
+            Value v = parseUnary();
+            return v.known ? knownValue(!v.value) : v;
+        }
+        if (accept("~"))
+        {
+            Value v = parseUnary();
+            return v.known ? knownValue(~v.value) : v;
+        }
+        if (accept("-"))
+        {
+            Value v = parseUnary();
+            return v.known ? knownValue(-v.value) : v;
+        }
+        if (accept("+"))
+        {
+            return parseUnary();
+        }
+        return parsePrimary();
+    }
+
+    Value parsePrimary()
+    {
+        if (_position >= _tokens.size())
+        {
+            _failed = true;
+            return unknownValue();
+        }
+
+        if (accept("("))
+        {
+            Value v = parseBinary(1);
+            if (!accept(")"))
+                _failed = true;
+            return v;
+        }
+
+        const std::string& token = _tokens[_position++];
+        if (isdigit((unsigned char)token[0]))
+        {
+            // Integer literal, with an optional u or U suffix.
+            char* end = NULL;
+            long long value = strtoll(token.c_str(), &end, 0);
+            if (*end == 'u' || *end == 'U')
+                ++end;
+            if (*end != '\0')
+                return unknownValue();
+            return knownValue(value);
+        }
+        if (!isIdentifierStart(token[0]))
+        {
+            _failed = true;
+            return unknownValue();
+        }
+
+        if (token == "defined")
+        {
+            bool parenthesis = accept("(");
+            if (_position >= _tokens.size() || !isIdentifierStart(_tokens[_position][0]))
+            {
+                _failed = true;
+                return unknownValue();
+            }
+            const std::string& name = _tokens[_position++];
+            if (parenthesis && !accept(")"))
+            {
+                _failed = true;
+                return unknownValue();
+            }
+            if (isUnknown(name))
+                return unknownValue();
+            return knownValue(_macros.find(name) != _macros.end() ? 1 : 0);
+        }
+
+        // A macro evaluates to its value. Undefined names are an error in GLSL, which is
+        // left to the compiler to report.
+        if (isUnknown(token) || _depth >= MACRO_DEPTH_MAX)
+            return unknownValue();
+        std::map<std::string, std::string>::const_iterator itr = _macros.find(token);
+        if (itr == _macros.end())
+            return unknownValue();
+        ConditionParser parser(_macros, _unknowns, _depth + 1);
+        return parser.evaluate(itr->second);
+    }
+
+    bool isUnknown(const std::string& name) const
+    {
+        // Names reserved for the implementation are defined by the shader compiler.
+        if (name.compare(0, 3, "GL_") == 0 || name.compare(0, 2, "__") == 0)
+            return true;
+        return _unknowns.find(name) != _unknowns.end();
+    }
+
+    const std::map<std::string, std::string>& _macros;
+    const std::set<std::string>& _unknowns;
+    unsigned int _depth;
+    std::vector<std::string> _tokens;
+    size_t _position;
+    bool _failed;
+};
+
+/**
+ * An #if block being stripped.
+ */
+struct Conditional
+{
+    // The directives of the block are left to the compiler.
+    bool kept;
+    // The current branch is active.
+    bool active;
+    // A branch of the block has been active.
+    bool taken;
+};
+
+static void skipComment(const std::string& line, size_t& i, bool& inComment)
+{
+    size_t end = line.find("*/", i);
+    if (end == std::string::npos)
+    {
+        i = line.length();
+        return;
+    }
+    i = end + 2;
+    inComment = false;
+}
+
+/**
+ * Removes the comments of a directive.
+ */
+static std::string stripComments(const std::string& text)
+{
+    std::string out;
+    bool inComment = false;
+    size_t i = 0;
+    while (i < text.length())
+    {
+        if (inComment)
+        {
+            skipComment(text, i, inComment);
+            out += ' ';
+        }
+        else if (text.compare(i, 2, "/*") == 0)
+        {
+            inComment = true;
+            i += 2;
+        }
+        else if (text.compare(i, 2, "//") == 0)
+        {
+            break;
+        }
+        else
+        {
+            out += text[i++];
+        }
+    }
+    return out;
+}
+
+/**
+ * Updates the block comment state at the end of a line.
+ */
+static void scanComments(const char* start, const char* end, bool& inComment)
+{
+    const char* c = start;
+    while (c < end)
+    {
+        if (inComment)
+        {
+            while (c + 1 < end && (c[0] != '*' || c[1] != '/'))
+                ++c;
+            if (c + 1 >= end)
+                return;
+            inComment = false;
+            c += 2;
+            continue;
+        }
+        c = (const char*)memchr(c, '/', end - c);
+        if (c == NULL || c + 1 >= end || c[1] == '/')
+            return;
+        if (c[1] == '*')
+        {
+            inComment = true;
+            c += 2;
+        }
+        else
+        {
+            ++c;
+        }
+    }
+}
+
+/**
+ * Checks whether a name appears in a source as a whole identifier.
+ */
+static bool refersTo(const std::string& source, const std::string& name)
+{
+    size_t position = 0;
+    while ((position = source.find(name, position)) != std::string::npos)
+    {
+        size_t end = position + name.length();
+        if ((position == 0 || !isIdentifierChar(source[position - 1])) && (end == source.length() || !isIdentifierChar(source[end])))
+            return true;
+        position = end;
+    }
+    return false;
+}
+
+ShaderPreprocessor::ShaderPreprocessor()
+{
+}
+
+std::string ShaderPreprocessor::canonicalizeDefines(const char* defines)
+{
+    std::vector<std::string> list;
+    if (defines)
+    {
+        const char* start = defines;
+        while (true)
+        {
+            const char* end = start + strcspn(start, ";\n");
+
+            // Collapse runs of whitespace so that "A  1" and "A 1" are the same define.
+            std::string define;
+            for (const char* c = start; c < end; ++c)
+            {
+                if (isspace((unsigned char)*c))
+                {
+                    if (!define.empty() && define[define.length() - 1] != ' ')
+                        define += ' ';
+                }
+                else
+                {
+                    define += *c;
+                }
+            }
+            trim(define);
+            if (!define.empty())
+                list.push_back(define);
+
+            if (*end == '\0')
+                break;
+            start = end + 1;
+        }
+    }
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+
+    std::string out;
+    for (size_t i = 0, count = list.size(); i < count; ++i)
+    {
+        if (i > 0)
+            out += ';';
+        out += list[i];
+    }
+    return out;
+}
+
+unsigned int ShaderPreprocessor::getSourceCount()
+{
+    return (unsigned int)__sources.size();
+}
+
+size_t ShaderPreprocessor::getSourceSize()
+{
+    return __sourceSize;
+}
+
+const char* ShaderPreprocessor::getSource(const char* path)
+{
+    GP_ASSERT(path);
+    return getSource(std::string(path), 0);
+}
+
+const char* ShaderPreprocessor::getSource(const std::string& path, unsigned int depth)
+{
+    std::map<std::string, unsigned long long>::const_iterator itr = __sourcePaths.find(path);
+    if (itr != __sourcePaths.end())
+        return __sources[itr->second].c_str();
+
+    if (depth > INCLUDE_DEPTH_MAX)
+    {
+        GP_ERROR("Compile failed for shader '%s' includes nested too deeply.", path.c_str());
+        return NULL;
+    }
+
+    char* source = FileSystem::readAll(path.c_str());
+    if (source == NULL)
+        return NULL;
+
+    // Replace the #include "xxxx.xxx" with the source of "filepath/xxxx.xxx"
+    std::string str = source;
+    SAFE_DELETE_ARRAY(source);
+    std::string directoryPath = path.substr(0, path.rfind('/') + 1);
+    std::string out;
+    size_t lastPos = 0;
+    size_t headPos;
+    while ((headPos = str.find("#include", lastPos)) != std::string::npos)
+    {
+        out.append(str, lastPos, headPos - lastPos);
+
+        // find the start quote "
+        size_t startQuote = str.find('"', headPos);
+        if (startQuote == std::string::npos)
+        {
+            // We have started an "#include" but missing the leading quote "
+            GP_ERROR("Compile failed for shader '%s' missing leading \".", path.c_str());
+            return NULL;
+        }
+        ++startQuote;
+
+        // find the end quote "
+        size_t endQuote = str.find('"', startQuote);
+        if (endQuote == std::string::npos)
+        {
+            // We have a start quote but missing the trailing quote "
+            GP_ERROR("Compile failed for shader '%s' missing trailing \".", path.c_str());
+            return NULL;
+        }
+
+        std::string includePath = directoryPath + str.substr(startQuote, endQuote - startQuote);
+        const char* includedSource = getSource(includePath, depth + 1);
+        if (includedSource == NULL)
+        {
+            GP_ERROR("Compile failed for shader '%s' invalid filepath.", path.c_str());
+            return NULL;
+        }
+        out += includedSource;
+
+        // jump past the end quote
+        lastPos = endQuote + 1;
+    }
+    out.append(str, lastPos, std::string::npos);
+
+    // Files that expand to the same text share it.
+    unsigned long long hash = hashText(out);
+    __sourcePaths[path] = hash;
+    std::map<unsigned long long, std::string>::iterator sourceItr = __sources.find(hash);
+    if (sourceItr == __sources.end())
+    {
+        sourceItr = __sources.insert(std::make_pair(hash, std::string())).first;
+        sourceItr->second.swap(out);
+        __sourceSize += sourceItr->second.length();
+    }
+    return sourceItr->second.c_str();
+}
+
+void ShaderPreprocessor::preprocess(const std::vector<std::string>& defines, const char* vshSource, const char* fshSource,
+                                    std::string& header, std::string& vshOut, std::string& fshOut)
+{
+    GP_ASSERT(vshSource);
+    GP_ASSERT(fshSource);
+
+    size_t defineCount = defines.size();
+    std::vector<std::string> names(defineCount);
+    std::vector<std::string> values(defineCount);
+    std::map<std::string, std::string> macros;
+    for (size_t i = 0; i < defineCount; ++i)
+    {
+        const std::string& define = defines[i];
+        size_t space = define.find(' ');
+        names[i] = define.substr(0, space);
+        if (space != std::string::npos)
+            values[i] = define.substr(space + 1);
+        macros[names[i]] = values[i];
+    }
+
+    vshOut.clear();
+    fshOut.clear();
+    strip(vshSource, macros, vshOut);
+    strip(fshSource, macros, fshOut);
+
+    // Keep the defines that the remaining code refers to, and the ones their values
+    // refer to, until no more are added.
+    std::vector<bool> kept(defineCount, false);
+    bool added = true;
+    while (added)
+    {
+        added = false;
+        for (size_t i = 0; i < defineCount; ++i)
+        {
+            if (kept[i])
+                continue;
+            bool used = refersTo(vshOut, names[i]) || refersTo(fshOut, names[i]);
+            for (size_t j = 0; j < defineCount && !used; ++j)
+            {
+                used = kept[j] && refersTo(values[j], names[i]);
+            }
+            if (used)
+            {
+                kept[i] = true;
+                added = true;
+            }
+        }
+    }
+
+    header.clear();
+    for (size_t i = 0; i < defineCount; ++i)
+    {
+        if (kept[i])
+        {
+            header += "#define ";
+            header += defines[i];
+            header += '\n';
+        }
+    }
+}
+
+void ShaderPreprocessor::strip(const char* source, std::map<std::string, std::string> macros, std::string& out)
+{
+    std::set<std::string> unknowns;
+    std::vector<Conditional> conditionals;
+    unsigned int keptDepth = 0;
+    bool inComment = false;
+
+    const char* position = source;
+    while (*position)
+    {
+        // Read a line, joining lines that end with a backslash.
+        const char* start = position;
+        unsigned int lineCount = 0;
+        while (true)
+        {
+            const char* end = strchr(position, '\n');
+            if (end == NULL)
+            {
+                position += strlen(position);
+                ++lineCount;
+                break;
+            }
+            ++lineCount;
+            position = end + 1;
+            const char* last = end;
+            while (last > start && last[-1] == '\r')
+                --last;
+            if (last == start || last[-1] != '\\')
+                break;
+        }
+        const char* first = start;
+        while (*first == ' ' || *first == '\t')
+            ++first;
+
+        bool directive = false;
+        std::string keyword;
+        std::string rest;
+        std::string line;
+        if (!inComment && *first == '#')
+        {
+            directive = true;
+            line.assign(start, position);
+            std::string text = stripComments(std::string(first + 1, position));
+            for (size_t j = 0; j < text.length(); ++j)
+            {
+                if (text[j] == '\\' && (j + 1 == text.length() || text[j + 1] == '\n' || text[j + 1] == '\r'))
+                    text[j] = ' ';
+            }
+            trim(text);
+            size_t k = 0;
+            while (k < text.length() && isIdentifierChar(text[k]))
+                ++k;
+            keyword = text.substr(0, k);
+            rest = text.substr(k);
+            trim(rest);
+        }
+        scanComments(start, position, inComment);
+
+        bool live = true;
+        for (size_t i = 0, count = conditionals.size(); i < count; ++i)
+        {
+            if (!conditionals[i].kept && !conditionals[i].active)
+            {
+                live = false;
+                break;
+            }
+        }
+
+        bool emit = live;
+        if (directive && (keyword == "if" || keyword == "ifdef" || keyword == "ifndef"))
+        {
+            Conditional conditional = { false, false, true };
+            if (live)
+            {
+                Value v;
+                if (keyword == "if")
+                {
+                    ConditionParser parser(macros, unknowns, 0);
+                    v = parser.evaluate(rest);
+                }
+                else
+                {
+                    ConditionParser parser(macros, unknowns, 0);
+                    v = parser.evaluate("defined " + rest);
+                    if (v.known && keyword == "ifndef")
+                        v.value = !v.value;
+                }
+                if (v.known)
+                {
+                    conditional.active = conditional.taken = v.value != 0;
+                    emit = false;
+                }
+                else
+                {
+                    conditional.kept = true;
+                    conditional.active = true;
+                    ++keptDepth;
+                }
+            }
+            conditionals.push_back(conditional);
+        }
+        else if (directive && (keyword == "elif" || keyword == "else" || keyword == "endif") && !conditionals.empty())
+        {
+            Conditional& conditional = conditionals.back();
+            bool parentLive = true;
+            for (size_t i = 0, count = conditionals.size() - 1; i < count; ++i)
+            {
+                if (!conditionals[i].kept && !conditionals[i].active)
+                {
+                    parentLive = false;
+                    break;
+                }
+            }
+
+            emit = conditional.kept;
+            if (keyword == "endif")
+            {
+                if (conditional.kept)
+                    --keptDepth;
+                conditionals.pop_back();
+            }
+            else if (conditional.kept || !parentLive)
+            {
+                // Left to the compiler, or inside an inactive block.
+            }
+            else if (conditional.taken)
+            {
+                conditional.active = false;
+            }
+            else if (keyword == "else")
+            {
+                conditional.active = conditional.taken = true;
+            }
+            else
+            {
+                ConditionParser parser(macros, unknowns, 0);
+                Value v = parser.evaluate(rest);
+                if (v.known)
+                {
+                    conditional.active = conditional.taken = v.value != 0;
+                }
+                else
+                {
+                    // The branches before this one were inactive and are blanked, so this
+                    // branch starts the block that is left to the compiler.
+                    conditional.kept = true;
+                    conditional.active = true;
+                    ++keptDepth;
+                    line = "#if " + rest + "\n";
+                    line.append(lineCount - 1, '\n');
+                    emit = true;
+                }
+            }
+        }
+        else if (directive && live && (keyword == "define" || keyword == "undef"))
+        {
+            size_t k = 0;
+            while (k < rest.length() && isIdentifierChar(rest[k]))
+                ++k;
+            std::string name = rest.substr(0, k);
+            bool functionLike = k < rest.length() && rest[k] == '(';
+
+            // Macros changed inside blocks left to the compiler may or may not be defined.
+            if (keptDepth > 0 || functionLike)
+            {
+                macros.erase(name);
+                unknowns.insert(name);
+            }
+            else if (keyword == "define")
+            {
+                std::string value = rest.substr(k);
+                trim(value);
+                macros[name] = value;
+                unknowns.erase(name);
+            }
+            else
+            {
+                macros.erase(name);
+                unknowns.erase(name);
+            }
+        }
+
+        if (!emit)
+        {
+            out.append(lineCount, '\n');
+        }
+        else
+        {
+            if (directive)
+                out += line;
+            else
+                out.append(start, position);
+            if (out.empty() || out[out.length() - 1] != '\n')
+                out += '\n';
+        }
+    }
+}
+
+void ShaderPreprocessor::finalize()
+{
+    __sources.clear();
+    __sourcePaths.clear();
+    __sourceSize = 0;
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef SHADERPREPROCESSOR_H_
+#define SHADERPREPROCESSOR_H_
+
+namespace egret
+{
+
+/**
+ * Prepares the sources of shader permutations for Effect.
+ *
+ * Shader files are read once with their #include directives resolved and kept until the
+ * game shuts down, so permutations of the same shaders do not read or expand them again.
+ * Files that expand to the same text share a single copy.
+ *
+ * For each permutation the #if, #ifdef, #ifndef, #elif and #else directives that can be
+ * decided from its defines (and the #defines of the shader itself) are evaluated, and the
+ * lines of inactive blocks are blanked so that compile errors keep their line numbers.
+ * Only the defines the remaining code still refers to are passed to the compiler. Effect
+ * links permutations that end up with the same sources into a single program.
+ *
+ * Conditions on names the preprocessor cannot know, such as GL_ES or
+ * GL_FRAGMENT_PRECISION_HIGH, or on macros defined inside such blocks, are left to the
+ * shader compiler.
+ *
+ * @script{ignore}
+ */
+class ShaderPreprocessor
+{
+    friend class Effect;
+    friend class Game;
+
+public:
+
+    /**
+     * Puts a list of defines in its canonical form, so that lists which differ only in the
+     * order of their defines, repeated defines or whitespace compare equal.
+     *
+     * @param defines A semicolon or new-line delimited list of defines. May be NULL.
+     *
+     * @return The sorted, semicolon delimited list of distinct defines.
+     */
+    static std::string canonicalizeDefines(const char* defines);
+
+    /**
+     * Gets the number of distinct shader sources that are loaded.
+     *
+     * @return The number of sources.
+     */
+    static unsigned int getSourceCount();
+
+    /**
+     * Gets the size of the shader sources that are loaded.
+     *
+     * @return The size of the sources in bytes.
+     */
+    static size_t getSourceSize();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ShaderPreprocessor();
+
+    /**
+     * Gets the source of a shader file with its #include directives resolved.
+     *
+     * @param path The path to the shader file.
+     *
+     * @return The source, or NULL if the file (or a file it includes) could not be read.
+     */
+    static const char* getSource(const char* path);
+
+    static const char* getSource(const std::string& path, unsigned int depth);
+
+    /**
+     * Strips the inactive blocks of a vertex and fragment shader for a set of defines.
+     *
+     * @param defines The defines, as "NAME" or "NAME VALUE".
+     * @param vshSource The vertex shader source.
+     * @param fshSource The fragment shader source.
+     * @param header Set to the #define lines of the defines the stripped sources refer to.
+     * @param vshOut Set to the stripped vertex shader source.
+     * @param fshOut Set to the stripped fragment shader source.
+     */
+    static void preprocess(const std::vector<std::string>& defines, const char* vshSource, const char* fshSource,
+                           std::string& header, std::string& vshOut, std::string& fshOut);
+
+    static void strip(const char* source, std::map<std::string, std::string> macros, std::string& out);
+
+    /**
+     * Releases the loaded shader sources.
+     */
+    static void finalize();
+};
+
+}
+
+#endif
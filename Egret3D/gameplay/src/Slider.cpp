@@ -67,6 +67,7 @@ const char* Slider::getTypeName() const
 void Slider::setMin(float min)
 {
     _min = min;
+    setDirty(DIRTY_DRAW);
 }
 
 float Slider::getMin() const
@@ -77,6 +78,7 @@ float Slider::getMin() const
 void Slider::setMax(float max)
 {
     _max = max;
+    setDirty(DIRTY_DRAW);
 }
 
 float Slider::getMax() const
@@ -106,6 +108,7 @@ void Slider::setValue(float value)
     if (value != _value)
     {
         _value = value;
+        setDirty(DIRTY_DRAW);
         notifyListeners(Control::Listener::VALUE_CHANGED);
     }
 
@@ -123,8 +126,7 @@ void Slider::setValueTextVisible(bool valueTextVisible)
     if (valueTextVisible != _valueTextVisible)
     {
         _valueTextVisible = valueTextVisible;
-        if (_autoSize & AUTO_SIZE_HEIGHT)
-            setDirty(DIRTY_BOUNDS);
+        setDirty((_autoSize & AUTO_SIZE_HEIGHT) ? DIRTY_BOUNDS : DIRTY_DRAW);
     }
 }
 
@@ -136,6 +138,7 @@ bool Slider::isValueTextVisible() const
 void Slider::setValueTextAlignment(Font::Justify alignment)
 {
     _valueTextAlignment = alignment;
+    setDirty(DIRTY_DRAW);
 }
 
 Font::Justify Slider::getValueTextAlignment() const
@@ -146,6 +149,7 @@ Font::Justify Slider::getValueTextAlignment() const
 void Slider::setValueTextPrecision(unsigned int precision)
 {
     _valueTextPrecision = precision;
+    setDirty(DIRTY_DRAW);
 }
 
 unsigned int Slider::getValueTextPrecision() const
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Sprite.h"
 #include "Scene.h"
+#include "TextureAtlas.h"
 
 namespace egret
 {
@@ -43,8 +44,12 @@ Sprite* Sprite::create(const char* imagePath, float width, float height,
     batch->getStateBlock()->setDepthWrite(false);
     batch->getStateBlock()->setDepthTest(true);
     
-    unsigned int imageWidth = batch->getSampler()->getTexture()->getWidth();
-    unsigned int imageHeight = batch->getSampler()->getTexture()->getHeight();
+    // Frame sources are relative to the image, which may be a region of an atlas page
+    Rectangle region(batch->getSampler()->getTexture()->getWidth(), batch->getSampler()->getTexture()->getHeight());
+    if (const TextureAtlas::Region* atlasRegion = TextureAtlas::findRegion(imagePath))
+        region = atlasRegion->bounds;
+    unsigned int imageWidth = (unsigned int)region.width;
+    unsigned int imageHeight = (unsigned int)region.height;
     if (width == -1)
         width = imageWidth;
     if (height == -1)
@@ -54,6 +59,7 @@ Sprite* Sprite::create(const char* imagePath, float width, float height,
     sprite->_width = width;
     sprite->_height = height;
     sprite->_batch = batch;
+    sprite->_region = region;
     sprite->_frameCount = frameCount;
     sprite->_frames = new Rectangle[frameCount];
     sprite->_frames[0] = source;
@@ -430,10 +436,8 @@ void Sprite::computeFrames(unsigned int frameStride, unsigned int framePadding)
     
     if (_frameCount < 2)
         return;
-    unsigned int imageWidth = _batch->getSampler()->getTexture()->getWidth();
-    unsigned int imageHeight = _batch->getSampler()->getTexture()->getHeight();
-    float textureWidthRatio = 1.0f / imageWidth;
-    float textureHeightRatio = 1.0f / imageHeight;
+    unsigned int imageWidth = (unsigned int)_region.width;
+    unsigned int imageHeight = (unsigned int)_region.height;
     
     // If we have a stride then compute the wrap width
     float strideWidth;
@@ -638,8 +642,11 @@ unsigned int Sprite::draw(bool wireframe)
     }
     
     // TODO: Proper batching from cache based on batching rules (image, layers, etc)
+    Rectangle source = _frames[_frameIndex];
+    source.x += _region.x;
+    source.y += _region.y;
     _batch->start();
-	_batch->draw(position, _frames[_frameIndex], scale, { _color.x, _color.y, _color.z, _color.w * _opacity },
+	_batch->draw(position, source, scale, { _color.x, _color.y, _color.z, _color.w * _opacity },
                  _anchor, rotationAngle);
     _batch->finish();
     
@@ -679,6 +686,7 @@ Drawable* Sprite::clone(NodeCloneContext& context)
     spriteClone->_framePadding = _framePadding;
     spriteClone->_frameIndex = _frameIndex;
     spriteClone->_batch = _batch;
+    spriteClone->_region = _region;
 
     return spriteClone;
 }
@@ -109,6 +109,9 @@ public:
      * Passing -1 for width/height or source.width/.height,
      * will default to using the images width/height.
      *
+     * The image may be a region of a texture atlas, "sheet.atlas#name", in which case
+     * the source region is relative to the image.
+     *
      * @param imagePath The path to the image to create the sprite from.
      * @param width The width of a frame.
      * @param height The width of a frame.
@@ -391,6 +394,7 @@ private:
     unsigned int _framePadding;
     unsigned int _frameIndex;
     SpriteBatch* _batch;
+    Rectangle _region;
     float _opacity;
     kmVec4 _color;
     BlendMode _blendMode;
@@ -19,14 +19,50 @@
 #define SPRITE_VSH "res/shaders/sprite.vert"
 #define SPRITE_FSH "res/shaders/sprite.frag"
 
+// Instruction set used by drawMany to build four sprites at a time
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define SPRITE_BATCH_SSE
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SPRITE_BATCH_NEON
+#endif
+
 namespace egret
 {
 
 static Effect* __spriteEffect = NULL;
+static SpriteBatch::Recording* __recording = NULL;
+
+#if defined(SPRITE_BATCH_SSE)
+typedef __m128 SpriteLanes;
+static inline SpriteLanes lanesLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline SpriteLanes lanesSet(float f) { return _mm_set1_ps(f); }
+static inline SpriteLanes lanesAdd(SpriteLanes a, SpriteLanes b) { return _mm_add_ps(a, b); }
+static inline SpriteLanes lanesSub(SpriteLanes a, SpriteLanes b) { return _mm_sub_ps(a, b); }
+static inline SpriteLanes lanesMul(SpriteLanes a, SpriteLanes b) { return _mm_mul_ps(a, b); }
+static inline void lanesStore(float* p, SpriteLanes a) { _mm_storeu_ps(p, a); }
+#elif defined(SPRITE_BATCH_NEON)
+typedef float32x4_t SpriteLanes;
+static inline SpriteLanes lanesLoad(const float* p) { return vld1q_f32(p); }
+static inline SpriteLanes lanesSet(float f) { return vdupq_n_f32(f); }
+static inline SpriteLanes lanesAdd(SpriteLanes a, SpriteLanes b) { return vaddq_f32(a, b); }
+static inline SpriteLanes lanesSub(SpriteLanes a, SpriteLanes b) { return vsubq_f32(a, b); }
+static inline SpriteLanes lanesMul(SpriteLanes a, SpriteLanes b) { return vmulq_f32(a, b); }
+static inline void lanesStore(float* p, SpriteLanes a) { vst1q_f32(p, a); }
+#else
+struct SpriteLanes { float f[4]; };
+static inline SpriteLanes lanesLoad(const float* p) { SpriteLanes r = { { p[0], p[1], p[2], p[3] } }; return r; }
+static inline SpriteLanes lanesSet(float f) { SpriteLanes r = { { f, f, f, f } }; return r; }
+static inline SpriteLanes lanesAdd(SpriteLanes a, SpriteLanes b) { for (int i = 0; i < 4; ++i) a.f[i] += b.f[i]; return a; }
+static inline SpriteLanes lanesSub(SpriteLanes a, SpriteLanes b) { for (int i = 0; i < 4; ++i) a.f[i] -= b.f[i]; return a; }
+static inline SpriteLanes lanesMul(SpriteLanes a, SpriteLanes b) { for (int i = 0; i < 4; ++i) a.f[i] *= b.f[i]; return a; }
+static inline void lanesStore(float* p, SpriteLanes a) { memcpy(p, a.f, sizeof(a.f)); }
+#endif
 
 SpriteBatch::SpriteBatch()
     : _batch(NULL), _sampler(NULL), _textureWidthRatio(0.0f),
-	_textureHeightRatio(0.0f)
+	_textureHeightRatio(0.0f), _recordingGeneration(0), _replayFunction(NULL), _replayData(NULL)
 {
 	memset(_projectionMatrix.mat, 0, sizeof(float) * 16);
 }
@@ -236,10 +272,8 @@ void SpriteBatch::draw(float x, float y, float z, float width, float height, flo
     SPRITE_ADD_VERTEX(v[1], upLeft.x, upLeft.y, z, u1, v2, color.x, color.y, color.z, color.w);
     SPRITE_ADD_VERTEX(v[2], downRight.x, downRight.y, z, u2, v1, color.x, color.y, color.z, color.w);
     SPRITE_ADD_VERTEX(v[3], upRight.x, upRight.y, z, u2, v2, color.x, color.y, color.z, color.w);
-    
-    static unsigned short indices[4] = { 0, 1, 2, 3 };
 
-    _batch->add(v, 4, indices, 4);
+    addQuad(v);
 }
 
 void SpriteBatch::draw(const kmVec3& position, const kmVec3& right, const kmVec3& forward, float width, float height,
@@ -340,9 +374,8 @@ void SpriteBatch::draw(const kmVec3& position, const kmVec3& right, const kmVec3
     SPRITE_ADD_VERTEX(v[1], p1.x, p1.y, p1.z, u2, v1, color.x, color.y, color.z, color.w);
     SPRITE_ADD_VERTEX(v[2], p2.x, p2.y, p2.z, u1, v2, color.x, color.y, color.z, color.w);
     SPRITE_ADD_VERTEX(v[3], p3.x, p3.y, p3.z, u2, v2, color.x, color.y, color.z, color.w);
-    
-    static const unsigned short indices[4] = { 0, 1, 2, 3 };
-    _batch->add(v, 4, const_cast<unsigned short*>(indices), 4);
+
+    addQuad(v);
 }
 
 void SpriteBatch::draw(float x, float y, float width, float height, float u1, float v1, float u2, float v2, const kmVec4& color)
@@ -398,6 +431,119 @@ void SpriteBatch::draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexC
     GP_ASSERT(indices);
 
     _batch->add(vertices, vertexCount, indices, indexCount);
+
+    // Arbitrary geometry can't be replayed as quads
+    if (__recording)
+        __recording->_complete = false;
+}
+
+void SpriteBatch::drawMany(const SpriteArrays& sprites, const kmVec3& right, const kmVec3& up)
+{
+    if (sprites.count == 0)
+        return;
+
+    GP_ASSERT(sprites.x && sprites.y && sprites.z && sprites.width);
+
+    SpriteVertex* vertices = (SpriteVertex*)_batch->addQuads(sprites.count);
+    if (vertices == NULL)
+        return;
+
+    static const kmVec4 wholeTexture = { 0.0f, 1.0f, 1.0f, 0.0f };
+    static const kmVec4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    const SpriteLanes half = lanesSet(0.5f);
+    const SpriteLanes rightX = lanesSet(right.x), rightY = lanesSet(right.y), rightZ = lanesSet(right.z);
+    const SpriteLanes upX = lanesSet(up.x), upY = lanesSet(up.y), upZ = lanesSet(up.z);
+
+    for (unsigned int i = 0; i < sprites.count; i += 4)
+    {
+        unsigned int n = std::min(sprites.count - i, 4u);
+        const float* x = sprites.x + i;
+        const float* y = sprites.y + i;
+        const float* z = sprites.z + i;
+        const float* width = sprites.width + i;
+        const float* height = sprites.height ? sprites.height + i : width;
+
+        // Pad the last group of sprites out to a full four lanes.
+        float padded[5][4];
+        if (n < 4)
+        {
+            memset(padded, 0, sizeof(padded));
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                padded[0][j] = x[j];
+                padded[1][j] = y[j];
+                padded[2][j] = z[j];
+                padded[3][j] = width[j];
+                padded[4][j] = height[j];
+            }
+            x = padded[0];
+            y = padded[1];
+            z = padded[2];
+            width = padded[3];
+            height = padded[4];
+        }
+
+        float cosAngle[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float sinAngle[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        if (sprites.angle)
+        {
+            for (unsigned int j = 0; j < n; ++j)
+            {
+                float angle = sprites.angle[i + j];
+                if (angle != 0.0f)
+                {
+                    cosAngle[j] = cosf(angle);
+                    sinAngle[j] = sinf(angle);
+                }
+            }
+        }
+
+        // Rotate the half extents of each quad about its normal.
+        SpriteLanes c = lanesLoad(cosAngle);
+        SpriteLanes s = lanesLoad(sinAngle);
+        SpriteLanes halfWidth = lanesMul(lanesLoad(width), half);
+        SpriteLanes halfHeight = lanesMul(lanesLoad(height), half);
+        SpriteLanes ax = lanesMul(lanesAdd(lanesMul(c, rightX), lanesMul(s, upX)), halfWidth);
+        SpriteLanes ay = lanesMul(lanesAdd(lanesMul(c, rightY), lanesMul(s, upY)), halfWidth);
+        SpriteLanes az = lanesMul(lanesAdd(lanesMul(c, rightZ), lanesMul(s, upZ)), halfWidth);
+        SpriteLanes bx = lanesMul(lanesSub(lanesMul(c, upX), lanesMul(s, rightX)), halfHeight);
+        SpriteLanes by = lanesMul(lanesSub(lanesMul(c, upY), lanesMul(s, rightY)), halfHeight);
+        SpriteLanes bz = lanesMul(lanesSub(lanesMul(c, upZ), lanesMul(s, rightZ)), halfHeight);
+
+        // Corners in strip order: center - a - b, center + a - b, center - a + b, center + a + b.
+        SpriteLanes bottomX = lanesSub(lanesLoad(x), bx), topX = lanesAdd(lanesLoad(x), bx);
+        SpriteLanes bottomY = lanesSub(lanesLoad(y), by), topY = lanesAdd(lanesLoad(y), by);
+        SpriteLanes bottomZ = lanesSub(lanesLoad(z), bz), topZ = lanesAdd(lanesLoad(z), bz);
+        float corners[4][3][4];
+        lanesStore(corners[0][0], lanesSub(bottomX, ax));
+        lanesStore(corners[0][1], lanesSub(bottomY, ay));
+        lanesStore(corners[0][2], lanesSub(bottomZ, az));
+        lanesStore(corners[1][0], lanesAdd(bottomX, ax));
+        lanesStore(corners[1][1], lanesAdd(bottomY, ay));
+        lanesStore(corners[1][2], lanesAdd(bottomZ, az));
+        lanesStore(corners[2][0], lanesSub(topX, ax));
+        lanesStore(corners[2][1], lanesSub(topY, ay));
+        lanesStore(corners[2][2], lanesSub(topZ, az));
+        lanesStore(corners[3][0], lanesAdd(topX, ax));
+        lanesStore(corners[3][1], lanesAdd(topY, ay));
+        lanesStore(corners[3][2], lanesAdd(topZ, az));
+
+        // Interleave the corners with the texture coordinates and colors.
+        for (unsigned int j = 0; j < n; ++j)
+        {
+            const kmVec4& t = sprites.texCoords ? sprites.texCoords[i + j] : wholeTexture;
+            const kmVec4& color = sprites.colors ? sprites.colors[i + j] : white;
+            SpriteVertex* v = vertices + (i + j) * 4;
+            SPRITE_ADD_VERTEX(v[0], corners[0][0][j], corners[0][1][j], corners[0][2][j], t.x, t.y, color.x, color.y, color.z, color.w);
+            SPRITE_ADD_VERTEX(v[1], corners[1][0][j], corners[1][1][j], corners[1][2][j], t.z, t.y, color.x, color.y, color.z, color.w);
+            SPRITE_ADD_VERTEX(v[2], corners[2][0][j], corners[2][1][j], corners[2][2][j], t.x, t.w, color.x, color.y, color.z, color.w);
+            SPRITE_ADD_VERTEX(v[3], corners[3][0][j], corners[3][1][j], corners[3][2][j], t.z, t.w, color.x, color.y, color.z, color.w);
+        }
+    }
+
+    if (__recording)
+        __recording->add(this, vertices, sprites.count * 4);
 }
 
 void SpriteBatch::draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const kmVec4& color, bool positionIsCenter)
@@ -418,9 +564,7 @@ void SpriteBatch::draw(float x, float y, float z, float width, float height, flo
     SPRITE_ADD_VERTEX(v[2], x2, y, z, u2, v1, color.x, color.y, color.z, color.w);
     SPRITE_ADD_VERTEX(v[3], x2, y2, z, u2, v2, color.x, color.y, color.z, color.w);
 
-    static unsigned short indices[4] = { 0, 1, 2, 3 };
-
-    _batch->add(v, 4, indices, 4);
+    addQuad(v);
 }
 
 void SpriteBatch::finish()
@@ -517,4 +661,211 @@ bool SpriteBatch::clipSprite(const Rectangle& clip, float& x, float& y, float& w
     return true;
 }
 
+void SpriteBatch::addQuad(const SpriteVertex* vertices)
+{
+    static unsigned short indices[4] = { 0, 1, 2, 3 };
+
+    _batch->add(vertices, 4, indices, 4);
+
+    if (__recording)
+        __recording->add(this, vertices, 4);
+}
+
+void SpriteBatch::addQuads(const SpriteVertex* vertices, unsigned int quadCount)
+{
+    GP_ASSERT(vertices);
+
+    void* batchVertices = _batch->addQuads(quadCount);
+    if (batchVertices == NULL)
+        return;
+    memcpy(batchVertices, vertices, quadCount * 4 * sizeof(SpriteVertex));
+
+    if (__recording)
+        __recording->add(this, vertices, quadCount * 4);
+}
+
+void SpriteBatch::invalidateRecordings()
+{
+    ++_recordingGeneration;
+}
+
+void SpriteBatch::addRecordingKeys(const unsigned int* keys, unsigned int keyCount)
+{
+    GP_ASSERT(keys || keyCount == 0);
+
+    if (__recording && keyCount > 0)
+        __recording->addKeys(this, keys, keyCount);
+}
+
+void SpriteBatch::setReplayFunction(ReplayFunction function, void* data)
+{
+    _replayFunction = function;
+    _replayData = data;
+}
+
+SpriteBatch::Recording::Recording()
+    : _previous(NULL), _active(false), _complete(true)
+{
+}
+
+SpriteBatch::Recording::~Recording()
+{
+    GP_ASSERT(!_active);
+}
+
+void SpriteBatch::Recording::begin()
+{
+    GP_ASSERT(!_active);
+
+    clear();
+    _previous = __recording;
+    _active = true;
+    __recording = this;
+}
+
+bool SpriteBatch::Recording::end()
+{
+    GP_ASSERT(_active && __recording == this);
+
+    __recording = _previous;
+    _active = false;
+
+    // The enclosing recording replays this one instead of copying its sprites
+    if (_previous)
+    {
+        kmVec2 offset = { 0.0f, 0.0f };
+        _previous->addRecording(this, offset);
+        _previous = NULL;
+    }
+    return _complete;
+}
+
+void SpriteBatch::Recording::clear()
+{
+    _segments.clear();
+    _batches.clear();
+    _complete = true;
+}
+
+unsigned int SpriteBatch::Recording::getBatchCount() const
+{
+    return (unsigned int)_batches.size();
+}
+
+SpriteBatch* SpriteBatch::Recording::getBatch(unsigned int index) const
+{
+    GP_ASSERT(index < _batches.size());
+    return _batches[index];
+}
+
+void SpriteBatch::Recording::replay(const kmVec2& offset) const
+{
+    GP_ASSERT(!_active);
+
+    // Refer to the replayed sprites from the enclosing recording rather than capturing them again
+    Recording* recording = __recording;
+    if (recording)
+        recording->addRecording(this, offset);
+    __recording = NULL;
+    replaySegments(offset);
+    __recording = recording;
+}
+
+bool SpriteBatch::Recording::isValid() const
+{
+    for (size_t i = 0, count = _segments.size(); i < count; ++i)
+    {
+        const Segment& segment = _segments[i];
+        if (segment.recording ? !segment.recording->isValid() : segment.generation != segment.batch->_recordingGeneration)
+            return false;
+    }
+    return true;
+}
+
+SpriteBatch::Recording::Segment* SpriteBatch::Recording::getSegment(SpriteBatch* batch)
+{
+    // Sprites drawn in a row into the same batch are merged, whichever control drew them
+    if (!_segments.empty() && _segments.back().batch == batch)
+        return &_segments.back();
+
+    addBatch(batch);
+    _segments.push_back(Segment());
+    Segment* segment = &_segments.back();
+    segment->batch = batch;
+    segment->generation = batch->_recordingGeneration;
+    segment->recording = NULL;
+    return segment;
+}
+
+void SpriteBatch::Recording::add(SpriteBatch* batch, const SpriteVertex* vertices, unsigned int vertexCount)
+{
+    Segment* segment = getSegment(batch);
+    segment->vertices.insert(segment->vertices.end(), vertices, vertices + vertexCount);
+}
+
+void SpriteBatch::Recording::addKeys(SpriteBatch* batch, const unsigned int* keys, unsigned int keyCount)
+{
+    Segment* segment = getSegment(batch);
+    segment->keys.insert(segment->keys.end(), keys, keys + keyCount);
+}
+
+void SpriteBatch::Recording::addRecording(const Recording* recording, const kmVec2& offset)
+{
+    GP_ASSERT(recording && recording != this);
+
+    _segments.push_back(Segment());
+    Segment& segment = _segments.back();
+    segment.batch = NULL;
+    segment.generation = 0;
+    segment.recording = recording;
+    segment.offset = offset;
+
+    for (size_t i = 0, count = recording->_batches.size(); i < count; ++i)
+        addBatch(recording->_batches[i]);
+    if (!recording->_complete)
+        _complete = false;
+}
+
+void SpriteBatch::Recording::addBatch(SpriteBatch* batch)
+{
+    if (std::find(_batches.begin(), _batches.end(), batch) == _batches.end())
+        _batches.push_back(batch);
+}
+
+void SpriteBatch::Recording::replaySegments(const kmVec2& offset) const
+{
+    for (size_t i = 0, count = _segments.size(); i < count; ++i)
+    {
+        const Segment& segment = _segments[i];
+        if (segment.recording)
+        {
+            kmVec2 nestedOffset = { offset.x + segment.offset.x, offset.y + segment.offset.y };
+            segment.recording->replaySegments(nestedOffset);
+            continue;
+        }
+
+        SpriteBatch* batch = segment.batch;
+        GP_ASSERT(batch && batch->isStarted());
+        unsigned int vertexCount = (unsigned int)segment.vertices.size();
+        if (vertexCount > 0)
+        {
+            SpriteVertex* vertices = (SpriteVertex*)batch->_batch->addQuads(vertexCount / 4);
+            if (vertices)
+            {
+                memcpy(vertices, &segment.vertices[0], vertexCount * sizeof(SpriteVertex));
+                if (offset.x != 0.0f || offset.y != 0.0f)
+                {
+                    for (unsigned int j = 0; j < vertexCount; ++j)
+                    {
+                        vertices[j].x += offset.x;
+                        vertices[j].y += offset.y;
+                    }
+                }
+            }
+        }
+        if (!segment.keys.empty() && batch->_replayFunction)
+            batch->_replayFunction(batch->_replayData, &segment.keys[0], (unsigned int)segment.keys.size());
+    }
+}
+
 }
@@ -287,6 +287,45 @@ public:
         float a;
     };
     
+    /**
+     * Sprites described as parallel arrays, one element per sprite, for drawing with drawMany.
+     */
+    struct SpriteArrays
+    {
+        /** The number of sprites. */
+        unsigned int count;
+        /** The x coordinates of the sprite centers. */
+        const float* x;
+        /** The y coordinates of the sprite centers. */
+        const float* y;
+        /** The z coordinates of the sprite centers. */
+        const float* z;
+        /** The sprite widths. */
+        const float* width;
+        /** The sprite heights, or NULL for square sprites as wide as they are high. */
+        const float* height;
+        /** The rotation angles in radians around the sprite centers, or NULL for no rotation. */
+        const float* angle;
+        /** The texture coordinates of the sprites as (u1, v1, u2, v2), or NULL to use the whole texture. */
+        const kmVec4* texCoords;
+        /** The colors to tint the sprites, or NULL for no tint. */
+        const kmVec4* colors;
+    };
+
+    /**
+     * Draws many sprites at once, each facing along the plane spanned by the given vectors.
+     *
+     * This produces the same quads as the draw method taking right and forward vectors with
+     * a rotation point at the sprite center, but writes them straight into the batch four
+     * sprites at a time with SIMD instructions where available. Use the x and y axes as
+     * the right and up vectors for screen space sprites.
+     *
+     * @param sprites The sprites to draw.
+     * @param right The right vector of the sprite quads (should be normalized).
+     * @param up The up vector of the sprite quads (should be normalized).
+     */
+    void drawMany(const SpriteArrays& sprites, const kmVec3& right, const kmVec3& up);
+
     /**
      * Draws an array of vertices.
      *
@@ -298,7 +337,128 @@ public:
      * @param indexCount The number of indices within the index array.
      */
     void draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, unsigned short* indices, unsigned int indexCount);
-    
+
+    /**
+     * Defines a recording of the sprites drawn into sprite batches.
+     *
+     * While a recording is active, every sprite drawn into any sprite batch is also
+     * captured, in the order it was drawn. A recording can later be replayed to draw the
+     * same sprites again without regenerating them. Recordings nest without copying: when
+     * a recording ends, or is replayed while another one is active, the enclosing recording
+     * only refers to it. Replaying the enclosing recording replays the nested one as it is
+     * at that time, so the nested recording must outlive it or be recorded again first.
+     *
+     * @script{ignore}
+     */
+    class Recording
+    {
+        friend class SpriteBatch;
+
+    public:
+
+        /**
+         * Constructor.
+         */
+        Recording();
+
+        /**
+         * Destructor.
+         */
+        ~Recording();
+
+        /**
+         * Clears the recording and starts capturing sprites.
+         */
+        void begin();
+
+        /**
+         * Stops capturing sprites.
+         *
+         * @return True if everything drawn could be recorded, false if the recording
+         *      is incomplete and must not be replayed.
+         */
+        bool end();
+
+        /**
+         * Clears the recorded sprites.
+         */
+        void clear();
+
+        /**
+         * Gets the number of sprite batches drawn into by the recording and the recordings it refers to.
+         *
+         * @return The number of sprite batches.
+         */
+        unsigned int getBatchCount() const;
+
+        /**
+         * Gets a sprite batch drawn into by the recording or the recordings it refers to,
+         * in the order the batches were first drawn into.
+         *
+         * @param index The index of the batch.
+         *
+         * @return The sprite batch.
+         */
+        SpriteBatch* getBatch(unsigned int index) const;
+
+        /**
+         * Draws the recorded sprites into their sprite batches again.
+         *
+         * All of the batches returned by getBatch must have been started.
+         *
+         * @param offset The offset to move the sprites by.
+         */
+        void replay(const kmVec2& offset) const;
+
+        /**
+         * Determines whether the recorded sprites can still be replayed.
+         *
+         * A recording goes stale when one of its batches changes the texture regions
+         * its sprites refer to, such as a font moving glyphs within its atlas, or when
+         * a recording it refers to goes stale.
+         *
+         * @return True if none of the batches have invalidated their recordings since they were recorded.
+         */
+        bool isValid() const;
+
+    private:
+
+        /**
+         * Sprites drawn in a row into one batch, or a reference to a nested recording.
+         */
+        struct Segment
+        {
+            SpriteBatch* batch;
+            unsigned int generation;
+            std::vector<SpriteVertex> vertices;
+            std::vector<unsigned int> keys;
+            const Recording* recording;
+            kmVec2 offset;
+        };
+
+        Recording(const Recording& copy);
+
+        Recording& operator=(const Recording&);
+
+        Segment* getSegment(SpriteBatch* batch);
+
+        void add(SpriteBatch* batch, const SpriteVertex* vertices, unsigned int vertexCount);
+
+        void addKeys(SpriteBatch* batch, const unsigned int* keys, unsigned int keyCount);
+
+        void addRecording(const Recording* recording, const kmVec2& offset);
+
+        void addBatch(SpriteBatch* batch);
+
+        void replaySegments(const kmVec2& offset) const;
+
+        std::vector<Segment> _segments;
+        std::vector<SpriteBatch*> _batches;
+        Recording* _previous;
+        bool _active;
+        bool _complete;
+    };
+
     /**
      * Finishes sprite drawing.
      *
@@ -402,12 +562,53 @@ private:
 
     bool clipSprite(const Rectangle& clip, float& x, float& y, float& width, float& height, float& u1, float& v1, float& u2, float& v2);
 
+    /**
+     * Adds a sprite quad to the batch and to the active recording, if any.
+     *
+     * @param vertices The four vertices of the quad, in triangle strip order.
+     */
+    void addQuad(const SpriteVertex* vertices);
+
+    /**
+     * Adds sprite quads to the batch and to the active recording, if any.
+     *
+     * @param vertices The vertices of the quads, four per quad in triangle strip order.
+     * @param quadCount The number of quads.
+     */
+    void addQuads(const SpriteVertex* vertices, unsigned int quadCount);
+
+    /**
+     * Makes every recording of sprites drawn into this batch invalid.
+     */
+    void invalidateRecordings();
+
+    /**
+     * Called with the keys recorded for the sprites of a batch each time they are replayed.
+     */
+    typedef void (*ReplayFunction)(void* data, const unsigned int* keys, unsigned int keyCount);
+
+    /**
+     * Records keys along with the sprites drawn into this batch by the active recording, if any.
+     *
+     * The keys are passed to the replay function of the batch whenever the recording is
+     * replayed, such as a font marking the glyphs of replayed text as used.
+     */
+    void addRecordingKeys(const unsigned int* keys, unsigned int keyCount);
+
+    /**
+     * Sets the function called with the recorded keys when sprites of this batch are replayed.
+     */
+    void setReplayFunction(ReplayFunction function, void* data);
+
     MeshBatch* _batch;
     Texture::Sampler* _sampler;
     bool _customEffect;
     float _textureWidthRatio;
     float _textureHeightRatio;
     mutable kmMat4 _projectionMatrix;
+    unsigned int _recordingGeneration;
+    ReplayFunction _replayFunction;
+    void* _replayData;
 };
 
 }
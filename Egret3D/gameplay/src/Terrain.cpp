@@ -2,6 +2,8 @@
 #include "Terrain.h"
 #include "TerrainPatch.h"
 #include "Node.h"
+#include "Scene.h"
+#include "Game.h"
 #include "FileSystem.h"
 
 namespace egret
@@ -22,6 +24,15 @@ static const unsigned int DEFAULT_TERRAIN_PATCH_SIZE = 32;
 //
 static const float DEFAULT_TERRAIN_HEIGHT_RATIO = 0.3f;
 
+// The default screen-space error tolerance, in pixels, for selecting terrain levels of detail.
+static const float DEFAULT_TERRAIN_PIXEL_ERROR = 2.0f;
+
+// The default memory budget, in megabytes, of the resident pages of a streamed terrain.
+static const unsigned int DEFAULT_TERRAIN_PAGE_BUDGET = 64;
+
+// The default number of pages a streamed terrain loads per frame.
+static const unsigned int DEFAULT_TERRAIN_PAGE_LOADS = 4;
+
 // Terrain dirty flags
 static const unsigned int DIRTY_FLAG_INVERSE_WORLD = 1;
 
@@ -30,7 +41,8 @@ static float getDefaultHeight(unsigned int width, unsigned int height);
 Terrain::Terrain() : Drawable(),
     _heightfield(NULL), _normalMap(NULL), 
 	_flags(FRUSTUM_CULLING | LEVEL_OF_DETAIL),
-    _dirtyFlags(DIRTY_FLAG_INVERSE_WORLD)
+    _dirtyFlags(DIRTY_FLAG_INVERSE_WORLD), _pixelError(DEFAULT_TERRAIN_PIXEL_ERROR), _skirtScale(0.0f),
+    _pager(NULL), _selectionTime(0.0)
 {
 	_localScale = vec3Zero;
 	memset(_inverseWorldMatrix.mat, 0, sizeof(float) * 16);
@@ -42,6 +54,7 @@ Terrain::~Terrain()
     {
         SAFE_DELETE(_patches[i]);
     }
+    SAFE_DELETE(_pager);
     SAFE_RELEASE(_normalMap);
     SAFE_RELEASE(_heightfield);
 }
@@ -63,6 +76,11 @@ Terrain* Terrain::create(const char* path, Properties* properties)
     Properties* pTerrain = NULL;
     bool externalProperties = (p != NULL);
     HeightField* heightfield = NULL;
+    TerrainPager* pager = NULL;
+    std::string streamedPath;
+    unsigned int columnCount = 0, rowCount = 0;
+    unsigned int pageBudget = DEFAULT_TERRAIN_PAGE_BUDGET;
+    unsigned int pageLoads = DEFAULT_TERRAIN_PAGE_LOADS;
     kmVec3 terrainSize = vec3Zero;
     int patchSize = 0;
     int detailLevels = 1;
@@ -122,8 +140,22 @@ Terrain* Terrain::create(const char* path, Properties* properties)
                 return NULL;
             }
 
-            // Read normalized height values from RAW file
-            heightfield = HeightField::createFromRAW(heightmap.c_str(), (unsigned int)imageSize.x, (unsigned int)imageSize.y, 0, 1);
+            if (pHeightmap->getBool("streamed"))
+            {
+                // Streamed heightmaps are paged in once the patch size is known
+                streamedPath = heightmap;
+                columnCount = (unsigned int)imageSize.x;
+                rowCount = (unsigned int)imageSize.y;
+                if (pHeightmap->exists("pageBudget"))
+                    pageBudget = (unsigned int)std::max(pHeightmap->getInt("pageBudget"), 1);
+                if (pHeightmap->exists("pageLoads"))
+                    pageLoads = (unsigned int)std::max(pHeightmap->getInt("pageLoads"), 1);
+            }
+            else
+            {
+                // Read normalized height values from RAW file
+                heightfield = HeightField::createFromRAW(heightmap.c_str(), (unsigned int)imageSize.x, (unsigned int)imageSize.y, 0, 1);
+            }
         }
         else
         {
@@ -201,7 +233,12 @@ Terrain* Terrain::create(const char* path, Properties* properties)
     // Read 'material'
     materialPath = pTerrain->getString("material", "");
 
-    if (heightfield == NULL)
+    if (heightfield)
+    {
+        columnCount = heightfield->getColumnCount();
+        rowCount = heightfield->getRowCount();
+    }
+    else if (streamedPath.empty())
     {
         GP_WARN("Failed to read heightfield heights for terrain definition: %s", path);
         if (!externalProperties)
@@ -212,12 +249,25 @@ Terrain* Terrain::create(const char* path, Properties* properties)
 	if (kmVec3IsZero(&terrainSize))
     {
         //terrainSize.set(heightfield->getColumnCount(), getDefaultHeight(heightfield->getColumnCount(), heightfield->getRowCount()), heightfield->getRowCount());
-		kmVec3Fill(&terrainSize, heightfield->getColumnCount(), getDefaultHeight(heightfield->getColumnCount(), heightfield->getRowCount()), heightfield->getRowCount());
+		kmVec3Fill(&terrainSize, columnCount, getDefaultHeight(columnCount, rowCount), rowCount);
+    }
+
+    if (patchSize <= 0 || patchSize > (int)columnCount || patchSize > (int)rowCount)
+    {
+        patchSize = std::min(rowCount, std::min(columnCount, DEFAULT_TERRAIN_PATCH_SIZE));
     }
 
-    if (patchSize <= 0 || patchSize > (int)heightfield->getColumnCount() || patchSize > (int)heightfield->getRowCount())
+    if (!streamedPath.empty())
     {
-        patchSize = std::min(heightfield->getRowCount(), std::min(heightfield->getColumnCount(), DEFAULT_TERRAIN_PATCH_SIZE));
+        // Streamed terrains use the patch size as their page size
+        pager = TerrainPager::create(streamedPath.c_str(), columnCount, rowCount, (unsigned int)patchSize, (size_t)pageBudget * 1024 * 1024, pageLoads);
+        if (pager == NULL)
+        {
+            GP_WARN("Failed to open streamed heightmap for terrain definition: %s", path);
+            if (!externalProperties)
+                SAFE_DELETE(p);
+            return NULL;
+        }
     }
 
     if (detailLevels <= 0)
@@ -227,10 +277,12 @@ Terrain* Terrain::create(const char* path, Properties* properties)
         skirtScale = 0;
 
     // Compute terrain scale
-	kmVec3 scale = { terrainSize.x / (heightfield->getColumnCount() - 1), terrainSize.y, terrainSize.z / (heightfield->getRowCount() - 1) };
+	kmVec3 scale = { terrainSize.x / (columnCount - 1), terrainSize.y, terrainSize.z / (rowCount - 1) };
 
     // Create terrain
-    Terrain* terrain = create(heightfield, scale, (unsigned int)patchSize, (unsigned int)detailLevels, skirtScale, normalMap, materialPath.c_str(), pTerrain);
+    Terrain* terrain = create(heightfield, pager, scale, (unsigned int)patchSize, (unsigned int)detailLevels, skirtScale, normalMap, materialPath.c_str(), pTerrain);
+    if (terrain && pTerrain->exists("pixelError"))
+        terrain->_pixelError = std::max(pTerrain->getFloat("pixelError"), 0.0f);
 
     if (!externalProperties)
         SAFE_DELETE(p);
@@ -240,21 +292,20 @@ Terrain* Terrain::create(const char* path, Properties* properties)
 
 Terrain* Terrain::create(HeightField* heightfield, const kmVec3& scale, unsigned int patchSize, unsigned int detailLevels, float skirtScale, const char* normalMapPath, const char* materialPath)
 {
-    return create(heightfield, scale, patchSize, detailLevels, skirtScale, normalMapPath, materialPath, NULL);
+    return create(heightfield, NULL, scale, patchSize, detailLevels, skirtScale, normalMapPath, materialPath, NULL);
 }
 
-Terrain* Terrain::create(HeightField* heightfield, const kmVec3& scale,
+Terrain* Terrain::create(HeightField* heightfield, TerrainPager* pager, const kmVec3& scale,
     unsigned int patchSize, unsigned int detailLevels, float skirtScale,
     const char* normalMapPath, const char* materialPath, Properties* properties)
 {
-    GP_ASSERT(heightfield);
-
-    unsigned int width = heightfield->getColumnCount();
-    unsigned int height = heightfield->getRowCount();
+    GP_ASSERT(heightfield || pager);
 
     // Create the terrain object
     Terrain* terrain = new Terrain();
     terrain->_heightfield = heightfield;
+    terrain->_pager = pager;
+    terrain->_skirtScale = skirtScale;
     terrain->_materialPath = (materialPath == NULL || strlen(materialPath) == 0) ? TERRAIN_MATERIAL : materialPath;
 
     // Store terrain local scaling so it can be applied to the heightfield
@@ -269,6 +320,8 @@ Terrain* Terrain::create(HeightField* heightfield, const kmVec3& scale,
         GP_ASSERT( terrain->_normalMap->getTexture()->getType() == Texture::TEXTURE_2D );
     }
 
+    unsigned int width = terrain->getColumnCount();
+    unsigned int height = terrain->getRowCount();
     float halfWidth = (width - 1) * 0.5f;
     float halfHeight = (height - 1) * 0.5f;
 
@@ -277,10 +330,10 @@ Terrain* Terrain::create(HeightField* heightfield, const kmVec3& scale,
     // level detail terrain patch.
     unsigned int maxStep = (unsigned int)std::pow(2.0, (double)(detailLevels-1));
 
-    // Create terrain patches
+    // Create terrain patches (streamed terrains create their patches as pages are loaded)
     unsigned int x1, x2, z1, z2;
     unsigned int row = 0, column = 0;
-    for (unsigned int z = 0; z < height-1; z = z2, ++row)
+    for (unsigned int z = 0; z < height-1 && !pager; z = z2, ++row)
     {
         z1 = z;
         z2 = std::min(z1 + patchSize, height-1);
@@ -375,6 +428,18 @@ Terrain* Terrain::create(HeightField* heightfield, const kmVec3& scale,
     for (size_t i = 0, count = terrain->_patches.size(); i < count; ++i)
         terrain->_patches[i]->updateMaterial();
 
+    // Load the root page of a streamed terrain, which bounds the whole terrain
+    if (pager)
+    {
+        if (!pager->initialize(terrain))
+        {
+            GP_WARN("Failed to load the root page of a streamed terrain.");
+            SAFE_RELEASE(terrain);
+            return NULL;
+        }
+        terrain->_boundingBox.set(pager->_root->patch->getBoundingBox(false));
+    }
+
     return terrain;
 }
 
@@ -396,6 +461,13 @@ void Terrain::setNode(Node* node)
         {
             _patches[i]->updateNodeBindings();
         }
+        if (_pager)
+        {
+            for (std::map<unsigned long long, TerrainPager::Page*>::iterator itr = _pager->_pages.begin(); itr != _pager->_pages.end(); ++itr)
+            {
+                itr->second->patch->updateNodeBindings();
+            }
+        }
         _dirtyFlags |= DIRTY_FLAG_INVERSE_WORLD;
     }
 }
@@ -434,6 +506,35 @@ bool Terrain::setLayer(int index, const char* texturePath, const kmVec2& texture
     if (!texturePath)
         return false;
 
+    if (_pager)
+    {
+        if (row != -1 || column != -1)
+            GP_WARN("Layers of streamed terrains always span the entire terrain.");
+
+        // Remember the layer for pages loaded later on
+        Layer layer;
+        layer.index = index;
+        layer.texturePath = texturePath;
+        layer.textureRepeat = textureRepeat;
+        layer.blendPath = blendPath ? blendPath : "";
+        layer.blendChannel = blendChannel;
+        std::vector<Layer>::iterator itr = _streamedLayers.begin();
+        while (itr != _streamedLayers.end() && itr->index != index)
+            ++itr;
+        if (itr != _streamedLayers.end())
+            *itr = layer;
+        else
+            _streamedLayers.push_back(layer);
+
+        bool result = true;
+        for (std::map<unsigned long long, TerrainPager::Page*>::iterator itr = _pager->_pages.begin(); itr != _pager->_pages.end(); ++itr)
+        {
+            if (!itr->second->patch->setLayer(index, texturePath, textureRepeat, blendPath, blendChannel))
+                result = false;
+        }
+        return result;
+    }
+
     // Set layer on applicable patches
     bool result = true;
     for (size_t i = 0, count = _patches.size(); i < count; ++i)
@@ -482,6 +583,13 @@ void Terrain::setFlag(Flags flag, bool on)
         {
             _patches[i]->setMaterialDirty();
         }
+        if (_pager)
+        {
+            for (std::map<unsigned long long, TerrainPager::Page*>::iterator itr = _pager->_pages.begin(); itr != _pager->_pages.end(); ++itr)
+            {
+                itr->second->patch->setMaterialDirty();
+            }
+        }
     }
 }
 
@@ -503,8 +611,8 @@ const BoundingBox& Terrain::getBoundingBox() const
 float Terrain::getHeight(float x, float z) const
 {
     // Calculate the correct x, z position relative to the heightfield data.
-    float cols = _heightfield->getColumnCount();
-    float rows = _heightfield->getRowCount();
+    float cols = getColumnCount();
+    float rows = getRowCount();
 
     GP_ASSERT(cols > 0);
     GP_ASSERT(rows > 0);
@@ -518,8 +626,8 @@ float Terrain::getHeight(float x, float z) const
     x = v.x + (cols - 1) * 0.5f;
     z = v.z + (rows - 1) * 0.5f;
 
-    // Get the unscaled height value from the HeightField
-    float height = _heightfield->getHeight(x, z);
+    // Get the unscaled height value from the HeightField, or the finest resident page of a streamed terrain
+    float height = _pager ? _pager->getHeight(x, z) : _heightfield->getHeight(x, z);
 
     // Apply world scale to the height value
     if (_node)
@@ -543,9 +651,192 @@ unsigned int Terrain::draw(bool wireframe)
     {
         visibleCount += _patches[i]->draw(wireframe);
     }
+
+    if (_pager)
+    {
+        Scene* scene = _node ? _node->getScene() : NULL;
+        Camera* camera = scene ? scene->getActiveCamera() : NULL;
+        if (!camera)
+            return 0;
+
+        // Build the pages read since the last frame, then select the pages to draw,
+        // requesting the missing ones from the loader thread
+        _pager->beginFrame();
+        double startTime = Game::getAbsoluteTime();
+        _visiblePages.clear();
+        selectPages(camera, _pager->_root);
+        _pager->evictPages();
+        _selectionTime = Game::getAbsoluteTime() - startTime;
+
+        for (size_t i = 0, count = _visiblePages.size(); i < count; ++i)
+        {
+            visibleCount += _visiblePages[i]->patch->draw(wireframe);
+        }
+    }
     return visibleCount;
 }
 
+bool Terrain::isStreamed() const
+{
+    return _pager != NULL;
+}
+
+unsigned int Terrain::getResidentPageCount() const
+{
+    return _pager ? (unsigned int)_pager->_pages.size() : 0;
+}
+
+unsigned int Terrain::getPageLoadCount() const
+{
+    return _pager ? _pager->_loadCount : 0;
+}
+
+double Terrain::getPageLoadTime() const
+{
+    return _pager ? _pager->_loadTime : 0.0;
+}
+
+double Terrain::getSelectionTime() const
+{
+    return _selectionTime;
+}
+
+unsigned int Terrain::getColumnCount() const
+{
+    return _pager ? _pager->_width : _heightfield->getColumnCount();
+}
+
+unsigned int Terrain::getRowCount() const
+{
+    return _pager ? _pager->_height : _heightfield->getRowCount();
+}
+
+float Terrain::computeScreenError(Camera* camera, const BoundingBox& worldBounds, float error) const
+{
+    GP_ASSERT(camera);
+    if (error <= 0.0f)
+        return 0.0f;
+
+    float viewportHeight = (float)Game::getInstance()->getHeight();
+    if (camera->getCameraType() == Camera::ORTHOGRAPHIC)
+        return error * viewportHeight / camera->getZoomY();
+
+    // Distance from the eye to the nearest point of the bounds
+    kmVec3 eye = camera->getNode() ? camera->getNode()->getTranslationWorld() : vec3Zero;
+    kmVec3 nearest =
+    {
+        std::min(std::max(eye.x, worldBounds.min.x), worldBounds.max.x),
+        std::min(std::max(eye.y, worldBounds.min.y), worldBounds.max.y),
+        std::min(std::max(eye.z, worldBounds.min.z), worldBounds.max.z)
+    };
+    float distance = std::max(kmVec3Distance(&eye, &nearest), 0.001f);
+
+    return error * viewportHeight / (2.0f * tanf(MATH_DEG_TO_RAD(camera->getFieldOfView()) * 0.5f) * distance);
+}
+
+TerrainPatch* Terrain::createPagePatch(const TerrainPager::Page* page)
+{
+    GP_ASSERT(_pager && page && page->heights);
+
+    // A page covers pageSize quads every 'stride' samples, clipped to the heightmap
+    unsigned int stride = 1 << page->level;
+    unsigned int span = _pager->_pageSize * stride;
+    unsigned int x1 = page->x * span;
+    unsigned int z1 = page->z * span;
+    unsigned int quadsX = std::min(_pager->_pageSize, (getColumnCount() - 1 - x1 + stride - 1) / stride);
+    unsigned int quadsZ = std::min(_pager->_pageSize, (getRowCount() - 1 - z1 + stride - 1) / stride);
+
+    // Skirts hide cracks against coarser neighbors, which differ by up to this page's error
+    float skirtSize = std::max(_skirtScale, page->error * 2.0f / (_localScale.y > 0.0f ? _localScale.y : 1.0f));
+
+    TerrainPatch* patch = TerrainPatch::createPage(this, page->z, page->x,
+        page->heights->getArray(), page->heights->getColumnCount(), page->heights->getRowCount(),
+        (int)x1 - (int)stride, (int)z1 - (int)stride, stride, quadsX, quadsZ,
+        -(getColumnCount() - 1) * 0.5f, -(getRowCount() - 1) * 0.5f, skirtSize);
+
+    for (size_t i = 0, count = _streamedLayers.size(); i < count; ++i)
+    {
+        const Layer& layer = _streamedLayers[i];
+        if (!patch->setLayer(layer.index, layer.texturePath.c_str(), layer.textureRepeat,
+                             layer.blendPath.empty() ? NULL : layer.blendPath.c_str(), layer.blendChannel))
+        {
+            GP_WARN("Failed to load terrain layer: %s", layer.texturePath.c_str());
+        }
+    }
+    patch->updateMaterial();
+
+    return patch;
+}
+
+BoundingBox Terrain::getChildPageBounds(const TerrainPager::Page* page, unsigned int x, unsigned int z) const
+{
+    GP_ASSERT(_pager && page && page->patch && page->level > 0);
+
+    // The child covers a quadrant of its parent, clipped to the heightmap
+    float span = (float)((size_t)_pager->_pageSize << (page->level - 1));
+    float xOffset = -(getColumnCount() - 1) * 0.5f;
+    float zOffset = -(getRowCount() - 1) * 0.5f;
+    float x1 = x * span;
+    float z1 = z * span;
+    float x2 = std::min(x1 + span, (float)(getColumnCount() - 1));
+    float z2 = std::min(z1 + span, (float)(getRowCount() - 1));
+
+    // Its heights lie within the parent's, give or take the detail the parent skips
+    const BoundingBox& parentBounds = page->patch->getBoundingBox(false);
+    kmVec3 min = { (x1 + xOffset) * _localScale.x, parentBounds.min.y - page->error, (z1 + zOffset) * _localScale.z };
+    kmVec3 max = { (x2 + xOffset) * _localScale.x, parentBounds.max.y + page->error, (z2 + zOffset) * _localScale.z };
+    BoundingBox bounds(min, max);
+    if (_node)
+        bounds.transform(_node->getWorldMatrix());
+    return bounds;
+}
+
+void Terrain::selectPages(Camera* camera, TerrainPager::Page* page)
+{
+    GP_ASSERT(page && page->patch);
+
+    const BoundingBox& bounds = page->patch->getBoundingBox(true);
+    if (isFlagSet(FRUSTUM_CULLING) && !camera->getFrustum().intersects(bounds))
+        return;
+
+    // Refine while the page's error is visible, once all of its children are resident
+    if (page->level > 0 && isFlagSet(LEVEL_OF_DETAIL) && computeScreenError(camera, bounds, page->error) > _pixelError)
+    {
+        TerrainPager::Page* children[4];
+        unsigned int childCount = 0;
+        bool resident = true;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            unsigned int x = page->x * 2 + (i & 1);
+            unsigned int z = page->z * 2 + (i >> 1);
+            if (!_pager->pageExists(page->level - 1, x, z))
+                continue;
+
+            // Children outside the view are neither loaded nor drawn
+            if (isFlagSet(FRUSTUM_CULLING) && !camera->getFrustum().intersects(getChildPageBounds(page, x, z)))
+                continue;
+
+            // Keep requesting the other children so that they load over the next frames
+            children[childCount] = _pager->getPage(page->level - 1, x, z, true);
+            if (children[childCount])
+                ++childCount;
+            else
+                resident = false;
+        }
+
+        if (resident)
+        {
+            for (unsigned int i = 0; i < childCount; ++i)
+            {
+                selectPages(camera, children[i]);
+            }
+            return;
+        }
+    }
+
+    _visiblePages.push_back(page);
+}
+
 Drawable* Terrain::clone(NodeCloneContext& context)
 {
     // TODO:
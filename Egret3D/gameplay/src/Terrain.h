@@ -9,6 +9,7 @@
 #include "Texture.h"
 #include "BoundingBox.h"
 #include "TerrainPatch.h"
+#include "TerrainPager.h"
 
 namespace egret
 {
@@ -67,6 +68,22 @@ class TerrainAutoBindingResolver;
  * Using too large a number for detailLevels can result in excessive popping in the distance
  * for very hilly terrains, so a smaller number (2-3) often works best in these cases.
  *
+ * Each level stores its geometric error (the largest height difference to the base level)
+ * and a patch uses the coarsest level whose error, projected to the screen, stays within
+ * the pixelError property (2 pixels by default).
+ *
+ * Very large RAW heightmaps can be streamed instead of loaded, by setting 'streamed = true'
+ * in the heightmap section. A streamed terrain keeps the heightmap on disk and reads it in
+ * pages of patchSize quads, which form a quadtree from a single coarse root page down to
+ * full resolution pages. Every frame the quadtree is refined while a page's projected error
+ * exceeds pixelError; visible pages are read on demand on a loader thread (and at most
+ * 'pageLoads' of them built per frame, drawing the coarser page until its children arrive)
+ * and the least recently used pages are evicted
+ * once the resident pages exceed 'pageBudget' megabytes. The skirts of streamed pages are
+ * sized from their geometric error so that neighboring pages of different levels never
+ * show cracks. Streamed terrains have no patches (see getPatchCount) and cannot be used as
+ * heightfield collision shapes.
+ *
  * Finally, when LOD is enabled, cracks can begin to appear between terrain patches of
  * different LOD levels. If the cracks are only minor (depends on your terrain topology
  * and textures used), an acceptable approach might be to simply use a background clear
@@ -87,6 +104,7 @@ class Terrain : public Ref, public Drawable, private Transform::Listener
     friend class PhysicsController;
     friend class PhysicsRigidBody;
     friend class TerrainPatch;
+    friend class TerrainPager;
     friend class TerrainAutoBindingResolver;
 
 public:
@@ -252,6 +270,7 @@ public:
      * @param blendChannel Channel of the blend texture to sample for the blend map (0 == R, 1 == G, 2 == B, 3 == A).
      * @param row Specifies the row index of patches to use this layer (optional, -1 means all rows).
      * @param column Specifies the column index of patches to use this layer (optional, -1 means all columns).
+     *      Layers of streamed terrains always span the entire terrain.
      *
      * @return True if the layer was successfully set, false otherwise. The most common reason for failure is an
      *      invalid texture path.
@@ -267,6 +286,42 @@ public:
      */
     unsigned int draw(bool wireframe = false);
 
+    /**
+     * Determines whether the terrain heightmap is streamed from disk.
+     *
+     * @return True if the terrain is streamed.
+     */
+    bool isStreamed() const;
+
+    /**
+     * Gets the number of heightmap pages of a streamed terrain currently in memory.
+     *
+     * @return The number of resident pages.
+     */
+    unsigned int getResidentPageCount() const;
+
+    /**
+     * Gets the total number of heightmap pages a streamed terrain has loaded from disk.
+     *
+     * @return The number of page loads.
+     */
+    unsigned int getPageLoadCount() const;
+
+    /**
+     * Gets the total time a streamed terrain has spent loading pages from disk.
+     *
+     * @return The page load time, in milliseconds.
+     */
+    double getPageLoadTime() const;
+
+    /**
+     * Gets the time taken by the level of detail selection of the last draw of a
+     * streamed terrain, excluding page loads.
+     *
+     * @return The selection time, in milliseconds.
+     */
+    double getSelectionTime() const;
+
 protected:
 
     /**
@@ -301,10 +356,22 @@ private:
      */
     ~Terrain();
 
+    /**
+     * A layer of a streamed terrain, applied to pages as they are loaded.
+     */
+    struct Layer
+    {
+        int index;
+        std::string texturePath;
+        kmVec2 textureRepeat;
+        std::string blendPath;
+        int blendChannel;
+    };
+
     /**
      * Internal method for creating terrain.
      */
-    static Terrain* create(HeightField* heightfield, const kmVec3& scale, 
+    static Terrain* create(HeightField* heightfield, TerrainPager* pager, const kmVec3& scale, 
         unsigned int patchSize, unsigned int detailLevels, float skirtScale, 
         const char* normalMapPath, const char* materialPath, Properties* properties);
 
@@ -329,6 +396,42 @@ private:
      */
     BoundingBox getBoundingBox(bool worldSpace) const;
 
+    /**
+     * Gets the number of heightmap columns.
+     */
+    unsigned int getColumnCount() const;
+
+    /**
+     * Gets the number of heightmap rows.
+     */
+    unsigned int getRowCount() const;
+
+    /**
+     * Projects a geometric error to the screen.
+     *
+     * @param camera The camera to project with.
+     * @param worldBounds The world-space bounds of the geometry.
+     * @param error The geometric error, in terrain local units.
+     *
+     * @return The largest error in pixels at the point of the bounds nearest to the camera.
+     */
+    float computeScreenError(Camera* camera, const BoundingBox& worldBounds, float error) const;
+
+    /**
+     * Creates the patch drawing a newly loaded page of a streamed terrain.
+     */
+    TerrainPatch* createPagePatch(const TerrainPager::Page* page);
+
+    /**
+     * Estimates the world-space bounds of a child page from its parent, before the child is loaded.
+     */
+    BoundingBox getChildPageBounds(const TerrainPager::Page* page, unsigned int x, unsigned int z) const;
+
+    /**
+     * Refines the page quadtree of a streamed terrain from the given page, collecting the pages to draw.
+     */
+    void selectPages(Camera* camera, TerrainPager::Page* page);
+
     std::string _materialPath;
     HeightField* _heightfield;
     kmVec3 _localScale = vec3Zero;
@@ -338,6 +441,12 @@ private:
     mutable kmMat4 _inverseWorldMatrix;
     mutable unsigned int _dirtyFlags;
     BoundingBox _boundingBox;
+    float _pixelError;
+    float _skirtScale;
+    TerrainPager* _pager;
+    std::vector<Layer> _streamedLayers;
+    std::vector<TerrainPager::Page*> _visiblePages;
+    double _selectionTime;
 };
 
 }
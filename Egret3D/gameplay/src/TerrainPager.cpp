@@ -0,0 +1,438 @@
+#include "Base.h"
+#include "TerrainPager.h"
+#include "Terrain.h"
+#include "TerrainPatch.h"
+#include "MeshPart.h"
+#include "FileSystem.h"
+#include "Game.h"
+
+namespace egret
+{
+
+TerrainPager::TerrainPager()
+    : _terrain(NULL), _width(0), _height(0), _bytesPerSample(0), _pageSize(0), _levelCount(0),
+      _memoryBudget(0), _memoryUsed(0), _root(NULL), _loaderThreadActive(false), _frame(0), _pageLoads(0),
+      _maxPageLoads(0), _loadCount(0), _evictionCount(0), _loadTime(0.0)
+{
+}
+
+TerrainPager::~TerrainPager()
+{
+    stopLoading();
+
+    for (std::map<unsigned long long, Page*>::iterator itr = _requests.begin(); itr != _requests.end(); ++itr)
+    {
+        deletePage(itr->second);
+    }
+    _requests.clear();
+    _loadQueue.clear();
+    _readPages.clear();
+
+    for (std::map<unsigned long long, Page*>::iterator itr = _pages.begin(); itr != _pages.end(); ++itr)
+    {
+        Page* page = itr->second;
+        SAFE_DELETE(page->patch);
+        deletePage(page);
+    }
+    _pages.clear();
+    _lru.clear();
+}
+
+TerrainPager* TerrainPager::create(const char* path, unsigned int width, unsigned int height,
+                                   unsigned int pageSize, size_t memoryBudget, unsigned int maxPageLoads)
+{
+    GP_ASSERT(path);
+
+    if (width < 2 || height < 2 || pageSize == 0)
+    {
+        GP_WARN("Invalid 'width', 'height' or page size for streamed heightmap: %s.", path);
+        return NULL;
+    }
+
+    std::unique_ptr<Stream> stream(FileSystem::open(path));
+    if (stream.get() == NULL || !stream->canSeek())
+    {
+        GP_WARN("Failed to open streamed heightmap: %s.", path);
+        return NULL;
+    }
+
+    // Determine if the RAW file is 8-bit or 16-bit based on file size.
+    size_t samples = (size_t)width * height;
+    unsigned int bytesPerSample = (unsigned int)(stream->length() / samples);
+    if ((bytesPerSample != 1 && bytesPerSample != 2) || stream->length() != samples * bytesPerSample)
+    {
+        GP_WARN("Invalid RAW file - must be 8-bit or 16-bit, but found neither: %s.", path);
+        return NULL;
+    }
+
+    TerrainPager* pager = new TerrainPager();
+    pager->_stream.reset(stream.release());
+    pager->_width = width;
+    pager->_height = height;
+    pager->_bytesPerSample = bytesPerSample;
+    pager->_pageSize = pageSize;
+    pager->_memoryBudget = memoryBudget;
+    pager->_maxPageLoads = maxPageLoads;
+
+    // The root page covers the whole heightmap
+    unsigned int quads = std::max(width, height) - 1;
+    pager->_levelCount = 1;
+    while (((size_t)pageSize << (pager->_levelCount - 1)) < quads)
+        ++pager->_levelCount;
+
+    return pager;
+}
+
+bool TerrainPager::initialize(Terrain* terrain)
+{
+    GP_ASSERT(terrain);
+    _terrain = terrain;
+
+    // The root page is read here, before the loader thread owns the stream
+    Page* root = createPage(_levelCount - 1, 0, 0);
+    if (!readPage(root))
+    {
+        GP_WARN("Failed to read the root page of a streamed heightmap.");
+        deletePage(root);
+        return false;
+    }
+    root->read = true;
+    root->error = computePageError(root);
+    installPage(root);
+
+    // The root page always stays resident, so it is kept out of the eviction order
+    _lru.erase(root->lru);
+    _root = root;
+
+    _loaderMutex.reset(new std::mutex());
+    _loaderCondition.reset(new std::condition_variable());
+    _loaderThreadActive = true;
+    _loaderThread.reset(new std::thread(&loaderThreadProc, this));
+
+    return true;
+}
+
+void TerrainPager::beginFrame()
+{
+    ++_frame;
+    _pageLoads = 0;
+
+    if (!_loaderThread)
+        return;
+
+    std::vector<Page*> readPages;
+    {
+        std::lock_guard<std::mutex> lock(*_loaderMutex);
+        readPages.swap(_readPages);
+
+        // Drop the queued requests the selection no longer asks for
+        for (std::deque<Page*>::iterator itr = _loadQueue.begin(); itr != _loadQueue.end();)
+        {
+            Page* page = *itr;
+            if (page->lastUsed + 1 < _frame)
+            {
+                _requests.erase(getPageKey(page->level, page->x, page->z));
+                deletePage(page);
+                itr = _loadQueue.erase(itr);
+            }
+            else
+            {
+                ++itr;
+            }
+        }
+    }
+
+    // Build the patches of the pages that were read, keeping the rest for the next frames
+    for (size_t i = 0, count = readPages.size(); i < count; ++i)
+    {
+        Page* page = readPages[i];
+        if (page->read && _pageLoads >= _maxPageLoads)
+        {
+            std::lock_guard<std::mutex> lock(*_loaderMutex);
+            _readPages.push_back(page);
+            continue;
+        }
+
+        _requests.erase(getPageKey(page->level, page->x, page->z));
+        if (!page->read)
+        {
+            GP_WARN("Failed to read page (%u, %u) at level %u of a streamed heightmap.", page->x, page->z, page->level);
+            deletePage(page);
+            continue;
+        }
+
+        ++_pageLoads;
+        installPage(page);
+    }
+}
+
+bool TerrainPager::pageExists(unsigned int level, unsigned int x, unsigned int z) const
+{
+    size_t span = (size_t)_pageSize << level;
+    return x * span < _width - 1 && z * span < _height - 1;
+}
+
+TerrainPager::Page* TerrainPager::getPage(unsigned int level, unsigned int x, unsigned int z, bool load)
+{
+    unsigned long long key = getPageKey(level, x, z);
+    std::map<unsigned long long, Page*>::iterator itr = _pages.find(key);
+    if (itr != _pages.end())
+    {
+        // Move the page to the front of the least recently used list
+        Page* page = itr->second;
+        page->lastUsed = _frame;
+        if (page != _root)
+            _lru.splice(_lru.begin(), _lru, page->lru);
+        return page;
+    }
+
+    if (!load || !_loaderThread)
+        return NULL;
+
+    itr = _requests.find(key);
+    if (itr != _requests.end())
+    {
+        // Already requested; keep the request alive
+        itr->second->lastUsed = _frame;
+        return NULL;
+    }
+
+    Page* page = createPage(level, x, z);
+    _requests[key] = page;
+    {
+        std::lock_guard<std::mutex> lock(*_loaderMutex);
+        _loadQueue.push_back(page);
+    }
+    _loaderCondition->notify_one();
+    return NULL;
+}
+
+void TerrainPager::evictPages()
+{
+    while (_memoryUsed > _memoryBudget && !_lru.empty())
+    {
+        // Pages used this frame are at the front of the list, so stop at the first one
+        Page* page = _lru.back();
+        if (page->lastUsed == _frame)
+            break;
+
+        releasePage(page);
+        ++_evictionCount;
+    }
+}
+
+float TerrainPager::getHeight(float column, float row) const
+{
+    GP_ASSERT(_root);
+
+    column = std::min(std::max(column, 0.0f), (float)(_width - 1));
+    row = std::min(std::max(row, 0.0f), (float)(_height - 1));
+
+    // Descend to the finest resident page containing the position
+    const Page* page = _root;
+    while (page->level > 0)
+    {
+        float childSpan = (float)((size_t)_pageSize << (page->level - 1));
+        std::map<unsigned long long, Page*>::const_iterator itr =
+            _pages.find(getPageKey(page->level - 1, (unsigned int)(column / childSpan), (unsigned int)(row / childSpan)));
+        if (itr == _pages.end())
+            break;
+        page = itr->second;
+    }
+
+    // Page samples are 'stride' apart and offset by the apron
+    float stride = (float)(1 << page->level);
+    float span = _pageSize * stride;
+    return page->heights->getHeight((column - page->x * span) / stride + 1.0f, (row - page->z * span) / stride + 1.0f);
+}
+
+TerrainPager::Page* TerrainPager::createPage(unsigned int level, unsigned int x, unsigned int z)
+{
+    Page* page = new Page();
+    page->level = level;
+    page->x = x;
+    page->z = z;
+    page->heights = HeightField::create(_pageSize + 3, _pageSize + 3);
+    page->patch = NULL;
+    page->error = 0.0f;
+    page->memorySize = 0;
+    page->lastUsed = _frame;
+    page->read = false;
+    page->readTime = 0.0;
+    return page;
+}
+
+void TerrainPager::installPage(Page* page)
+{
+    GP_ASSERT(_terrain);
+    GP_ASSERT(page && page->read);
+    GP_ASSERT(_pages.find(getPageKey(page->level, page->x, page->z)) == _pages.end());
+
+    double startTime = Game::getAbsoluteTime();
+
+    // The loader thread measures the error in normalized heights
+    page->error *= _terrain->_localScale.y;
+    page->patch = _terrain->createPagePatch(page);
+    page->lastUsed = _frame;
+
+    // Account for the heights and the geometry of the page
+    Mesh* mesh = page->patch->_levels[0]->model->getMesh();
+    page->memorySize = page->heights->getRowCount() * page->heights->getColumnCount() * sizeof(float) +
+        mesh->getVertexCount() * mesh->getVertexSize() + mesh->getPart(0)->getIndexCount() * sizeof(unsigned short);
+    _memoryUsed += page->memorySize;
+
+    _lru.push_front(page);
+    page->lru = _lru.begin();
+    _pages[getPageKey(page->level, page->x, page->z)] = page;
+
+    ++_loadCount;
+    _loadTime += page->readTime + Game::getAbsoluteTime() - startTime;
+}
+
+bool TerrainPager::readPage(Page* page)
+{
+    GP_ASSERT(page && page->heights);
+
+    int stride = 1 << page->level;
+    int span = (int)_pageSize * stride;
+    int x1 = (int)page->x * span;
+    int z1 = (int)page->z * span;
+    int columns = (int)page->heights->getColumnCount();
+    int rows = (int)page->heights->getRowCount();
+    float* heights = page->heights->getArray();
+
+    // Every row of the page, including the apron, is read with a single seek
+    int readX1 = std::max(x1 - stride, 0);
+    int readX2 = std::min(x1 + (columns - 2) * stride, (int)_width - 1);
+    _rowBuffer.resize((readX2 - readX1 + 1) * _bytesPerSample);
+
+    int lastRow = -1;
+    for (int j = 0; j < rows; ++j)
+    {
+        float* pageRow = heights + j * columns;
+        int row = std::min(std::max(z1 + (j - 1) * stride, 0), (int)_height - 1);
+        if (row == lastRow)
+        {
+            // Rows clamped to the heightmap edge repeat the previous row
+            memcpy(pageRow, pageRow - columns, columns * sizeof(float));
+            continue;
+        }
+        lastRow = row;
+
+        size_t offset = ((size_t)row * _width + readX1) * _bytesPerSample;
+        if (!_stream->seek((long int)offset, SEEK_SET) || _stream->read(&_rowBuffer[0], 1, _rowBuffer.size()) != _rowBuffer.size())
+            return false;
+
+        for (int i = 0; i < columns; ++i)
+        {
+            int column = std::min(std::max(x1 + (i - 1) * stride, 0), (int)_width - 1) - readX1;
+            if (_bytesPerSample == 2)
+            {
+                const unsigned char* sample = &_rowBuffer[column << 1];
+                pageRow[i] = (sample[0] | (int)sample[1] << 8) / 65535.0f;
+            }
+            else
+            {
+                pageRow[i] = _rowBuffer[column] / 255.0f;
+            }
+        }
+    }
+    return true;
+}
+
+float TerrainPager::computePageError(const Page* page) const
+{
+    // Estimate the error of the page from the detail it loses at half its resolution,
+    // i.e. how far its odd samples lie from the surface through its even samples.
+    const float* heights = page->heights->getArray();
+    unsigned int columns = page->heights->getColumnCount();
+    float error = 0.0f;
+    for (unsigned int z = 0; z <= _pageSize; ++z)
+    {
+        unsigned int z1 = z & ~1u;
+        unsigned int z2 = std::min(z1 + 2, _pageSize);
+        float tz = z2 > z1 ? (float)(z - z1) / (z2 - z1) : 0.0f;
+        for (unsigned int x = 0; x <= _pageSize; ++x)
+        {
+            if (((x | z) & 1) == 0)
+                continue;
+
+            unsigned int x1 = x & ~1u;
+            unsigned int x2 = std::min(x1 + 2, _pageSize);
+            float tx = x2 > x1 ? (float)(x - x1) / (x2 - x1) : 0.0f;
+
+            // Heights are stored with a one sample apron
+            #define PAGE_HEIGHT(px, pz) heights[((pz) + 1) * columns + (px) + 1]
+            float h1 = PAGE_HEIGHT(x1, z1) * (1.0f - tx) + PAGE_HEIGHT(x2, z1) * tx;
+            float h2 = PAGE_HEIGHT(x1, z2) * (1.0f - tx) + PAGE_HEIGHT(x2, z2) * tx;
+            error = std::max(error, fabsf(PAGE_HEIGHT(x, z) - (h1 * (1.0f - tz) + h2 * tz)));
+            #undef PAGE_HEIGHT
+        }
+    }
+    return error;
+}
+
+void TerrainPager::releasePage(Page* page)
+{
+    GP_ASSERT(page && page != _root);
+
+    _pages.erase(getPageKey(page->level, page->x, page->z));
+    _lru.erase(page->lru);
+    _memoryUsed -= page->memorySize;
+
+    SAFE_DELETE(page->patch);
+    deletePage(page);
+}
+
+void TerrainPager::deletePage(Page* page)
+{
+    GP_ASSERT(page && !page->patch);
+    SAFE_RELEASE(page->heights);
+    SAFE_DELETE(page);
+}
+
+void TerrainPager::stopLoading()
+{
+    if (!_loaderThread)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(*_loaderMutex);
+        _loaderThreadActive = false;
+    }
+    _loaderCondition->notify_all();
+    _loaderThread->join();
+    _loaderThread.reset();
+}
+
+void TerrainPager::loaderThreadProc(TerrainPager* pager)
+{
+    std::unique_lock<std::mutex> lock(*pager->_loaderMutex);
+    while (true)
+    {
+        pager->_loaderCondition->wait(lock, [pager] { return !pager->_loadQueue.empty() || !pager->_loaderThreadActive; });
+        if (!pager->_loaderThreadActive)
+            return;
+
+        // Requests are served in order, so coarser pages load before the finer ones they refine into
+        Page* page = pager->_loadQueue.front();
+        pager->_loadQueue.pop_front();
+        lock.unlock();
+
+        double startTime = Game::getAbsoluteTime();
+        page->read = pager->readPage(page);
+        if (page->read)
+            page->error = pager->computePageError(page);
+        page->readTime = Game::getAbsoluteTime() - startTime;
+
+        lock.lock();
+        pager->_readPages.push_back(page);
+    }
+}
+
+unsigned long long TerrainPager::getPageKey(unsigned int level, unsigned int x, unsigned int z)
+{
+    return ((unsigned long long)level << 48) | ((unsigned long long)z << 24) | x;
+}
+
+}
@@ -0,0 +1,191 @@
+#ifndef TERRAINPAGER_H_
+#define TERRAINPAGER_H_
+
+#include "HeightField.h"
+#include "Stream.h"
+
+namespace egret
+{
+
+class Terrain;
+class TerrainPatch;
+
+/**
+ * Defines the page cache of a streamed Terrain.
+ *
+ * The heightmap of a streamed terrain stays on disk as a RAW file and is read in square
+ * pages of patchSize quads. Pages form a quadtree: the root page covers the whole heightmap
+ * at the coarsest sample spacing and every level below halves the spacing, down to the
+ * full resolution pages at level zero. Pages are requested when the level of detail
+ * selection refines into them and read on a loader thread; their patches are built at the
+ * start of a later frame. Resident pages other than the root are kept in least recently
+ * used order and are evicted once the resident pages exceed the memory budget.
+ *
+ * @script{ignore}
+ */
+class TerrainPager
+{
+    friend class Terrain;
+
+private:
+
+    /**
+     * A resident page of the heightmap.
+     */
+    struct Page
+    {
+        /** The quadtree level; zero is full resolution. */
+        unsigned int level;
+        /** The page column within its level. */
+        unsigned int x;
+        /** The page row within its level. */
+        unsigned int z;
+        /** The normalized page heights, including a one sample apron on every side. */
+        HeightField* heights;
+        /** The patch drawing the page. */
+        TerrainPatch* patch;
+        /** The estimated geometric error of the page, in terrain local units. */
+        float error;
+        /** The memory used by the page heights and geometry. */
+        size_t memorySize;
+        /** The frame the page was last used or requested in. */
+        unsigned int lastUsed;
+        /** The position of the page in the least recently used list. */
+        std::list<Page*>::iterator lru;
+        /** Whether the loader thread read the page heights. */
+        bool read;
+        /** The time the loader thread spent reading the page, in milliseconds. */
+        double readTime;
+    };
+
+    /**
+     * Constructor.
+     */
+    TerrainPager();
+
+    /**
+     * Hidden copy constructor.
+     */
+    TerrainPager(const TerrainPager&);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    TerrainPager& operator=(const TerrainPager&);
+
+    /**
+     * Destructor.
+     */
+    ~TerrainPager();
+
+    /**
+     * Opens an 8-bit or 16-bit RAW heightmap for streaming.
+     *
+     * @param path The path to the RAW heightmap.
+     * @param width The number of samples per heightmap row.
+     * @param height The number of heightmap rows.
+     * @param pageSize The number of quads along the side of a page.
+     * @param memoryBudget The number of bytes the resident pages may use.
+     * @param maxPageLoads The maximum number of pages loaded per frame.
+     *
+     * @return The new pager, or NULL if the heightmap could not be opened.
+     */
+    static TerrainPager* create(const char* path, unsigned int width, unsigned int height,
+                                unsigned int pageSize, size_t memoryBudget, unsigned int maxPageLoads);
+
+    /**
+     * Loads the root page of the given terrain.
+     *
+     * @return True if the root page was loaded.
+     */
+    bool initialize(Terrain* terrain);
+
+    /**
+     * Starts a new frame of page requests.
+     *
+     * Builds the patches of pages the loader thread has read, within the per-frame limit,
+     * and drops queued requests that were not repeated in the last frame.
+     */
+    void beginFrame();
+
+    /**
+     * Determines whether the given page covers any part of the heightmap.
+     */
+    bool pageExists(unsigned int level, unsigned int x, unsigned int z) const;
+
+    /**
+     * Gets a page and marks it as used in the current frame.
+     *
+     * @param level The quadtree level of the page.
+     * @param x The page column.
+     * @param z The page row.
+     * @param load Whether to request the page from the loader thread if it is not resident.
+     *
+     * @return The page, or NULL if it is not resident yet.
+     */
+    Page* getPage(unsigned int level, unsigned int x, unsigned int z, bool load);
+
+    /**
+     * Evicts the least recently used pages until the resident pages fit the memory budget.
+     *
+     * Pages used in the current frame and the root page are never evicted.
+     */
+    void evictPages();
+
+    /**
+     * Gets the normalized height at the given heightmap position from the finest resident page.
+     *
+     * @param column The heightmap column, which may fall between samples.
+     * @param row The heightmap row, which may fall between samples.
+     */
+    float getHeight(float column, float row) const;
+
+    Page* createPage(unsigned int level, unsigned int x, unsigned int z);
+
+    void installPage(Page* page);
+
+    bool readPage(Page* page);
+
+    float computePageError(const Page* page) const;
+
+    void releasePage(Page* page);
+
+    void deletePage(Page* page);
+
+    void stopLoading();
+
+    static void loaderThreadProc(TerrainPager* pager);
+
+    static unsigned long long getPageKey(unsigned int level, unsigned int x, unsigned int z);
+
+    Terrain* _terrain;
+    std::unique_ptr<Stream> _stream;
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _bytesPerSample;
+    unsigned int _pageSize;
+    unsigned int _levelCount;
+    size_t _memoryBudget;
+    size_t _memoryUsed;
+    std::map<unsigned long long, Page*> _pages;
+    std::list<Page*> _lru;
+    Page* _root;
+    std::vector<unsigned char> _rowBuffer;
+    std::map<unsigned long long, Page*> _requests;
+    std::deque<Page*> _loadQueue;
+    std::vector<Page*> _readPages;
+    std::unique_ptr<std::thread> _loaderThread;
+    std::unique_ptr<std::mutex> _loaderMutex;
+    std::unique_ptr<std::condition_variable> _loaderCondition;
+    bool _loaderThreadActive;
+    unsigned int _frame;
+    unsigned int _pageLoads;
+    unsigned int _maxPageLoads;
+    unsigned int _loadCount;
+    unsigned int _evictionCount;
+    double _loadTime;
+};
+
+}
+
+#endif
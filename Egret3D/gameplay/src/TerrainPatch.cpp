@@ -27,10 +27,10 @@ class TerrainAutoBindingResolver : RenderState::AutoBindingResolver
     bool resolveAutoBinding(const char* autoBinding, Node* node, MaterialParameter* parameter);
 };
 static TerrainAutoBindingResolver __autoBindingResolver;
-static int __currentPatchIndex = -1;
+static TerrainPatch* __currentPatch = NULL;
 
 TerrainPatch::TerrainPatch() :
-    _terrain(NULL), _row(0), _column(0), _camera(NULL),
+    _terrain(NULL), _index(0), _row(0), _column(0), _originX(0), _originZ(0), _stride(1), _camera(NULL),
 	_level(0), _bits(TERRAINPATCH_DIRTY_ALL)
 {	
 }
@@ -79,6 +79,32 @@ TerrainPatch* TerrainPatch::create(Terrain* terrain, unsigned int index,
     return patch;
 }
 
+TerrainPatch* TerrainPatch::createPage(Terrain* terrain, unsigned int row, unsigned int column,
+                                       float* heights, unsigned int width, unsigned int height,
+                                       int originX, int originZ, unsigned int stride,
+                                       unsigned int quadsX, unsigned int quadsZ,
+                                       float xOffset, float zOffset, float verticalSkirtSize)
+{
+    // Create patch
+    TerrainPatch* patch = new TerrainPatch();
+    patch->_terrain = terrain;
+    patch->_row = row;
+    patch->_column = column;
+
+    // Heights are sampled every 'stride' heightmap samples, starting at the given origin
+    patch->_originX = originX;
+    patch->_originZ = originZ;
+    patch->_stride = stride;
+
+    // Pages have a single level; the one sample apron around the page only feeds the normals
+    patch->addLOD(heights, width, height, 1, 1, 1 + quadsX, 1 + quadsZ, xOffset, zOffset, 1, verticalSkirtSize);
+    GP_ASSERT(patch->_levels.size() == 1);
+
+    patch->_boundingBox.set(patch->_levels[0]->model->getMesh()->getBoundingBox());
+
+    return patch;
+}
+
 unsigned int TerrainPatch::getMaterialCount() const
 {
     return _levels.size();
@@ -137,8 +163,10 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
 	unsigned int index = 0;
 	kmVec3 min = { FLT_MAX, FLT_MAX, FLT_MAX };
 	kmVec3 max = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
-    float stepXScaled = step * _terrain->_localScale.x;
-    float stepZScaled = step * _terrain->_localScale.z;
+    float stepXScaled = step * _stride * _terrain->_localScale.x;
+    float stepZScaled = step * _stride * _terrain->_localScale.z;
+    float columnCount = (float)_terrain->getColumnCount();
+    float rowCount = (float)_terrain->getRowCount();
     bool zskirt = verticalSkirtSize > 0 ? true : false;
     for (unsigned int z = z1; ; )
     {
@@ -151,11 +179,11 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
             index++;
 
             // Compute position - apply the local scale of the terrain into the vertex data
-            v[0] = (x + xOffset) * _terrain->_localScale.x;
+            v[0] = (getTerrainColumn(x) + xOffset) * _terrain->_localScale.x;
             v[1] = computeHeight(heights, width, x, z);
             if (xskirt || zskirt)
                 v[1] -= verticalSkirtSize * _terrain->_localScale.y;
-            v[2] = (z + zOffset) * _terrain->_localScale.z;
+            v[2] = (getTerrainRow(z) + zOffset) * _terrain->_localScale.z;
 
             // Update bounding box min/max (don't include vertical skirt vertices in bounding box)
             if (!(xskirt || zskirt))
@@ -229,16 +257,16 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
             v += 3;
 
             // Compute texture coord
-            v[0] = (float)x / width;
-            v[1] = 1.0f - (float)z / height;
+            v[0] = getTerrainColumn(x) / columnCount;
+            v[1] = 1.0f - getTerrainRow(z) / rowCount;
             if (xskirt)
             {
-                float offset = verticalSkirtSize / width;
+                float offset = verticalSkirtSize / columnCount;
                 v[0] = x == x1 ? v[0]-offset : v[0]+offset;
             }
             else if (zskirt)
             {
-                float offset = verticalSkirtSize / height;
+                float offset = verticalSkirtSize / rowCount;
                 v[1] = z == z1 ? v[1]-offset : v[1]+offset;
             }
 
@@ -377,7 +405,32 @@ void TerrainPatch::addLOD(float* heights, unsigned int width, unsigned int heigh
     // Add this level
     Level* level = new Level();
     level->model = model;
+    level->error = 0.0f;
     _levels.push_back(level);
+
+    // Measure the geometric error of this level: the largest vertical distance between the
+    // full resolution heights and the surface interpolated from the skipped vertices.
+    if (step > 1)
+    {
+        for (unsigned int z = z1; z <= z2; ++z)
+        {
+            unsigned int cz1 = z1 + ((z - z1) / step) * step;
+            unsigned int cz2 = std::min(cz1 + step, z2);
+            float tz = cz2 > cz1 ? (float)(z - cz1) / (cz2 - cz1) : 0.0f;
+            for (unsigned int x = x1; x <= x2; ++x)
+            {
+                unsigned int cx1 = x1 + ((x - x1) / step) * step;
+                unsigned int cx2 = std::min(cx1 + step, x2);
+                float tx = cx2 > cx1 ? (float)(x - cx1) / (cx2 - cx1) : 0.0f;
+
+                float h1 = computeHeight(heights, width, cx1, cz1) * (1.0f - tx) + computeHeight(heights, width, cx2, cz1) * tx;
+                float h2 = computeHeight(heights, width, cx1, cz2) * (1.0f - tx) + computeHeight(heights, width, cx2, cz2) * tx;
+                float error = fabs(computeHeight(heights, width, x, z) - (h1 * (1.0f - tz) + h2 * tz));
+                if (error > level->error)
+                    level->error = error;
+            }
+        }
+    }
 }
 
 void TerrainPatch::deleteLayer(Layer* layer)
@@ -564,7 +617,7 @@ bool TerrainPatch::updateMaterial()
 
     _bits &= ~TERRAINPATCH_DIRTY_MATERIAL;
 
-    __currentPatchIndex = _index;
+    __currentPatch = this;
 
     for (size_t i = 0, count = _levels.size(); i < count; ++i)
     {
@@ -573,7 +626,7 @@ bool TerrainPatch::updateMaterial()
         if (!material)
         {
             GP_WARN("Failed to load material for terrain patch: %s", _terrain->_materialPath.c_str());
-            __currentPatchIndex = -1;
+            __currentPatch = NULL;
             return false;
         }
 
@@ -585,19 +638,19 @@ bool TerrainPatch::updateMaterial()
         material->release();
     }
 
-    __currentPatchIndex = -1;
+    __currentPatch = NULL;
 
     return true;
 }
 
 void TerrainPatch::updateNodeBindings()
 {
-    __currentPatchIndex = _index;
+    __currentPatch = this;
     for (size_t i = 0, count = _levels.size(); i < count; ++i)
     {
         _levels[i]->model->getMaterial()->setNodeBinding(_terrain->_node);
     }
-    __currentPatchIndex = -1;
+    __currentPatch = NULL;
 }
 
 unsigned int TerrainPatch::draw(bool wireframe)
@@ -673,36 +726,17 @@ unsigned int TerrainPatch::computeLOD(Camera* camera, const BoundingBox& worldBo
 
 	_bits &= ~TERRAINPATCH_DIRTY_LEVEL;
 
-	// Compute LOD to use based on very simple distance metric. TODO: Optimize me.
-	Game* game = Game::getInstance();
-	Rectangle vp(0, 0, game->getWidth(), game->getHeight());
-	kmVec3 corners[8];
-	kmVec2 min = { FLT_MAX, FLT_MAX };
-	kmVec2 max ={-FLT_MAX, -FLT_MAX};
-    worldBounds.getCorners(corners);
-    for (unsigned int i = 0; i < 8; ++i)
+    // Use the coarsest level whose geometric error projects to no more than the
+    // terrain's screen-space error tolerance.
+    size_t lod = 0;
+    for (size_t i = _levels.size() - 1; i > 0; --i)
     {
-        const kmVec3& corner = corners[i];
-        float x, y;
-        camera->project(vp, corners[i], &x, &y);
-        if (x < min.x)
-            min.x = x;
-        if (y < min.y)
-            min.y = y;
-        if (x > max.x)
-            max.x = x;
-        if (y > max.y)
-            max.y = y;
+        if (_terrain->computeScreenError(camera, worldBounds, _levels[i]->error) <= _terrain->_pixelError)
+        {
+            lod = i;
+            break;
+        }
     }
-    float area = (max.x - min.x) * (max.y - min.y);
-    float screenArea = game->getWidth() * game->getHeight() / 10.0f;
-    float error = screenArea / area;
-
-    // Level LOD based on distance from camera
-    size_t maxLod = _levels.size()-1;
-    size_t lod = (size_t)error;
-    lod = std::max(lod, (size_t)0);
-    lod = std::min(lod, maxLod);
     _level = lod;
 
     return _level;
@@ -724,6 +758,16 @@ float TerrainPatch::computeHeight(float* heights, unsigned int width, unsigned i
     return heights[z * width + x] * _terrain->_localScale.y;
 }
 
+float TerrainPatch::getTerrainColumn(unsigned int x) const
+{
+    return (float)clamp<int>(_originX + (int)(x * _stride), 0, (int)_terrain->getColumnCount() - 1);
+}
+
+float TerrainPatch::getTerrainRow(unsigned int z) const
+{
+    return (float)clamp<int>(_originZ + (int)(z * _stride), 0, (int)_terrain->getRowCount() - 1);
+}
+
 TerrainPatch::Layer::Layer() :
     index(0), row(-1), column(-1), textureIndex(-1), blendIndex(-1)
 {
@@ -734,7 +778,7 @@ TerrainPatch::Layer::~Layer()
 {
 }
 
-TerrainPatch::Level::Level() : model(NULL)
+TerrainPatch::Level::Level() : model(NULL), error(0.0f)
 {
 }
 
@@ -751,12 +795,9 @@ bool TerrainAutoBindingResolver::resolveAutoBinding(const char* autoBinding, Nod
         static TerrainPatch* getPatch(Node* node)
         {
             Terrain* terrain = dynamic_cast<Terrain*>(node->getDrawable());
-            if (terrain)
+            if (terrain && __currentPatch && __currentPatch->_terrain == terrain)
             {
-                if (__currentPatchIndex >= 0 && __currentPatchIndex < (int)terrain->_patches.size())
-                {
-                    return terrain->_patches[__currentPatchIndex];
-                }
+                return __currentPatch;
             }
             return NULL;
         }
@@ -16,6 +16,7 @@ class TerrainAutoBindingResolver;
 class TerrainPatch : public Camera::Listener
 {
     friend class Terrain;
+    friend class TerrainPager;
     friend class TerrainAutoBindingResolver;
 
 public:
@@ -96,6 +97,7 @@ private:
     struct Level
     {
         Model* model;
+        float error;
 
         Level();
     };
@@ -111,6 +113,12 @@ private:
                                 unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
                                 float xOffset, float zOffset, unsigned int maxStep, float verticalSkirtSize);
 
+    static TerrainPatch* createPage(Terrain* terrain, unsigned int row, unsigned int column,
+                                    float* heights, unsigned int width, unsigned int height,
+                                    int originX, int originZ, unsigned int stride,
+                                    unsigned int quadsX, unsigned int quadsZ,
+                                    float xOffset, float zOffset, float verticalSkirtSize);
+
     void addLOD(float* heights, unsigned int width, unsigned int height,
                 unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2,
                 float xOffset, float zOffset, unsigned int step, float verticalSkirtSize);
@@ -134,6 +142,10 @@ private:
 
     float computeHeight(float* heights, unsigned int width, unsigned int x, unsigned int z);
 
+    float getTerrainColumn(unsigned int x) const;
+
+    float getTerrainRow(unsigned int z) const;
+
     void updateNodeBindings();
 
     std::string passCreated(Pass* pass);
@@ -142,6 +154,9 @@ private:
     unsigned int _index;
     unsigned int _row;
     unsigned int _column;
+    int _originX;
+    int _originZ;
+    unsigned int _stride;
     std::vector<Level*> _levels;
     std::set<Layer*, LayerCompare> _layers;
     std::vector<Texture::Sampler*> _samplers;
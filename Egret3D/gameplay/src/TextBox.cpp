@@ -71,6 +71,7 @@ void TextBox::setCaretLocation(unsigned int index)
     _caretLocation = index;
     if (_caretLocation > _text.length())
         _caretLocation = (unsigned int)_text.length();
+    setDirty(DIRTY_DRAW);
 }
 
 bool TextBox::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
@@ -275,8 +276,9 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
                     {
                         key = toupper(key);
                     }
-                    // Insert character into string, only if our font supports this character
-                    if (_font && _font->isCharacterSupported(key))
+                    // Insert character into string, only if our font supports this character.
+                    // Text is edited a byte at a time, so only ASCII characters are inserted.
+                    if (_font && key < 0x80 && _font->isCharacterSupported(key))
                     {
                         if (_caretLocation <= _text.length())
                         {
@@ -309,6 +311,10 @@ bool TextBox::keyEvent(Keyboard::KeyEvent evt, int key)
             }
     }
 
+    // Typing edits the text and moves the caret in place
+    if (evt != Keyboard::KEY_RELEASE)
+        setDirty(DIRTY_DRAW);
+
     _lastKeypress = key;
 
     return Label::keyEvent(evt, key);
@@ -453,7 +459,10 @@ void TextBox::setCaretLocation(int x, int y)
     }
 
     if (index != -1)
+    {
         _caretLocation = index;
+        setDirty(DIRTY_DRAW);
+    }
 }
 
 void TextBox::getCaretLocation(kmVec2* p)
@@ -467,6 +476,7 @@ void TextBox::getCaretLocation(kmVec2* p)
 void TextBox::setPasswordChar(char character)
 {
     _passwordChar = character;
+    setDirty(DIRTY_DRAW);
 }
 
 char TextBox::getPasswordChar() const
@@ -477,6 +487,7 @@ char TextBox::getPasswordChar() const
 void TextBox::setInputMode(InputMode inputMode)
 {
     _inputMode = inputMode;
+    setDirty(DIRTY_DRAW);
 }
 
 TextBox::InputMode TextBox::getInputMode() const
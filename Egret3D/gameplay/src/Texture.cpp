@@ -1,7 +1,10 @@
 #include "Base.h"
 #include "Image.h"
 #include "Texture.h"
+#include "PerformanceCounters.h"
 #include "FileSystem.h"
+#include "TextureAtlas.h"
+#include "TextureDecompressor.h"
 
 // PVRTC (GL_IMG_texture_compression_pvrtc) : Imagination based gpus
 #ifndef GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG
@@ -50,6 +53,27 @@ namespace egret
 static std::vector<Texture*> __textureCache;
 static TextureHandle __currentTextureId = 0;
 static Texture::Type __currentTextureType = Texture::TEXTURE_2D;
+static std::vector<GLint> __compressedFormats;
+static bool __compressedFormatsQueried = false;
+
+/**
+ * Determines whether the GPU supports a compressed texture format.
+ */
+static bool isCompressedFormatSupported(GLenum format)
+{
+    if (!__compressedFormatsQueried)
+    {
+        __compressedFormatsQueried = true;
+        GLint count = 0;
+        GL_ASSERT( glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count) );
+        if (count > 0)
+        {
+            __compressedFormats.resize(count);
+            GL_ASSERT( glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, &__compressedFormats[0]) );
+        }
+    }
+    return std::find(__compressedFormats.begin(), __compressedFormats.end(), (GLint)format) != __compressedFormats.end();
+}
 
 Texture::Texture() : _handle(0), _format(UNKNOWN), _type((Texture::Type)0), _width(0), _height(0), _mipmapped(false), _cached(false), _compressed(false),
     _wrapS(Texture::REPEAT), _wrapT(Texture::REPEAT), _wrapR(Texture::REPEAT), _minFilter(Texture::NEAREST_MIPMAP_LINEAR), _magFilter(Texture::LINEAR)
@@ -79,6 +103,13 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
 {
     GP_ASSERT( path );
 
+    // An image in an atlas loads the atlas page it is on.
+    if (TextureAtlas::isRegionPath(path))
+    {
+        const TextureAtlas::Region* region = TextureAtlas::findRegion(path);
+        return region ? create(region->texturePath.c_str(), generateMipmaps) : NULL;
+    }
+
     // Search texture cache first.
     for (size_t i = 0, count = __textureCache.size(); i < count; ++i)
     {
@@ -111,7 +142,8 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
         case 4:
             if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g')
             {
-                Image* image = Image::create(path);
+                // The pixels are only uploaded, so the image is not copied out of the cache
+                Image* image = Image::createShared(path);
                 if (image)
                     texture = create(image, generateMipmaps);
                 SAFE_RELEASE(image);
@@ -126,6 +158,11 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
                 // DDS file format (DXT/S3TC) compressed textures
                 texture = createCompressedDDS(path);
             }
+            else if (tolower(ext[1]) == 'k' && tolower(ext[2]) == 't' && tolower(ext[3]) == 'x')
+            {
+                // KTX file format (ETC2/ASTC/BCn or uncompressed) textures
+                texture = createCompressedKTX(path);
+            }
             break;
         }
     }
@@ -149,16 +186,47 @@ Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT( image );
 
+    Format format;
     switch (image->getFormat())
     {
     case Image::RGB:
-        return create(Texture::RGB, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
+        format = Texture::RGB;
+        break;
     case Image::RGBA:
-        return create(Texture::RGBA, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
+        format = Texture::RGBA;
+        break;
     default:
         GP_ERROR("Unsupported image format (%d).", image->getFormat());
         return NULL;
     }
+
+    unsigned int mipmapCount = image->getMipmapCount();
+    if (!generateMipmaps || mipmapCount == 1)
+        return create(format, image->getWidth(), image->getHeight(), image->getData(), generateMipmaps);
+
+    // Upload the mipmaps generated with the image instead of generating them on the GPU.
+    Texture* texture = create(format, image->getWidth(), image->getHeight(), image->getData(), false);
+    if (texture == NULL)
+        return NULL;
+
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, texture->_handle) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    unsigned int width = image->getWidth();
+    unsigned int height = image->getHeight();
+    for (unsigned int level = 1; level < mipmapCount; ++level)
+    {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, level, (GLenum)format, width, height, 0, (GLenum)format, GL_UNSIGNED_BYTE, image->getMipmapData(level)) );
+    }
+    texture->_minFilter = NEAREST_MIPMAP_LINEAR;
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture->_minFilter) );
+    texture->_mipmapped = true;
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+
+    return texture;
 }
 
 Texture* Texture::create(Format format, unsigned int width, unsigned int height, const unsigned char* data, bool generateMipmaps, Texture::Type type)
@@ -312,6 +380,28 @@ void Texture::setData(const unsigned char* data)
     GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
 }
 
+void Texture::setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    // Don't work with any compressed or cached textures
+    GP_ASSERT( data );
+    GP_ASSERT( (!_compressed) );
+    GP_ASSERT( (!_cached) );
+    GP_ASSERT( _type == Texture::TEXTURE_2D );
+    GP_ASSERT( x + width <= _width && y + height <= _height );
+
+    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _handle) );
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 1) );
+    GL_ASSERT( glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, (GLenum)_format, GL_UNSIGNED_BYTE, data) );
+
+    if (_mipmapped)
+    {
+        generateMipmaps();
+    }
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+}
+
 // Computes the size of a PVRTC data chunk for a mipmap level of the given size.
 static unsigned int computePVRTCDataSize(int width, int height, int bpp)
 {
@@ -718,6 +808,171 @@ int Texture::getMaskByteIndex(unsigned int mask)
     }
 }
 
+Texture* Texture::createCompressedKTX(const char* path)
+{
+    GP_ASSERT( path );
+
+    // KTX file header.
+    struct ktx_header
+    {
+        unsigned char identifier[12];
+        unsigned int endianness;
+        unsigned int glType;
+        unsigned int glTypeSize;
+        unsigned int glFormat;
+        unsigned int glInternalFormat;
+        unsigned int glBaseInternalFormat;
+        unsigned int pixelWidth;
+        unsigned int pixelHeight;
+        unsigned int pixelDepth;
+        unsigned int numberOfArrayElements;
+        unsigned int numberOfFaces;
+        unsigned int numberOfMipmapLevels;
+        unsigned int bytesOfKeyValueData;
+    };
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // Read the whole file at once; the mip levels are uploaded straight from it.
+    int size = 0;
+    char* file = FileSystem::readAll(path, &size);
+    if (file == NULL)
+    {
+        GP_ERROR("Failed to read KTX file '%s'.", path);
+        return NULL;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file);
+
+    ktx_header header;
+    if (size < (int)sizeof(ktx_header) || memcmp(data, identifier, sizeof(identifier)) != 0)
+    {
+        GP_ERROR("Failed to read KTX file '%s': invalid KTX identifier.", path);
+        SAFE_DELETE_ARRAY(file);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(ktx_header));
+    if (header.endianness != 0x04030201)
+    {
+        GP_ERROR("Failed to read KTX file '%s': big endian files are unsupported.", path);
+        SAFE_DELETE_ARRAY(file);
+        return NULL;
+    }
+    if (header.pixelDepth > 0 || header.numberOfArrayElements > 0 || (header.numberOfFaces != 1 && header.numberOfFaces != 6))
+    {
+        GP_ERROR("Failed to create texture from KTX file '%s': 3D and array textures are unsupported.", path);
+        SAFE_DELETE_ARRAY(file);
+        return NULL;
+    }
+
+    // Compressed formats the GPU lacks are decompressed on the CPU.
+    bool compressed = header.glType == 0;
+    bool decompress = compressed && !isCompressedFormatSupported(header.glInternalFormat);
+    if (decompress && !TextureDecompressor::canDecompress(header.glInternalFormat))
+    {
+        GP_ERROR("Unsupported compressed texture format (0x%x) for KTX file '%s'.", header.glInternalFormat, path);
+        SAFE_DELETE_ARRAY(file);
+        return NULL;
+    }
+
+    unsigned int mipMapCount = std::max(header.numberOfMipmapLevels, 1u);
+    GLenum target = header.numberOfFaces == 6 ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+    GLuint textureId;
+    GL_ASSERT( glGenTextures(1, &textureId) );
+    GL_ASSERT( glBindTexture(target, textureId) );
+
+    // Rows of uncompressed KTX images are padded to 4 bytes.
+    GL_ASSERT( glPixelStorei(GL_UNPACK_ALIGNMENT, 4) );
+
+    std::vector<unsigned char> pixels;
+    size_t offset = sizeof(ktx_header) + header.bytesOfKeyValueData;
+    GLsizei width = header.pixelWidth;
+    GLsizei height = std::max(header.pixelHeight, 1u);
+    bool failed = false;
+    for (unsigned int i = 0; i < mipMapCount && !failed; ++i)
+    {
+        unsigned int imageSize;
+        if (offset + sizeof(imageSize) > (size_t)size)
+        {
+            failed = true;
+            break;
+        }
+        memcpy(&imageSize, data + offset, sizeof(imageSize));
+        offset += sizeof(imageSize);
+
+        for (unsigned int face = 0; face < header.numberOfFaces; ++face)
+        {
+            if (offset + imageSize > (size_t)size)
+            {
+                failed = true;
+                break;
+            }
+
+            GLenum texImageTarget = header.numberOfFaces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+            const unsigned char* image = data + offset;
+            if (decompress)
+            {
+                // The decompressor reads every block of the image, so a short image is corrupt.
+                if (imageSize < TextureDecompressor::getImageSize(header.glInternalFormat, width, height))
+                {
+                    failed = true;
+                    break;
+                }
+                pixels.resize(width * height * 4);
+                TextureDecompressor::decompress(header.glInternalFormat, image, width, height, &pixels[0]);
+                GL_ASSERT( glTexImage2D(texImageTarget, i, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]) );
+            }
+            else if (compressed)
+            {
+                GL_ASSERT( glCompressedTexImage2D(texImageTarget, i, header.glInternalFormat, width, height, 0, imageSize, image) );
+            }
+            else
+            {
+                GL_ASSERT( glTexImage2D(texImageTarget, i, header.glBaseInternalFormat, width, height, 0, header.glFormat, header.glType, image) );
+            }
+
+            // Faces and mip levels are padded to 4 bytes.
+            offset += (imageSize + 3) & ~3u;
+        }
+
+        width = std::max(1, width >> 1);
+        height = std::max(1, height >> 1);
+    }
+    SAFE_DELETE_ARRAY(file);
+
+    if (failed)
+    {
+        GP_ERROR("Failed to read texture data from KTX file '%s': file is truncated or corrupt.", path);
+        GL_ASSERT( glDeleteTextures(1, &textureId) );
+        GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+        return NULL;
+    }
+
+    Filter minFilter = mipMapCount > 1 ? NEAREST_MIPMAP_LINEAR : LINEAR;
+    GL_ASSERT( glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter) );
+
+    // Create gameplay texture.
+    Texture* texture = new Texture();
+    texture->_handle = textureId;
+    texture->_type = (Type)target;
+    texture->_width = header.pixelWidth;
+    texture->_height = std::max(header.pixelHeight, 1u);
+    texture->_compressed = compressed && !decompress;
+    texture->_mipmapped = mipMapCount > 1;
+    texture->_minFilter = minFilter;
+    if (decompress)
+    {
+        texture->_format = RGBA;
+    }
+    else if (!compressed && (header.glBaseInternalFormat == GL_RGB || header.glBaseInternalFormat == GL_RGBA || header.glBaseInternalFormat == GL_ALPHA))
+    {
+        texture->_format = (Format)header.glBaseInternalFormat;
+    }
+
+    // Restore the texture id
+    GL_ASSERT( glBindTexture((GLenum)__currentTextureType, __currentTextureId) );
+
+    return texture;
+}
+
 Texture* Texture::createCompressedDDS(const char* path)
 {
     GP_ASSERT( path );
@@ -1189,6 +1444,7 @@ void Texture::Sampler::bind()
     if (__currentTextureId != _texture->_handle)
     {
         GL_ASSERT( glBindTexture(target, _texture->_handle) );
+        PerformanceCounters::add(PerformanceCounters::TEXTURE_BINDS);
         __currentTextureId = _texture->_handle;
         __currentTextureType = _texture->_type;
     }
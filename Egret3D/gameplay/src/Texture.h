@@ -105,7 +105,8 @@ public:
         /**
          * Creates a sampler for the specified texture.
          *
-         * @param path Path to the texture to create a sampler for.
+         * @param path Path to the texture to create a sampler for, or "sheet.atlas#name" for
+         *        the atlas page an image is on (see TextureAtlas).
          * @param generateMipmaps True to force a full mipmap chain to be generated for the texture, false otherwise.
          *
          * @return The new sampler.
@@ -168,6 +169,12 @@ public:
      * Note that for textures that include mipmap data in the source data (such as most compressed textures),
      * the generateMipmaps flags should NOT be set to true.
      *
+     * A path of the form "sheet.atlas#name" loads the atlas page the named image is on;
+     * see TextureAtlas for the region of the image on the page.
+     *
+     * PNG, PVR, DDS and KTX files are supported. Compressed KTX textures are uploaded as
+     * they are, or decompressed if the GPU does not support their format; see TextureDecompressor.
+     *
      * @param path The image resource path.
      * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
      * 
@@ -235,6 +242,17 @@ public:
      */
     void setData(const unsigned char* data);
 
+    /**
+     * Replaces a region of a 2D texture image.
+     *
+     * @param data Raw texture data for the region (expected to be tightly packed).
+     * @param x The left edge of the region.
+     * @param y The top edge of the region.
+     * @param width The width of the region.
+     * @param height The height of the region.
+     */
+    void setData(const unsigned char* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
     /**
      * Returns the path that the texture was originally loaded from (if applicable).
      *
@@ -320,6 +338,8 @@ private:
 
     static Texture* createCompressedDDS(const char* path);
 
+    static Texture* createCompressedKTX(const char* path);
+
     static GLubyte* readCompressedPVRTC(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount, GLenum faces[6]);
 
     static GLubyte* readCompressedPVRTCLegacy(const char* path, Stream* stream, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount, unsigned int* faceCount, GLenum faces[6]);
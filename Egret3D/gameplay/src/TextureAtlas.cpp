@@ -0,0 +1,98 @@
+#include "Base.h"
+#include "TextureAtlas.h"
+#include "Properties.h"
+
+namespace egret
+{
+
+// Lookup tables of the atlases used so far, by atlas file path.
+static std::map<std::string, TextureAtlas> __atlasCache;
+
+static const char* findRegionName(const char* path)
+{
+    const char* name = strchr(path, '#');
+    if (name == NULL || name - path < 6 || strncmp(name - 6, ".atlas", 6) != 0)
+        return NULL;
+    return name + 1;
+}
+
+bool TextureAtlas::isRegionPath(const char* path)
+{
+    GP_ASSERT(path);
+
+    return findRegionName(path) != NULL;
+}
+
+const TextureAtlas::Region* TextureAtlas::findRegion(const char* path)
+{
+    GP_ASSERT(path);
+
+    const char* name = findRegionName(path);
+    if (name == NULL)
+        return NULL;
+
+    std::string atlasPath(path, name - 1 - path);
+    std::map<std::string, TextureAtlas>::iterator itr = __atlasCache.find(atlasPath);
+    if (itr == __atlasCache.end())
+    {
+        itr = __atlasCache.insert(std::make_pair(atlasPath, TextureAtlas())).first;
+        if (!itr->second.load(atlasPath.c_str()))
+        {
+            // Keep the empty table so that the file is not loaded again for every image
+            GP_WARN("Failed to load texture atlas '%s'.", atlasPath.c_str());
+        }
+    }
+
+    std::map<std::string, Region>::const_iterator region = itr->second._regions.find(name);
+    if (region == itr->second._regions.end())
+    {
+        GP_WARN("Texture atlas '%s' has no image named '%s'.", atlasPath.c_str(), name);
+        return NULL;
+    }
+    return &region->second;
+}
+
+bool TextureAtlas::load(const char* path)
+{
+    Properties* properties = Properties::create(path);
+    if (properties == NULL)
+        return false;
+
+    Properties* atlas = (strlen(properties->getNamespace()) > 0) ? properties : properties->getNextNamespace();
+    if (atlas == NULL || strcmp(atlas->getNamespace(), "atlas") != 0)
+    {
+        GP_WARN("Texture atlas '%s' must have the namespace 'atlas'.", path);
+        SAFE_DELETE(properties);
+        return false;
+    }
+
+    while (Properties* page = atlas->getNextNamespace())
+    {
+        if (strcmp(page->getNamespace(), "page") != 0)
+            continue;
+
+        std::string texturePath;
+        if (!page->getPath("path", &texturePath))
+        {
+            GP_WARN("Texture atlas '%s' has a page without a path.", path);
+            continue;
+        }
+
+        while (Properties* space = page->getNextNamespace())
+        {
+            if (strcmp(space->getNamespace(), "region") != 0)
+                continue;
+
+            kmVec4 rect = vec4Zero;
+            space->getVector4("rect", &rect);
+            Region& region = _regions[space->getId()];
+            region.texturePath = texturePath;
+            region.bounds.set(rect.x, rect.y, rect.z, rect.w);
+        }
+    }
+
+    SAFE_DELETE(properties);
+    return true;
+}
+
+}
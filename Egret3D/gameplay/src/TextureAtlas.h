@@ -0,0 +1,67 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include "Base.h"
+#include "Rectangle.h"
+
+namespace egret
+{
+
+/**
+ * Defines the lookup table of a texture atlas written by the encoder.
+ *
+ * The encoder packs a directory of images into one or more atlas pages and writes an
+ * ".atlas" file naming the region of each image. An image in an atlas is referred to as
+ * "path/to/sheet.atlas#name", where name is the path of the image relative to the packed
+ * directory, without the extension. Texture::create, and so Texture::Sampler::create,
+ * loads the page an image is on for such a path. Sprite, TileSet, ParticleEmitter, Theme
+ * and ImageControl also take their source rectangles relative to the region of the image,
+ * so images packed together share one texture and can be drawn without switching textures.
+ *
+ * Lookup tables are loaded the first time an atlas is used and kept for the rest of the
+ * run; the page textures are shared through the texture cache.
+ *
+ * @script{ignore}
+ */
+class TextureAtlas
+{
+public:
+
+    /**
+     * An image in an atlas.
+     */
+    struct Region
+    {
+        /** The path of the atlas page the image is on. */
+        std::string texturePath;
+        /** The bounds of the image on the page, in pixels. */
+        Rectangle bounds;
+    };
+
+    /**
+     * Determines whether the given path names an image in an atlas, that is has the form "sheet.atlas#name".
+     */
+    static bool isRegionPath(const char* path);
+
+    /**
+     * Finds the image named by a path of the form "sheet.atlas#name".
+     *
+     * @param path The path of the image.
+     *
+     * @return The image, or NULL if the path does not name an image in an atlas.
+     */
+    static const Region* findRegion(const char* path);
+
+private:
+
+    /**
+     * Loads the lookup table of an atlas file.
+     */
+    bool load(const char* path);
+
+    std::map<std::string, Region> _regions;
+};
+
+}
+
+#endif
@@ -0,0 +1,408 @@
+#include "Base.h"
+#include "TextureDecompressor.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef ETC1_RGB8
+#define ETC1_RGB8 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+namespace egret
+{
+
+// The intensity modifiers of the ETC1 tables, indexed by the pixel index (msb, lsb).
+static const int ETC_MODIFIERS[8][4] =
+{
+    { 2, 8, -2, -8 },
+    { 5, 17, -5, -17 },
+    { 9, 29, -9, -29 },
+    { 13, 42, -13, -42 },
+    { 18, 60, -18, -60 },
+    { 24, 80, -24, -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+// The distances between the paint colors of the ETC2 T and H modes.
+static const int ETC_DISTANCES[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+// The alpha modifiers of the EAC tables.
+static const int EAC_MODIFIERS[16][8] =
+{
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static unsigned char clampByte(int value)
+{
+    return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static int extend4(int value)
+{
+    return (value << 4) | value;
+}
+
+static int extend5(int value)
+{
+    return (value << 3) | (value >> 2);
+}
+
+static void unpackRGB565(unsigned int color, int* rgb)
+{
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+static unsigned long long readBigEndian64(const unsigned char* block)
+{
+    unsigned long long bits = 0;
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        bits = (bits << 8) | block[i];
+    }
+    return bits;
+}
+
+static unsigned int getBits(unsigned long long bits, unsigned int first, unsigned int count)
+{
+    return (unsigned int)(bits >> first) & ((1u << count) - 1);
+}
+
+bool TextureDecompressor::canDecompress(GLenum format)
+{
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case ETC1_RGB8:
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+unsigned int TextureDecompressor::getImageSize(GLenum format, unsigned int width, unsigned int height)
+{
+    if (!canDecompress(format))
+        return 0;
+
+    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ||
+        format == GL_COMPRESSED_RGBA8_ETC2_EAC) ? 16 : 8;
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+}
+
+bool TextureDecompressor::decompress(GLenum format, const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba)
+{
+    GP_ASSERT(data && rgba);
+
+    if (!canDecompress(format))
+        return false;
+
+    unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ||
+        format == GL_COMPRESSED_RGBA8_ETC2_EAC) ? 16 : 8;
+    unsigned char pixels[16 * 4];
+    for (unsigned int by = 0; by < height; by += 4)
+    {
+        for (unsigned int bx = 0; bx < width; bx += 4)
+        {
+            switch (format)
+            {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                decompressBC1(data, pixels, false);
+                for (unsigned int i = 0; i < 16; ++i)
+                    pixels[i * 4 + 3] = 255;
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                decompressBC1(data, pixels, false);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+                decompressBC1(data + 8, pixels, true);
+                decompressBC2Alpha(data, pixels);
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                decompressBC1(data + 8, pixels, true);
+                decompressBC3Alpha(data, pixels);
+                break;
+            case ETC1_RGB8:
+            case GL_COMPRESSED_RGB8_ETC2:
+                decompressETC2(data, pixels);
+                break;
+            case GL_COMPRESSED_RGBA8_ETC2_EAC:
+                decompressETC2(data + 8, pixels);
+                decompressEACAlpha(data, pixels);
+                break;
+            }
+            data += blockSize;
+
+            // Copy the part of the block inside the image
+            unsigned int rowSize = std::min(4u, width - bx) * 4;
+            for (unsigned int y = 0; y < 4 && by + y < height; ++y)
+            {
+                memcpy(rgba + ((by + y) * width + bx) * 4, pixels + y * 16, rowSize);
+            }
+        }
+    }
+    return true;
+}
+
+void TextureDecompressor::decompressBC1(const unsigned char* block, unsigned char* pixels, bool fourColors)
+{
+    unsigned int color0 = block[0] | (block[1] << 8);
+    unsigned int color1 = block[2] | (block[3] << 8);
+
+    int palette[4][4];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        if (fourColors || color0 > color1)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    if (!fourColors && color0 <= color1)
+        palette[3][3] = 0;
+
+    unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((unsigned int)block[7] << 24);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        const int* color = palette[(indices >> (i * 2)) & 3];
+        for (unsigned int c = 0; c < 4; ++c)
+            pixels[i * 4 + c] = (unsigned char)color[c];
+    }
+}
+
+void TextureDecompressor::decompressBC2Alpha(const unsigned char* block, unsigned char* pixels)
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        unsigned int alpha = (block[i / 2] >> ((i & 1) * 4)) & 15;
+        pixels[i * 4 + 3] = (unsigned char)(alpha * 17);
+    }
+}
+
+void TextureDecompressor::decompressBC3Alpha(const unsigned char* block, unsigned char* pixels)
+{
+    int palette[8];
+    palette[0] = block[0];
+    palette[1] = block[1];
+    if (palette[0] > palette[1])
+    {
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+            palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    unsigned long long indices = 0;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        indices |= (unsigned long long)block[2 + i] << (i * 8);
+    }
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        pixels[i * 4 + 3] = (unsigned char)palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+void TextureDecompressor::decompressETC2(const unsigned char* block, unsigned char* pixels)
+{
+    unsigned long long bits = readBigEndian64(block);
+    bool differential = getBits(bits, 33, 1) != 0;
+
+    // Each pixel index selects one of four paint colors; the individual and differential
+    // modes add the modifiers of a table to the base color of each half of the block.
+    int paint[2][4][3];
+    bool halves = true;
+    bool flip = getBits(bits, 32, 1) != 0;
+    if (!differential)
+    {
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            int base0 = extend4(getBits(bits, 60 - c * 8, 4));
+            int base1 = extend4(getBits(bits, 56 - c * 8, 4));
+            for (unsigned int m = 0; m < 4; ++m)
+            {
+                paint[0][m][c] = clampByte(base0 + ETC_MODIFIERS[getBits(bits, 37, 3)][m]);
+                paint[1][m][c] = clampByte(base1 + ETC_MODIFIERS[getBits(bits, 34, 3)][m]);
+            }
+        }
+    }
+    else
+    {
+        int base[3];
+        int delta[3];
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            base[c] = getBits(bits, 59 - c * 8, 5);
+            delta[c] = getBits(bits, 56 - c * 8, 3);
+            if (delta[c] >= 4)
+                delta[c] -= 8;
+        }
+
+        if (base[0] + delta[0] < 0 || base[0] + delta[0] > 31)
+        {
+            // T mode
+            int color0[3] = { extend4((getBits(bits, 59, 2) << 2) | getBits(bits, 56, 2)), extend4(getBits(bits, 52, 4)), extend4(getBits(bits, 48, 4)) };
+            int color1[3] = { extend4(getBits(bits, 44, 4)), extend4(getBits(bits, 40, 4)), extend4(getBits(bits, 36, 4)) };
+            int distance = ETC_DISTANCES[(getBits(bits, 34, 2) << 1) | getBits(bits, 32, 1)];
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                paint[0][0][c] = color0[c];
+                paint[0][1][c] = clampByte(color1[c] + distance);
+                paint[0][2][c] = color1[c];
+                paint[0][3][c] = clampByte(color1[c] - distance);
+            }
+            halves = false;
+        }
+        else if (base[1] + delta[1] < 0 || base[1] + delta[1] > 31)
+        {
+            // H mode
+            int color0[3] = { extend4(getBits(bits, 59, 4)), extend4((getBits(bits, 56, 3) << 1) | getBits(bits, 52, 1)),
+                extend4((getBits(bits, 51, 1) << 3) | getBits(bits, 47, 3)) };
+            int color1[3] = { extend4(getBits(bits, 43, 4)), extend4(getBits(bits, 39, 4)), extend4(getBits(bits, 35, 4)) };
+            int value0 = (color0[0] << 16) | (color0[1] << 8) | color0[2];
+            int value1 = (color1[0] << 16) | (color1[1] << 8) | color1[2];
+            int distance = ETC_DISTANCES[(getBits(bits, 34, 1) << 2) | (getBits(bits, 32, 1) << 1) | (value0 >= value1 ? 1 : 0)];
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                paint[0][0][c] = clampByte(color0[c] + distance);
+                paint[0][1][c] = clampByte(color0[c] - distance);
+                paint[0][2][c] = clampByte(color1[c] + distance);
+                paint[0][3][c] = clampByte(color1[c] - distance);
+            }
+            halves = false;
+        }
+        else if (base[2] + delta[2] < 0 || base[2] + delta[2] > 31)
+        {
+            // Planar mode: the colors are interpolated from the origin, horizontal and vertical colors
+            int origin[3] = { (int)getBits(bits, 57, 6), (int)((getBits(bits, 56, 1) << 6) | getBits(bits, 49, 6)),
+                (int)((getBits(bits, 48, 1) << 5) | (getBits(bits, 43, 2) << 3) | (getBits(bits, 39, 3))) };
+            int horizontal[3] = { (int)((getBits(bits, 34, 5) << 1) | getBits(bits, 32, 1)), (int)getBits(bits, 25, 7), (int)getBits(bits, 19, 6) };
+            int vertical[3] = { (int)getBits(bits, 13, 6), (int)getBits(bits, 6, 7), (int)getBits(bits, 0, 6) };
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                if (c == 1)
+                {
+                    origin[c] = (origin[c] << 1) | (origin[c] >> 6);
+                    horizontal[c] = (horizontal[c] << 1) | (horizontal[c] >> 6);
+                    vertical[c] = (vertical[c] << 1) | (vertical[c] >> 6);
+                }
+                else
+                {
+                    origin[c] = (origin[c] << 2) | (origin[c] >> 4);
+                    horizontal[c] = (horizontal[c] << 2) | (horizontal[c] >> 4);
+                    vertical[c] = (vertical[c] << 2) | (vertical[c] >> 4);
+                }
+            }
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    unsigned char* pixel = pixels + (y * 4 + x) * 4;
+                    for (unsigned int c = 0; c < 3; ++c)
+                        pixel[c] = clampByte((x * (horizontal[c] - origin[c]) + y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2);
+                    pixel[3] = 255;
+                }
+            }
+            return;
+        }
+        else
+        {
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                int base0 = extend5(base[c]);
+                int base1 = extend5(base[c] + delta[c]);
+                for (unsigned int m = 0; m < 4; ++m)
+                {
+                    paint[0][m][c] = clampByte(base0 + ETC_MODIFIERS[getBits(bits, 37, 3)][m]);
+                    paint[1][m][c] = clampByte(base1 + ETC_MODIFIERS[getBits(bits, 34, 3)][m]);
+                }
+            }
+        }
+    }
+
+    // Pixel indices are stored by column, most significant bits first
+    for (int x = 0; x < 4; ++x)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            unsigned int position = x * 4 + y;
+            unsigned int index = (getBits(bits, 16 + position, 1) << 1) | getBits(bits, position, 1);
+            unsigned int half = halves && (flip ? y >= 2 : x >= 2) ? 1 : 0;
+            unsigned char* pixel = pixels + (y * 4 + x) * 4;
+            for (unsigned int c = 0; c < 3; ++c)
+                pixel[c] = (unsigned char)paint[half][index][c];
+            pixel[3] = 255;
+        }
+    }
+}
+
+void TextureDecompressor::decompressEACAlpha(const unsigned char* block, unsigned char* pixels)
+{
+    unsigned long long bits = readBigEndian64(block);
+    int base = getBits(bits, 56, 8);
+    int multiplier = getBits(bits, 52, 4);
+    const int* modifiers = EAC_MODIFIERS[getBits(bits, 48, 4)];
+    for (int x = 0; x < 4; ++x)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            unsigned int index = getBits(bits, 45 - (x * 4 + y) * 3, 3);
+            pixels[(y * 4 + x) * 4 + 3] = clampByte(base + modifiers[index] * multiplier);
+        }
+    }
+}
+
+}
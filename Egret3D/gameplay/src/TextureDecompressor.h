@@ -0,0 +1,73 @@
+#ifndef TEXTUREDECOMPRESSOR_H_
+#define TEXTUREDECOMPRESSOR_H_
+
+namespace egret
+{
+
+/**
+ * Decompresses block compressed textures on the CPU.
+ *
+ * Used to load compressed textures on GPUs that do not support their format, so the
+ * same assets work everywhere at the cost of uncompressed memory on those devices.
+ * Supports the S3TC formats (BC1, BC2 and BC3), ETC1, and ETC2 RGB and RGBA (EAC alpha).
+ *
+ * @script{ignore}
+ */
+class TextureDecompressor
+{
+public:
+
+    /**
+     * Determines whether blocks of the given format can be decompressed.
+     *
+     * @param format The OpenGL compressed internal format.
+     */
+    static bool canDecompress(GLenum format);
+
+    /**
+     * Gets the number of bytes of compressed blocks in an image of the given format and size.
+     *
+     * @param format The OpenGL compressed internal format.
+     * @param width The width of the image.
+     * @param height The height of the image.
+     *
+     * @return The size of the image data, or 0 if the format is not supported.
+     */
+    static unsigned int getImageSize(GLenum format, unsigned int width, unsigned int height);
+
+    /**
+     * Decompresses an image of the given format into RGBA pixels.
+     *
+     * Rows of blocks are decompressed in the order they are stored.
+     *
+     * @param format The OpenGL compressed internal format.
+     * @param data The compressed blocks, at least getImageSize() bytes.
+     * @param width The width of the image.
+     * @param height The height of the image.
+     * @param rgba The width * height * 4 bytes to write the pixels to.
+     *
+     * @return True if the format is supported.
+     */
+    static bool decompress(GLenum format, const unsigned char* data, unsigned int width, unsigned int height, unsigned char* rgba);
+
+private:
+
+    /**
+     * Constructor.
+     */
+    TextureDecompressor();
+
+    static void decompressBC1(const unsigned char* block, unsigned char* pixels, bool fourColors);
+
+    static void decompressBC2Alpha(const unsigned char* block, unsigned char* pixels);
+
+    static void decompressBC3Alpha(const unsigned char* block, unsigned char* pixels);
+
+    static void decompressETC2(const unsigned char* block, unsigned char* pixels);
+
+    static void decompressEACAlpha(const unsigned char* block, unsigned char* pixels);
+};
+
+}
+
+#endif
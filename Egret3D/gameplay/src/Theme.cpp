@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "Theme.h"
 #include "ThemeStyle.h"
+#include "TextureAtlas.h"
 #include "Game.h"
 #include "FileSystem.h"
 
@@ -145,6 +146,14 @@ Theme* Theme::create(const char* url)
     float tw = 1.0f / theme->_texture->getWidth();
     float th = 1.0f / theme->_texture->getHeight();
 
+    // Regions in a theme whose texture is an image in an atlas are relative to the image
+    kmVec2 origin = vec2Zero;
+    if (const TextureAtlas::Region* region = TextureAtlas::findRegion(textureFile.c_str()))
+    {
+        origin.x = region->bounds.x;
+        origin.y = region->bounds.y;
+    }
+
 	theme->_emptyImage = new Theme::ThemeImage(tw, th, Rectangle::empty(), { 0.0f, 0.0f, 0.0f, 0.0f });
 
     Properties* space = themeProperties->getNextNamespace();
@@ -155,11 +164,11 @@ Theme* Theme::create(const char* url)
             
         if (strcmpnocase(spacename, "image") == 0)
         {
-			theme->_images.push_back(ThemeImage::create(tw, th, space, { 1.0f, 1.0f, 1.0f, 1.0f }));
+			theme->_images.push_back(ThemeImage::create(tw, th, origin, space, { 1.0f, 1.0f, 1.0f, 1.0f }));
         }
         else if (strcmpnocase(spacename, "imageList") == 0)
         {
-            theme->_imageLists.push_back(ImageList::create(tw, th, space));
+            theme->_imageLists.push_back(ImageList::create(tw, th, origin, space));
         }
         else if (strcmpnocase(spacename, "skin") == 0)
         {
@@ -179,7 +188,7 @@ Theme* Theme::create(const char* url)
 
             kmVec4 regionVector = vec4Zero;
             space->getVector4("region", &regionVector);
-            const Rectangle region(regionVector.x, regionVector.y, regionVector.z, regionVector.w);
+            const Rectangle region(origin.x + regionVector.x, origin.y + regionVector.y, regionVector.z, regionVector.w);
 
 			kmVec4 color = { 1, 1, 1, 1 };
             if (space->exists("color"))
@@ -593,13 +602,13 @@ Theme::ThemeImage::~ThemeImage()
 {
 }
 
-Theme::ThemeImage* Theme::ThemeImage::create(float tw, float th, Properties* properties, const kmVec4& defaultColor)
+Theme::ThemeImage* Theme::ThemeImage::create(float tw, float th, const kmVec2& origin, Properties* properties, const kmVec4& defaultColor)
 {
     GP_ASSERT(properties);
 
     kmVec4 regionVector = vec4Zero;                
     properties->getVector4("region", &regionVector);
-    const Rectangle region(regionVector.x, regionVector.y, regionVector.z, regionVector.w);
+    const Rectangle region(origin.x + regionVector.x, origin.y + regionVector.y, regionVector.z, regionVector.w);
 
     kmVec4 color = vec4Zero;
     if (properties->exists("color"))
@@ -670,7 +679,7 @@ Theme::ImageList::~ImageList()
     }
 }
 
-Theme::ImageList* Theme::ImageList::create(float tw, float th, Properties* properties)
+Theme::ImageList* Theme::ImageList::create(float tw, float th, const kmVec2& origin, Properties* properties)
 {
     GP_ASSERT(properties);
 
@@ -691,7 +700,7 @@ Theme::ImageList* Theme::ImageList::create(float tw, float th, Properties* prope
     Properties* space = properties->getNextNamespace();
     while (space != NULL)
     {
-        ThemeImage* image = ThemeImage::create(tw, th, space, color);
+        ThemeImage* image = ThemeImage::create(tw, th, origin, space, color);
         GP_ASSERT(image);
         imageList->_images.push_back(image);
         space = properties->getNextNamespace();
@@ -18,6 +18,9 @@ namespace egret
  * UI controls.  A Theme has one property, 'texture', which points to a texture atlas containing
  * all the images used by the theme.  Cursor images, skins, and lists of images used by controls
  * are defined in their own namespaces.  The rest of the Theme consists of Style namespaces.
+ * The texture may be an image in a texture atlas, "sheet.atlas#name", in which case the regions
+ * in the theme file are relative to the image; regions set on controls at runtime are always
+ * in texture pixels.
  * A Style describes the border, margin, and padding of a Control, what images, skins, and cursors
  * are associated with a Control, and Font properties to apply to a Control's text.
  */
@@ -180,7 +183,7 @@ public:
 
         ~ThemeImage();
 
-        static ThemeImage* create(float tw, float th, Properties* properties, const kmVec4& defaultColor);
+        static ThemeImage* create(float tw, float th, const kmVec2& origin, Properties* properties, const kmVec4& defaultColor);
 
         std::string _id;
         UVs _uvs;
@@ -263,7 +266,7 @@ private:
          */
         ImageList& operator=(const ImageList&);
 
-        static ImageList* create(float tw, float th, Properties* properties);
+        static ImageList* create(float tw, float th, const kmVec2& origin, Properties* properties);
 
         std::string _id;
         std::vector<ThemeImage*> _images;
@@ -1,6 +1,7 @@
 #include "Base.h"
 #include "TileSet.h"
 #include "Scene.h"
+#include "TextureAtlas.h"
 
 namespace egret
 {
@@ -8,7 +9,7 @@ namespace egret
 TileSet::TileSet() : Drawable(),
     _tiles(NULL), _tileWidth(0), _tileHeight(0),
     _rowCount(0), _columnCount(0), _width(0), _height(0),
-	_opacity(1.0f), _color({ 1.0f, 1.0f, 1.0f, 1.0f }), _batch(NULL)
+	_opacity(1.0f), _color({ 1.0f, 1.0f, 1.0f, 1.0f }), _batch(NULL), _origin(vec2Zero)
 {
 }
 
@@ -39,6 +40,11 @@ TileSet* TileSet::create(const char* imagePath,
     
     TileSet* tileset = new TileSet();
     tileset->_batch = batch;
+    if (const TextureAtlas::Region* region = TextureAtlas::findRegion(imagePath))
+    {
+        tileset->_origin.x = region->bounds.x;
+        tileset->_origin.y = region->bounds.y;
+    }
     tileset->_tiles = new kmVec2[rowCount * columnCount];
     memset(tileset->_tiles, -1, sizeof(float) * rowCount * columnCount * 2);
     tileset->_tileWidth = tileWidth;
@@ -256,8 +262,8 @@ unsigned int TileSet::draw(bool wireframe)
             if (_tiles[row * _columnCount + col].x >= 0 &&
                 _tiles[row * _columnCount + col].y >= 0)
             {
-                Rectangle source = Rectangle(_tiles[row * _columnCount + col].x,
-                                             _tiles[row * _columnCount + col].y, _tileWidth, _tileHeight);
+                Rectangle source = Rectangle(_origin.x + _tiles[row * _columnCount + col].x,
+                                             _origin.y + _tiles[row * _columnCount + col].y, _tileWidth, _tileHeight);
 				_batch->draw(position, source, scale, { _color.x, _color.y, _color.z, _color.w * _opacity },
 				{ 0.5f, 0.5f }, 0);
             }
@@ -288,6 +294,7 @@ Drawable* TileSet::clone(NodeCloneContext& context)
     tilesetClone->_opacity = _opacity;
     tilesetClone->_color = _color;
     tilesetClone->_batch = _batch;
+    tilesetClone->_origin = _origin;
 
     return tilesetClone;
 }
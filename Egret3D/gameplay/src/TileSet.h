@@ -36,7 +36,8 @@ public:
     /**
      * Creates a tile set.
      *
-     * @param imagePath The path to the image to create the sprite from.
+     * @param imagePath The path to the image to create the sprite from. For an image in
+     *        a texture atlas, "sheet.atlas#name", tile sources are relative to the image.
      * @param tileWidth The width of each tile in the tile set.
      * @param tileHeight The height of each tile in the tile set.
      * @param rowCount The number of tile rows.
@@ -186,6 +187,7 @@ private:
     SpriteBatch* _batch;
     float _opacity;
     kmVec4 _color;
+    kmVec2 _origin;
 };
     
 }
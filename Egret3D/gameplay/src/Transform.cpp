@@ -1067,7 +1067,11 @@ void Transform::transformChanged()
             l.listener->transformChanged(this, l.cookie);
         }
     }
-    fireScriptEvent<void>(GP_GET_SCRIPT_EVENT(Transform, transformChanged), dynamic_cast<void*>(this));
+
+    // Only pay for the dynamic_cast and script event when a handler is registered
+    const ScriptTarget::Event* changedEvent = GP_GET_SCRIPT_EVENT(Transform, transformChanged);
+    if (hasScriptEventHandler(changedEvent))
+        fireScriptEvent<void>(changedEvent, dynamic_cast<void*>(this));
 }
 
 void Transform::cloneInto(Transform* transform, NodeCloneContext &context) const
@@ -8,6 +8,10 @@
 #include "Gesture.h"
 #include "Gamepad.h"
 #include "FileSystem.h"
+#include "Profiler.h"
+#include "PerformanceCounters.h"
+#include "FrameScheduler.h"
+#include "FramePacket.h"
 #include "Bundle.h"
 //#include "MathUtil.h"
 #include "Logger.h"
@@ -29,10 +33,14 @@
 
 // Graphics
 #include "Image.h"
+#include "ImageLoader.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureDecompressor.h"
 #include "Mesh.h"
 #include "MeshPart.h"
 #include "Effect.h"
+#include "ShaderPreprocessor.h"
 #include "Material.h"
 #include "RenderState.h"
 #include "VertexFormat.h"
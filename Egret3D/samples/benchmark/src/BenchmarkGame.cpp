@@ -0,0 +1,387 @@
+#include "BenchmarkGame.h"
+#include "MeshBatchBenchmark.h"
+#include "SpriteBatchBenchmark.h"
+#include "ParticlesBenchmark.h"
+#include "PhysicsBenchmark.h"
+#include "TerrainBenchmark.h"
+#include "FormLayoutBenchmark.h"
+
+// Declare our game instance
+BenchmarkGame game;
+
+struct BenchmarkSceneEntry
+{
+    const char* name;
+    BenchmarkScene* (*create)();
+};
+
+template <class T>
+static BenchmarkScene* createScene()
+{
+    return new T();
+}
+
+template <FormLayoutBenchmark::Mode mode>
+static BenchmarkScene* createFormScene()
+{
+    return new FormLayoutBenchmark(mode);
+}
+
+static const BenchmarkSceneEntry __scenes[] =
+{
+    { "meshBatch", &createScene<MeshBatchBenchmark> },
+    { "spriteBatch", &createScene<SpriteBatchBenchmark> },
+    { "particles", &createScene<ParticlesBenchmark> },
+    { "physics", &createScene<PhysicsBenchmark> },
+    { "terrain", &createScene<TerrainBenchmark> },
+    { "formBuild", &createFormScene<FormLayoutBenchmark::BUILD> },
+    { "formLayout", &createFormScene<FormLayoutBenchmark::MUTATE> },
+    { "formResize", &createFormScene<FormLayoutBenchmark::RESIZE> }
+};
+
+#ifdef GP_USE_PROFILER
+static const char* __stageNames[] = { "update", "render", "animation", "physics", "ai", "engine", "frame" };
+#else
+static const char* __stageNames[] = { "update", "render", "engine", "frame" };
+#endif
+
+BenchmarkGame::BenchmarkGame()
+    : _config(NULL), _sceneIndex(0), _scene(NULL), _frames(300), _warmupFrames(30), _frame(0),
+      _timeStep(1000.0f / 60.0f), _seed(1), _frameStart(0), _updateTime(0), _renderTime(0)
+{
+}
+
+void BenchmarkGame::initialize()
+{
+    // The scenes create meshes, materials and textures, which need a graphics context.
+    if (!isRenderingEnabled())
+    {
+        print("The benchmark needs a graphics context; run it with --headless instead of --headless=null.\n");
+        exit(2);
+        return;
+    }
+
+    _config = getConfig()->getNamespace("benchmark", true);
+
+    std::string scenes;
+    if (_config)
+    {
+        if (_config->exists("frames"))
+            _frames = std::max(_config->getInt("frames"), 1);
+        if (_config->exists("warmupFrames"))
+            _warmupFrames = std::max(_config->getInt("warmupFrames"), 0);
+        if (_config->exists("timeStep"))
+            _timeStep = _config->getFloat("timeStep");
+        if (_config->exists("seed"))
+            _seed = (unsigned int)_config->getInt("seed");
+        const char* names = _config->getString("scenes");
+        if (names)
+            scenes = names;
+    }
+
+    // Run every scene unless a list is given.
+    std::string name;
+    for (size_t i = 0; i <= scenes.size(); ++i)
+    {
+        if (i == scenes.size() || isspace(scenes[i]) || scenes[i] == ',')
+        {
+            if (!name.empty())
+                _sceneNames.push_back(name);
+            name.clear();
+        }
+        else
+        {
+            name += scenes[i];
+        }
+    }
+    if (_sceneNames.empty())
+    {
+        for (size_t i = 0; i < sizeof(__scenes) / sizeof(__scenes[0]); ++i)
+            _sceneNames.push_back(__scenes[i].name);
+    }
+
+    setVsync(false);
+    setFixedTimeStep(_timeStep);
+    startScene();
+}
+
+void BenchmarkGame::finalize()
+{
+    if (_scene)
+    {
+        _scene->finalize();
+        SAFE_DELETE(_scene);
+    }
+}
+
+void BenchmarkGame::update(float elapsedTime)
+{
+    double now = getAbsoluteTime();
+    if (_scene && _frame > _warmupFrames)
+    {
+        // The previous frame ended where this one starts.
+        double frameTime = now - _frameStart;
+        double engineTime = frameTime - _updateTime - _renderTime;
+        addTime("update", _updateTime);
+        addTime("render", _renderTime);
+#ifdef GP_USE_PROFILER
+        // The profiler holds the scopes of the previous frame until the next one ends.
+        static const char* controllerStages[][2] =
+        {
+            { "animation", "AnimationController::update" },
+            { "physics", "PhysicsController::update" },
+            { "ai", "AIController::update" }
+        };
+        for (size_t i = 0; i < sizeof(controllerStages) / sizeof(controllerStages[0]); ++i)
+        {
+            double time = Profiler::getFrameTime(controllerStages[i][1]);
+            addTime(controllerStages[i][0], time);
+            engineTime -= time;
+        }
+#endif
+        addTime("engine", engineTime);
+        addTime("frame", frameTime);
+    }
+
+    if (_scene && _frame == _warmupFrames + _frames)
+    {
+        endScene();
+        ++_sceneIndex;
+        startScene();
+        now = getAbsoluteTime();
+    }
+    if (_scene == NULL)
+        return;
+
+    _frameStart = now;
+    _scene->update(elapsedTime);
+    _updateTime = getAbsoluteTime() - now;
+
+    // Frames are counted here; render adds its time before the next update reads it.
+    _renderTime = 0.0;
+    ++_frame;
+}
+
+void BenchmarkGame::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0);
+    if (_scene == NULL)
+        return;
+
+    double start = getAbsoluteTime();
+    _scene->render(elapsedTime);
+    _renderTime = getAbsoluteTime() - start;
+}
+
+void BenchmarkGame::startScene()
+{
+    while (_sceneIndex < _sceneNames.size())
+    {
+        const std::string& name = _sceneNames[_sceneIndex];
+        for (size_t i = 0; i < sizeof(__scenes) / sizeof(__scenes[0]); ++i)
+        {
+            if (name == __scenes[i].name)
+            {
+                _scene = __scenes[i].create();
+                break;
+            }
+        }
+        if (_scene)
+            break;
+
+        GP_WARN("Unknown benchmark scene '%s'.", name.c_str());
+        ++_sceneIndex;
+    }
+    if (_scene == NULL)
+    {
+        finish();
+        return;
+    }
+
+    print("Running benchmark scene '%s' for %u frames.\n", _sceneNames[_sceneIndex].c_str(), _frames);
+
+    // Each run of a scene uses the same random numbers.
+    srand(_seed);
+    _scene->initialize();
+
+    Result result;
+    result.scene = _sceneNames[_sceneIndex];
+    for (size_t i = 0; i < sizeof(__stageNames) / sizeof(__stageNames[0]); ++i)
+    {
+        Stage stage;
+        stage.name = __stageNames[i];
+        stage.times.reserve(_frames);
+        stage.median = stage.mean = stage.p95 = stage.max = 0.0f;
+        result.stages.push_back(stage);
+    }
+    _results.push_back(result);
+    _frame = 0;
+}
+
+void BenchmarkGame::endScene()
+{
+    GP_ASSERT(_scene);
+
+    _scene->finalize();
+    SAFE_DELETE(_scene);
+
+    std::vector<Stage>& stages = _results.back().stages;
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        Stage& stage = stages[i];
+        std::vector<float> times = stage.times;
+        if (times.empty())
+            continue;
+
+        std::sort(times.begin(), times.end());
+        size_t count = times.size();
+        double total = 0.0;
+        for (size_t j = 0; j < count; ++j)
+            total += times[j];
+        stage.median = (count & 1) ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) * 0.5f;
+        stage.mean = (float)(total / count);
+        stage.p95 = times[(count * 95 + 99) / 100 - 1];
+        stage.max = times[count - 1];
+    }
+}
+
+void BenchmarkGame::finish()
+{
+    const char* resultsPath = _config ? _config->getString("results", "results.config") : "results.config";
+    if (writeResults(resultsPath))
+        print("Wrote benchmark results to '%s'.\n", resultsPath);
+
+    unsigned int regressions = 0;
+    const char* baselinePath = _config ? _config->getString("baseline") : NULL;
+    if (baselinePath && *baselinePath)
+        regressions = compareResults(baselinePath);
+
+    if (regressions > 0)
+        print("%u benchmark stages regressed.\n", regressions);
+
+    // Exit with a status the calling script can check.
+    exit(regressions > 0 ? 1 : 0);
+}
+
+void BenchmarkGame::addTime(const char* stage, double time)
+{
+    std::vector<Stage>& stages = _results.back().stages;
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        if (stages[i].name == stage)
+        {
+            stages[i].times.push_back((float)std::max(time, 0.0));
+            return;
+        }
+    }
+}
+
+bool BenchmarkGame::writeResults(const char* path) const
+{
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL || !stream->canWrite())
+    {
+        GP_WARN("Failed to write benchmark results to '%s'.", path);
+        return false;
+    }
+
+    std::ostringstream out;
+    out << "benchmark\n{\n";
+    out << "    timeStep = " << _timeStep << "\n";
+    out << "    frames = " << _frames << "\n";
+    for (size_t i = 0; i < _results.size(); ++i)
+    {
+        const Result& result = _results[i];
+        out << "\n    scene " << result.scene << "\n    {\n";
+        for (size_t j = 0; j < result.stages.size(); ++j)
+        {
+            const Stage& stage = result.stages[j];
+            out << "        stage " << stage.name << "\n        {\n";
+            out << "            median = " << stage.median << "\n";
+            out << "            mean = " << stage.mean << "\n";
+            out << "            p95 = " << stage.p95 << "\n";
+            out << "            max = " << stage.max << "\n";
+            out << "        }\n";
+        }
+        out << "    }\n";
+    }
+    out << "}\n";
+
+    std::string text = out.str();
+    return stream->write(text.c_str(), 1, text.size()) == text.size();
+}
+
+unsigned int BenchmarkGame::compareResults(const char* path) const
+{
+    if (!FileSystem::fileExists(path))
+    {
+        print("No benchmark baseline '%s'; keep the results file as the baseline.\n", path);
+        return 0;
+    }
+    Properties* baseline = Properties::create(path);
+    if (baseline == NULL)
+        return 0;
+    Properties* root = strcmp(baseline->getNamespace(), "benchmark") == 0 ? baseline : baseline->getNamespace("benchmark", true, false);
+    if (root == NULL)
+    {
+        GP_WARN("The benchmark baseline '%s' has no benchmark namespace.", path);
+        SAFE_DELETE(baseline);
+        return 0;
+    }
+
+    const char* metric = _config ? _config->getString("metric", "median") : "median";
+    float threshold = (_config && _config->exists("threshold")) ? _config->getFloat("threshold") : 10.0f;
+    float minimum = (_config && _config->exists("minimum")) ? _config->getFloat("minimum") : 0.05f;
+
+    print("%-14s %-8s %10s %10s %8s\n", "scene", "stage", "baseline", metric, "change");
+    unsigned int regressions = 0;
+    for (size_t i = 0; i < _results.size(); ++i)
+    {
+        const Result& result = _results[i];
+        Properties* sceneBaseline = root->getNamespace(result.scene.c_str(), false, false);
+        if (sceneBaseline == NULL)
+        {
+            print("%-14s not in the baseline\n", result.scene.c_str());
+            continue;
+        }
+
+        // Scenes can have their own threshold and minimum.
+        float sceneThreshold = threshold;
+        float sceneMinimum = minimum;
+        Properties* sceneConfig = _config ? _config->getNamespace(result.scene.c_str(), true, false) : NULL;
+        if (sceneConfig)
+        {
+            if (sceneConfig->exists("threshold"))
+                sceneThreshold = sceneConfig->getFloat("threshold");
+            if (sceneConfig->exists("minimum"))
+                sceneMinimum = sceneConfig->getFloat("minimum");
+        }
+
+        for (size_t j = 0; j < result.stages.size(); ++j)
+        {
+            const Stage& stage = result.stages[j];
+            Properties* stageBaseline = sceneBaseline->getNamespace(stage.name.c_str(), false, false);
+            if (stageBaseline == NULL || !stageBaseline->exists(metric))
+                continue;
+
+            float base = stageBaseline->getFloat(metric);
+            float value = stage.median;
+            if (strcmp(metric, "mean") == 0)
+                value = stage.mean;
+            else if (strcmp(metric, "p95") == 0)
+                value = stage.p95;
+            else if (strcmp(metric, "max") == 0)
+                value = stage.max;
+
+            float change = base > 0.0f ? (value - base) * 100.0f / base : 0.0f;
+            bool regressed = value - base > sceneMinimum && change > sceneThreshold;
+            if (regressed)
+                ++regressions;
+            print("%-14s %-8s %10.4f %10.4f %+7.1f%%%s\n", result.scene.c_str(), stage.name.c_str(), base, value, change,
+                  regressed ? "  REGRESSED" : "");
+        }
+    }
+
+    SAFE_DELETE(baseline);
+    return regressions;
+}
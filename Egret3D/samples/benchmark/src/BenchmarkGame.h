@@ -0,0 +1,141 @@
+#ifndef BENCHMARKGAME_H_
+#define BENCHMARKGAME_H_
+
+#include "gameplay.h"
+#include "BenchmarkScene.h"
+
+using namespace egret;
+
+/**
+ * Runs scripted scenes for a number of frames each and checks their frame times
+ * against a baseline.
+ *
+ * Every frame advances by a fixed time step, so each run does the same work. For each
+ * scene the CPU time of these stages is recorded per frame:
+ *
+ * - update: the scene's update. The form scenes lay out their form here.
+ * - render: the scene's render (building batches and issuing draw calls).
+ * - animation, physics and ai: the engine's controller updates. These are read from the
+ *   frame profiler, so they are only recorded when the engine is built with GP_USE_PROFILER.
+ * - engine: the rest of the frame (audio, forms, the buffer swap and, without the
+ *   profiler, the controller updates).
+ * - frame: the whole frame.
+ *
+ * The median, mean, 95th percentile and maximum of each stage are written to the results
+ * file, which has the same format as the baseline file, so a results file can be kept as
+ * the next baseline. A stage regresses when its metric is more than the threshold (in
+ * percent) and more than the minimum (in milliseconds) above the baseline. The process
+ * exits with 1 if a stage regressed, 2 if it could not run and 0 otherwise.
+ *
+ * Every scene creates meshes, materials or textures, so the benchmark needs a graphics
+ * context. On Linux, pass --headless to render into an offscreen context on machines
+ * without a display (a software renderer will do on machines without a GPU). It refuses
+ * to run with --headless=null, which has no graphics context.
+ *
+ * The game config controls the run:
+ *
+ * @code
+ * benchmark
+ * {
+ *     scenes = meshBatch spriteBatch particles physics terrain formBuild formLayout formResize
+ *     frames = 300
+ *     warmupFrames = 30
+ *     timeStep = 16.667
+ *     seed = 1
+ *     results = results.config
+ *     baseline = baseline.config
+ *     metric = median
+ *     threshold = 10
+ *     minimum = 0.05
+ *
+ *     // Per scene overrides of the threshold and minimum
+ *     physics
+ *     {
+ *         threshold = 20
+ *     }
+ * }
+ * @endcode
+ */
+class BenchmarkGame : public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    BenchmarkGame();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+
+private:
+
+    /**
+     * The times of a stage in each frame of a scene, in milliseconds.
+     */
+    struct Stage
+    {
+        std::string name;
+        std::vector<float> times;
+        float median;
+        float mean;
+        float p95;
+        float max;
+    };
+
+    /**
+     * The stages of a scene.
+     */
+    struct Result
+    {
+        std::string scene;
+        std::vector<Stage> stages;
+    };
+
+    void startScene();
+
+    void endScene();
+
+    void finish();
+
+    void addTime(const char* stage, double time);
+
+    bool writeResults(const char* path) const;
+
+    unsigned int compareResults(const char* path) const;
+
+    Properties* _config;
+    std::vector<std::string> _sceneNames;
+    unsigned int _sceneIndex;
+    BenchmarkScene* _scene;
+    unsigned int _frames;
+    unsigned int _warmupFrames;
+    unsigned int _frame;
+    float _timeStep;
+    unsigned int _seed;
+    double _frameStart;
+    double _updateTime;
+    double _renderTime;
+    std::vector<Result> _results;
+};
+
+#endif
@@ -0,0 +1,5 @@
+#include "BenchmarkScene.h"
+
+BenchmarkScene::~BenchmarkScene()
+{
+}
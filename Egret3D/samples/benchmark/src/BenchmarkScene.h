@@ -0,0 +1,49 @@
+#ifndef BENCHMARKSCENE_H_
+#define BENCHMARKSCENE_H_
+
+#include "gameplay.h"
+
+using namespace egret;
+
+/**
+ * Base class for the scripted scenes the benchmark runs.
+ *
+ * A scene must do the same work on every run: it is advanced by a fixed time step, the
+ * random number generator is seeded before it is initialized, and it must not depend
+ * on input or on the time that passed.
+ */
+class BenchmarkScene
+{
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~BenchmarkScene();
+
+    /**
+     * Creates the resources of the scene.
+     */
+    virtual void initialize() = 0;
+
+    /**
+     * Releases the resources of the scene.
+     */
+    virtual void finalize() = 0;
+
+    /**
+     * Advances the scene.
+     *
+     * @param elapsedTime The fixed time step, in milliseconds.
+     */
+    virtual void update(float elapsedTime) = 0;
+
+    /**
+     * Draws the scene.
+     *
+     * @param elapsedTime The fixed time step, in milliseconds.
+     */
+    virtual void render(float elapsedTime) = 0;
+};
+
+#endif
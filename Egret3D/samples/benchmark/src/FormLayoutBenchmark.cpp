@@ -0,0 +1,94 @@
+#include "FormLayoutBenchmark.h"
+
+// The form holds ROW_COUNT rows of LABELS_PER_ROW labels, ten thousand controls in all.
+#define ROW_COUNT 100
+#define LABELS_PER_ROW 99
+
+// The number of labels whose text changes every frame.
+#define MUTATIONS_PER_FRAME 20
+
+FormLayoutBenchmark::FormLayoutBenchmark(Mode mode)
+    : _mode(mode), _form(NULL), _frame(0)
+{
+}
+
+void FormLayoutBenchmark::initialize()
+{
+    if (_mode != BUILD)
+        buildForm();
+}
+
+void FormLayoutBenchmark::finalize()
+{
+    _labels.clear();
+    SAFE_RELEASE(_form);
+}
+
+void FormLayoutBenchmark::update(float elapsedTime)
+{
+    ++_frame;
+    switch (_mode)
+    {
+    case BUILD:
+        // Release the previous form and lay out a new one.
+        finalize();
+        buildForm();
+        break;
+
+    case MUTATE:
+        {
+            char text[32];
+            for (unsigned int i = 0; i < MUTATIONS_PER_FRAME; ++i)
+            {
+                unsigned int index = rand() % _labels.size();
+                sprintf(text, "label%u:%u", index, _frame % 1000);
+                _labels[index]->setText(text);
+            }
+            _form->update(elapsedTime);
+        }
+        break;
+
+    case RESIZE:
+        _form->setWidth(Game::getInstance()->getWidth() - (_frame & 1));
+        _form->update(elapsedTime);
+        break;
+    }
+}
+
+void FormLayoutBenchmark::render(float elapsedTime)
+{
+    // Only the layout is measured.
+}
+
+void FormLayoutBenchmark::buildForm()
+{
+    Game* game = Game::getInstance();
+    _form = Form::create("formLayout", NULL, Layout::LAYOUT_VERTICAL);
+    _form->setSize(game->getWidth(), game->getHeight());
+    _form->setScroll(Container::SCROLL_VERTICAL);
+
+    char text[32];
+    _labels.reserve(ROW_COUNT * LABELS_PER_ROW);
+    for (unsigned int i = 0; i < ROW_COUNT; ++i)
+    {
+        sprintf(text, "row%u", i);
+        Container* row = Container::create(text, NULL, Layout::LAYOUT_FLOW);
+        row->setWidth(1, true);
+        row->setAutoSize(Control::AUTO_SIZE_HEIGHT);
+        for (unsigned int j = 0; j < LABELS_PER_ROW; ++j)
+        {
+            sprintf(text, "label%u", i * LABELS_PER_ROW + j);
+            Label* label = Label::create(text);
+            label->setText(text);
+            row->addControl(label);
+            _labels.push_back(label);
+            label->release();
+        }
+        _form->addControl(row);
+        row->release();
+    }
+
+    // Forms are updated by the game unless they are disabled, so this one is laid out here.
+    _form->setEnabled(false);
+    _form->update(0);
+}
@@ -0,0 +1,48 @@
+#ifndef FORMLAYOUTBENCHMARK_H_
+#define FORMLAYOUTBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Lays out a form of ten thousand labels in flow layout rows, without drawing it.
+ *
+ * The scene runs in one of three modes, so each kind of layout gets its own frame times:
+ * building the whole form and laying it out, changing the text of a few labels (which
+ * only lays out the rows containing them again) or resizing the form (which lays out
+ * all of it).
+ */
+class FormLayoutBenchmark : public BenchmarkScene
+{
+public:
+
+    /**
+     * The work done every frame.
+     */
+    enum Mode
+    {
+        BUILD,
+        MUTATE,
+        RESIZE
+    };
+
+    FormLayoutBenchmark(Mode mode);
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    void buildForm();
+
+    Mode _mode;
+    Form* _form;
+    std::vector<Label*> _labels;
+    unsigned int _frame;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "MeshBatchBenchmark.h"
+
+// The number of triangles added to the batch each frame.
+#define TRIANGLE_COUNT 20000
+
+MeshBatchBenchmark::MeshBatchBenchmark()
+    : _meshBatch(NULL), _angle(0.0f)
+{
+}
+
+void MeshBatchBenchmark::initialize()
+{
+    Game* game = Game::getInstance();
+    float halfWidth = game->getWidth() / 2.0f;
+    float halfHeight = game->getHeight() / 2.0f;
+    kmMat4OrthographicProjection(&_projectionMatrix, -halfWidth, halfWidth, -halfHeight, halfHeight, -1.0f, 1.0f);
+
+    Material* material = Material::create("res/shaders/colored.vert", "res/shaders/colored.frag", "VERTEX_COLOR");
+    GP_ASSERT(material);
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3),
+        VertexFormat::Element(VertexFormat::COLOR, 3)
+    };
+    _meshBatch = MeshBatch::create(VertexFormat(elements, 2), Mesh::TRIANGLES, material, false, TRIANGLE_COUNT * 3);
+    SAFE_RELEASE(material);
+
+    // Scatter small triangles over the screen.
+    _vertices.resize(TRIANGLE_COUNT * 3);
+    for (unsigned int i = 0; i < TRIANGLE_COUNT; ++i)
+    {
+        float x = MATH_RANDOM_MINUS1_1() * halfWidth;
+        float y = MATH_RANDOM_MINUS1_1() * halfHeight;
+        float size = 4.0f + MATH_RANDOM_0_1() * 12.0f;
+        Vertex* v = &_vertices[i * 3];
+        kmVec3Fill(&v[0].position, x, y + size, 0.0f);
+        kmVec3Fill(&v[1].position, x - size, y - size, 0.0f);
+        kmVec3Fill(&v[2].position, x + size, y - size, 0.0f);
+        for (unsigned int j = 0; j < 3; ++j)
+            kmVec3Fill(&v[j].color, MATH_RANDOM_0_1(), MATH_RANDOM_0_1(), MATH_RANDOM_0_1());
+    }
+}
+
+void MeshBatchBenchmark::finalize()
+{
+    SAFE_DELETE(_meshBatch);
+    _vertices.clear();
+}
+
+void MeshBatchBenchmark::update(float elapsedTime)
+{
+    _angle += elapsedTime * 0.0005f;
+}
+
+void MeshBatchBenchmark::render(float elapsedTime)
+{
+    kmMat4 worldViewProjection = _projectionMatrix;
+    kmMat4RotateZ(&worldViewProjection, &worldViewProjection, _angle);
+
+    _meshBatch->start();
+    _meshBatch->add(&_vertices[0], (unsigned int)_vertices.size());
+    _meshBatch->finish();
+    _meshBatch->getMaterial()->getParameter("u_worldViewProjectionMatrix")->setValue(worldViewProjection);
+    _meshBatch->draw();
+}
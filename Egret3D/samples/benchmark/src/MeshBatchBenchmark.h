@@ -0,0 +1,37 @@
+#ifndef MESHBATCHBENCHMARK_H_
+#define MESHBATCHBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Streams a large number of vertex colored triangles through one MeshBatch each frame.
+ */
+class MeshBatchBenchmark : public BenchmarkScene
+{
+public:
+
+    MeshBatchBenchmark();
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    struct Vertex
+    {
+        kmVec3 position;
+        kmVec3 color;
+    };
+
+    MeshBatch* _meshBatch;
+    std::vector<Vertex> _vertices;
+    kmMat4 _projectionMatrix;
+    float _angle;
+};
+
+#endif
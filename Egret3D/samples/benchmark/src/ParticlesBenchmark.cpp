@@ -0,0 +1,73 @@
+#include "ParticlesBenchmark.h"
+
+// The number of emitters along each side of the grid.
+#define GRID_SIZE 4
+
+static const char* __emitterUrls[] =
+{
+    "res/common/particles/fire.particle",
+    "res/common/particles/smoke.particle",
+    "res/common/particles/explosion.particle"
+};
+
+ParticlesBenchmark::ParticlesBenchmark()
+    : _scene(NULL)
+{
+}
+
+void ParticlesBenchmark::initialize()
+{
+    _scene = Scene::create();
+    Camera* camera = Camera::createPerspective(45.0f, Game::getInstance()->getAspectRatio(), 0.25f, 1000.0f);
+    Node* cameraNode = _scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    cameraNode->setTranslation(0.0f, 0.0f, 80.0f);
+    _scene->setActiveCamera(camera);
+    SAFE_RELEASE(camera);
+
+    unsigned int urlCount = sizeof(__emitterUrls) / sizeof(__emitterUrls[0]);
+    for (unsigned int i = 0; i < GRID_SIZE * GRID_SIZE; ++i)
+    {
+        ParticleEmitter* emitter = ParticleEmitter::create(__emitterUrls[i % urlCount]);
+        if (emitter == NULL)
+            continue;
+
+        Node* node = _scene->addNode();
+        node->setTranslation(((i % GRID_SIZE) - (GRID_SIZE - 1) * 0.5f) * 15.0f, ((i / GRID_SIZE) - (GRID_SIZE - 1) * 0.5f) * 15.0f, 0.0f);
+        node->setDrawable(emitter);
+        emitter->start();
+        _emitters.push_back(emitter);
+        emitter->release();
+    }
+}
+
+void ParticlesBenchmark::finalize()
+{
+    _emitters.clear();
+    SAFE_RELEASE(_scene);
+}
+
+void ParticlesBenchmark::update(float elapsedTime)
+{
+    for (size_t i = 0; i < _emitters.size(); ++i)
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        // Restart emitters that burst once so every frame has work to do.
+        if (!emitter->isActive())
+            emitter->start();
+        emitter->update(elapsedTime);
+    }
+}
+
+void ParticlesBenchmark::render(float elapsedTime)
+{
+    _scene->visit(this, &ParticlesBenchmark::drawScene);
+}
+
+bool ParticlesBenchmark::drawScene(Node* node)
+{
+    Drawable* drawable = node->getDrawable();
+    if (drawable)
+        drawable->draw();
+    return true;
+}
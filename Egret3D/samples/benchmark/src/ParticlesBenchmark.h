@@ -0,0 +1,31 @@
+#ifndef PARTICLESBENCHMARK_H_
+#define PARTICLESBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Updates and draws a grid of fire, smoke and explosion particle emitters.
+ */
+class ParticlesBenchmark : public BenchmarkScene
+{
+public:
+
+    ParticlesBenchmark();
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    bool drawScene(Node* node);
+
+    Scene* _scene;
+    std::vector<ParticleEmitter*> _emitters;
+};
+
+#endif
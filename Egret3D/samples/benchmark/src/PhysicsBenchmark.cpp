@@ -0,0 +1,121 @@
+#include "PhysicsBenchmark.h"
+
+// The number of boxes along each side of a layer, and the number of layers.
+#define GRID_SIZE 8
+#define LAYER_COUNT 6
+
+static Model* createBoxModel(const kmVec4& color)
+{
+    float vertices[] =
+    {
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f
+    };
+    short indices[] =
+    {
+        0, 1, 2, 2, 1, 3, 2, 3, 6, 6, 3, 7, 6, 7, 4, 4, 7, 5, 4, 5, 0, 0, 5, 1, 1, 5, 3, 3, 5, 7, 4, 0, 6, 6, 0, 2
+    };
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3)
+    };
+    Mesh* mesh = Mesh::createMesh(VertexFormat(elements, 1), 8, false);
+    if (mesh == NULL)
+    {
+        GP_ERROR("Failed to create mesh.");
+        return NULL;
+    }
+    mesh->setVertexData(vertices, 0, 8);
+    MeshPart* meshPart = mesh->addPart(Mesh::TRIANGLES, Mesh::INDEX16, 36, false);
+    meshPart->setIndexData(indices, 0, 36);
+
+    Model* model = Model::create(mesh);
+    SAFE_RELEASE(mesh);
+    Material* material = model->setMaterial("res/shaders/colored.vert", "res/shaders/colored.frag");
+    material->setParameterAutoBinding("u_worldViewProjectionMatrix", "WORLD_VIEW_PROJECTION_MATRIX");
+    material->getParameter("u_diffuseColor")->setValue(color);
+    material->getStateBlock()->setCullFace(true);
+    material->getStateBlock()->setDepthTest(true);
+    material->getStateBlock()->setDepthWrite(true);
+    return model;
+}
+
+PhysicsBenchmark::PhysicsBenchmark()
+    : _scene(NULL)
+{
+}
+
+void PhysicsBenchmark::initialize()
+{
+    _scene = Scene::create();
+    Camera* camera = Camera::createPerspective(45.0f, Game::getInstance()->getAspectRatio(), 1.0f, 200.0f);
+    Node* cameraNode = _scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    cameraNode->setTranslation(0.0f, 15.0f, 30.0f);
+    cameraNode->rotateX(MATH_DEG_TO_RAD(-25.0f));
+    _scene->setActiveCamera(camera);
+    SAFE_RELEASE(camera);
+
+    // A static floor.
+    kmVec4 floorColor = { 0.4f, 0.4f, 0.4f, 1.0f };
+    Model* floorModel = createBoxModel(floorColor);
+    Node* floor = _scene->addNode("floor");
+    floor->setDrawable(floorModel);
+    SAFE_RELEASE(floorModel);
+    floor->setScale(40.0f, 1.0f, 40.0f);
+    floor->setTranslation(0.0f, -0.5f, 0.0f);
+    PhysicsRigidBody::Parameters floorParameters;
+    floor->setCollisionObject(PhysicsCollisionObject::RIGID_BODY, PhysicsCollisionShape::box(), &floorParameters);
+
+    // Layers of boxes that fall onto the floor and each other.
+    kmVec4 boxColor = { 0.8f, 0.5f, 0.2f, 1.0f };
+    Model* boxModel = createBoxModel(boxColor);
+    Node* box = Node::create("box");
+    box->setDrawable(boxModel);
+    SAFE_RELEASE(boxModel);
+    for (unsigned int layer = 0; layer < LAYER_COUNT; ++layer)
+    {
+        for (unsigned int i = 0; i < GRID_SIZE * GRID_SIZE; ++i)
+        {
+            Node* clone = box->clone();
+            float jitter = MATH_RANDOM_MINUS1_1() * 0.2f;
+            clone->setTranslation(((i % GRID_SIZE) - (GRID_SIZE - 1) * 0.5f) * 1.5f + jitter, 2.0f + layer * 1.5f,
+                                  ((i / GRID_SIZE) - (GRID_SIZE - 1) * 0.5f) * 1.5f - jitter);
+            clone->rotateY(MATH_RANDOM_0_1() * MATH_PI);
+            PhysicsRigidBody::Parameters parameters(1);
+            clone->setCollisionObject(PhysicsCollisionObject::RIGID_BODY, PhysicsCollisionShape::box(), &parameters);
+            _scene->addNode(clone);
+            clone->release();
+        }
+    }
+    SAFE_RELEASE(box);
+}
+
+void PhysicsBenchmark::finalize()
+{
+    SAFE_RELEASE(_scene);
+}
+
+void PhysicsBenchmark::update(float elapsedTime)
+{
+    // The physics controller steps the world before this; that time is in the engine stage.
+}
+
+void PhysicsBenchmark::render(float elapsedTime)
+{
+    _scene->visit(this, &PhysicsBenchmark::drawScene);
+}
+
+bool PhysicsBenchmark::drawScene(Node* node)
+{
+    Drawable* drawable = node->getDrawable();
+    if (drawable)
+        drawable->draw();
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef PHYSICSBENCHMARK_H_
+#define PHYSICSBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Drops a stack of rigid body boxes onto a static floor and draws them.
+ */
+class PhysicsBenchmark : public BenchmarkScene
+{
+public:
+
+    PhysicsBenchmark();
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    bool drawScene(Node* node);
+
+    Scene* _scene;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "SpriteBatchBenchmark.h"
+
+// The number of sprites drawn each frame.
+#define SPRITE_COUNT 10000
+
+SpriteBatchBenchmark::SpriteBatchBenchmark()
+    : _spriteBatch(NULL)
+{
+}
+
+void SpriteBatchBenchmark::initialize()
+{
+    _spriteBatch = SpriteBatch::create("res/png/logo.png", NULL, SPRITE_COUNT);
+
+    // The x, y, z, size and angle of every sprite, one array after another.
+    Game* game = Game::getInstance();
+    _values.resize(SPRITE_COUNT * 5);
+    _speeds.resize(SPRITE_COUNT);
+    _colors.resize(SPRITE_COUNT);
+    for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        _values[i] = MATH_RANDOM_0_1() * game->getWidth();
+        _values[SPRITE_COUNT + i] = MATH_RANDOM_0_1() * game->getHeight();
+        _values[SPRITE_COUNT * 2 + i] = 0.0f;
+        _values[SPRITE_COUNT * 3 + i] = 8.0f + MATH_RANDOM_0_1() * 24.0f;
+        _values[SPRITE_COUNT * 4 + i] = MATH_RANDOM_0_1() * MATH_PIX2;
+        _speeds[i] = MATH_RANDOM_MINUS1_1() * 0.005f;
+        kmVec4 color = { MATH_RANDOM_0_1(), MATH_RANDOM_0_1(), MATH_RANDOM_0_1(), 0.5f };
+        _colors[i] = color;
+    }
+}
+
+void SpriteBatchBenchmark::finalize()
+{
+    SAFE_DELETE(_spriteBatch);
+    _values.clear();
+    _speeds.clear();
+    _colors.clear();
+}
+
+void SpriteBatchBenchmark::update(float elapsedTime)
+{
+    float* angle = &_values[SPRITE_COUNT * 4];
+    for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+        angle[i] += _speeds[i] * elapsedTime;
+}
+
+void SpriteBatchBenchmark::render(float elapsedTime)
+{
+    const float* x = &_values[0];
+    const float* y = x + SPRITE_COUNT;
+    const float* z = y + SPRITE_COUNT;
+    const float* size = z + SPRITE_COUNT;
+    const float* angle = size + SPRITE_COUNT;
+    const kmVec3 right = { 1.0f, 0.0f, 0.0f };
+    const kmVec3 up = { 0.0f, 1.0f, 0.0f };
+
+    SpriteBatch::SpriteArrays sprites = { SPRITE_COUNT, x, y, z, size, NULL, angle, NULL, &_colors[0] };
+    _spriteBatch->start();
+    _spriteBatch->drawMany(sprites, right, up);
+    _spriteBatch->finish();
+}
@@ -0,0 +1,31 @@
+#ifndef SPRITEBATCHBENCHMARK_H_
+#define SPRITEBATCHBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Draws many rotating sprites with one SpriteBatch each frame.
+ */
+class SpriteBatchBenchmark : public BenchmarkScene
+{
+public:
+
+    SpriteBatchBenchmark();
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    SpriteBatch* _spriteBatch;
+    std::vector<float> _values;
+    std::vector<float> _speeds;
+    std::vector<kmVec4> _colors;
+};
+
+#endif
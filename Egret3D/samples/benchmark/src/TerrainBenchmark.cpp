@@ -0,0 +1,80 @@
+#include "TerrainBenchmark.h"
+
+// The number of height samples along each side of the terrain.
+#define TERRAIN_SIZE 257
+
+// The radius of the camera's flight around the center of the terrain.
+#define FLIGHT_RADIUS 300.0f
+
+TerrainBenchmark::TerrainBenchmark()
+    : _scene(NULL), _terrain(NULL), _angle(0.0f)
+{
+}
+
+void TerrainBenchmark::initialize()
+{
+    _scene = Scene::create();
+    Camera* camera = Camera::createPerspective(60.0f, Game::getInstance()->getAspectRatio(), 1.0f, 2000.0f);
+    Node* cameraNode = _scene->addNode("camera");
+    cameraNode->setCamera(camera);
+    _scene->setActiveCamera(camera);
+    SAFE_RELEASE(camera);
+
+    // Rolling hills with some noise, so every run builds the same terrain.
+    HeightField* heightField = HeightField::create(TERRAIN_SIZE, TERRAIN_SIZE);
+    float* heights = heightField->getArray();
+    for (unsigned int row = 0; row < TERRAIN_SIZE; ++row)
+    {
+        for (unsigned int column = 0; column < TERRAIN_SIZE; ++column)
+        {
+            float hills = sinf(column * 0.05f) * cosf(row * 0.04f) + sinf((column + row) * 0.013f);
+            heights[row * TERRAIN_SIZE + column] = 0.5f + hills * 0.2f + MATH_RANDOM_MINUS1_1() * 0.01f;
+        }
+    }
+
+    const kmVec3 scale = { 4.0f, 100.0f, 4.0f };
+    _terrain = Terrain::create(heightField, scale, 32, 3, 0.1f);
+    if (_terrain == NULL)
+    {
+        GP_ERROR("Failed to create the benchmark terrain.");
+        return;
+    }
+    const kmVec2 repeat = { 50.0f, 50.0f };
+    _terrain->setLayer(0, "res/png/dirt.png", repeat);
+    Node* terrainNode = _scene->addNode("terrain");
+    terrainNode->setDrawable(_terrain);
+    _terrain->release();
+}
+
+void TerrainBenchmark::finalize()
+{
+    _terrain = NULL;
+    SAFE_RELEASE(_scene);
+}
+
+void TerrainBenchmark::update(float elapsedTime)
+{
+    if (_terrain == NULL)
+        return;
+
+    // Circle the terrain close to the ground, looking ahead.
+    _angle += elapsedTime * 0.0002f;
+    float x = cosf(_angle) * FLIGHT_RADIUS;
+    float z = sinf(_angle) * FLIGHT_RADIUS;
+    Node* cameraNode = _scene->getActiveCamera()->getNode();
+    cameraNode->setTranslation(x, _terrain->getHeight(x, z) + 20.0f, z);
+    cameraNode->setRotation(vec3uintY, MATH_PI - _angle);
+}
+
+void TerrainBenchmark::render(float elapsedTime)
+{
+    _scene->visit(this, &TerrainBenchmark::drawScene);
+}
+
+bool TerrainBenchmark::drawScene(Node* node)
+{
+    Drawable* drawable = node->getDrawable();
+    if (drawable)
+        drawable->draw();
+    return true;
+}
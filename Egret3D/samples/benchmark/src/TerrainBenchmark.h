@@ -0,0 +1,32 @@
+#ifndef TERRAINBENCHMARK_H_
+#define TERRAINBENCHMARK_H_
+
+#include "BenchmarkScene.h"
+
+/**
+ * Flies a camera over a procedural terrain, so its patches change level of detail.
+ */
+class TerrainBenchmark : public BenchmarkScene
+{
+public:
+
+    TerrainBenchmark();
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    bool drawScene(Node* node);
+
+    Scene* _scene;
+    Terrain* _terrain;
+    float _angle;
+};
+
+#endif
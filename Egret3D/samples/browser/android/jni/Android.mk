@@ -31,9 +31,11 @@ LOCAL_SRC_FILES := ../../../gameplay/src/gameplay-main-android.cpp \
     AudioSample.cpp \
     BillboardSample.cpp \
     FontSample.cpp \
+    FormLayoutSample.cpp \
     FormsSample.cpp \
     GestureSample.cpp \
     GamepadSample.cpp \
+    ImageLoadingSample.cpp \
     InputSample.cpp \
     LightSample.cpp \
     MeshBatchSample.cpp \
@@ -41,13 +43,18 @@ LOCAL_SRC_FILES := ../../../gameplay/src/gameplay-main-android.cpp \
     ParticlesSample.cpp \
     PhysicsCollisionObjectSample.cpp \
     PostProcessSample.cpp \
+    PropertiesLoadingSample.cpp \
     SceneCreateSample.cpp \
     SceneLoadSample.cpp \
+    ScriptEventSample.cpp \
     SpriteBatchSample.cpp \
     SpriteSample.cpp \
+    SpriteThroughputSample.cpp \
     TerrainSample.cpp \
+    TerrainStreamingSample.cpp \
     TextureSample.cpp \
     TriangleSample.cpp \
+    TrueTypeFontSample.cpp \
     WaterSample.cpp
 
 LOCAL_CPPFLAGS += -std=c++11 -frtti -Wno-switch-enum -Wno-switch
@@ -0,0 +1,5 @@
+-- Update handler attached to every node by ScriptEventSample
+
+function node_update(node, elapsedTime)
+    node:rotateY(elapsedTime * 0.001)
+end
@@ -14,10 +14,12 @@ SOURCES += src/Audio3DSample.cpp \
     src/BillboardSample.cpp \
     src/FirstPersonCamera.cpp \
     src/FontSample.cpp \
+    src/FormLayoutSample.cpp \
     src/FormsSample.cpp \
     src/GamepadSample.cpp \
     src/GestureSample.cpp \
     src/Grid.cpp \
+    src/ImageLoadingSample.cpp \
     src/InputSample.cpp \
     src/LightSample.cpp \
     src/MeshBatchSample.cpp \
@@ -25,15 +27,20 @@ SOURCES += src/Audio3DSample.cpp \
     src/ParticlesSample.cpp \
     src/PhysicsCollisionObjectSample.cpp \
     src/PostProcessSample.cpp \
+    src/PropertiesLoadingSample.cpp \
     src/Sample.cpp \
     src/SamplesGame.cpp \
     src/SceneCreateSample.cpp \
     src/SceneLoadSample.cpp \
+    src/ScriptEventSample.cpp \
     src/SpriteBatchSample.cpp \
     src/SpriteSample.cpp \
+    src/SpriteThroughputSample.cpp \
     src/TerrainSample.cpp \
+    src/TerrainStreamingSample.cpp \
     src/TextureSample.cpp \
     src/TriangleSample.cpp \
+    src/TrueTypeFontSample.cpp \
     src/WaterSample.cpp
 
 HEADERS += src/Audio3DSample.h \
@@ -41,10 +48,12 @@ HEADERS += src/Audio3DSample.h \
     src/BillboardSample.h \
     src/FirstPersonCamera.h \
     src/FontSample.h \
+    src/FormLayoutSample.h \
     src/FormsSample.h \
     src/GamepadSample.h \
     src/GestureSample.h \
     src/Grid.h \
+    src/ImageLoadingSample.h \
     src/InputSample.h \
     src/LightSample.h \
     src/MeshBatchSample.h \
@@ -52,15 +61,20 @@ HEADERS += src/Audio3DSample.h \
     src/ParticlesSample.h \
     src/PhysicsCollisionObjectSample.h \
     src/PostProcessSample.h \
+    src/PropertiesLoadingSample.h \
     src/Sample.h \
     src/SamplesGame.h \
     src/SceneCreateSample.h \
     src/SceneLoadSample.h \
+    src/ScriptEventSample.h \
     src/SpriteBatchSample.h \
     src/SpriteSample.h \
+    src/SpriteThroughputSample.h \
     src/TerrainSample.h \
+    src/TerrainStreamingSample.h \
     src/TextureSample.h \
     src/TriangleSample.h \
+    src/TrueTypeFontSample.h \
     src/WaterSample.h
 
 INCLUDEPATH += $$PWD/../../gameplay/src
@@ -84,7 +98,7 @@ linux: INCLUDEPATH += /usr/include/libpng12
 linux: INCLUDEPATH += /usr/include/harfbuzz
 linux: LIBS += -L$$PWD/../../gameplay/Debug/ -lgameplay
 linux: LIBS += -L$$PWD/../../external-deps/lib/linux/x86_64/ -lgameplay-deps
-linux: LIBS += -lm -lGL -lrt -ldl -lX11 -lpthread -lgtk-x11-2.0 -lglib-2.0 -lgobject-2.0
+linux: LIBS += -lm -lGL -lEGL -lrt -ldl -lX11 -lpthread -lgtk-x11-2.0 -lglib-2.0 -lgobject-2.0
 linux: QMAKE_POST_LINK += $$quote(rsync -rau $$PWD/../../gameplay/res/shaders ../res$$escape_expand(\n\t))
 linux: QMAKE_POST_LINK += $$quote(rsync -rau $$PWD/../../gameplay/res/ui ../res$$escape_expand(\n\t))
 linux: QMAKE_POST_LINK += $$quote(cp -rf $$PWD/../../gameplay/res/logo_powered_white.png ../res$$escape_expand(\n\t))
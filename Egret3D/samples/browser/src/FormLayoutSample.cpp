@@ -0,0 +1,121 @@
+#include "FormLayoutSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "Form Layout", FormLayoutSample, 18);
+#endif
+
+// The form holds ROW_COUNT rows of LABELS_PER_ROW labels, ten thousand controls in all.
+#define ROW_COUNT 100
+#define LABELS_PER_ROW 99
+
+// The number of labels whose text changes every frame.
+#define MUTATIONS_PER_FRAME 20
+
+// The number of frames between layouts of the whole form.
+#define FULL_LAYOUT_FRAMES 60
+
+FormLayoutSample::FormLayoutSample()
+    : _font(NULL), _form(NULL), _drawForm(false), _frame(0), _buildTime(0), _incrementalTime(0), _fullTime(0),
+      _incrementalFrames(0), _fullFrames(0)
+{
+}
+
+void FormLayoutSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+
+    double start = Game::getAbsoluteTime();
+
+    _form = Form::create("formLayout", NULL, Layout::LAYOUT_VERTICAL);
+    _form->setSize(getWidth(), getHeight());
+    _form->setScroll(Container::SCROLL_VERTICAL);
+
+    char text[32];
+    _labels.reserve(ROW_COUNT * LABELS_PER_ROW);
+    for (unsigned int i = 0; i < ROW_COUNT; ++i)
+    {
+        sprintf(text, "row%u", i);
+        Container* row = Container::create(text, NULL, Layout::LAYOUT_FLOW);
+        row->setWidth(1, true);
+        row->setAutoSize(Control::AUTO_SIZE_HEIGHT);
+        for (unsigned int j = 0; j < LABELS_PER_ROW; ++j)
+        {
+            sprintf(text, "label%u", i * LABELS_PER_ROW + j);
+            Label* label = Label::create(text);
+            label->setText(text);
+            row->addControl(label);
+            _labels.push_back(label);
+            label->release();
+        }
+        _form->addControl(row);
+        row->release();
+    }
+
+    // Forms are updated by the game unless they are disabled, so this one is laid out explicitly
+    _form->setEnabled(false);
+    _form->update(0);
+
+    _buildTime = Game::getAbsoluteTime() - start;
+}
+
+void FormLayoutSample::finalize()
+{
+    _labels.clear();
+    SAFE_RELEASE(_form);
+    SAFE_RELEASE(_font);
+}
+
+void FormLayoutSample::update(float elapsedTime)
+{
+    double start = Game::getAbsoluteTime();
+    if (++_frame % FULL_LAYOUT_FRAMES == 0)
+    {
+        // Resizing the form lays out every control in it.
+        _form->setWidth(getWidth() - (_frame / FULL_LAYOUT_FRAMES & 1));
+        _form->update(elapsedTime);
+        _fullTime += Game::getAbsoluteTime() - start;
+        ++_fullFrames;
+    }
+    else
+    {
+        // Changing text only lays out the rows of the changed labels.
+        char text[32];
+        for (unsigned int i = 0; i < MUTATIONS_PER_FRAME; ++i)
+        {
+            unsigned int index = rand() % _labels.size();
+            sprintf(text, "label%u:%u", index, _frame % 1000);
+            _labels[index]->setText(text);
+        }
+        _form->update(elapsedTime);
+        _incrementalTime += Game::getAbsoluteTime() - start;
+        ++_incrementalFrames;
+    }
+}
+
+void FormLayoutSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    if (_drawForm)
+        _form->draw();
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    // Average layout times in milliseconds.
+    double incremental = _incrementalFrames > 0 ? _incrementalTime / _incrementalFrames : 0;
+    double full = _fullFrames > 0 ? _fullTime / _fullFrames : 0;
+
+    char text[1024];
+    sprintf(text, "%u controls built in %.1f ms\n%u labels changed: %.3f ms/frame\nwhole form: %.3f ms\nTouch to %s the form",
+        ROW_COUNT * (LABELS_PER_ROW + 1), _buildTime, MUTATIONS_PER_FRAME, incremental, full, _drawForm ? "hide" : "draw");
+    _font->start();
+    _font->drawText(text, 10, 40, vec4One, 18);
+    _font->finish();
+}
+
+void FormLayoutSample::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
+{
+    if (evt == Touch::TOUCH_PRESS)
+        _drawForm = !_drawForm;
+}
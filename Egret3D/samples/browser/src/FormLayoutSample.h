@@ -0,0 +1,49 @@
+#ifndef FORMLAYOUTSAMPLE_H_
+#define FORMLAYOUTSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring how long forms take to lay out a large number of controls.
+ *
+ * Builds a form of ten thousand labels in flow layout rows and changes the text of a
+ * few of them every frame, which only lays out the rows containing them again. Every
+ * second the form is resized, which lays out all of it. The form is laid out without
+ * being drawn; touch the screen to toggle drawing it.
+ */
+class FormLayoutSample : public Sample
+{
+public:
+
+    FormLayoutSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+    void touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex);
+
+private:
+
+    Font* _font;
+    Form* _form;
+    std::vector<Label*> _labels;
+    bool _drawForm;
+    unsigned int _frame;
+    double _buildTime;
+    double _incrementalTime;
+    double _fullTime;
+    unsigned int _incrementalFrames;
+    unsigned int _fullFrames;
+};
+
+#endif
@@ -10,7 +10,7 @@
 const static unsigned int __formsCount = 5;
 
 FormsSample::FormsSample()
-    : _scene(NULL), _formNode(NULL), _formNodeParent(NULL), _formSelect(NULL), _activeForm(NULL), _gamepad(NULL), _keyFlags(0)
+    : _font(NULL), _scene(NULL), _formNode(NULL), _formNodeParent(NULL), _formSelect(NULL), _activeForm(NULL), _gamepad(NULL), _keyFlags(0)
 {
 	memset(_joysticks, 0, sizeof(float) * 2 * 2);
     const char* formFiles[] = 
@@ -27,6 +27,7 @@ FormsSample::FormsSample()
 
 void FormsSample::finalize()
 {
+    SAFE_RELEASE(_font);
     SAFE_RELEASE(_scene);
     SAFE_RELEASE(_formNode);
     SAFE_RELEASE(_formSelect);
@@ -74,6 +75,8 @@ void FormsSample::initialize()
     setMultiTouch(true);
     setVsync(false);
 
+    _font = Font::create("res/ui/arial.gpb");
+
     _formSelect = Form::create("res/common/forms/formSelect.form");
     _formSelect->setFocus();
 
@@ -259,6 +262,16 @@ void FormsSample::render(float elapsedTime)
     }
 
     _gamepad->draw();
+
+    // Show how many controls were drawn from scratch and from their retained sprites,
+    // and how much of their text was laid out again
+    char text[128];
+    sprintf(text, "Controls rebuilt: %u reused: %u  Text layouts cached: %u laid out: %u (%u KB)",
+        Form::getControlsRebuilt(), Form::getControlsReused(), Font::getLayoutCacheHits(), Font::getLayoutCacheMisses(),
+        (unsigned int)(Font::getLayoutCacheSize() / 1024));
+    _font->start();
+    _font->drawText(text, 10, getHeight() - _font->getSize() - 10, vec4One, 18);
+    _font->finish();
 }
 
 void FormsSample::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
@@ -33,6 +33,7 @@ private:
     
     void createSampleForm();
     
+    Font* _font;
     Scene* _scene;
     Node* _formNode;
     Node* _formNodeParent;
@@ -0,0 +1,115 @@
+#include "ImageLoadingSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "Image Loading", ImageLoadingSample, 19);
+#endif
+
+// The number of images decoded per measurement.
+#define IMAGE_COUNT 500
+
+ImageLoadingSample::ImageLoadingSample()
+    : _font(NULL), _threadCount(0), _cacheSize(0), _maxThreads(0), _cachedTime(-1), _cacheHits(0)
+{
+}
+
+void ImageLoadingSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+
+    std::vector<std::string> files;
+    FileSystem::listFiles("res/png", files);
+    for (size_t i = 0, count = files.size(); i < count; ++i)
+    {
+        if (files[i].size() > 4 && files[i].compare(files[i].size() - 4, 4, ".png") == 0)
+            _paths.push_back("res/png/" + files[i]);
+    }
+
+    _threadCount = ImageLoader::getThreadCount();
+    _cacheSize = ImageLoader::getCacheSize();
+    _maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ImageLoadingSample::finalize()
+{
+    ImageLoader::setThreadCount(_threadCount);
+    ImageLoader::setCacheSize(_cacheSize);
+    SAFE_RELEASE(_font);
+}
+
+double ImageLoadingSample::loadImages()
+{
+    double start = Game::getAbsoluteTime();
+
+    // A file can only be queued once at a time, so the images are decoded in passes over the files.
+    unsigned int remaining = IMAGE_COUNT;
+    while (remaining > 0 && !_paths.empty())
+    {
+        size_t count = std::min((size_t)remaining, _paths.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            ImageLoader::load(_paths[i].c_str());
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            Image* image = Image::create(_paths[i].c_str());
+            SAFE_RELEASE(image);
+        }
+        remaining -= (unsigned int)count;
+    }
+
+    return Game::getAbsoluteTime() - start;
+}
+
+void ImageLoadingSample::update(float elapsedTime)
+{
+    if (_times.size() < _maxThreads)
+    {
+        ImageLoader::setCacheSize(0);
+        ImageLoader::setThreadCount((unsigned int)_times.size() + 1);
+        _times.push_back(loadImages());
+    }
+    else if (_cachedTime < 0)
+    {
+        ImageLoader::setCacheSize(_cacheSize);
+        unsigned int hits = ImageLoader::getCacheHits();
+        loadImages();
+        _cachedTime = loadImages();
+        _cacheHits = ImageLoader::getCacheHits() - hits;
+    }
+}
+
+void ImageLoadingSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    std::string text;
+    char line[128];
+    sprintf(line, "%u images from %u files\n", IMAGE_COUNT, (unsigned int)_paths.size());
+    text += line;
+    for (size_t i = 0, count = _times.size(); i < count; ++i)
+    {
+        sprintf(line, "%u threads: %.1f ms (%.2fx)\n", (unsigned int)i + 1, _times[i], _times[i] > 0 ? _times[0] / _times[i] : 0.0);
+        text += line;
+    }
+    if (_cachedTime >= 0)
+    {
+        sprintf(line, "cached: %.1f ms, %u hits\n", _cachedTime, _cacheHits);
+        text += line;
+        text += "Touch to measure again";
+    }
+    _font->start();
+    _font->drawText(text.c_str(), 10, 40, vec4One, 18);
+    _font->finish();
+}
+
+void ImageLoadingSample::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
+{
+    if (evt == Touch::TOUCH_PRESS && _cachedTime >= 0)
+    {
+        _times.clear();
+        _cachedTime = -1;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef IMAGELOADINGSAMPLE_H_
+#define IMAGELOADINGSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring how long PNG images take to decode on different numbers of loader threads.
+ *
+ * Decodes 500 images, one pass over the sample PNG files after another, with one loader
+ * thread and then with each thread count up to the number of cores, one count per frame.
+ * The decoded image cache is disabled while measuring so that every image is decoded.
+ * A last pass loads the files again with the cache enabled. Touch the screen to measure again.
+ */
+class ImageLoadingSample : public Sample
+{
+public:
+
+    ImageLoadingSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+    void touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex);
+
+private:
+
+    double loadImages();
+
+    Font* _font;
+    std::vector<std::string> _paths;
+    unsigned int _threadCount;
+    size_t _cacheSize;
+    unsigned int _maxThreads;
+    std::vector<double> _times;
+    double _cachedTime;
+    unsigned int _cacheHits;
+};
+
+#endif
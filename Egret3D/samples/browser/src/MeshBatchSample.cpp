@@ -78,8 +78,9 @@ void MeshBatchSample::render(float elapsedTime)
 	drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
     _font->start();
     char text[1024];
-    sprintf(text, "Touch to add triangles (%d)", (int)(_vertices.size() / 3));
-    _font->drawText(text, 10, getHeight() - _font->getSize() - 10, vec4One, 18);
+    sprintf(text, "Touch to add triangles (%d)\nStreamed %u bytes in %u batch flushes", (int)(_vertices.size() / 3),
+        MeshBatch::getBytesStreamed(), MeshBatch::getFlushCount());
+    _font->drawText(text, 10, getHeight() - _font->getSize() * 2 - 10, vec4One, 18);
     _font->finish();
 }
 
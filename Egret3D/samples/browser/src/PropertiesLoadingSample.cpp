@@ -0,0 +1,163 @@
+#include "PropertiesLoadingSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "Properties Loading", PropertiesLoadingSample, 20);
+#endif
+
+// The number of materials in the generated file.
+#define MATERIAL_COUNT 2000
+
+// The number of typed lookups per measurement.
+#define LOOKUP_COUNT 100000
+
+PropertiesLoadingSample::PropertiesLoadingSample()
+    : _font(NULL), _fileSize(0), _parseTime(-1), _cachedTime(0), _lookupTime(0), _reparseTime(0)
+{
+}
+
+void PropertiesLoadingSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+}
+
+void PropertiesLoadingSample::finalize()
+{
+    for (size_t i = 0, count = _paths.size(); i < count; ++i)
+    {
+        std::string path = FileSystem::getResourcePath();
+        path += _paths[i];
+        remove(path.c_str());
+    }
+    SAFE_RELEASE(_font);
+}
+
+bool PropertiesLoadingSample::writeFile(const std::string& path)
+{
+    std::unique_ptr<Stream> stream(FileSystem::open(path.c_str(), FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        GP_WARN("Failed to write '%s'.", path.c_str());
+        return false;
+    }
+
+    std::string text;
+    char line[128];
+    text += "material base\n{\n    technique\n    {\n        pass\n        {\n";
+    for (unsigned int i = 0; i < 40; ++i)
+    {
+        sprintf(line, "            p%u = %f\n", i, i * 0.125f);
+        text += line;
+    }
+    text += "            u_diffuseColor = 1.0, 0.5, 0.25, 1.0\n        }\n    }\n}\n";
+    for (unsigned int i = 0; i < MATERIAL_COUNT; ++i)
+    {
+        sprintf(line, "material m%u : base\n{\n    technique\n    {\n        pass\n        {\n", i);
+        text += line;
+        for (unsigned int j = 0; j < 10; ++j)
+        {
+            sprintf(line, "            p%u = %u.%u\n", (i * 7 + j * 13) % 60, i, j);
+            text += line;
+        }
+        sprintf(line, "            sampler u_texture\n            {\n                path = res/png/image%u.png\n", i % 50);
+        text += line;
+        text += "                mipmap = true\n            }\n        }\n    }\n}\n";
+    }
+    _fileSize = text.size();
+    bool written = stream->write(text.c_str(), 1, text.size()) == text.size();
+    stream->close();
+    return written;
+}
+
+void PropertiesLoadingSample::measure()
+{
+    // A new file each time, so that it is not in the cache of parsed files
+    char path[64];
+    sprintf(path, "properties%u.material", (unsigned int)_paths.size());
+    _paths.push_back(path);
+    if (!writeFile(path))
+    {
+        _parseTime = 0;
+        return;
+    }
+
+    double start = Game::getAbsoluteTime();
+    Properties* properties = Properties::create(path);
+    _parseTime = Game::getAbsoluteTime() - start;
+
+    start = Game::getAbsoluteTime();
+    Properties* cached = Properties::create(path);
+    _cachedTime = Game::getAbsoluteTime() - start;
+    SAFE_DELETE(cached);
+
+    Properties* material = properties ? properties->getNamespace("m100") : NULL;
+    Properties* pass = material ? material->getNamespace("pass", true) : NULL;
+    if (pass)
+    {
+        float sum = 0;
+        kmVec4 color;
+        start = Game::getAbsoluteTime();
+        for (unsigned int i = 0; i < LOOKUP_COUNT; ++i)
+        {
+            sum += pass->getFloat("p7");
+            pass->getVector4("u_diffuseColor", &color);
+            sum += color.y;
+        }
+        _lookupTime = Game::getAbsoluteTime() - start;
+
+        // As every lookup did before typed values were kept
+        start = Game::getAbsoluteTime();
+        for (unsigned int i = 0; i < LOOKUP_COUNT; ++i)
+        {
+            sum += (float)atof(pass->getString("p7"));
+            Properties::parseVector4(pass->getString("u_diffuseColor"), &color);
+            sum += color.y;
+        }
+        _reparseTime = Game::getAbsoluteTime() - start;
+        GP_ASSERT(sum != 0);
+    }
+    SAFE_DELETE(properties);
+}
+
+void PropertiesLoadingSample::update(float elapsedTime)
+{
+    if (_parseTime < 0)
+    {
+        measure();
+    }
+}
+
+void PropertiesLoadingSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    if (_parseTime < 0)
+        return;
+
+    std::string text;
+    char line[128];
+    sprintf(line, "%u materials, %u KB\n", MATERIAL_COUNT, (unsigned int)(_fileSize / 1024));
+    text += line;
+    sprintf(line, "parse: %.1f ms\n", _parseTime);
+    text += line;
+    sprintf(line, "cached: %.1f ms\n", _cachedTime);
+    text += line;
+    sprintf(line, "%u typed lookups: %.1f ms\n", LOOKUP_COUNT * 2, _lookupTime);
+    text += line;
+    sprintf(line, "%u reparsed lookups: %.1f ms (%.2fx)\n", LOOKUP_COUNT * 2, _reparseTime, _lookupTime > 0 ? _reparseTime / _lookupTime : 0.0);
+    text += line;
+    text += "Touch to measure again";
+    _font->start();
+    _font->drawText(text.c_str(), 10, 40, vec4One, 18);
+    _font->finish();
+}
+
+void PropertiesLoadingSample::touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex)
+{
+    if (evt == Touch::TOUCH_PRESS && _parseTime >= 0)
+    {
+        _parseTime = -1;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PROPERTIESLOADINGSAMPLE_H_
+#define PROPERTIESLOADINGSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring how long a large properties file takes to load and query.
+ *
+ * Writes a synthetic material file of 2000 materials inheriting from a base material and
+ * measures parsing it, creating it again from the parsed file cache, and looking up typed
+ * values, which are parsed once, against parsing the value strings on every lookup.
+ * Touch the screen to measure again with a new file.
+ */
+class PropertiesLoadingSample : public Sample
+{
+public:
+
+    PropertiesLoadingSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+    void touchEvent(Touch::TouchEvent evt, int x, int y, unsigned int contactIndex);
+
+private:
+
+    bool writeFile(const std::string& path);
+
+    void measure();
+
+    Font* _font;
+    std::vector<std::string> _paths;
+    size_t _fileSize;
+    double _parseTime;
+    double _cachedTime;
+    double _lookupTime;
+    double _reparseTime;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "ScriptEventSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Scripting", "Script Events", ScriptEventSample, 1);
+#endif
+
+// The number of nodes with a Lua update handler.
+#define NODE_COUNT 10000
+
+// The number of frames to average timings over.
+#define SAMPLE_FRAMES 60
+
+static const char* NODE_UPDATE_FUNCTION = "res/common/script_event.lua#node_update";
+
+ScriptEventSample::ScriptEventSample()
+    : _font(NULL), _scene(NULL), _frame(0), _byNameTime(0), _boundTime(0), _byNameFrames(0), _boundFrames(0)
+{
+}
+
+void ScriptEventSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+
+    _scene = Scene::create();
+    for (unsigned int i = 0; i < NODE_COUNT; ++i)
+    {
+        Node* node = _scene->addNode();
+        node->addScriptCallback(GP_GET_SCRIPT_EVENT(Node, update), NODE_UPDATE_FUNCTION);
+    }
+}
+
+void ScriptEventSample::finalize()
+{
+    ScriptTarget::setScriptCallbackBinding(true);
+    SAFE_RELEASE(_scene);
+    SAFE_RELEASE(_font);
+}
+
+void ScriptEventSample::update(float elapsedTime)
+{
+    // Fire the update event of every node the way Node::update does, resolving the
+    // handler by name on even frames and calling its bound reference on odd frames.
+    bool bound = (_frame++ & 1) != 0;
+    ScriptTarget::setScriptCallbackBinding(bound);
+
+    const ScriptTarget::Event* updateEvent = GP_GET_SCRIPT_EVENT(Node, update);
+    double start = Game::getAbsoluteTime();
+    for (Node* node = _scene->getFirstNode(); node != NULL; node = node->getNextSibling())
+    {
+        node->fireScriptEvent<void>(updateEvent, dynamic_cast<void*>(node), elapsedTime);
+    }
+    double time = Game::getAbsoluteTime() - start;
+
+    ScriptTarget::setScriptCallbackBinding(true);
+    if (bound)
+    {
+        _boundTime += time;
+        ++_boundFrames;
+    }
+    else
+    {
+        _byNameTime += time;
+        ++_byNameFrames;
+    }
+
+    if (_byNameFrames > SAMPLE_FRAMES && _boundFrames > SAMPLE_FRAMES)
+    {
+        _byNameTime = _boundTime = 0;
+        _byNameFrames = _boundFrames = 0;
+    }
+}
+
+void ScriptEventSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    // Average cost per call in microseconds.
+    double byName = _byNameFrames ? (_byNameTime * 1000.0) / (_byNameFrames * (double)NODE_COUNT) : 0;
+    double bound = _boundFrames ? (_boundTime * 1000.0) / (_boundFrames * (double)NODE_COUNT) : 0;
+
+    char text[1024];
+    sprintf(text, "%d nodes\nBy name: %.3f us/call\nBound: %.3f us/call\nScript events fired: %u skipped: %u",
+        NODE_COUNT, byName, bound, ScriptTarget::getScriptEventsFired(), ScriptTarget::getScriptEventsSkipped());
+    _font->start();
+    _font->drawText(text, 10, 40, vec4One, 18);
+    _font->finish();
+}
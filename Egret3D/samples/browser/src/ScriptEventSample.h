@@ -0,0 +1,43 @@
+#ifndef SCRIPTEVENTSAMPLE_H_
+#define SCRIPTEVENTSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring the per-call overhead of Lua script events fired on a large number of nodes.
+ *
+ * Fires the Node 'update' script event of every node each frame, alternating between
+ * looking the Lua handler up by name and calling its bound function reference (see
+ * ScriptTarget::setScriptCallbackBinding), and displays the average cost per call of each.
+ */
+class ScriptEventSample : public Sample
+{
+public:
+
+    ScriptEventSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    Font* _font;
+    Scene* _scene;
+    unsigned int _frame;
+    double _byNameTime;
+    double _boundTime;
+    unsigned int _byNameFrames;
+    unsigned int _boundFrames;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "SpriteThroughputSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "Sprite Throughput", SpriteThroughputSample, 17);
+#endif
+
+// The number of sprites built per frame.
+#define SPRITE_COUNT 20000
+
+// The number of frames to average timings over.
+#define SAMPLE_FRAMES 60
+
+SpriteThroughputSample::SpriteThroughputSample()
+    : _font(NULL), _spriteBatch(NULL), _frame(0), _drawTime(0), _drawManyTime(0), _drawFrames(0), _drawManyFrames(0)
+{
+}
+
+void SpriteThroughputSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+    _spriteBatch = SpriteBatch::create("res/png/logo.png");
+
+    // Scatter rotated sprites over the screen.
+    _values.resize(SPRITE_COUNT * 5);
+    _texCoords.resize(SPRITE_COUNT);
+    _colors.resize(SPRITE_COUNT);
+    for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        _values[i] = MATH_RANDOM_0_1() * getWidth();
+        _values[SPRITE_COUNT + i] = MATH_RANDOM_0_1() * getHeight();
+        _values[SPRITE_COUNT * 2 + i] = 0.0f;
+        _values[SPRITE_COUNT * 3 + i] = 8.0f + MATH_RANDOM_0_1() * 24.0f;
+        _values[SPRITE_COUNT * 4 + i] = MATH_RANDOM_0_1() * MATH_PIX2;
+        kmVec4 texCoords = { 0.0f, 1.0f, 1.0f, 0.0f };
+        kmVec4 color = { MATH_RANDOM_0_1(), MATH_RANDOM_0_1(), MATH_RANDOM_0_1(), 0.5f };
+        _texCoords[i] = texCoords;
+        _colors[i] = color;
+    }
+}
+
+void SpriteThroughputSample::finalize()
+{
+    SAFE_DELETE(_spriteBatch);
+    SAFE_RELEASE(_font);
+}
+
+void SpriteThroughputSample::update(float elapsedTime)
+{
+}
+
+void SpriteThroughputSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    const float* x = &_values[0];
+    const float* y = x + SPRITE_COUNT;
+    const float* z = y + SPRITE_COUNT;
+    const float* size = z + SPRITE_COUNT;
+    const float* angle = size + SPRITE_COUNT;
+    const kmVec3 right = { 1.0f, 0.0f, 0.0f };
+    const kmVec3 up = { 0.0f, 1.0f, 0.0f };
+    const kmVec2 center = { 0.5f, 0.5f };
+
+    _spriteBatch->start();
+    double start = Game::getAbsoluteTime();
+    if ((_frame++ & 1) == 0)
+    {
+        // One call per sprite.
+        for (unsigned int i = 0; i < SPRITE_COUNT; ++i)
+        {
+            kmVec3 position = { x[i], y[i], z[i] };
+            const kmVec4& t = _texCoords[i];
+            _spriteBatch->draw(position, right, up, size[i], size[i], t.x, t.y, t.z, t.w, _colors[i], center, angle[i]);
+        }
+        _drawTime += Game::getAbsoluteTime() - start;
+        ++_drawFrames;
+    }
+    else
+    {
+        // One call for all sprites.
+        SpriteBatch::SpriteArrays sprites = { SPRITE_COUNT, x, y, z, size, NULL, angle, &_texCoords[0], &_colors[0] };
+        _spriteBatch->drawMany(sprites, right, up);
+        _drawManyTime += Game::getAbsoluteTime() - start;
+        ++_drawManyFrames;
+    }
+    _spriteBatch->finish();
+
+    if (_drawFrames > SAMPLE_FRAMES && _drawManyFrames > SAMPLE_FRAMES)
+    {
+        _drawTime = _drawManyTime = 0;
+        _drawFrames = _drawManyFrames = 0;
+    }
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    // Millions of sprites built per second.
+    double draw = _drawTime > 0 ? (_drawFrames * (double)SPRITE_COUNT) / (_drawTime * 1000.0) : 0;
+    double drawMany = _drawManyTime > 0 ? (_drawManyFrames * (double)SPRITE_COUNT) / (_drawManyTime * 1000.0) : 0;
+
+    char text[1024];
+    sprintf(text, "%d sprites\ndraw: %.2f M sprites/s\ndrawMany: %.2f M sprites/s", SPRITE_COUNT, draw, drawMany);
+    _font->start();
+    _font->drawText(text, 10, 40, vec4One, 18);
+    _font->finish();
+}
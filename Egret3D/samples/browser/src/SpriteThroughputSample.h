@@ -0,0 +1,46 @@
+#ifndef SPRITETHROUGHPUTSAMPLE_H_
+#define SPRITETHROUGHPUTSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring how many camera facing sprites per second SpriteBatch can build.
+ *
+ * Alternates each frame between adding every sprite with a separate SpriteBatch::draw call
+ * and adding them all with one SpriteBatch::drawMany call, and displays the throughput of
+ * each path. Only building the batch is timed, not drawing it.
+ */
+class SpriteThroughputSample : public Sample
+{
+public:
+
+    SpriteThroughputSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    Font* _font;
+    SpriteBatch* _spriteBatch;
+    std::vector<float> _values;
+    std::vector<kmVec4> _texCoords;
+    std::vector<kmVec4> _colors;
+    unsigned int _frame;
+    double _drawTime;
+    double _drawManyTime;
+    unsigned int _drawFrames;
+    unsigned int _drawManyFrames;
+};
+
+#endif
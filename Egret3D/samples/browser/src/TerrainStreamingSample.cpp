@@ -0,0 +1,142 @@
+#include "TerrainStreamingSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "Terrain Streaming", TerrainStreamingSample, 13);
+#endif
+
+// The number of samples along each side of the generated heightmap.
+#define HEIGHTMAP_SIZE 4097
+
+// The radius of the camera flight path in world units.
+#define FLIGHT_RADIUS 15000.0f
+
+// The time in seconds to complete one flight around the terrain.
+#define FLIGHT_PERIOD 120.0f
+
+static const char* HEIGHTMAP_PATH = "res/common/terrain/streamed.r16";
+
+TerrainStreamingSample::TerrainStreamingSample()
+    : _font(NULL), _scene(NULL), _terrain(NULL), _directionalLight(NULL), _time(0), _drawnPages(0)
+{
+}
+
+void TerrainStreamingSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+
+    // The heightmap is too large to ship, so generate it on first run
+    if (!FileSystem::fileExists(HEIGHTMAP_PATH) && !generateHeightmap(HEIGHTMAP_PATH, HEIGHTMAP_SIZE))
+    {
+        GP_ERROR("Failed to generate heightmap: %s.", HEIGHTMAP_PATH);
+        return;
+    }
+
+    _scene = Scene::load("res/common/terrain/streamed.scene");
+    _terrain = dynamic_cast<Terrain*>(_scene->findNode("terrain")->getDrawable());
+    _directionalLight = _scene->findNode("directionalLight")->getLight();
+}
+
+void TerrainStreamingSample::finalize()
+{
+    SAFE_RELEASE(_scene);
+    SAFE_RELEASE(_font);
+}
+
+bool TerrainStreamingSample::generateHeightmap(const char* path, unsigned int size)
+{
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+        return false;
+
+    // Sum a few octaves of sines so every level of detail has something to resolve
+    std::vector<unsigned char> row(size * 2);
+    for (unsigned int z = 0; z < size; ++z)
+    {
+        for (unsigned int x = 0; x < size; ++x)
+        {
+            float u = (float)x / (size - 1) * MATH_PIX2;
+            float v = (float)z / (size - 1) * MATH_PIX2;
+            float h = 0.0f;
+            float amplitude = 0.5f;
+            float frequency = 2.0f;
+            for (int octave = 0; octave < 6; ++octave)
+            {
+                h += amplitude * sinf(u * frequency + octave) * cosf(v * frequency * 1.3f + octave * 0.7f);
+                amplitude *= 0.5f;
+                frequency *= 2.1f;
+            }
+            unsigned int sample = (unsigned int)(std::min(std::max(h * 0.5f + 0.5f, 0.0f), 1.0f) * 65535.0f);
+            row[x * 2] = (unsigned char)(sample & 0xff);
+            row[x * 2 + 1] = (unsigned char)(sample >> 8);
+        }
+        if (stream->write(&row[0], 1, row.size()) != row.size())
+            return false;
+    }
+    return true;
+}
+
+void TerrainStreamingSample::update(float elapsedTime)
+{
+    if (!_scene)
+        return;
+
+    // Fly a circle around the terrain center, looking along the direction of travel
+    _time += elapsedTime * 0.001f;
+    float angle = _time / FLIGHT_PERIOD * MATH_PIX2;
+    float x = cosf(angle) * FLIGHT_RADIUS;
+    float z = sinf(angle) * FLIGHT_RADIUS;
+
+    Node* camera = _scene->getActiveCamera()->getNode();
+    camera->setTranslation(x, _terrain->getHeight(x, z) + 300.0f, z);
+    camera->setRotation(vec3uintY, MATH_PI - angle);
+}
+
+void TerrainStreamingSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    if (_scene)
+        _drawnPages = _terrain->draw();
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    if (!_terrain)
+        return;
+
+    unsigned int loads = _terrain->getPageLoadCount();
+    double loadTime = loads ? _terrain->getPageLoadTime() / loads : 0.0;
+
+    char text[1024];
+    sprintf(text, "Selection: %.3f ms\nPage loads: %u (%.3f ms/page)\nResident pages: %u\nDrawn pages: %u",
+        _terrain->getSelectionTime(), loads, loadTime, _terrain->getResidentPageCount(), _drawnPages);
+    _font->start();
+    _font->drawText(text, 10, 40, vec4One, 18);
+    _font->finish();
+}
+
+kmVec3 TerrainStreamingSample::getLightDirection0() const
+{
+    return _directionalLight->getNode()->getForwardVectorView();
+}
+
+kmVec3 TerrainStreamingSample::getLightColor0() const
+{
+    return _directionalLight->getColor();
+}
+
+bool TerrainStreamingSample::resolveAutoBinding(const char* autoBinding, Node* node, MaterialParameter* parameter)
+{
+    if (strcmp(autoBinding, "LIGHT_DIRECTION_0") == 0)
+    {
+        parameter->bindValue(this, &TerrainStreamingSample::getLightDirection0);
+        return true;
+    }
+    else if (strcmp(autoBinding, "LIGHT_COLOR_0") == 0)
+    {
+        parameter->bindValue(this, &TerrainStreamingSample::getLightColor0);
+        return true;
+    }
+
+    return false;
+}
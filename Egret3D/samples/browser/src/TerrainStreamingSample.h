@@ -0,0 +1,50 @@
+#ifndef TERRAINSTREAMINGSAMPLE_H_
+#define TERRAINSTREAMINGSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample measuring the cost of streaming a large terrain.
+ *
+ * Flies the camera over a 4097x4097 heightmap that is paged in from disk and displays
+ * the time spent selecting pages, the time spent loading them and the number of pages
+ * that are resident and drawn.
+ */
+class TerrainStreamingSample : public Sample, private RenderState::AutoBindingResolver
+{
+public:
+
+    TerrainStreamingSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    kmVec3 getLightDirection0() const;
+
+    kmVec3 getLightColor0() const;
+
+    bool resolveAutoBinding(const char* autoBinding, Node* node, MaterialParameter* parameter);
+
+    static bool generateHeightmap(const char* path, unsigned int size);
+
+    Font* _font;
+    Scene* _scene;
+    Terrain* _terrain;
+    Light* _directionalLight;
+    float _time;
+    unsigned int _drawnPages;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "TrueTypeFontSample.h"
+#include "SamplesGame.h"
+
+#if defined(ADD_SAMPLE)
+    ADD_SAMPLE("Graphics", "TrueType Font", TrueTypeFontSample, 21);
+#endif
+
+// The number of frames each range of characters is drawn for.
+#define RANGE_FRAMES 60
+
+// The number of characters drawn from each range.
+#define RANGE_LENGTH 64
+
+// The first characters of the ranges cycled through: Latin-1, Latin Extended-A, Greek and Cyrillic.
+static const unsigned int __ranges[] = { 0xC0, 0x100, 0x140, 0x391, 0x410 };
+
+static const char* __lines[] =
+{
+    "The quick brown fox jumps over the lazy dog.",
+    "Pack my box with five dozen liquor jugs.",
+    "How vexingly quick daft zebras jump!",
+    "0123456789 +-*/=()[]{}<>?!&%$#@"
+};
+
+static void appendCharacter(std::string* text, unsigned int code)
+{
+    // Encode the character as UTF-8.
+    if (code < 0x80)
+    {
+        text->push_back((char)code);
+    }
+    else if (code < 0x800)
+    {
+        text->push_back((char)(0xC0 | (code >> 6)));
+        text->push_back((char)(0x80 | (code & 0x3F)));
+    }
+    else
+    {
+        text->push_back((char)(0xE0 | (code >> 12)));
+        text->push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+        text->push_back((char)(0x80 | (code & 0x3F)));
+    }
+}
+
+TrueTypeFontSample::TrueTypeFontSample()
+    : _font(NULL), _trueTypeFont(NULL), _form(NULL), _frame(0), _range(0)
+{
+}
+
+void TrueTypeFontSample::initialize()
+{
+    _font = Font::create("res/ui/arial.gpb");
+
+    // Fails with a warning when the engine is built without FreeType.
+    _trueTypeFont = Font::create("res/design/arial.ttf");
+    if (_trueTypeFont == NULL)
+        return;
+
+    _form = Form::create("trueType", NULL, Layout::LAYOUT_VERTICAL);
+    _form->setPosition(10, 80);
+    _form->setSize(getWidth() / 2 - 20, getHeight() - 100);
+    char id[16];
+    for (unsigned int i = 0; i < sizeof(__lines) / sizeof(__lines[0]); ++i)
+    {
+        sprintf(id, "line%u", i);
+        Label* label = Label::create(id);
+        label->setText(__lines[i]);
+        label->setFont(_trueTypeFont);
+        label->setFontSize(24);
+        label->setTextColor(vec4One);
+        label->setWidth(1, true);
+        label->setHeight(32);
+        _form->addControl(label);
+        label->release();
+    }
+}
+
+void TrueTypeFontSample::finalize()
+{
+    SAFE_RELEASE(_form);
+    SAFE_RELEASE(_trueTypeFont);
+    SAFE_RELEASE(_font);
+}
+
+void TrueTypeFontSample::update(float elapsedTime)
+{
+    if (_trueTypeFont == NULL)
+        return;
+
+    if (_text.empty() || ++_frame % RANGE_FRAMES == 0)
+    {
+        if (!_text.empty())
+            _range = (_range + 1) % (sizeof(__ranges) / sizeof(__ranges[0]));
+        _text.clear();
+        for (unsigned int i = 0; i < RANGE_LENGTH; ++i)
+        {
+            appendCharacter(&_text, __ranges[_range] + i);
+            if (i % 16 == 15)
+                _text.push_back('\n');
+        }
+    }
+}
+
+void TrueTypeFontSample::render(float elapsedTime)
+{
+    clear(CLEAR_COLOR_DEPTH, vec4Zero, 1.0f, 0);
+
+    drawFrameRate(_font, { 0, 0.5f, 1, 1 }, 5, 1, getFrameRate());
+
+    if (_trueTypeFont == NULL)
+    {
+        _font->start();
+        _font->drawText("TrueType fonts require the engine to be built with GP_USE_FREETYPE.", 10, 40, vec4One, 18);
+        _font->finish();
+        return;
+    }
+
+    _form->draw();
+
+    _trueTypeFont->start();
+    _trueTypeFont->drawText(_text.c_str(), Rectangle(getWidth() / 2, 80, getWidth() / 2 - 10, getHeight() - 100), vec4One, 32);
+    _trueTypeFont->finish();
+
+    char text[64];
+    sprintf(text, "Characters from U+%04X", __ranges[_range]);
+    _font->start();
+    _font->drawText(text, 10, 40, vec4One, 18);
+    _font->finish();
+}
@@ -0,0 +1,43 @@
+#ifndef TRUETYPEFONTSAMPLE_H_
+#define TRUETYPEFONTSAMPLE_H_
+
+#include "gameplay.h"
+#include "Sample.h"
+
+using namespace egret;
+
+/**
+ * Sample drawing text with a font rasterised from a TrueType file while it runs.
+ *
+ * A form of labels that do not change is drawn from its recorded sprites, next to a line
+ * of text that moves on to another range of characters every second. The changing text
+ * fills the glyph atlas and makes it evict glyphs, while the labels must stay readable.
+ * Requires the engine to be built with GP_USE_FREETYPE defined.
+ */
+class TrueTypeFontSample : public Sample
+{
+public:
+
+    TrueTypeFontSample();
+
+protected:
+
+    void initialize();
+
+    void finalize();
+
+    void update(float elapsedTime);
+
+    void render(float elapsedTime);
+
+private:
+
+    Font* _font;
+    Font* _trueTypeFont;
+    Form* _form;
+    unsigned int _frame;
+    unsigned int _range;
+    std::string _text;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "AudioStreamingTest.h"
+
+// Declare our game instance
+AudioStreamingTest game;
+
+// The tone spans several streaming buffers (AudioBuffer::STREAMING_BUFFER_SIZE bytes each).
+#define TONE_FILE "stream.wav"
+#define TONE_FREQUENCY 44100
+#define TONE_DURATION 2.0f
+
+// The fraction of the tone that must be heard each time it is played.
+#define MIN_PLAYED_FRACTION 0.9f
+
+// The game time, in seconds, for all three plays to finish.
+#define TIMEOUT 20.0f
+
+AudioStreamingTest::AudioStreamingTest()
+    : _source(NULL), _playCount(0), _started(false), _playedTime(0.0f), _totalTime(0.0f), _result(-1)
+{
+}
+
+void AudioStreamingTest::initialize()
+{
+    if (!writeTone(TONE_FILE))
+    {
+        print("FAIL: could not write %s.\n", TONE_FILE);
+        _result = 1;
+        return;
+    }
+
+    _source = AudioSource::create(TONE_FILE, true);
+    if (!_source)
+    {
+        print("FAIL: could not create a streamed audio source.\n");
+        _result = 1;
+        return;
+    }
+    _source->play();
+    _playCount = 1;
+}
+
+void AudioStreamingTest::finalize()
+{
+    SAFE_RELEASE(_source);
+}
+
+void AudioStreamingTest::update(float elapsedTime)
+{
+    if (_result < 0)
+    {
+        float seconds = elapsedTime * 0.001f;
+        _totalTime += seconds;
+        if (_totalTime > TIMEOUT)
+        {
+            print("FAIL: play %u did not finish within %.0f seconds.\n", _playCount, TIMEOUT);
+            _result = 1;
+        }
+        else if (_source->getState() == AudioSource::PLAYING)
+        {
+            _started = true;
+            _playedTime += seconds;
+        }
+        else if (_started && checkPlayback())
+        {
+            // Play the stream again once it ended, and then after rewinding it.
+            _started = false;
+            _playedTime = 0.0f;
+            if (++_playCount == 2)
+            {
+                _source->play();
+            }
+            else if (_playCount == 3)
+            {
+                _source->rewind();
+                if (_source->getState() != AudioSource::INITIAL)
+                {
+                    print("FAIL: the rewound source is not in its initial state.\n");
+                    _result = 1;
+                    return;
+                }
+                _source->play();
+            }
+            else
+            {
+                _result = 0;
+            }
+        }
+    }
+    if (_result < 0)
+        return;
+
+    if (_result == 0)
+        print("Audio streaming OK.\n");
+    exit(_result);
+}
+
+void AudioStreamingTest::render(float elapsedTime)
+{
+}
+
+bool AudioStreamingTest::checkPlayback()
+{
+    // The source stopped; it must have played the whole tone without running dry.
+    if (_source->getUnderrunCount() > 0)
+    {
+        print("FAIL: play %u ran out of decoded data %u times.\n", _playCount, _source->getUnderrunCount());
+        _result = 1;
+        return false;
+    }
+    if (_playedTime < TONE_DURATION * MIN_PLAYED_FRACTION)
+    {
+        print("FAIL: play %u stopped after %.2f of %.2f seconds.\n", _playCount, _playedTime, TONE_DURATION);
+        _result = 1;
+        return false;
+    }
+    return true;
+}
+
+bool AudioStreamingTest::writeTone(const char* path)
+{
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+        return false;
+
+    // 16-bit mono PCM.
+    unsigned int sampleCount = (unsigned int)(TONE_DURATION * TONE_FREQUENCY);
+    unsigned int dataSize = sampleCount * 2;
+    unsigned char header[44];
+    unsigned int fields[][2] =
+    {
+        { 4, 36 + dataSize },   // RIFF chunk size
+        { 16, 16 },             // fmt chunk size
+        { 20, 1 | (1 << 16) },  // PCM, one channel
+        { 24, TONE_FREQUENCY }, // sample rate
+        { 28, TONE_FREQUENCY * 2 }, // byte rate
+        { 32, 2 | (16 << 16) }, // block align, bits per sample
+        { 40, dataSize }        // data chunk size
+    };
+    memcpy(header, "RIFF....WAVEfmt ", 16);
+    memcpy(header + 36, "data", 4);
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+    {
+        for (unsigned int j = 0; j < 4; ++j)
+            header[fields[i][0] + j] = (unsigned char)(fields[i][1] >> (j * 8));
+    }
+    if (stream->write(header, 1, sizeof(header)) != sizeof(header))
+        return false;
+
+    std::vector<unsigned char> data(dataSize);
+    for (unsigned int i = 0; i < sampleCount; ++i)
+    {
+        short sample = (short)(sinf(i * 440.0f * 2.0f * MATH_PI / TONE_FREQUENCY) * 8000.0f);
+        data[i * 2] = (unsigned char)(sample & 0xff);
+        data[i * 2 + 1] = (unsigned char)((sample >> 8) & 0xff);
+    }
+    bool written = stream->write(&data[0], 1, dataSize) == dataSize;
+    stream->close();
+    return written;
+}
@@ -0,0 +1,66 @@
+#ifndef AUDIOSTREAMINGTEST_H_
+#define AUDIOSTREAMINGTEST_H_
+
+#include "gameplay.h"
+
+using namespace egret;
+
+/**
+ * Checks that a streamed audio source plays its whole stream every time it is played.
+ *
+ * The test writes a tone longer than the streaming queue to a wave file and plays it
+ * as a streamed source three times: once after it is created, again once it played
+ * to its end and a third time after it is rewound. Each time the source must play
+ * for about the length of the tone, without any streaming underrun.
+ *
+ * The game.config selects the OpenAL loopback device, which mixes in step with game
+ * time and needs no audio output. Run it with --headless=null on machines without a
+ * display. The process exits with 0 if the stream played through every time and 1
+ * otherwise.
+ */
+class AudioStreamingTest : public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    AudioStreamingTest();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+
+private:
+
+    bool writeTone(const char* path);
+
+    bool checkPlayback();
+
+    AudioSource* _source;
+    unsigned int _playCount;
+    bool _started;
+    float _playedTime;
+    float _totalTime;
+    int _result;
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "FramePacketTest.h"
+
+// Declare our game instance
+FramePacketTest game;
+
+// The frames to wait for the recorded frame to be drawn.
+#define MAX_FRAMES 60
+
+static const unsigned char RED[] = { 255, 0, 0 };
+static const unsigned char GREEN[] = { 0, 255, 0 };
+
+FramePacketTest::FramePacketTest()
+    : _node(NULL), _model(NULL), _color(NULL), _batch(NULL), _recorded(false), _result(-1), _frames(0)
+{
+}
+
+void FramePacketTest::initialize()
+{
+    if (!isRenderingEnabled())
+    {
+        print("FAIL: the frame packet test needs a graphics context.\n");
+        _result = 1;
+        return;
+    }
+
+    // A red quad on the left, placed by its node's world matrix.
+    Mesh* mesh = Mesh::createQuad(-0.9f, -0.5f, 0.8f, 1.0f);
+    _model = Model::create(mesh);
+    SAFE_RELEASE(mesh);
+    Material* material = _model->setMaterial("res/shaders/colored.vert", "res/shaders/colored.frag");
+    _node = Node::create("quad");
+    _node->setDrawable(_model);
+    material->getParameter("u_worldViewProjectionMatrix")->bindValue(_node, &Node::getWorldMatrix);
+    _color = material->getParameter("u_diffuseColor");
+    kmVec4 red = { 1.0f, 0.0f, 0.0f, 1.0f };
+    _color->setValue(red);
+
+    // A green batched quad on the right.
+    material = Material::create("res/shaders/colored.vert", "res/shaders/colored.frag");
+    kmVec4 green = { 0.0f, 1.0f, 0.0f, 1.0f };
+    kmMat4 identity;
+    kmMat4Identity(&identity);
+    material->getParameter("u_worldViewProjectionMatrix")->setValue(identity);
+    material->getParameter("u_diffuseColor")->setValue(green);
+    VertexFormat::Element elements[] =
+    {
+        VertexFormat::Element(VertexFormat::POSITION, 3)
+    };
+    _batch = MeshBatch::create(VertexFormat(elements, 1), Mesh::TRIANGLES, material, false, 6);
+    SAFE_RELEASE(material);
+    _batch->start();
+    addQuad(0.1f);
+    _batch->finish();
+
+    // Record on the simulation thread and draw the packet in the next frame.
+    getFrameScheduler()->setPipelined(true);
+}
+
+void FramePacketTest::finalize()
+{
+    SAFE_DELETE(_batch);
+    SAFE_RELEASE(_model);
+    SAFE_RELEASE(_node);
+}
+
+void FramePacketTest::update(float elapsedTime)
+{
+    if (_result < 0 && ++_frames > MAX_FRAMES)
+    {
+        print("FAIL: the recorded frame was not drawn within %u frames.\n", MAX_FRAMES);
+        _result = 1;
+    }
+    if (_result < 0)
+        return;
+
+    // Exit from the game's thread, once the simulation thread is idle.
+    if (getFrameScheduler()->isPipelined())
+    {
+        getFrameScheduler()->setPipelined(false);
+        return;
+    }
+    if (_result == 0)
+        print("Frame packet isolation OK.\n");
+    exit(_result);
+}
+
+void FramePacketTest::render(float elapsedTime)
+{
+    if (_recorded || _result >= 0)
+        return;
+
+    FramePacket* packet = FramePacket::getRecording();
+    if (packet == NULL)
+    {
+        print("FAIL: render is not recorded while frames are pipelined.\n");
+        _result = 1;
+        return;
+    }
+
+    clear(CLEAR_COLOR_DEPTH, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0);
+    _model->draw();
+    _batch->draw();
+    FramePacketTest* test = this;
+    packet->addCallback(&checkFrame, &test, sizeof(test));
+    _recorded = true;
+
+    // Change everything the packet copied before it is drawn.
+    _node->setTranslationX(1.0f);
+    kmVec4 blue = { 0.0f, 0.0f, 1.0f, 1.0f };
+    _color->setValue(blue);
+    _batch->start();
+    addQuad(-0.9f);
+    _batch->finish();
+}
+
+void FramePacketTest::checkFrame(void* data)
+{
+    GP_ASSERT(data);
+    FramePacketTest* test = *(FramePacketTest**)data;
+
+    bool passed = test->checkPixel(0.25f, 0.5f, RED, "model");
+    passed = test->checkPixel(0.75f, 0.5f, GREEN, "mesh batch") && passed;
+    test->_result = passed ? 0 : 1;
+}
+
+bool FramePacketTest::checkPixel(float x, float y, const unsigned char* expected, const char* name)
+{
+    unsigned char pixel[4];
+    GL_ASSERT( glReadPixels((GLint)(getWidth() * x), (GLint)(getHeight() * y), 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel) );
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+        if (abs((int)pixel[i] - (int)expected[i]) > 2)
+        {
+            print("FAIL: the %s drew (%u, %u, %u) instead of (%u, %u, %u).\n", name,
+                  pixel[0], pixel[1], pixel[2], expected[0], expected[1], expected[2]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void FramePacketTest::addQuad(float x)
+{
+    float vertices[] =
+    {
+        x, -0.5f, 0.0f,  x + 0.8f, -0.5f, 0.0f,  x, 0.5f, 0.0f,
+        x, 0.5f, 0.0f,  x + 0.8f, -0.5f, 0.0f,  x + 0.8f, 0.5f, 0.0f
+    };
+    _batch->add(vertices, 6);
+}
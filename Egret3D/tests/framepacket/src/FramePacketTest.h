@@ -0,0 +1,68 @@
+#ifndef FRAMEPACKETTEST_H_
+#define FRAMEPACKETTEST_H_
+
+#include "gameplay.h"
+
+using namespace egret;
+
+/**
+ * Checks that a pipelined frame draws what was recorded, not what changed after it.
+ *
+ * The test records one frame with a red quad model on the left and a green mesh batch
+ * quad on the right. Right after recording it moves the model's node to the right,
+ * turns its material parameter blue and refills the batch with a quad on the left. A
+ * callback recorded at the end of the frame reads the pixels back once the packet is
+ * drawn. They must still be red on the left and green on the right.
+ *
+ * Run it with --headless on machines without a display. The process exits with 0 if the
+ * packet was isolated and 1 otherwise.
+ */
+class FramePacketTest : public Game
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    FramePacketTest();
+
+protected:
+
+    /**
+     * @see Game::initialize
+     */
+    void initialize();
+
+    /**
+     * @see Game::finalize
+     */
+    void finalize();
+
+    /**
+     * @see Game::update
+     */
+    void update(float elapsedTime);
+
+    /**
+     * @see Game::render
+     */
+    void render(float elapsedTime);
+
+private:
+
+    static void checkFrame(void* data);
+
+    bool checkPixel(float x, float y, const unsigned char* expected, const char* name);
+
+    void addQuad(float x);
+
+    Node* _node;
+    Model* _model;
+    MaterialParameter* _color;
+    MeshBatch* _batch;
+    bool _recorded;
+    int _result;
+    unsigned int _frames;
+};
+
+#endif
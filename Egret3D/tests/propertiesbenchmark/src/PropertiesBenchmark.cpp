@@ -0,0 +1,124 @@
+#include "Base.h"
+#include "FileSystem.h"
+#include "Properties.h"
+#include "Stream.h"
+#include <chrono>
+
+using namespace egret;
+
+// Measures loading and querying a large properties file through the public Properties API
+// only, so the same source builds against older versions of the parser to compare them.
+// Prints the time of each step in milliseconds.
+
+// The number of materials in the generated file.
+#define MATERIAL_COUNT 2000
+
+// The number of typed lookups measured.
+#define LOOKUP_COUNT 100000
+
+// The number of values set and read back on a created namespace.
+#define SET_COUNT 100000
+
+static double getTime()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool writeFile(const char* path, size_t* size)
+{
+    std::unique_ptr<Stream> stream(FileSystem::open(path, FileSystem::WRITE));
+    if (stream.get() == NULL)
+    {
+        printf("Failed to write '%s'.\n", path);
+        return false;
+    }
+
+    std::string text;
+    char line[128];
+    text += "material base\n{\n    technique\n    {\n        pass\n        {\n";
+    for (unsigned int i = 0; i < 40; ++i)
+    {
+        sprintf(line, "            p%u = %f\n", i, i * 0.125f);
+        text += line;
+    }
+    text += "            u_diffuseColor = 1.0, 0.5, 0.25, 1.0\n        }\n    }\n}\n";
+    for (unsigned int i = 0; i < MATERIAL_COUNT; ++i)
+    {
+        sprintf(line, "material m%u : base\n{\n    technique\n    {\n        pass\n        {\n", i);
+        text += line;
+        for (unsigned int j = 0; j < 10; ++j)
+        {
+            sprintf(line, "            p%u = %u.%u\n", (i * 7 + j * 13) % 60, i, j);
+            text += line;
+        }
+        sprintf(line, "            sampler u_texture\n            {\n                path = res/png/image%u.png\n", i % 50);
+        text += line;
+        text += "                mipmap = true\n            }\n        }\n    }\n}\n";
+    }
+    *size = text.size();
+    bool written = stream->write(text.c_str(), 1, text.size()) == text.size();
+    stream->close();
+    return written;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = argc > 1 ? argv[1] : "properties-benchmark.material";
+    size_t size = 0;
+    if (!writeFile(path, &size))
+        return 1;
+    printf("%u materials, %u KB\n", MATERIAL_COUNT, (unsigned int)(size / 1024));
+
+    double start = getTime();
+    Properties* properties = Properties::create(path);
+    printf("parse: %.2f ms\n", getTime() - start);
+    if (properties == NULL)
+    {
+        remove(path);
+        return 1;
+    }
+
+    start = getTime();
+    Properties* again = Properties::create(path);
+    printf("create again: %.2f ms\n", getTime() - start);
+    SAFE_DELETE(again);
+
+    Properties* material = properties->getNamespace("m100");
+    Properties* pass = material ? material->getNamespace("pass", true) : NULL;
+    if (pass == NULL)
+    {
+        printf("Failed to find the pass of material m100.\n");
+        SAFE_DELETE(properties);
+        remove(path);
+        return 1;
+    }
+
+    float sum = 0;
+    kmVec4 color;
+    start = getTime();
+    for (unsigned int i = 0; i < LOOKUP_COUNT; ++i)
+    {
+        sum += pass->getFloat("p7");
+        pass->getVector4("u_diffuseColor", &color);
+        sum += color.y;
+    }
+    printf("%u typed lookups: %.2f ms\n", LOOKUP_COUNT * 2, getTime() - start);
+
+    // Values changed at runtime, such as by an editor or a script.
+    char value[64];
+    start = getTime();
+    for (unsigned int i = 0; i < SET_COUNT; ++i)
+    {
+        sprintf(value, "%u.5, 0.5, 0.25, 1.0", i);
+        pass->setString("u_diffuseColor", value);
+        pass->getVector4("u_diffuseColor", &color);
+        sum += color.x;
+    }
+    printf("%u values set and read: %.2f ms\n", SET_COUNT, getTime() - start);
+
+    SAFE_DELETE(properties);
+    remove(path);
+
+    // Keeps the lookups from being optimised away.
+    return sum == 0 ? 1 : 0;
+}
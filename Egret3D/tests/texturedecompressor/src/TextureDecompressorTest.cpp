@@ -0,0 +1,190 @@
+#include "Base.h"
+#include "TextureDecompressor.h"
+
+using namespace egret;
+
+// Decodes known blocks of every format the texture decompressor supports and compares
+// them to reference pixels worked out by hand from the format specifications.
+// Exits with 0 if every block decodes to its reference pixels and 1 otherwise.
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef ETC1_RGB8
+#define ETC1_RGB8 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+// BC1 with color0 > color1: red, blue and the two colors between them, one per column.
+static const unsigned char BC1_BLOCK[] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4 };
+static const unsigned char BC1_PIXELS[] =
+{
+    255,   0,   0, 255,   0,   0, 255, 255, 170,   0,  85, 255,  85,   0, 170, 255,
+    255,   0,   0, 255,   0,   0, 255, 255, 170,   0,  85, 255,  85,   0, 170, 255,
+    255,   0,   0, 255,   0,   0, 255, 255, 170,   0,  85, 255,  85,   0, 170, 255,
+    255,   0,   0, 255,   0,   0, 255, 255, 170,   0,  85, 255,  85,   0, 170, 255
+};
+
+// BC1 with color0 <= color1: blue, red, their average and transparent black.
+static const unsigned char BC1_ALPHA_BLOCK[] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0xE4, 0xE4, 0xE4 };
+static const unsigned char BC1_ALPHA_PIXELS[] =
+{
+      0,   0, 255, 255, 255,   0,   0, 255, 127,   0, 127, 255,   0,   0,   0,   0,
+      0,   0, 255, 255, 255,   0,   0, 255, 127,   0, 127, 255,   0,   0,   0,   0,
+      0,   0, 255, 255, 255,   0,   0, 255, 127,   0, 127, 255,   0,   0,   0,   0,
+      0,   0, 255, 255, 255,   0,   0, 255, 127,   0, 127, 255,   0,   0,   0,   0
+};
+
+// BC3 with alpha from 255 to 0 in eight steps over every row pair, on red.
+static const unsigned char BC3_BLOCK[] =
+{
+    0xFF, 0x00, 0x88, 0xC6, 0xFA, 0x88, 0xC6, 0xFA,
+    0x00, 0xF8, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const unsigned char BC3_PIXELS[] =
+{
+    255,   0,   0, 255, 255,   0,   0,   0, 255,   0,   0, 218, 255,   0,   0, 182,
+    255,   0,   0, 145, 255,   0,   0, 109, 255,   0,   0,  72, 255,   0,   0,  36,
+    255,   0,   0, 255, 255,   0,   0,   0, 255,   0,   0, 218, 255,   0,   0, 182,
+    255,   0,   0, 145, 255,   0,   0, 109, 255,   0,   0,  72, 255,   0,   0,  36
+};
+
+// ETC1 in individual mode with left and right halves of different gray bases and tables.
+static const unsigned char ETC1_BLOCK[] = { 0x84, 0x84, 0x84, 0x04, 0x00, 0x00, 0x00, 0xFF };
+static const unsigned char ETC1_PIXELS[] =
+{
+    144, 144, 144, 255, 144, 144, 144, 255,  73,  73,  73, 255,  73,  73,  73, 255,
+    144, 144, 144, 255, 144, 144, 144, 255,  73,  73,  73, 255,  73,  73,  73, 255,
+    144, 144, 144, 255, 144, 144, 144, 255,  73,  73,  73, 255,  73,  73,  73, 255,
+    144, 144, 144, 255, 144, 144, 144, 255,  73,  73,  73, 255,  73,  73,  73, 255
+};
+
+// ETC2 in T mode, where the red base overflows: green less the distance, then the red base.
+static const unsigned char ETC2_BLOCK[] = { 0xF9, 0x00, 0x0F, 0x02, 0x00, 0xFF, 0x00, 0xFF };
+static const unsigned char ETC2_PIXELS[] =
+{
+      0, 252,   0, 255,   0, 252,   0, 255, 221,   0,   0, 255, 221,   0,   0, 255,
+      0, 252,   0, 255,   0, 252,   0, 255, 221,   0,   0, 255, 221,   0,   0, 255,
+      0, 252,   0, 255,   0, 252,   0, 255, 221,   0,   0, 255, 221,   0,   0, 255,
+      0, 252,   0, 255,   0, 252,   0, 255, 221,   0,   0, 255, 221,   0,   0, 255
+};
+
+// ETC2 with EAC alpha of base 128, multiplier 2 and every modifier of the first table.
+static const unsigned char EAC_BLOCK[] =
+{
+    0x80, 0x20, 0x05, 0x39, 0x77, 0x05, 0x39, 0x77,
+    0x84, 0x84, 0x84, 0x04, 0x00, 0x00, 0x00, 0xFF
+};
+static const unsigned char EAC_PIXELS[] =
+{
+    144, 144, 144, 122, 144, 144, 144, 132,  73,  73,  73, 122,  73,  73,  73, 132,
+    144, 144, 144, 116, 144, 144, 144, 138,  73,  73,  73, 116,  73,  73,  73, 138,
+    144, 144, 144, 110, 144, 144, 144, 144,  73,  73,  73, 110,  73,  73,  73, 144,
+    144, 144, 144,  98, 144, 144, 144, 156,  73,  73,  73,  98,  73,  73,  73, 156
+};
+
+static bool checkBlock(const char* name, GLenum format, const unsigned char* block, const unsigned char* expected)
+{
+    unsigned char pixels[16 * 4];
+    memset(pixels, 0xCD, sizeof(pixels));
+    if (!TextureDecompressor::decompress(format, block, 4, 4, pixels))
+    {
+        printf("FAIL: %s is not supported.\n", name);
+        return false;
+    }
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        if (memcmp(pixels + i * 4, expected + i * 4, 4) != 0)
+        {
+            const unsigned char* p = pixels + i * 4;
+            const unsigned char* e = expected + i * 4;
+            printf("FAIL: %s pixel (%u, %u) is (%u, %u, %u, %u) instead of (%u, %u, %u, %u).\n", name, i % 4, i / 4,
+                   p[0], p[1], p[2], p[3], e[0], e[1], e[2], e[3]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkPartialBlocks()
+{
+    // A 6x5 image takes 2x2 blocks, of which only the pixels inside the image are written.
+    const unsigned int width = 6;
+    const unsigned int height = 5;
+    unsigned char blocks[4 * sizeof(BC1_BLOCK)];
+    for (unsigned int i = 0; i < 4; ++i)
+        memcpy(blocks + i * sizeof(BC1_BLOCK), BC1_BLOCK, sizeof(BC1_BLOCK));
+
+    std::vector<unsigned char> pixels(width * height * 4 + 4, 0xCD);
+    TextureDecompressor::decompress(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, blocks, width, height, &pixels[0]);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            if (memcmp(&pixels[(y * width + x) * 4], BC1_PIXELS + ((y % 4) * 4 + x % 4) * 4, 4) != 0)
+            {
+                printf("FAIL: partial block pixel (%u, %u) is wrong.\n", x, y);
+                return false;
+            }
+        }
+    }
+    if (pixels[width * height * 4] != 0xCD)
+    {
+        printf("FAIL: partial blocks are written past the end of the image.\n");
+        return false;
+    }
+    return true;
+}
+
+static bool checkImageSizes()
+{
+    struct { GLenum format; unsigned int width; unsigned int height; unsigned int size; } sizes[] =
+    {
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 4, 4, 8 },
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 6, 5, 32 },
+        { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 1, 1, 16 },
+        { ETC1_RGB8, 8, 4, 16 },
+        { GL_COMPRESSED_RGBA8_ETC2_EAC, 5, 9, 96 },
+        { 0x1908, 4, 4, 0 }
+    };
+    bool passed = true;
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        unsigned int size = TextureDecompressor::getImageSize(sizes[i].format, sizes[i].width, sizes[i].height);
+        if (size != sizes[i].size)
+        {
+            printf("FAIL: a %ux%u image of format 0x%x takes %u bytes instead of %u.\n",
+                   sizes[i].width, sizes[i].height, sizes[i].format, size, sizes[i].size);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    bool passed = true;
+    passed = checkBlock("BC1", GL_COMPRESSED_RGB_S3TC_DXT1_EXT, BC1_BLOCK, BC1_PIXELS) && passed;
+    passed = checkBlock("BC1 with alpha", GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, BC1_ALPHA_BLOCK, BC1_ALPHA_PIXELS) && passed;
+    passed = checkBlock("BC3", GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, BC3_BLOCK, BC3_PIXELS) && passed;
+    passed = checkBlock("ETC1", ETC1_RGB8, ETC1_BLOCK, ETC1_PIXELS) && passed;
+    passed = checkBlock("ETC2 T mode", GL_COMPRESSED_RGB8_ETC2, ETC2_BLOCK, ETC2_PIXELS) && passed;
+    passed = checkBlock("ETC2 with EAC alpha", GL_COMPRESSED_RGBA8_ETC2_EAC, EAC_BLOCK, EAC_PIXELS) && passed;
+    passed = checkPartialBlocks() && passed;
+    passed = checkImageSizes() && passed;
+
+    if (passed)
+        printf("Texture decompression OK.\n");
+    return passed ? 0 : 1;
+}
@@ -45,12 +45,15 @@ SOURCES += src/Mesh.cpp \
     src/Node.cpp \
     src/NormalMapGenerator.cpp \
     src/Object.cpp \
+    src/PropertiesCompiler.cpp \
     src/Quaternion.cpp \
     src/Reference.cpp \
     src/ReferenceTable.cpp \
     src/Sampler.cpp \
     src/Scene.cpp \
     src/StringUtil.cpp \
+    src/TextureAtlasGenerator.cpp \
+    src/TextureCompressor.cpp \
     src/Transform.cpp \
     src/TTFFontEncoder.cpp \
     src/Vector2.cpp \
@@ -93,6 +96,7 @@ HEADERS += src/AnimationChannel.h \
     src/Node.h \
     src/NormalMapGenerator.h \
     src/Object.h \
+    src/PropertiesCompiler.h \
     src/Quaternion.h \
     src/Quaternion.inl \
     src/Reference.h \
@@ -100,6 +104,8 @@ HEADERS += src/AnimationChannel.h \
     src/Sampler.h \
     src/Scene.h \
     src/StringUtil.h \
+    src/TextureAtlasGenerator.h \
+    src/TextureCompressor.h \
     src/Thread.h \
     src/Transform.h \
     src/TTFFontEncoder.h \
@@ -1,6 +1,7 @@
 #include "Base.h"
 
 #include "EncoderArguments.h"
+#include "TTFFontEncoder.h"
 #include "StringUtil.h"
 
 #ifdef WIN32
@@ -29,7 +30,12 @@ EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _optimizeAnimations(false),
     _animationGrouping(ANIMATIONGROUP_PROMPT),
     _outputMaterial(false),
-    _generateTextureGutter(false)
+    _generateTextureGutter(false),
+    _atlasPadding(2),
+    _atlasExtrude(1),
+    _atlasMaxSize(2048),
+    _textureFormat(TextureCompressor::NONE),
+    _textureMipmaps(false)
 {
     __instance = this;
 
@@ -119,10 +125,16 @@ std::string EncoderArguments::getOutputFileExtension() const
     {
     case FILEFORMAT_TMX:
         return ".scene";
+    case FILEFORMAT_DIRECTORY:
+        return ".atlas";
+    case FILEFORMAT_PROPERTIES:
+        return ".bin";
     case FILEFORMAT_PNG:
     case FILEFORMAT_RAW:
         if (_normalMap)
             return ".png";
+        if (_textureFormat != TextureCompressor::NONE)
+            return ".ktx";
 
     default:
         return ".gpb";
@@ -138,8 +150,10 @@ std::string EncoderArguments::getOutputFilePath() const
     }
     else
     {
-        // Generate an output file path
-        int pos = _filePath.find_last_of('.');
+        // Generate an output file path; a directory name has no extension to replace and
+        // a compiled properties file keeps the extension of the file it replaces
+        FileFormat format = getFileFormat();
+        int pos = format == FILEFORMAT_DIRECTORY || format == FILEFORMAT_PROPERTIES ? -1 : (int)_filePath.find_last_of('.');
         std::string outputFilePath(pos > 0 ? _filePath.substr(0, pos) : _filePath);
 
         // Modify the original file name if the output extension can be the same as the input
@@ -256,6 +270,8 @@ void EncoderArguments::printUsage() const
     "Supported file extensions:\n" \
     "  .fbx\t(FBX scenes)\n" \
     "  .ttf\t(TrueType fonts)\n" \
+    "  .material, .scene, .physics, ...\t(properties files)\n" \
+    "  <directory>\t(PNG images packed into a texture atlas)\n" \
     "\n" \
     "General options:\n" \
     "  -v <verbosity>\tVerbosity level (0-4).\n" \
@@ -310,6 +326,29 @@ void EncoderArguments::printUsage() const
     "  -s <sizes>\tComma-separated list of font sizes (in pixels).\n" \
     "  -p\t\tOutput font preview.\n" \
     "  -f\t\tFormat of font. -f:b (BITMAP), -f:d (DISTANCE_FIELD).\n" \
+        "\t\tA distance field font is generated at a single size and drawn\n" \
+        "\t\tat any size.\n" \
+    "  -c <ranges>\tComma-separated list of character codes or ranges of codes\n" \
+        "\t\tto generate glyphs for, e.g. \"32-126,0xA0-0xFF\" (default 32-126).\n" \
+    "\n" \
+    "Texture atlas options:\n" \
+    "  -ap <pixels>\tSpace between images (default 2).\n" \
+    "  -ae <pixels>\tBorder of repeated edge pixels around each image (default 1).\n" \
+    "  -as <size>\tLargest width and height of an atlas page (default 2048).\n" \
+        "\t\tWrites the pages as PNG files and a .atlas file naming the region\n" \
+        "\t\tof each image, which the runtime loads as \"<file>.atlas#<image>\".\n" \
+    "\n" \
+    "Compressed texture options:\n" \
+    "  -tc:<format>\tCompress a PNG image into a KTX file. <format> is bc1 or\n" \
+        "\t\tbc3 (DXT1/DXT5, desktop GPUs), etc2 or etc2a (OpenGL ES 3.0).\n" \
+        "\t\tThe runtime decompresses formats the GPU does not support.\n" \
+    "  -tm\t\tAlso write the mipmaps of the texture.\n" \
+    "\n" \
+    "Properties file options:\n" \
+    "  \t\tA properties file is compiled into a binary form with inheritance\n" \
+        "\t\tresolved, written to \"<file>.bin\" unless an output file is given.\n" \
+        "\t\tThe runtime loads either form, so rename the compiled file to the\n" \
+        "\t\tname of the text file to use it.\n" \
     "\n");
     exit(8);
 }
@@ -353,13 +392,72 @@ const char* EncoderArguments::getNodeId() const
     return _nodeId.c_str();
 }
 
+unsigned int EncoderArguments::getAtlasPadding() const
+{
+    return _atlasPadding;
+}
+
+unsigned int EncoderArguments::getAtlasExtrude() const
+{
+    return _atlasExtrude;
+}
+
+unsigned int EncoderArguments::getAtlasMaxSize() const
+{
+    return _atlasMaxSize;
+}
+
+TextureCompressor::Format EncoderArguments::getTextureFormat() const
+{
+    return _textureFormat;
+}
+
+bool EncoderArguments::textureMipmapsEnabled() const
+{
+    return _textureMipmaps;
+}
+
 std::vector<unsigned int> EncoderArguments::getFontSizes() const
 {
     return _fontSizes;
 }
 
+std::vector<unsigned int> EncoderArguments::getFontCharacters() const
+{
+    std::vector<unsigned int> characters;
+    if (_fontCharacters.empty())
+    {
+        for (unsigned int c = START_INDEX; c < END_INDEX; ++c)
+        {
+            characters.push_back(c);
+        }
+    }
+    else
+    {
+        // Ranges may overlap
+        characters = _fontCharacters;
+        std::sort(characters.begin(), characters.end());
+        characters.erase(std::unique(characters.begin(), characters.end()), characters.end());
+    }
+
+    // The runtime uses the first glyph for the width of spaces and tabs.
+    std::vector<unsigned int>::iterator space = std::find(characters.begin(), characters.end(), (unsigned int)' ');
+    if (space != characters.end())
+    {
+        characters.erase(space);
+    }
+    characters.insert(characters.begin(), (unsigned int)' ');
+
+    return characters;
+}
+
 EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
 {
+    struct stat buf;
+    if (stat(_filePath.c_str(), &buf) != -1 && (buf.st_mode & S_IFMT) == S_IFDIR)
+    {
+        return FILEFORMAT_DIRECTORY;
+    }
     if (_filePath.length() < 5)
     {
         return FILEFORMAT_UNKNOWN;
@@ -399,6 +497,12 @@ EncoderArguments::FileFormat EncoderArguments::getFileFormat() const
     {
         return FILEFORMAT_RAW;
     }
+    if (ext.compare("material") == 0 || ext.compare("scene") == 0 || ext.compare("physics") == 0 ||
+        ext.compare("particle") == 0 || ext.compare("animation") == 0 || ext.compare("audio") == 0 ||
+        ext.compare("terrain") == 0 || ext.compare("form") == 0 || ext.compare("theme") == 0)
+    {
+        return FILEFORMAT_PROPERTIES;
+    }
 
     return FILEFORMAT_UNKNOWN;
 }
@@ -412,6 +516,65 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     }
     switch (str[1])
     {
+    case 'a':
+        {
+            // Texture atlas options
+            unsigned int* value = NULL;
+            if (str.compare("-ap") == 0)
+                value = &_atlasPadding;
+            else if (str.compare("-ae") == 0)
+                value = &_atlasExtrude;
+            else if (str.compare("-as") == 0)
+                value = &_atlasMaxSize;
+            else
+                break;
+
+            (*index)++;
+            int n;
+            if (*index >= options.size() || (n = atoi(options[*index].c_str())) < 0 || (value == &_atlasMaxSize && n == 0))
+            {
+                LOG(1, "Error: invalid argument for %s.\n", str.c_str());
+                _parseError = true;
+                return;
+            }
+            *value = (unsigned int)n;
+        }
+        break;
+    case 'c':
+        {
+            // Character codes and ranges of codes to generate glyphs for
+            (*index)++;
+            if (*index >= options.size())
+            {
+                LOG(1, "Error: missing argument for -c.\n");
+                _parseError = true;
+                return;
+            }
+            std::vector<std::string> ranges;
+            splitString(options[*index].c_str(), &ranges);
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                const char* range = ranges[i].c_str();
+                char* end;
+                unsigned long first = strtoul(range, &end, 0);
+                unsigned long last = first;
+                if (*end == '-')
+                {
+                    last = strtoul(end + 1, &end, 0);
+                }
+                if (end == range || *end != 0 || last < first || last > 0x10FFFF)
+                {
+                    LOG(1, "Error: invalid character range for -c: %s\n", range);
+                    _parseError = true;
+                    return;
+                }
+                for (unsigned long c = first; c <= last; ++c)
+                {
+                    _fontCharacters.push_back((unsigned int)c);
+                }
+            }
+        }
+        break;
     case 'f':
         if (str.compare("-f:b") == 0)
         {
@@ -677,6 +840,29 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
                 _tangentBinormalId.insert(nodeId);
             }
         }
+        else if (str.compare(0, 4, "-tc:") == 0)
+        {
+            // Compressed texture format
+            std::string format = str.substr(4);
+            if (format == "bc1")
+                _textureFormat = TextureCompressor::BC1;
+            else if (format == "bc3")
+                _textureFormat = TextureCompressor::BC3;
+            else if (format == "etc2")
+                _textureFormat = TextureCompressor::ETC2;
+            else if (format == "etc2a")
+                _textureFormat = TextureCompressor::ETC2_ALPHA;
+            else
+            {
+                LOG(1, "Error: unknown compressed texture format: %s\n", format.c_str());
+                _parseError = true;
+                return;
+            }
+        }
+        else if (str.compare("-tm") == 0)
+        {
+            _textureMipmaps = true;
+        }
         else if (str.compare("-textureGutter:none") == 0 || str.compare("-tg:none") == 0)
         {
             _generateTextureGutter = false;
@@ -4,6 +4,7 @@
 #include <set>
 #include "Vector3.h"
 #include "Font.h"
+#include "TextureCompressor.h"
 
 namespace gameplay
 {
@@ -23,7 +24,9 @@ public:
         FILEFORMAT_TTF,
         FILEFORMAT_GPB,
         FILEFORMAT_PNG,
-        FILEFORMAT_RAW
+        FILEFORMAT_RAW,
+        FILEFORMAT_PROPERTIES,
+        FILEFORMAT_DIRECTORY
     };
 
     struct HeightmapOption
@@ -66,6 +69,8 @@ public:
 
     /**
      * Gets the file format from the file path based on the extension.
+     *
+     * A directory is packed into a texture atlas.
      */
     FileFormat getFileFormat() const;
 
@@ -165,6 +170,11 @@ public:
 
     std::vector<unsigned int> getFontSizes() const;
 
+    /**
+     * Gets the character codes to generate glyphs for, space first.
+     */
+    std::vector<unsigned int> getFontCharacters() const;
+
     bool fontPreviewEnabled() const;
 
     Font::FontFormat getFontFormat() const;
@@ -179,6 +189,31 @@ public:
 
     const char* getNodeId() const;
 
+    /**
+     * Gets the number of pixels between images packed into a texture atlas.
+     */
+    unsigned int getAtlasPadding() const;
+
+    /**
+     * Gets the number of times the edge pixels of images packed into a texture atlas are repeated around them.
+     */
+    unsigned int getAtlasExtrude() const;
+
+    /**
+     * Gets the largest width and height of a texture atlas page.
+     */
+    unsigned int getAtlasMaxSize() const;
+
+    /**
+     * Gets the compressed texture format to write PNG images in, or NONE.
+     */
+    TextureCompressor::Format getTextureFormat() const;
+
+    /**
+     * Returns true if compressed textures are written with mipmaps.
+     */
+    bool textureMipmapsEnabled() const;
+
     static std::string getRealPath(const std::string& filepath);
 
 private:
@@ -217,6 +252,7 @@ private:
 
     bool _parseError;
     std::vector<unsigned int> _fontSizes;
+    std::vector<unsigned int> _fontCharacters;
     bool _fontPreview;
     Font::FontFormat _fontFormat;
     bool _textOutput;
@@ -224,6 +260,11 @@ private:
     AnimationGroupOption _animationGrouping;
     bool _outputMaterial;
     bool _generateTextureGutter;
+    unsigned int _atlasPadding;
+    unsigned int _atlasExtrude;
+    unsigned int _atlasMaxSize;
+    TextureCompressor::Format _textureFormat;
+    bool _textureMipmaps;
 
     std::vector<std::string> _groupAnimationNodeId;
     std::vector<std::string> _groupAnimationAnimationId;
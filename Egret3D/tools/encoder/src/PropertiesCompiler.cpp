@@ -0,0 +1,453 @@
+#include "Base.h"
+#include "PropertiesCompiler.h"
+#include "FileIO.h"
+
+#define PROPERTIES_BINARY_MAGIC "GPPB"
+#define PROPERTIES_BINARY_VERSION 1
+
+namespace gameplay
+{
+
+static std::string trim(const std::string& str)
+{
+    size_t start = 0;
+    size_t end = str.size();
+    while (start < end && isspace((unsigned char)str[start]))
+        ++start;
+    while (end > start && isspace((unsigned char)str[end - 1]))
+        --end;
+    return str.substr(start, end - start);
+}
+
+/**
+ * Gets the next token of a line the way strtok() does, skipping the delimiter after it.
+ */
+static bool nextToken(const std::string& line, size_t* position, const char* delimiters, std::string* token)
+{
+    if (*position >= line.size())
+        return false;
+    size_t start = line.find_first_not_of(delimiters, *position);
+    if (start == std::string::npos)
+    {
+        *position = line.size();
+        return false;
+    }
+    size_t end = line.find_first_of(delimiters, start);
+    if (end == std::string::npos)
+        end = line.size();
+    *token = line.substr(start, end - start);
+    *position = end + 1;
+    return true;
+}
+
+PropertiesCompiler::PropertiesCompiler(const char* inputFile, const char* outputFile)
+    : _inputFile(inputFile), _outputFile(outputFile), _position(0)
+{
+}
+
+PropertiesCompiler::~PropertiesCompiler()
+{
+}
+
+bool PropertiesCompiler::compile()
+{
+    std::ifstream in(_inputFile.c_str(), std::ios::in | std::ios::binary);
+    if (!in)
+    {
+        LOG(1, "Error: Failed to open '%s'.\n", _inputFile.c_str());
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    _text = contents.str();
+    _position = 0;
+    if (_text.compare(0, 4, PROPERTIES_BINARY_MAGIC) == 0)
+    {
+        LOG(1, "Error: '%s' is already compiled.\n", _inputFile.c_str());
+        return false;
+    }
+
+    Namespace* root = new Namespace();
+    root->parent = NULL;
+    root->visited = false;
+    if (!readNamespace(root))
+    {
+        deleteNamespace(root);
+        return false;
+    }
+    resolveInheritance(root, NULL);
+
+    _strings.clear();
+    _stringIndices.clear();
+    addStrings(root);
+
+    FILE* file = fopen(_outputFile.c_str(), "wb");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open '%s' for writing.\n", _outputFile.c_str());
+        deleteNamespace(root);
+        return false;
+    }
+    fwrite(PROPERTIES_BINARY_MAGIC, 1, 4, file);
+    write((unsigned int)PROPERTIES_BINARY_VERSION, file);
+    write((unsigned int)_strings.size(), file);
+    for (size_t i = 0, count = _strings.size(); i < count; ++i)
+    {
+        write(_strings[i], file);
+    }
+    writeNamespace(root, file);
+    fclose(file);
+
+    LOG(1, "Compiled %u strings into '%s'.\n", (unsigned int)_strings.size(), _outputFile.c_str());
+    deleteNamespace(root);
+    return true;
+}
+
+bool PropertiesCompiler::readNamespace(Namespace* space)
+{
+    bool comment = false;
+    while (true)
+    {
+        skipWhiteSpace();
+        if (_position >= _text.size())
+            break;
+
+        std::string line = readLine();
+
+        // Comments only start or end at the start or end of a line, as at runtime
+        if (comment)
+        {
+            std::string trimmed = trim(line);
+            if (line.compare(0, 2, "*/") == 0 || (trimmed.size() >= 2 && trimmed.compare(trimmed.size() - 2, 2, "*/") == 0))
+                comment = false;
+            continue;
+        }
+        if (line.compare(0, 2, "/*") == 0)
+        {
+            comment = true;
+            continue;
+        }
+        if (line.compare(0, 2, "//") == 0)
+            continue;
+
+        size_t position = 0;
+        std::string name;
+        if (line.find('=') != std::string::npos)
+        {
+            // A name/value pair
+            if (!nextToken(line, &position, "=", &name))
+            {
+                LOG(1, "Error: Attribute without name in '%s'.\n", _inputFile.c_str());
+                return false;
+            }
+            name = trim(name);
+            std::string value = position < line.size() ? trim(line.substr(position)) : std::string();
+
+            if (name.size() > 3 && name.compare(0, 2, "${") == 0 && name[name.size() - 1] == '}')
+            {
+                setVariable(space, name.substr(2, name.size() - 3), value);
+            }
+            else
+            {
+                Property property;
+                property.name = name;
+                property.value = value;
+                space->properties.push_back(property);
+            }
+            continue;
+        }
+
+        // The line might begin or end a namespace, or be a name/value pair without '='
+        std::string trimmed = trim(line);
+        size_t openBrace = line.find('{');
+        size_t closeBrace = line.find('}');
+        bool endsOnLine = closeBrace != std::string::npos && trimmed.find('}') == trimmed.size() - 1;
+        bool inherits = line.find(':') != std::string::npos;
+
+        if (!nextToken(line, &position, " \t\r\n{", &name))
+        {
+            LOG(1, "Error: Failed to read the line '%s' in '%s'.\n", line.c_str(), _inputFile.c_str());
+            return false;
+        }
+        if (name[0] == '}')
+        {
+            // End of this namespace
+            return true;
+        }
+
+        // The ID and the ID of the parent namespace are optional
+        std::string id;
+        nextToken(line, &position, ":{", &id);
+        id = trim(id);
+        std::string parentId;
+        if (inherits && nextToken(line, &position, "{", &parentId))
+        {
+            parentId = trim(parentId);
+        }
+
+        bool isNamespace = openBrace != std::string::npos;
+        if (!isNamespace)
+        {
+            // The brace may start the next line
+            skipWhiteSpace();
+            if (_position < _text.size() && _text[_position] == '{')
+            {
+                ++_position;
+                isNamespace = true;
+                endsOnLine = false;
+            }
+        }
+
+        if (isNamespace)
+        {
+            Namespace* child = new Namespace();
+            child->name = name;
+            child->id = id;
+            child->parentId = parentId;
+            child->parent = space;
+            child->visited = false;
+            space->namespaces.push_back(child);
+
+            // A namespace closed on the line it is opened is empty
+            if (!endsOnLine && !readNamespace(child))
+                return false;
+        }
+        else
+        {
+            Property property;
+            property.name = name;
+            property.value = id;
+            space->properties.push_back(property);
+        }
+    }
+    return true;
+}
+
+std::string PropertiesCompiler::readLine()
+{
+    size_t end = _text.find('\n', _position);
+    if (end == std::string::npos)
+        end = _text.size();
+    std::string line = _text.substr(_position, end - _position);
+    _position = end < _text.size() ? end + 1 : end;
+    return line;
+}
+
+void PropertiesCompiler::skipWhiteSpace()
+{
+    while (_position < _text.size() && isspace((unsigned char)_text[_position]))
+        ++_position;
+}
+
+void PropertiesCompiler::resolveInheritance(Namespace* space, const char* id)
+{
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        Namespace* derived = id ? findNamespace(space, id) : space->namespaces[i];
+        if (derived == NULL)
+            return;
+
+        if (!derived->parentId.empty())
+        {
+            derived->visited = true;
+            Namespace* parent = findNamespace(space, derived->parentId);
+            if (parent && parent->visited)
+            {
+                LOG(1, "Warning: Namespace '%s' inherits from itself.\n", derived->parentId.c_str());
+            }
+            else if (parent)
+            {
+                resolveInheritance(space, parent->id.c_str());
+
+                // Start from a copy of the parent and override it with the child
+                std::vector<Namespace*> namespaces;
+                for (size_t j = 0; j < parent->namespaces.size(); ++j)
+                {
+                    namespaces.push_back(copyNamespace(parent->namespaces[j]));
+                }
+                Namespace* overrides = copyNamespace(derived);
+                for (size_t j = 0; j < derived->namespaces.size(); ++j)
+                {
+                    deleteNamespace(derived->namespaces[j]);
+                }
+                derived->properties = parent->properties;
+                derived->namespaces = namespaces;
+                mergeWith(derived, overrides);
+                deleteNamespace(overrides);
+            }
+            derived->visited = false;
+        }
+
+        resolveInheritance(derived, NULL);
+        if (id)
+            return;
+    }
+}
+
+void PropertiesCompiler::mergeWith(Namespace* space, const Namespace* overrides)
+{
+    for (size_t i = 0, count = overrides->properties.size(); i < count; ++i)
+    {
+        const Property& property = overrides->properties[i];
+        bool found = false;
+        for (size_t j = 0; j < space->properties.size() && !found; ++j)
+        {
+            if (space->properties[j].name == property.name)
+            {
+                space->properties[j].value = property.value;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            space->properties.push_back(property);
+        }
+    }
+
+    for (size_t i = 0, count = overrides->namespaces.size(); i < count; ++i)
+    {
+        const Namespace* child = overrides->namespaces[i];
+        bool merged = false;
+        for (size_t j = 0; j < space->namespaces.size(); ++j)
+        {
+            Namespace* derived = space->namespaces[j];
+            if (derived->name == child->name && derived->id == child->id)
+            {
+                mergeWith(derived, child);
+                merged = true;
+            }
+        }
+        if (!merged)
+        {
+            space->namespaces.push_back(copyNamespace(child));
+        }
+    }
+}
+
+PropertiesCompiler::Namespace* PropertiesCompiler::findNamespace(const Namespace* space, const std::string& id)
+{
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        Namespace* child = space->namespaces[i];
+        if (child->id == id)
+            return child;
+        Namespace* found = findNamespace(child, id);
+        if (found)
+            return found;
+    }
+    return NULL;
+}
+
+PropertiesCompiler::Namespace* PropertiesCompiler::copyNamespace(const Namespace* space)
+{
+    // Variables are not copied, as at runtime
+    Namespace* copy = new Namespace();
+    copy->name = space->name;
+    copy->id = space->id;
+    copy->parentId = space->parentId;
+    copy->properties = space->properties;
+    copy->parent = space->parent;
+    copy->visited = false;
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        copy->namespaces.push_back(copyNamespace(space->namespaces[i]));
+    }
+    return copy;
+}
+
+void PropertiesCompiler::deleteNamespace(Namespace* space)
+{
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        deleteNamespace(space->namespaces[i]);
+    }
+    delete space;
+}
+
+void PropertiesCompiler::setVariable(Namespace* space, const std::string& name, const std::string& value)
+{
+    // Set the variable where an enclosing namespace defines it, else define it here
+    Property* variable = NULL;
+    for (Namespace* current = space; current; current = current->parent)
+    {
+        for (size_t i = 0, count = current->variables.size(); i < count; ++i)
+        {
+            if (current->variables[i].name == name)
+            {
+                variable = &current->variables[i];
+                break;
+            }
+        }
+    }
+    if (variable)
+    {
+        variable->value = value;
+    }
+    else
+    {
+        Property property;
+        property.name = name;
+        property.value = value;
+        space->variables.push_back(property);
+    }
+}
+
+void PropertiesCompiler::addStrings(const Namespace* space)
+{
+    addString(space->name);
+    addString(space->id);
+    for (size_t i = 0, count = space->properties.size(); i < count; ++i)
+    {
+        addString(space->properties[i].name);
+        addString(space->properties[i].value);
+    }
+    for (size_t i = 0, count = space->variables.size(); i < count; ++i)
+    {
+        addString(space->variables[i].name);
+        addString(space->variables[i].value);
+    }
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        addStrings(space->namespaces[i]);
+    }
+}
+
+unsigned int PropertiesCompiler::addString(const std::string& str)
+{
+    std::map<std::string, unsigned int>::const_iterator itr = _stringIndices.find(str);
+    if (itr != _stringIndices.end())
+        return itr->second;
+
+    unsigned int index = (unsigned int)_strings.size();
+    _strings.push_back(str);
+    _stringIndices[str] = index;
+    return index;
+}
+
+void PropertiesCompiler::writeNamespace(const Namespace* space, FILE* file)
+{
+    write(addString(space->name), file);
+    write(addString(space->id), file);
+
+    write((unsigned int)space->properties.size(), file);
+    for (size_t i = 0, count = space->properties.size(); i < count; ++i)
+    {
+        write(addString(space->properties[i].name), file);
+        write(addString(space->properties[i].value), file);
+    }
+
+    write((unsigned int)space->variables.size(), file);
+    for (size_t i = 0, count = space->variables.size(); i < count; ++i)
+    {
+        write(addString(space->variables[i].name), file);
+        write(addString(space->variables[i].value), file);
+    }
+
+    write((unsigned int)space->namespaces.size(), file);
+    for (size_t i = 0, count = space->namespaces.size(); i < count; ++i)
+    {
+        writeNamespace(space->namespaces[i], file);
+    }
+}
+
+}
@@ -0,0 +1,123 @@
+#ifndef PROPERTIESCOMPILER_H_
+#define PROPERTIESCOMPILER_H_
+
+namespace gameplay
+{
+
+/**
+ * Compiles a properties file (.material, .scene, .physics, ...) into its binary form.
+ *
+ * The file is parsed the way the runtime parses it and inheritance ("name id : parentID")
+ * is resolved, so the runtime only has to read the namespaces back. Names and values are
+ * stored once in a table of strings and referred to by index:
+ *
+ * "GPPB", version, string count, { length, characters } per string, root namespace
+ *
+ * where a namespace is:
+ *
+ * name, id, property count, { name, value } per property,
+ * variable count, { name, value } per variable, namespace count, nested namespaces
+ *
+ * All numbers are 32 bit unsigned integers. The runtime recognises the binary form by
+ * its first four bytes, so a compiled file can keep the name of the text file it replaces.
+ */
+class PropertiesCompiler
+{
+public:
+
+    PropertiesCompiler(const char* inputFile, const char* outputFile);
+    ~PropertiesCompiler();
+
+    /**
+     * Parses the text file and writes the binary file.
+     *
+     * @return True if the file was written.
+     */
+    bool compile();
+
+private:
+
+    /**
+     * A name/value pair.
+     */
+    struct Property
+    {
+        std::string name;
+        std::string value;
+    };
+
+    /**
+     * A namespace of the file.
+     */
+    struct Namespace
+    {
+        std::string name;
+        std::string id;
+        std::string parentId;
+        std::vector<Property> properties;
+        std::vector<Property> variables;
+        std::vector<Namespace*> namespaces;
+        Namespace* parent;
+        bool visited;
+    };
+
+    // Hidden copy/assignment
+    PropertiesCompiler(const PropertiesCompiler&);
+    PropertiesCompiler& operator=(const PropertiesCompiler&);
+
+    /**
+     * Reads the properties and nested namespaces of a namespace up to its closing brace.
+     */
+    bool readNamespace(Namespace* space);
+
+    /**
+     * Reads the rest of the current line.
+     */
+    std::string readLine();
+
+    /**
+     * Skips whitespace up to the next character.
+     */
+    void skipWhiteSpace();
+
+    /**
+     * Merges the namespaces of a namespace with the namespaces they inherit from.
+     */
+    static void resolveInheritance(Namespace* space, const char* id);
+
+    /**
+     * Overrides the properties and nested namespaces of a namespace.
+     */
+    static void mergeWith(Namespace* space, const Namespace* overrides);
+
+    /**
+     * Finds a nested namespace by ID.
+     */
+    static Namespace* findNamespace(const Namespace* space, const std::string& id);
+
+    static Namespace* copyNamespace(const Namespace* space);
+
+    static void deleteNamespace(Namespace* space);
+
+    static void setVariable(Namespace* space, const std::string& name, const std::string& value);
+
+    /**
+     * Adds the names and values of a namespace to the table of strings.
+     */
+    void addStrings(const Namespace* space);
+
+    unsigned int addString(const std::string& str);
+
+    void writeNamespace(const Namespace* space, FILE* file);
+
+    std::string _inputFile;
+    std::string _outputFile;
+    std::string _text;
+    size_t _position;
+    std::vector<std::string> _strings;
+    std::map<std::string, unsigned int> _stringIndices;
+};
+
+}
+
+#endif
@@ -111,7 +111,7 @@ unsigned char* createDistanceFields(unsigned char* img, unsigned int width, unsi
 struct FontData
 {
     // Array of glyphs for a font
-    TTFGlyph glyphArray[END_INDEX - START_INDEX];
+    std::vector<TTFGlyph> glyphArray;
 
     // Stores final height of a row required to render all glyphs
     int fontSize;
@@ -135,7 +135,8 @@ struct FontData
     }
 };
  
-int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsigned int>& fontSizes, const char* id, bool fontpreview = false, Font::FontFormat fontFormat = Font::BITMAP)
+int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsigned int>& fontSizes, const std::vector<unsigned int>& requestedCharacters,
+              const char* id, bool fontpreview = false, Font::FontFormat fontFormat = Font::BITMAP)
 {
     // Initialize freetype library.
     FT_Library library;
@@ -155,6 +156,34 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
         return -1;
     }
 
+    // Skip characters the face has no glyph for, except space which the runtime relies on.
+    std::vector<unsigned int> characters;
+    for (size_t i = 0, count = requestedCharacters.size(); i < count; ++i)
+    {
+        unsigned int character = requestedCharacters[i];
+        if (character == ' ' || FT_Get_Char_Index(face, character) != 0)
+        {
+            characters.push_back(character);
+        }
+    }
+    if (characters.size() < requestedCharacters.size())
+    {
+        LOG(2, "Skipped %u characters not found in the font.\n", (unsigned int)(requestedCharacters.size() - characters.size()));
+    }
+
+    // A distance field scales to any size, so a single atlas at the largest size is enough.
+    int padding = GLYPH_PADDING;
+    if (fontFormat == Font::DISTANCE_FIELD)
+    {
+        padding = DISTANCE_FIELD_PADDING;
+        if (fontSizes.size() > 1)
+        {
+            unsigned int largest = *std::max_element(fontSizes.begin(), fontSizes.end());
+            LOG(1, "Distance field fonts are drawn at any size; generating size %u only.\n", largest);
+            fontSizes.assign(1, largest);
+        }
+    }
+
     std::vector<FontData*> fonts;
 
     for (size_t fontIndex = 0, count = fontSizes.size(); fontIndex < count; ++fontIndex)
@@ -164,7 +193,8 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
         FontData* font = new FontData();
         font->fontSize = fontSize;
 
-        TTFGlyph* glyphArray = font->glyphArray;
+        font->glyphArray.resize(characters.size());
+        TTFGlyph* glyphArray = &font->glyphArray[0];
 
         int rowSize = 0;
         int glyphSize = 0;
@@ -195,10 +225,10 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
             actualfontHeight = 0;
 
             // Find the width of the image.
-            for (unsigned char ascii = START_INDEX; ascii < END_INDEX; ++ascii)
+            for (size_t c = 0, count = characters.size(); c < count; ++c)
             {
                 // Load glyph image into the slot (erase previous one)
-                error = FT_Load_Char(face, ascii, loadFlags);
+                error = FT_Load_Char(face, characters[c], loadFlags);
                 if (error)
                 {
                     LOG(1, "FT_Load_Char error : %d \n", error);
@@ -230,7 +260,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
         }
 
         // Include padding in the rowSize.
-        rowSize += GLYPH_PADDING;
+        rowSize += padding;
 
         // Initialize with padding.
         int penX = 0;
@@ -255,10 +285,10 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
 
             // Find out the squared texture size that would fit all the require font glyphs.
             i = 0;
-            for (unsigned char ascii = START_INDEX; ascii < END_INDEX; ++ascii)
+            for (size_t c = 0, count = characters.size(); c < count; ++c)
             {
                 // Load glyph image into the slot (erase the previous one).
-                error = FT_Load_Char(face, ascii, loadFlags);
+                error = FT_Load_Char(face, characters[c], loadFlags);
                 if (error)
                 {
                     LOG(1, "FT_Load_Char error : %d \n", error);
@@ -267,7 +297,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
                 int glyphWidth = slot->bitmap.pitch;
                 int glyphHeight = slot->bitmap.rows;
 
-                advance = glyphWidth + GLYPH_PADDING; 
+                advance = glyphWidth + padding;
 
                 // If we reach the end of the image wrap aroud to the next row.
                 if ((penX + advance) > (int)imageWidth)
@@ -290,7 +320,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
                 // Move Y back to the top of the row.
                 penY = row * rowSize;
 
-                if (ascii == (END_INDEX - 1))
+                if (c == count - 1)
                 {
                     textureSizeFound = true;
                 }
@@ -320,10 +350,10 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
         penY = 0;
         row = 0;
         i = 0;
-        for (unsigned char ascii = START_INDEX; ascii < END_INDEX; ++ascii)
+        for (size_t c = 0, count = characters.size(); c < count; ++c)
         {
             // Load glyph image into the slot (erase the previous one).
-            error = FT_Load_Char(face, ascii, loadFlags);
+            error = FT_Load_Char(face, characters[c], loadFlags);
             if (error)
             {
                 LOG(1, "FT_Load_Char error : %d \n", error);
@@ -334,7 +364,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
             int glyphWidth = slot->bitmap.pitch;
             int glyphHeight = slot->bitmap.rows;
 
-            advance = glyphWidth + GLYPH_PADDING;
+            advance = glyphWidth + padding;
 
             // If we reach the end of the image wrap aroud to the next row.
             if ((penX + advance) > (int)imageWidth)
@@ -359,16 +389,16 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
             // Move Y back to the top of the row.
             penY = row * rowSize;
 
-            glyphArray[i].index = ascii;
-            glyphArray[i].width = advance - GLYPH_PADDING;
+            glyphArray[i].index = characters[c];
+            glyphArray[i].width = advance - padding;
             glyphArray[i].bearingX = slot->metrics.horiBearingX >> 6;
             glyphArray[i].advance = slot->metrics.horiAdvance >> 6;
 
             // Generate UV coords.
             glyphArray[i].uvCoords[0] = (float)penX / (float)imageWidth;
             glyphArray[i].uvCoords[1] = (float)penY / (float)imageHeight;
-            glyphArray[i].uvCoords[2] = (float)(penX + advance - GLYPH_PADDING) / (float)imageWidth;
-            glyphArray[i].uvCoords[3] = (float)(penY + rowSize - GLYPH_PADDING) / (float)imageHeight;
+            glyphArray[i].uvCoords[2] = (float)(penX + advance - padding) / (float)imageWidth;
+            glyphArray[i].uvCoords[3] = (float)(penY + rowSize - padding) / (float)imageHeight;
 
             // Set the pen position for the next glyph
             penX += advance;
@@ -415,7 +445,7 @@ int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsig
         writeString(gpbFp, "");
 
         // Glyphs.
-        unsigned int glyphSetSize = END_INDEX - START_INDEX;
+        unsigned int glyphSetSize = (unsigned int)font->glyphArray.size();
         writeUint(gpbFp, glyphSetSize);
         for (unsigned int j = 0; j < glyphSetSize; j++)
         {
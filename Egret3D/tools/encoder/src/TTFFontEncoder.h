@@ -6,6 +6,10 @@
 #define END_INDEX       127
 #define GLYPH_PADDING   4
 
+// Distance field glyphs are spaced further apart so that the field around
+// a glyph does not run into its neighbours.
+#define DISTANCE_FIELD_PADDING 8
+
 namespace gameplay
 {
 
@@ -25,12 +29,15 @@ public:
  * 
  * @param inFilePath Input file path to the tiff file.
  * @param outFilePath Output file path to write the gpb to.
- * @param fontSizes List of sizes to generate for the font.
+ * @param fontSizes List of sizes to generate for the font. Distance field fonts are
+ *        generated at the largest size only, since they are drawn at any size.
+ * @param characters The character codes to generate glyphs for, space first.
  * @param id ID string of the font in the ref table.
  * @param fontpreview True if the pgm font preview file should be written. (For debugging)
  * 
  * @return 0 if successful, -1 if error.
  */
-int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsigned int>& fontSize, const char* id, bool fontpreview, Font::FontFormat fontFormat);
+int writeFont(const char* inFilePath, const char* outFilePath, std::vector<unsigned int>& fontSize, const std::vector<unsigned int>& characters,
+              const char* id, bool fontpreview, Font::FontFormat fontFormat);
 
 }
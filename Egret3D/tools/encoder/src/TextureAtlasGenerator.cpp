@@ -0,0 +1,381 @@
+#include "Base.h"
+#include "TextureAtlasGenerator.h"
+#include "StringUtil.h"
+#include <climits>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <dirent.h>
+#endif
+
+namespace gameplay
+{
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+static bool compareSpriteSize(const Image* a, const Image* b)
+{
+    return max(a->getWidth(), a->getHeight()) > max(b->getWidth(), b->getHeight());
+}
+
+TextureAtlasGenerator::TextureAtlasGenerator(const char* inputDirectory, const char* outputFile, unsigned int padding, unsigned int extrude, unsigned int maxSize)
+    : _inputDirectory(inputDirectory), _outputFile(outputFile), _padding(padding), _extrude(extrude), _maxSize(maxSize)
+{
+}
+
+TextureAtlasGenerator::~TextureAtlasGenerator()
+{
+    for (size_t i = 0, count = _sprites.size(); i < count; ++i)
+    {
+        delete _sprites[i].image;
+    }
+}
+
+bool TextureAtlasGenerator::generate()
+{
+    findImages(_inputDirectory, "");
+    if (_sprites.empty())
+    {
+        LOG(1, "Error: No PNG images found in '%s'.\n", _inputDirectory.c_str());
+        return false;
+    }
+
+    // Place the largest images first, ordering images of the same size by name so that
+    // the same directory always gives the same atlas.
+    struct SpriteOrder
+    {
+        bool operator()(const Sprite& a, const Sprite& b) const
+        {
+            if (compareSpriteSize(a.image, b.image))
+                return true;
+            if (compareSpriteSize(b.image, a.image))
+                return false;
+            return a.name < b.name;
+        }
+    };
+    std::sort(_sprites.begin(), _sprites.end(), SpriteOrder());
+
+    std::vector<Page> pages;
+    for (size_t i = 0, count = _sprites.size(); i < count; ++i)
+    {
+        Sprite& sprite = _sprites[i];
+        unsigned int width = sprite.image->getWidth() + 2 * _extrude + _padding;
+        unsigned int height = sprite.image->getHeight() + 2 * _extrude + _padding;
+        if (width > _maxSize || height > _maxSize)
+        {
+            LOG(1, "Error: Image '%s' (%ux%u) does not fit in an atlas page of %ux%u.\n",
+                sprite.name.c_str(), sprite.image->getWidth(), sprite.image->getHeight(), _maxSize, _maxSize);
+            return false;
+        }
+
+        unsigned int x, y;
+        size_t page = 0;
+        for (; page < pages.size(); ++page)
+        {
+            if (insert(&pages[page], width, height, &x, &y))
+                break;
+        }
+        if (page == pages.size())
+        {
+            Page newPage;
+            Rect free = { 0, 0, _maxSize, _maxSize };
+            newPage.freeRects.push_back(free);
+            newPage.width = 0;
+            newPage.height = 0;
+            pages.push_back(newPage);
+            insert(&pages[page], width, height, &x, &y);
+        }
+
+        // The padding is only needed between images, not at the edges of the page
+        pages[page].width = max(pages[page].width, x + width - _padding);
+        pages[page].height = max(pages[page].height, y + height - _padding);
+        sprite.page = (unsigned int)page;
+        sprite.x = x + _extrude;
+        sprite.y = y + _extrude;
+    }
+
+    FILE* file = fopen(_outputFile.c_str(), "w");
+    if (!file)
+    {
+        LOG(1, "Error: Failed to open '%s' for writing.\n", _outputFile.c_str());
+        return false;
+    }
+
+    std::string outputDirectory;
+    std::string baseName = getFilenameNoExt(getFilenameFromFilePath(_outputFile));
+    size_t pos = _outputFile.find_last_of('/');
+    if (pos != std::string::npos)
+    {
+        outputDirectory = _outputFile.substr(0, pos + 1);
+    }
+
+    fprintf(file, "atlas\n{\n");
+    for (size_t page = 0, count = pages.size(); page < count; ++page)
+    {
+        std::string pageName = baseName;
+        if (count > 1)
+        {
+            char suffix[16];
+            sprintf(suffix, "_%u", (unsigned int)page);
+            pageName += suffix;
+        }
+        pageName += ".png";
+
+        unsigned int width = nextPowerOfTwo(pages[page].width);
+        unsigned int height = nextPowerOfTwo(pages[page].height);
+        writePage((unsigned int)page, width, height, outputDirectory + pageName);
+        LOG(2, "Atlas page '%s': %ux%u\n", pageName.c_str(), width, height);
+
+        fprintf(file, "    page\n    {\n        path = %s\n", pageName.c_str());
+        for (size_t i = 0, spriteCount = _sprites.size(); i < spriteCount; ++i)
+        {
+            const Sprite& sprite = _sprites[i];
+            if (sprite.page == page)
+            {
+                fprintf(file, "        region %s\n        {\n            rect = %u, %u, %u, %u\n        }\n",
+                    sprite.name.c_str(), sprite.x, sprite.y, sprite.image->getWidth(), sprite.image->getHeight());
+            }
+        }
+        fprintf(file, "    }\n");
+    }
+    fprintf(file, "}\n");
+    fclose(file);
+
+    LOG(1, "Packed %u images into %u atlas pages.\n", (unsigned int)_sprites.size(), (unsigned int)pages.size());
+    return true;
+}
+
+void TextureAtlasGenerator::findImages(const std::string& directory, const std::string& prefix)
+{
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+
+#ifdef WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((directory + "/*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        LOG(1, "Error: Failed to open directory '%s'.\n", directory.c_str());
+        return;
+    }
+    do
+    {
+        std::string name = data.cFileName;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            directories.push_back(name);
+        else
+            files.push_back(name);
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir)
+    {
+        LOG(1, "Error: Failed to open directory '%s'.\n", directory.c_str());
+        return;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        struct stat buf;
+        if (stat((directory + "/" + name).c_str(), &buf) == 0 && S_ISDIR(buf.st_mode))
+            directories.push_back(name);
+        else
+            files.push_back(name);
+    }
+    closedir(dir);
+#endif
+
+    for (size_t i = 0, count = files.size(); i < count; ++i)
+    {
+        if (!endsWith(files[i], ".png"))
+            continue;
+
+        std::string path = directory + "/" + files[i];
+        Image* image = Image::create(path.c_str());
+        if (!image)
+        {
+            LOG(1, "Warning: Skipping '%s'.\n", path.c_str());
+            continue;
+        }
+
+        // Region names are namespace ids in the lookup file, so they cannot contain spaces
+        Sprite sprite;
+        sprite.name = prefix + getFilenameNoExt(files[i]);
+        std::replace(sprite.name.begin(), sprite.name.end(), ' ', '_');
+        sprite.image = image;
+        sprite.page = 0;
+        sprite.x = 0;
+        sprite.y = 0;
+        _sprites.push_back(sprite);
+    }
+
+    for (size_t i = 0, count = directories.size(); i < count; ++i)
+    {
+        if (directories[i] != "." && directories[i] != "..")
+        {
+            findImages(directory + "/" + directories[i], prefix + directories[i] + "/");
+        }
+    }
+}
+
+bool TextureAtlasGenerator::insert(Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y)
+{
+    // Best short side fit: choose the free rectangle that leaves the least space along
+    // its shorter side, breaking ties on the longer side.
+    size_t best = page->freeRects.size();
+    unsigned int bestShortSide = UINT_MAX;
+    unsigned int bestLongSide = UINT_MAX;
+    for (size_t i = 0, count = page->freeRects.size(); i < count; ++i)
+    {
+        const Rect& free = page->freeRects[i];
+        if (free.width < width || free.height < height)
+            continue;
+
+        unsigned int leftoverX = free.width - width;
+        unsigned int leftoverY = free.height - height;
+        unsigned int shortSide = min(leftoverX, leftoverY);
+        unsigned int longSide = max(leftoverX, leftoverY);
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+        {
+            best = i;
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+        }
+    }
+    if (best == page->freeRects.size())
+        return false;
+
+    Rect used = { page->freeRects[best].x, page->freeRects[best].y, width, height };
+    splitFreeRects(page, used);
+    pruneFreeRects(page);
+
+    *x = used.x;
+    *y = used.y;
+    return true;
+}
+
+void TextureAtlasGenerator::splitFreeRects(Page* page, const Rect& used)
+{
+    std::vector<Rect> freeRects;
+    for (size_t i = 0, count = page->freeRects.size(); i < count; ++i)
+    {
+        const Rect& free = page->freeRects[i];
+        if (used.x >= free.x + free.width || used.x + used.width <= free.x ||
+            used.y >= free.y + free.height || used.y + used.height <= free.y)
+        {
+            freeRects.push_back(free);
+            continue;
+        }
+
+        // Keep the parts of the free rectangle on each side of the used one; they overlap
+        // each other, which is what lets MaxRects find the largest free areas.
+        if (used.x > free.x)
+        {
+            Rect left = { free.x, free.y, used.x - free.x, free.height };
+            freeRects.push_back(left);
+        }
+        if (used.x + used.width < free.x + free.width)
+        {
+            Rect right = { used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height };
+            freeRects.push_back(right);
+        }
+        if (used.y > free.y)
+        {
+            Rect top = { free.x, free.y, free.width, used.y - free.y };
+            freeRects.push_back(top);
+        }
+        if (used.y + used.height < free.y + free.height)
+        {
+            Rect bottom = { free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height };
+            freeRects.push_back(bottom);
+        }
+    }
+    page->freeRects.swap(freeRects);
+}
+
+void TextureAtlasGenerator::pruneFreeRects(Page* page)
+{
+    // Remove free rectangles that lie inside others
+    std::vector<Rect>& rects = page->freeRects;
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        for (size_t j = i + 1; j < rects.size(); ++j)
+        {
+            const Rect& a = rects[i];
+            const Rect& b = rects[j];
+            if (a.x >= b.x && a.y >= b.y && a.x + a.width <= b.x + b.width && a.y + a.height <= b.y + b.height)
+            {
+                rects.erase(rects.begin() + i);
+                --i;
+                break;
+            }
+            if (b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height)
+            {
+                rects.erase(rects.begin() + j);
+                --j;
+            }
+        }
+    }
+}
+
+void TextureAtlasGenerator::writePage(unsigned int page, unsigned int width, unsigned int height, const std::string& path) const
+{
+    Image* atlas = Image::create(Image::RGBA, width, height);
+    unsigned char* data = (unsigned char*)atlas->getData();
+
+    for (size_t i = 0, count = _sprites.size(); i < count; ++i)
+    {
+        const Sprite& sprite = _sprites[i];
+        if (sprite.page != page)
+            continue;
+
+        const unsigned char* src = (const unsigned char*)sprite.image->getData();
+        unsigned int bpp = sprite.image->getBpp();
+        int imageWidth = (int)sprite.image->getWidth();
+        int imageHeight = (int)sprite.image->getHeight();
+        int extrude = (int)_extrude;
+
+        // Copy the image and repeat its edge pixels into the border around it
+        for (int y = -extrude; y < imageHeight + extrude; ++y)
+        {
+            int srcY = y < 0 ? 0 : (y >= imageHeight ? imageHeight - 1 : y);
+            for (int x = -extrude; x < imageWidth + extrude; ++x)
+            {
+                int srcX = x < 0 ? 0 : (x >= imageWidth ? imageWidth - 1 : x);
+                const unsigned char* pixel = src + (srcY * imageWidth + srcX) * bpp;
+                unsigned char* dst = data + ((sprite.y + y) * width + sprite.x + x) * 4;
+                switch (sprite.image->getFormat())
+                {
+                case Image::LUMINANCE:
+                    dst[0] = dst[1] = dst[2] = pixel[0];
+                    dst[3] = 255;
+                    break;
+                case Image::RGB:
+                    dst[0] = pixel[0];
+                    dst[1] = pixel[1];
+                    dst[2] = pixel[2];
+                    dst[3] = 255;
+                    break;
+                case Image::RGBA:
+                    memcpy(dst, pixel, 4);
+                    break;
+                }
+            }
+        }
+    }
+
+    atlas->save(path.c_str());
+    delete atlas;
+}
+
+}
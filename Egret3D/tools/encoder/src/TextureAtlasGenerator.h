@@ -0,0 +1,107 @@
+#ifndef TEXTUREATLASGENERATOR_H_
+#define TEXTUREATLASGENERATOR_H_
+
+#include "Image.h"
+
+namespace gameplay
+{
+
+/**
+ * Packs the PNG images of a directory into texture atlas pages.
+ *
+ * Images are placed with the MaxRects algorithm (best short side fit), largest first.
+ * Each image is surrounded by a border of its own edge pixels, so that filtering at the
+ * edge of an image does not sample its neighbours, and images are kept apart by the
+ * padding. A page is shrunk to the smallest power of two that holds its images; images
+ * that do not fit on a page start another one.
+ *
+ * Writes the pages as PNG files next to a lookup file with the ".atlas" extension:
+ *
+ * atlas
+ * {
+ *     page
+ *     {
+ *         path = ui.png
+ *         region icons/sword
+ *         {
+ *             rect = 1, 1, 32, 32
+ *         }
+ *     }
+ * }
+ *
+ * Region names are the paths of the images relative to the input directory, without
+ * the extension. The runtime resolves "ui.atlas#icons/sword" to the page and rectangle.
+ */
+class TextureAtlasGenerator
+{
+
+public:
+
+    TextureAtlasGenerator(const char* inputDirectory, const char* outputFile, unsigned int padding, unsigned int extrude, unsigned int maxSize);
+    ~TextureAtlasGenerator();
+
+    /**
+     * Packs the images and writes the pages and the lookup file.
+     *
+     * @return True if the atlas was written.
+     */
+    bool generate();
+
+private:
+
+    /**
+     * An image to pack.
+     */
+    struct Sprite
+    {
+        std::string name;
+        Image* image;
+        unsigned int page;
+        unsigned int x;
+        unsigned int y;
+    };
+
+    struct Rect
+    {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    /**
+     * Free space of a page being packed.
+     */
+    struct Page
+    {
+        std::vector<Rect> freeRects;
+        unsigned int width;
+        unsigned int height;
+    };
+
+    // Hidden copy/assignment
+    TextureAtlasGenerator(const TextureAtlasGenerator&);
+    TextureAtlasGenerator& operator=(const TextureAtlasGenerator&);
+
+    void findImages(const std::string& directory, const std::string& prefix);
+
+    static bool insert(Page* page, unsigned int width, unsigned int height, unsigned int* x, unsigned int* y);
+
+    static void splitFreeRects(Page* page, const Rect& used);
+
+    static void pruneFreeRects(Page* page);
+
+    void writePage(unsigned int page, unsigned int width, unsigned int height, const std::string& path) const;
+
+    std::string _inputDirectory;
+    std::string _outputFile;
+    unsigned int _padding;
+    unsigned int _extrude;
+    unsigned int _maxSize;
+    std::vector<Sprite> _sprites;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,645 @@
+#include "Base.h"
+#include "TextureCompressor.h"
+#include <climits>
+
+// OpenGL format values written to the KTX header
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+
+namespace gameplay
+{
+
+// The intensity modifiers of the ETC1 tables, indexed by the pixel index (msb, lsb).
+static const int ETC_MODIFIERS[8][4] =
+{
+    { 2, 8, -2, -8 },
+    { 5, 17, -5, -17 },
+    { 9, 29, -9, -29 },
+    { 13, 42, -13, -42 },
+    { 18, 60, -18, -60 },
+    { 24, 80, -24, -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 }
+};
+
+// The alpha modifiers of the EAC tables.
+static const int EAC_MODIFIERS[16][8] =
+{
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static int clampByte(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static int square(int value)
+{
+    return value * value;
+}
+
+static unsigned short packRGB565(const float* color)
+{
+    int r = clampByte((int)(color[0] + 0.5f));
+    int g = clampByte((int)(color[1] + 0.5f));
+    int b = clampByte((int)(color[2] + 0.5f));
+    return (unsigned short)((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+}
+
+static void unpackRGB565(unsigned short color, int* rgb)
+{
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void writeBigEndian64(unsigned long long bits, unsigned char* block)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        block[i] = (unsigned char)(bits >> (56 - i * 8));
+    }
+}
+
+static void writeUInt(unsigned int value, FILE* file)
+{
+    fwrite(&value, 4, 1, file);
+}
+
+/**
+ * Finds the ETC1 table and pixel indices of a subblock of 8 pixels for a base color.
+ *
+ * @return The squared error of the subblock.
+ */
+static int fitETC1Subblock(const unsigned char* pixels, const int* subblock, const int* base, unsigned int* table, unsigned int* indices)
+{
+    int bestError = INT_MAX;
+    for (unsigned int t = 0; t < 8; ++t)
+    {
+        int error = 0;
+        unsigned int tableIndices = 0;
+        for (unsigned int p = 0; p < 8; ++p)
+        {
+            const unsigned char* pixel = pixels + subblock[p] * 4;
+            int pixelError = INT_MAX;
+            for (unsigned int m = 0; m < 4; ++m)
+            {
+                int modifier = ETC_MODIFIERS[t][m];
+                int e = square(clampByte(base[0] + modifier) - pixel[0]) +
+                        square(clampByte(base[1] + modifier) - pixel[1]) +
+                        square(clampByte(base[2] + modifier) - pixel[2]);
+                if (e < pixelError)
+                {
+                    pixelError = e;
+                    tableIndices = (tableIndices & ~(3u << (p * 2))) | (m << (p * 2));
+                }
+            }
+            error += pixelError;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            *table = t;
+            *indices = tableIndices;
+        }
+    }
+    return bestError;
+}
+
+TextureCompressor::TextureCompressor(const char* inputFile, const char* outputFile, Format format, bool generateMipmaps)
+    : _inputFile(inputFile), _outputFile(outputFile), _format(format), _generateMipmaps(generateMipmaps)
+{
+}
+
+TextureCompressor::~TextureCompressor()
+{
+}
+
+bool TextureCompressor::compress()
+{
+    Image* image = Image::create(_inputFile.c_str());
+    if (image == NULL)
+        return false;
+
+    // Convert to RGBA, bottom row first
+    unsigned int width = image->getWidth();
+    unsigned int height = image->getHeight();
+    unsigned int bpp = image->getBpp();
+    const unsigned char* src = (const unsigned char*)image->getData();
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        const unsigned char* row = src + (height - 1 - y) * width * bpp;
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            const unsigned char* pixel = row + x * bpp;
+            unsigned char* dst = &rgba[(y * width + x) * 4];
+            switch (image->getFormat())
+            {
+            case Image::LUMINANCE:
+                dst[0] = dst[1] = dst[2] = pixel[0];
+                dst[3] = 255;
+                break;
+            case Image::RGB:
+                dst[0] = pixel[0];
+                dst[1] = pixel[1];
+                dst[2] = pixel[2];
+                dst[3] = 255;
+                break;
+            case Image::RGBA:
+                memcpy(dst, pixel, 4);
+                break;
+            }
+        }
+    }
+    delete image;
+
+    FILE* file = fopen(_outputFile.c_str(), "wb");
+    if (file == NULL)
+    {
+        LOG(1, "Error: Failed to open '%s' for writing.\n", _outputFile.c_str());
+        return false;
+    }
+
+    unsigned int levelCount = 1;
+    if (_generateMipmaps)
+    {
+        for (unsigned int size = max(width, height); size > 1; size >>= 1)
+            ++levelCount;
+    }
+
+    unsigned int internalFormat = 0;
+    unsigned int baseInternalFormat = GL_RGBA;
+    switch (_format)
+    {
+    case BC1:
+        internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        baseInternalFormat = GL_RGB;
+        break;
+    case BC3:
+        internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        break;
+    case ETC2:
+        internalFormat = GL_COMPRESSED_RGB8_ETC2;
+        baseInternalFormat = GL_RGB;
+        break;
+    case ETC2_ALPHA:
+        internalFormat = GL_COMPRESSED_RGBA8_ETC2_EAC;
+        break;
+    default:
+        break;
+    }
+
+    // KTX 1.1 header
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const char orientationKey[] = "KTXorientation\0S=r,T=u";
+    unsigned int keyValueSize = sizeof(orientationKey);
+    unsigned int keyValuePadding = 3 - ((keyValueSize + 3) % 4);
+    fwrite(identifier, 1, sizeof(identifier), file);
+    writeUInt(0x04030201, file);
+    writeUInt(0, file);                  // glType
+    writeUInt(1, file);                  // glTypeSize
+    writeUInt(0, file);                  // glFormat
+    writeUInt(internalFormat, file);
+    writeUInt(baseInternalFormat, file);
+    writeUInt(width, file);
+    writeUInt(height, file);
+    writeUInt(0, file);                  // pixelDepth
+    writeUInt(0, file);                  // numberOfArrayElements
+    writeUInt(1, file);                  // numberOfFaces
+    writeUInt(levelCount, file);
+    writeUInt(4 + keyValueSize + keyValuePadding, file);
+    writeUInt(keyValueSize, file);
+    fwrite(orientationKey, 1, keyValueSize, file);
+    static const unsigned char padding[3] = { 0, 0, 0 };
+    fwrite(padding, 1, keyValuePadding, file);
+
+    std::vector<unsigned char> data;
+    for (unsigned int level = 0; level < levelCount; ++level)
+    {
+        compressLevel(&rgba[0], width, height, &data);
+        writeUInt((unsigned int)data.size(), file);
+        fwrite(&data[0], 1, data.size(), file);
+
+        if (level + 1 < levelCount)
+        {
+            // Average 2x2 pixels into the next level
+            unsigned int mipWidth = max(width / 2, 1u);
+            unsigned int mipHeight = max(height / 2, 1u);
+            std::vector<unsigned char> mip(mipWidth * mipHeight * 4);
+            for (unsigned int y = 0; y < mipHeight; ++y)
+            {
+                unsigned int y0 = min(y * 2, height - 1);
+                unsigned int y1 = min(y * 2 + 1, height - 1);
+                for (unsigned int x = 0; x < mipWidth; ++x)
+                {
+                    unsigned int x0 = min(x * 2, width - 1);
+                    unsigned int x1 = min(x * 2 + 1, width - 1);
+                    for (unsigned int c = 0; c < 4; ++c)
+                    {
+                        mip[(y * mipWidth + x) * 4 + c] = (unsigned char)((rgba[(y0 * width + x0) * 4 + c] + rgba[(y0 * width + x1) * 4 + c] +
+                            rgba[(y1 * width + x0) * 4 + c] + rgba[(y1 * width + x1) * 4 + c] + 2) / 4);
+                    }
+                }
+            }
+            rgba.swap(mip);
+            width = mipWidth;
+            height = mipHeight;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+void TextureCompressor::compressLevel(const unsigned char* rgba, unsigned int width, unsigned int height, std::vector<unsigned char>* data) const
+{
+    unsigned int blockSize = (_format == BC1 || _format == ETC2) ? 8 : 16;
+    unsigned int blocksX = (width + 3) / 4;
+    unsigned int blocksY = (height + 3) / 4;
+    data->resize(blocksX * blocksY * blockSize);
+
+    unsigned char pixels[16 * 4];
+    unsigned char* block = &(*data)[0];
+    for (unsigned int by = 0; by < blocksY; ++by)
+    {
+        for (unsigned int bx = 0; bx < blocksX; ++bx)
+        {
+            // Gather the block, repeating the edge pixels of images smaller than a block
+            for (unsigned int y = 0; y < 4; ++y)
+            {
+                unsigned int sy = min(by * 4 + y, height - 1);
+                for (unsigned int x = 0; x < 4; ++x)
+                {
+                    unsigned int sx = min(bx * 4 + x, width - 1);
+                    memcpy(pixels + (y * 4 + x) * 4, rgba + (sy * width + sx) * 4, 4);
+                }
+            }
+
+            switch (_format)
+            {
+            case BC1:
+                compressBC1(pixels, block);
+                break;
+            case BC3:
+                compressBC3Alpha(pixels, block);
+                compressBC1(pixels, block + 8);
+                break;
+            case ETC2:
+                compressETC1(pixels, block);
+                break;
+            case ETC2_ALPHA:
+                compressEACAlpha(pixels, block);
+                compressETC1(pixels, block + 8);
+                break;
+            default:
+                break;
+            }
+            block += blockSize;
+        }
+    }
+}
+
+void TextureCompressor::compressBC1(const unsigned char* pixels, unsigned char* block)
+{
+    // Find the principal axis of the colors through their mean
+    float mean[3] = { 0, 0, 0 };
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        for (unsigned int c = 0; c < 3; ++c)
+            mean[c] += pixels[i * 4 + c];
+    }
+    for (unsigned int c = 0; c < 3; ++c)
+        mean[c] /= 16.0f;
+
+    float covariance[6] = { 0, 0, 0, 0, 0, 0 };
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        float r = pixels[i * 4] - mean[0];
+        float g = pixels[i * 4 + 1] - mean[1];
+        float b = pixels[i * 4 + 2] - mean[2];
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    float axis[3] = { 1, 1, 1 };
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        float length = max(fabsf(x), max(fabsf(y), fabsf(z)));
+        if (length == 0)
+            break;
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    // The extreme colors along the axis are the endpoints
+    float minProjection = FLT_MAX;
+    float maxProjection = -FLT_MAX;
+    unsigned int minPixel = 0;
+    unsigned int maxPixel = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        float projection = pixels[i * 4] * axis[0] + pixels[i * 4 + 1] * axis[1] + pixels[i * 4 + 2] * axis[2];
+        if (projection < minProjection)
+        {
+            minProjection = projection;
+            minPixel = i;
+        }
+        if (projection > maxProjection)
+        {
+            maxProjection = projection;
+            maxPixel = i;
+        }
+    }
+
+    float endpoint0[3] = { (float)pixels[maxPixel * 4], (float)pixels[maxPixel * 4 + 1], (float)pixels[maxPixel * 4 + 2] };
+    float endpoint1[3] = { (float)pixels[minPixel * 4], (float)pixels[minPixel * 4 + 1], (float)pixels[minPixel * 4 + 2] };
+    unsigned short color0 = packRGB565(endpoint0);
+    unsigned short color1 = packRGB565(endpoint1);
+
+    // The first color must be the greater for the block to be in four color mode
+    unsigned int indices = 0;
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            const unsigned char* pixel = pixels + i * 4;
+            int bestError = INT_MAX;
+            unsigned int best = 0;
+            for (unsigned int p = 0; p < 4; ++p)
+            {
+                int error = square(palette[p][0] - pixel[0]) + square(palette[p][1] - pixel[1]) + square(palette[p][2] - pixel[2]);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    block[0] = (unsigned char)color0;
+    block[1] = (unsigned char)(color0 >> 8);
+    block[2] = (unsigned char)color1;
+    block[3] = (unsigned char)(color1 >> 8);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        block[4 + i] = (unsigned char)(indices >> (i * 8));
+    }
+}
+
+void TextureCompressor::compressBC3Alpha(const unsigned char* pixels, unsigned char* block)
+{
+    int alpha0 = 0;
+    int alpha1 = 255;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        alpha0 = max(alpha0, (int)pixels[i * 4 + 3]);
+        alpha1 = min(alpha1, (int)pixels[i * 4 + 3]);
+    }
+
+    // The first alpha is the greater, giving six values between them
+    unsigned long long indices = 0;
+    if (alpha0 != alpha1)
+    {
+        int palette[8];
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int p = 1; p < 7; ++p)
+        {
+            palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+        }
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            int alpha = pixels[i * 4 + 3];
+            int bestError = INT_MAX;
+            unsigned long long best = 0;
+            for (unsigned int p = 0; p < 8; ++p)
+            {
+                int error = abs(palette[p] - alpha);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+
+    block[0] = (unsigned char)alpha0;
+    block[1] = (unsigned char)alpha1;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        block[2 + i] = (unsigned char)(indices >> (i * 8));
+    }
+}
+
+void TextureCompressor::compressETC1(const unsigned char* pixels, unsigned char* block)
+{
+    unsigned long long bestBits = 0;
+    int bestError = INT_MAX;
+
+    for (unsigned int flip = 0; flip < 2; ++flip)
+    {
+        // Pixels of the two subblocks, side by side or, flipped, one above the other
+        int subblocks[2][8];
+        int counts[2] = { 0, 0 };
+        for (int x = 0; x < 4; ++x)
+        {
+            for (int y = 0; y < 4; ++y)
+            {
+                int subblock = flip ? (y >= 2) : (x >= 2);
+                subblocks[subblock][counts[subblock]++] = y * 4 + x;
+            }
+        }
+
+        float average[2][3];
+        for (unsigned int s = 0; s < 2; ++s)
+        {
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+                int sum = 0;
+                for (unsigned int p = 0; p < 8; ++p)
+                    sum += pixels[subblocks[s][p] * 4 + c];
+                average[s][c] = sum / 8.0f;
+            }
+        }
+
+        for (unsigned int differential = 0; differential < 2; ++differential)
+        {
+            int quantized[2][3];
+            int base[2][3];
+            bool valid = true;
+            for (unsigned int s = 0; s < 2; ++s)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    if (differential)
+                    {
+                        quantized[s][c] = min(31, (int)(average[s][c] * 31.0f / 255.0f + 0.5f));
+                        base[s][c] = (quantized[s][c] << 3) | (quantized[s][c] >> 2);
+                    }
+                    else
+                    {
+                        quantized[s][c] = min(15, (int)(average[s][c] * 15.0f / 255.0f + 0.5f));
+                        base[s][c] = (quantized[s][c] << 4) | quantized[s][c];
+                    }
+                }
+            }
+            if (differential)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    int delta = quantized[1][c] - quantized[0][c];
+                    if (delta < -4 || delta > 3)
+                        valid = false;
+                }
+            }
+            if (!valid)
+                continue;
+
+            unsigned int tables[2];
+            unsigned int indices[2];
+            int error = fitETC1Subblock(pixels, subblocks[0], base[0], &tables[0], &indices[0]) +
+                        fitETC1Subblock(pixels, subblocks[1], base[1], &tables[1], &indices[1]);
+            if (error >= bestError)
+                continue;
+            bestError = error;
+
+            unsigned long long bits = 0;
+            if (differential)
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    int delta = quantized[1][c] - quantized[0][c];
+                    bits |= (unsigned long long)((quantized[0][c] << 3) | (delta & 7)) << (56 - c * 8);
+                }
+            }
+            else
+            {
+                for (unsigned int c = 0; c < 3; ++c)
+                {
+                    bits |= (unsigned long long)((quantized[0][c] << 4) | quantized[1][c]) << (56 - c * 8);
+                }
+            }
+            bits |= (unsigned long long)tables[0] << 37;
+            bits |= (unsigned long long)tables[1] << 34;
+            bits |= (unsigned long long)differential << 33;
+            bits |= (unsigned long long)flip << 32;
+
+            // Pixel indices are stored by column, most significant bits first
+            for (unsigned int s = 0; s < 2; ++s)
+            {
+                for (unsigned int p = 0; p < 8; ++p)
+                {
+                    int pixel = subblocks[s][p];
+                    int position = (pixel % 4) * 4 + pixel / 4;
+                    unsigned int index = (indices[s] >> (p * 2)) & 3;
+                    bits |= (unsigned long long)(index >> 1) << (16 + position);
+                    bits |= (unsigned long long)(index & 1) << position;
+                }
+            }
+            bestBits = bits;
+        }
+    }
+
+    writeBigEndian64(bestBits, block);
+}
+
+void TextureCompressor::compressEACAlpha(const unsigned char* pixels, unsigned char* block)
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        minAlpha = min(minAlpha, (int)pixels[i * 4 + 3]);
+        maxAlpha = max(maxAlpha, (int)pixels[i * 4 + 3]);
+    }
+
+    // Try every table and multiplier, centering the range of the table on the alpha range
+    int bestError = INT_MAX;
+    unsigned long long bestBits = 0;
+    for (int table = 0; table < 16; ++table)
+    {
+        const int* modifiers = EAC_MODIFIERS[table];
+        for (int multiplier = 1; multiplier < 16; ++multiplier)
+        {
+            int base = clampByte((int)floorf((minAlpha + maxAlpha) * 0.5f - multiplier * (modifiers[3] + modifiers[7]) * 0.5f + 0.5f));
+            int error = 0;
+            unsigned long long indices = 0;
+            for (unsigned int x = 0; x < 4 && error < bestError; ++x)
+            {
+                for (unsigned int y = 0; y < 4; ++y)
+                {
+                    int alpha = pixels[(y * 4 + x) * 4 + 3];
+                    int pixelError = INT_MAX;
+                    unsigned long long best = 0;
+                    for (unsigned int m = 0; m < 8; ++m)
+                    {
+                        int e = abs(clampByte(base + modifiers[m] * multiplier) - alpha);
+                        if (e < pixelError)
+                        {
+                            pixelError = e;
+                            best = m;
+                        }
+                    }
+                    error += pixelError * pixelError;
+                    indices |= best << (45 - (x * 4 + y) * 3);
+                }
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                bestBits = ((unsigned long long)base << 56) | ((unsigned long long)multiplier << 52) | ((unsigned long long)table << 48) | indices;
+            }
+        }
+    }
+
+    writeBigEndian64(bestBits, block);
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef TEXTURECOMPRESSOR_H_
+#define TEXTURECOMPRESSOR_H_
+
+#include "Image.h"
+
+namespace gameplay
+{
+
+/**
+ * Compresses a PNG image into a block compressed texture written as a KTX file.
+ *
+ * The texture is stored bottom row first, as the runtime uploads PNG images, so it
+ * can replace the PNG without changing texture coordinates. BC1 and BC3 are the DXT
+ * formats of desktop GPUs; ETC2 is required by OpenGL ES 3.0. The ETC2 RGB blocks only
+ * use the modes shared with ETC1. The runtime decompresses formats the GPU lacks.
+ */
+class TextureCompressor
+{
+public:
+
+    /**
+     * Defines the compressed texture formats.
+     */
+    enum Format
+    {
+        NONE,
+        BC1,
+        BC3,
+        ETC2,
+        ETC2_ALPHA
+    };
+
+    TextureCompressor(const char* inputFile, const char* outputFile, Format format, bool generateMipmaps);
+    ~TextureCompressor();
+
+    /**
+     * Compresses the image and writes the KTX file.
+     *
+     * @return True if the file was written.
+     */
+    bool compress();
+
+private:
+
+    // Hidden copy/assignment
+    TextureCompressor(const TextureCompressor&);
+    TextureCompressor& operator=(const TextureCompressor&);
+
+    /**
+     * Compresses an RGBA image into blocks of the format.
+     */
+    void compressLevel(const unsigned char* rgba, unsigned int width, unsigned int height, std::vector<unsigned char>* data) const;
+
+    /**
+     * Compresses the colors of 16 RGBA pixels into a BC1 block in four color mode.
+     */
+    static void compressBC1(const unsigned char* pixels, unsigned char* block);
+
+    /**
+     * Compresses the alpha of 16 RGBA pixels into a BC3 alpha block.
+     */
+    static void compressBC3Alpha(const unsigned char* pixels, unsigned char* block);
+
+    /**
+     * Compresses the colors of 16 RGBA pixels into an ETC1 block, also valid ETC2.
+     */
+    static void compressETC1(const unsigned char* pixels, unsigned char* block);
+
+    /**
+     * Compresses the alpha of 16 RGBA pixels into an ETC2 EAC alpha block.
+     */
+    static void compressEACAlpha(const unsigned char* pixels, unsigned char* block);
+
+    std::string _inputFile;
+    std::string _outputFile;
+    Format _format;
+    bool _generateMipmaps;
+};
+
+}
+
+#endif
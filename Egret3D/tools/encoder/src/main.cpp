@@ -5,6 +5,9 @@
 #include "GPBDecoder.h"
 #include "EncoderArguments.h"
 #include "NormalMapGenerator.h"
+#include "TextureAtlasGenerator.h"
+#include "TextureCompressor.h"
+#include "PropertiesCompiler.h"
 #include "Font.h"
 
 using namespace gameplay;
@@ -134,7 +137,8 @@ int main(int argc, const char** argv)
                 }
             }
             std::string id = getBaseName(arguments.getFilePath());
-            writeFont(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), fontSizes, id.c_str(), arguments.fontPreviewEnabled(), fontFormat);
+            std::vector<unsigned int> characters = arguments.getFontCharacters();
+            writeFont(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), fontSizes, characters, id.c_str(), arguments.fontPreviewEnabled(), fontFormat);
             break;
         }
     case EncoderArguments::FILEFORMAT_GPB:
@@ -154,6 +158,15 @@ int main(int argc, const char** argv)
                 NormalMapGenerator generator(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(), x, y, arguments.getHeightmapWorldSize());
                 generator.generate();
             }
+            else if (arguments.getTextureFormat() != TextureCompressor::NONE && arguments.getFileFormat() == EncoderArguments::FILEFORMAT_PNG)
+            {
+                TextureCompressor compressor(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(),
+                    arguments.getTextureFormat(), arguments.textureMipmapsEnabled());
+                if (!compressor.compress())
+                {
+                    return -1;
+                }
+            }
             else
             {
                 LOG(1, "Error: Nothing to do for specified file format. Did you forget an option?\n");
@@ -161,6 +174,25 @@ int main(int argc, const char** argv)
             }
             break;
         }
+    case EncoderArguments::FILEFORMAT_PROPERTIES:
+        {
+            PropertiesCompiler compiler(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str());
+            if (!compiler.compile())
+            {
+                return -1;
+            }
+            break;
+        }
+    case EncoderArguments::FILEFORMAT_DIRECTORY:
+        {
+            TextureAtlasGenerator generator(arguments.getFilePath().c_str(), arguments.getOutputFilePath().c_str(),
+                arguments.getAtlasPadding(), arguments.getAtlasExtrude(), arguments.getAtlasMaxSize());
+            if (!generator.generate())
+            {
+                return -1;
+            }
+            break;
+        }
    default:
         {
             LOG(1, "Error: Unsupported file format: %s\n", arguments.getFilePathPointer());